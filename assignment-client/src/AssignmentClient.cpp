@@ -24,6 +24,7 @@
 #include <LogHandler.h>
 #include <LogUtils.h>
 #include <LimitedNodeList.h>
+#include <MetricsRegistry.h>
 #include <NodeList.h>
 #include <udt/PacketHeaders.h>
 #include <SharedUtil.h>
@@ -45,13 +46,16 @@ const long long ASSIGNMENT_REQUEST_INTERVAL_MSECS = 1 * 1000;
 
 AssignmentClient::AssignmentClient(Assignment::Type requestAssignmentType, QString assignmentPool,
                                    quint16 listenPort, QUuid walletUUID, QString assignmentServerHostname,
-                                   quint16 assignmentServerPort, quint16 assignmentMonitorPort) :
-    _assignmentServerHostname(DEFAULT_ASSIGNMENT_SERVER_HOSTNAME)
+                                   quint16 assignmentServerPort, quint16 assignmentMonitorPort, quint16 metricsPort,
+                                   qint64 agentUnusedCacheSize) :
+    _assignmentServerHostname(DEFAULT_ASSIGNMENT_SERVER_HOSTNAME),
+    _agentUnusedCacheSize(agentUnusedCacheSize)
 {
     LogUtils::init();
 
     DependencyManager::set<tracing::Tracer>();
     DependencyManager::set<StatTracker>();
+    DependencyManager::set<MetricsRegistry>();
     DependencyManager::set<AccountManager>();
 
     auto scriptableAvatar = DependencyManager::set<ScriptableAvatar>();
@@ -67,6 +71,12 @@ AssignmentClient::AssignmentClient(Assignment::Type requestAssignmentType, QStri
     auto actionFactory = DependencyManager::set<AssignmentActionFactory>();
     DependencyManager::set<ResourceScriptingInterface>();
 
+    if (metricsPort != 0) {
+        // local only, scrapers run next to the assignment clients
+        _metricsHTTPManager = new HTTPManager(QHostAddress::LocalHost, metricsPort, QString(), &_metricsHandler, this);
+        qCDebug(assignment_client) << "Serving metrics on localhost port" << metricsPort;
+    }
+
     // setup a thread for the NodeList and its PacketReceiver
     QThread* nodeThread = new QThread(this);
     nodeThread->setObjectName("NodeList Thread");
@@ -252,6 +262,15 @@ void AssignmentClient::handleCreateAssignmentPacket(QSharedPointer<ReceivedMessa
 
         qCDebug(assignment_client) << "Destination IP for assignment is" << nodeList->getDomainHandler().getIP().toString();
 
+        if (_currentAssignment->getType() == Assignment::AgentType && _agentUnusedCacheSize >= 0) {
+            // domains can run hundreds of agents, each in its own process, so an agent shouldn't hold on to
+            // sounds and animations its script let go of the way an interface does
+            DependencyManager::get<SoundCache>()->setUnusedResourceCacheSize(_agentUnusedCacheSize);
+            DependencyManager::get<AnimationCache>()->setUnusedResourceCacheSize(_agentUnusedCacheSize);
+            qCDebug(assignment_client) << "Agent unused resource cache size set to"
+                << _agentUnusedCacheSize / BYTES_PER_MEGABYTES << "MB";
+        }
+
         // start the deployed assignment
         QThread* workerThread = new QThread;
         workerThread->setObjectName("ThreadedAssignment Worker");
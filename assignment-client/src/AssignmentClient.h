@@ -15,6 +15,9 @@
 #include <QtCore/QCoreApplication>
 #include <QtCore/QPointer>
 
+#include <HTTPManager.h>
+#include <MetricsHTTPHandler.h>
+
 #include "ThreadedAssignment.h"
 
 class QSharedMemory;
@@ -25,7 +28,7 @@ public:
     AssignmentClient(Assignment::Type requestAssignmentType, QString assignmentPool,
                      quint16 listenPort,
                      QUuid walletUUID, QString assignmentServerHostname, quint16 assignmentServerPort,
-                     quint16 assignmentMonitorPort);
+                     quint16 assignmentMonitorPort, quint16 metricsPort = 0, qint64 agentUnusedCacheSize = -1);
     ~AssignmentClient();
 
 private slots:
@@ -53,6 +56,9 @@ private:
     QTimer _requestTimer; // timer for requesting and assignment
     QTimer _statsTimerACM; // timer for sending stats to assignment client monitor
     QUuid _childAssignmentUUID = QUuid::createUuid();
+    MetricsHTTPHandler _metricsHandler;
+    HTTPManager* _metricsHTTPManager { nullptr };
+    qint64 _agentUnusedCacheSize { -1 }; // bytes, negative to keep the caches' default
 
  protected:
     HifiSockAddr _assignmentClientMonitorSocket;
@@ -13,6 +13,7 @@
 #include <QThread>
 
 #include <LogHandler.h>
+#include <ResourceCache.h>
 #include <SharedUtil.h>
 #include <HifiConfigVariantMap.h>
 #include <ShutdownEventListener.h>
@@ -87,6 +88,16 @@ AssignmentClientApp::AssignmentClientApp(int argc, char* argv[]) :
     const QCommandLineOption logDirectoryOption(ASSIGNMENT_LOG_DIRECTORY, "directory to store logs", "log-directory");
     parser.addOption(logDirectoryOption);
 
+    const QCommandLineOption metricsPortOption(ASSIGNMENT_METRICS_PORT_OPTION,
+                                               "localhost port serving /metrics, children of a monitor use the following ports",
+                                               "port");
+    parser.addOption(metricsPortOption);
+
+    const QCommandLineOption agentUnusedCacheOption(ASSIGNMENT_AGENT_UNUSED_CACHE_OPTION,
+                                                    "MB of unused sounds and animations an agent keeps cached",
+                                                    "megabytes");
+    parser.addOption(agentUnusedCacheOption);
+
     if (!parser.parse(QCoreApplication::arguments())) {
         qCritical() << parser.errorText() << endl;
         parser.showHelp();
@@ -136,6 +147,25 @@ AssignmentClientApp::AssignmentClientApp(int argc, char* argv[]) :
         logDirectory = parser.value(logDirectoryOption);
     }
 
+    quint16 metricsPort { 0 };
+    if (parser.isSet(metricsPortOption)) {
+        metricsPort = parser.value(metricsPortOption).toUShort();
+    }
+
+    // negative keeps the resource caches' own default
+    qint64 agentUnusedCacheSize = -1;
+    if (parser.isSet(agentUnusedCacheOption)) {
+        bool ok;
+        qint64 megabytes = parser.value(agentUnusedCacheOption).toLongLong(&ok);
+        if (!ok || megabytes < 0) {
+            qCritical() << "Invalid value for" << ASSIGNMENT_AGENT_UNUSED_CACHE_OPTION << ":"
+                << parser.value(agentUnusedCacheOption) << endl;
+            parser.showHelp();
+            Q_UNREACHABLE();
+        }
+        agentUnusedCacheSize = megabytes * BYTES_PER_MEGABYTES;
+    }
+
 
     Assignment::Type requestAssignmentType = Assignment::AllTypes;
     if (argumentVariantMap.contains(ASSIGNMENT_TYPE_OVERRIDE_OPTION)) {
@@ -207,13 +237,15 @@ AssignmentClientApp::AssignmentClientApp(int argc, char* argv[]) :
         AssignmentClientMonitor* monitor =  new AssignmentClientMonitor(numForks, minForks, maxForks,
                                                                         requestAssignmentType, assignmentPool,
                                                                         listenPort, walletUUID, assignmentServerHostname,
-                                                                        assignmentServerPort, httpStatusPort, logDirectory);
+                                                                        assignmentServerPort, httpStatusPort, logDirectory,
+                                                                        metricsPort, agentUnusedCacheSize);
         monitor->setParent(this);
         connect(this, &QCoreApplication::aboutToQuit, monitor, &AssignmentClientMonitor::aboutToQuit);
     } else {
         AssignmentClient* client = new AssignmentClient(requestAssignmentType, assignmentPool, listenPort,
                                                         walletUUID, assignmentServerHostname,
-                                                        assignmentServerPort, monitorPort);
+                                                        assignmentServerPort, monitorPort, metricsPort,
+                                                        agentUnusedCacheSize);
         client->setParent(this);
         connect(this, &QCoreApplication::aboutToQuit, client, &AssignmentClient::aboutToQuit);
     }
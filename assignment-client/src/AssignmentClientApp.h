@@ -27,6 +27,8 @@ const QString ASSIGNMENT_MAX_FORKS_OPTION = "max";
 const QString ASSIGNMENT_CLIENT_MONITOR_PORT_OPTION = "monitor-port";
 const QString ASSIGNMENT_HTTP_STATUS_PORT = "http-status-port";
 const QString ASSIGNMENT_LOG_DIRECTORY = "log-directory";
+const QString ASSIGNMENT_METRICS_PORT_OPTION = "metrics-port";
+const QString ASSIGNMENT_AGENT_UNUSED_CACHE_OPTION = "agent-unused-cache-mb";
 
 class AssignmentClientApp : public QCoreApplication {
     Q_OBJECT
@@ -17,6 +17,7 @@
 
 #include <AddressManager.h>
 #include <LogHandler.h>
+#include <ResourceCache.h>
 #include <udt/PacketHeaders.h>
 
 #include "AssignmentClientMonitor.h"
@@ -33,7 +34,8 @@ AssignmentClientMonitor::AssignmentClientMonitor(const unsigned int numAssignmen
                                                  const unsigned int maxAssignmentClientForks,
                                                  Assignment::Type requestAssignmentType, QString assignmentPool,
                                                  quint16 listenPort, QUuid walletUUID, QString assignmentServerHostname,
-                                                 quint16 assignmentServerPort, quint16 httpStatusServerPort, QString logDirectory) :
+                                                 quint16 assignmentServerPort, quint16 httpStatusServerPort, QString logDirectory,
+                                                 quint16 metricsPort, qint64 agentUnusedCacheSize) :
     _httpManager(QHostAddress::LocalHost, httpStatusServerPort, "", this),
     _numAssignmentClientForks(numAssignmentClientForks),
     _minAssignmentClientForks(minAssignmentClientForks),
@@ -42,7 +44,9 @@ AssignmentClientMonitor::AssignmentClientMonitor(const unsigned int numAssignmen
     _assignmentPool(assignmentPool),
     _walletUUID(walletUUID),
     _assignmentServerHostname(assignmentServerHostname),
-    _assignmentServerPort(assignmentServerPort)
+    _assignmentServerPort(assignmentServerPort),
+    _metricsPort(metricsPort),
+    _agentUnusedCacheSize(agentUnusedCacheSize)
 
 {
     qDebug() << "_requestAssignmentType =" << _requestAssignmentType;
@@ -154,6 +158,15 @@ void AssignmentClientMonitor::spawnChildClient() {
         _childArguments.append("--" + ASSIGNMENT_TYPE_OVERRIDE_OPTION);
         _childArguments.append(QString::number(_requestAssignmentType));
     }
+    quint16 metricsPort = getFreeMetricsPort();
+    if (metricsPort != 0) {
+        _childArguments.append("--" + ASSIGNMENT_METRICS_PORT_OPTION);
+        _childArguments.append(QString::number(metricsPort));
+    }
+    if (_agentUnusedCacheSize >= 0) {
+        _childArguments.append("--" + ASSIGNMENT_AGENT_UNUSED_CACHE_OPTION);
+        _childArguments.append(QString::number(_agentUnusedCacheSize / BYTES_PER_MEGABYTES));
+    }
 
     // tell children which assignment monitor port to use
     // for now they simply talk to us on localhost
@@ -223,10 +236,30 @@ void AssignmentClientMonitor::spawnChildClient() {
 
         qDebug() << "Spawned a child client with PID" << assignmentClient->processId();
 
-        _childProcesses.insert(assignmentClient->processId(), { assignmentClient, stdoutPath, stderrPath });
+        _childProcesses.insert(assignmentClient->processId(), { assignmentClient, stdoutPath, stderrPath, metricsPort });
     }
 }
 
+quint16 AssignmentClientMonitor::getFreeMetricsPort() const {
+    if (_metricsPort == 0) {
+        return 0;
+    }
+    // the lowest port after ours that no running child uses, so ports are reused as children come and go
+    for (quint16 port = _metricsPort; port != 0; port++) {
+        bool isUsed = false;
+        for (auto& ac : _childProcesses) {
+            if (ac.metricsPort == port) {
+                isUsed = true;
+                break;
+            }
+        }
+        if (!isUsed) {
+            return port;
+        }
+    }
+    return 0;
+}
+
 void AssignmentClientMonitor::checkSpares() {
     auto nodeList = DependencyManager::get<NodeList>();
     QUuid aSpareId = "";
@@ -330,6 +363,9 @@ bool AssignmentClientMonitor::handleHTTPRequest(HTTPConnection* connection, cons
             server["pid"] = ac.process->processId();
             server["logStdout"] = ac.logStdoutPath;
             server["logStderr"] = ac.logStderrPath;
+            if (ac.metricsPort != 0) {
+                server["metricsPort"] = ac.metricsPort;
+            }
 
             servers[QString::number(ac.process->processId())] = server;
         }
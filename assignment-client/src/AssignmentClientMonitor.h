@@ -30,6 +30,7 @@ struct ACProcess {
     QProcess* process; // looks like a dangling pointer, but is parented by the AssignmentClientMonitor 
     QString logStdoutPath;
     QString logStderrPath;
+    quint16 metricsPort; // 0 when the monitor wasn't given a metrics port
 };
 
 class AssignmentClientMonitor : public QObject, public HTTPRequestHandler {
@@ -38,7 +39,8 @@ public:
     AssignmentClientMonitor(const unsigned int numAssignmentClientForks, const unsigned int minAssignmentClientForks,
                             const unsigned int maxAssignmentClientForks, Assignment::Type requestAssignmentType,
                             QString assignmentPool, quint16 listenPort, QUuid walletUUID, QString assignmentServerHostname,
-                            quint16 assignmentServerPort, quint16 httpStatusServerPort, QString logDirectory);
+                            quint16 assignmentServerPort, quint16 httpStatusServerPort, QString logDirectory,
+                            quint16 metricsPort = 0, qint64 agentUnusedCacheSize = -1);
     ~AssignmentClientMonitor();
 
     void stopChildProcesses();
@@ -54,6 +56,7 @@ public slots:
 
 private:
     void spawnChildClient();
+    quint16 getFreeMetricsPort() const;
     void simultaneousWaitOnChildren(int waitMsecs);
 
     QTimer _checkSparesTimer; // every few seconds see if it need fewer or more spare children
@@ -71,6 +74,8 @@ private:
     QUuid _walletUUID;
     QString _assignmentServerHostname;
     quint16 _assignmentServerPort;
+    quint16 _metricsPort; // first port handed out to the children
+    qint64 _agentUnusedCacheSize; // bytes, negative to keep the children's default
 
     QMap<qint64, ACProcess> _childProcesses;
 
@@ -17,6 +17,7 @@
 #include <QtCore/QJsonValue>
 
 #include <LogHandler.h>
+#include <MetricsRegistry.h>
 #include <NetworkAccessManager.h>
 #include <NodeList.h>
 #include <Node.h>
@@ -355,6 +356,9 @@ void AudioMixer::start() {
     unsigned int frame = 1;
     auto frameTimestamp = p_high_resolution_clock::now();
 
+    // the stats only carry averages, the metrics endpoint gets the distribution
+    auto frameTimes = MetricsRegistry::findHistogram("audio_mixer_frame_usecs", "time spent on a mix frame, excluding sleep");
+
     while (!_isFinished) {
         auto ticTimer = _ticTiming.timer();
 
@@ -365,6 +369,7 @@ void AudioMixer::start() {
         }
 
         auto frameTimer = _frameTiming.timer();
+        MetricsRegistry::ScopedTimer frameTimeRecorder(frameTimes);
 
         nodeList->nestedEach([&](NodeList::const_iterator cbegin, NodeList::const_iterator cend) {
             // prepare frames; pop off any new audio from their streams
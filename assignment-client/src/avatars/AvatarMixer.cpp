@@ -25,6 +25,7 @@
 #include <AABox.h>
 #include <AvatarLogging.h>
 #include <LogHandler.h>
+#include <MetricsRegistry.h>
 #include <NodeList.h>
 #include <udt/PacketHeaders.h>
 #include <SharedUtil.h>
@@ -110,11 +111,16 @@ void AvatarMixer::start() {
     unsigned int frame = 1;
     auto frameTimestamp = p_high_resolution_clock::now();
 
+    // the stats only carry averages, the metrics endpoint gets the distribution
+    auto frameTimes = MetricsRegistry::findHistogram("avatar_mixer_frame_usecs", "time spent on a mixer frame, excluding sleep");
+
     while (!_isFinished) {
 
         auto frameDuration = timeFrame(frameTimestamp); // calculates last frame duration and sleeps remainder of target amount
         throttle(frameDuration, frame); // determines _throttlingRatio for upcoming mix frame
 
+        MetricsRegistry::ScopedTimer frameTimeRecorder(frameTimes);
+
         int lockWait, nodeTransform, functor;
 
         // Allow nodes to process any pending/queued packets across our worker threads
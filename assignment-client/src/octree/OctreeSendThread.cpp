@@ -40,6 +40,8 @@ OctreeSendThread::OctreeSendThread(OctreeServer* myServer, const SharedNodePoint
         safeServerName = _myServer->getMyServerName();
     }
 
+    _sendTimes = MetricsRegistry::findHistogram("octree_send_usecs", "time spent on one pass of a client's send thread");
+
     qDebug() << qPrintable(safeServerName)  << "server [" << _myServer << "]: client connected "
                                             "- starting sending thread [" << this << "]";
 
@@ -102,6 +104,9 @@ bool OctreeSendThread::process() {
     if (isStillRunning()) {
         // dynamically sleep until we need to fire off the next set of octree elements
         int elapsed = (usecTimestampNow() - start);
+        if (_sendTimes) {
+            _sendTimes->record(elapsed);
+        }
         int usecToSleep =  OCTREE_SEND_INTERVAL_USECS - elapsed;
 
         if (usecToSleep <= 0) {
@@ -17,6 +17,7 @@
 #include <atomic>
 
 #include <GenericThread.h>
+#include <MetricsRegistry.h>
 #include <Node.h>
 #include <OctreePacketData.h>
 
@@ -67,6 +68,7 @@ private:
     OctreePacketData _packetData;
 
     int _nodeMissingCount { 0 };
+    MetricsRegistry::Histogram* _sendTimes { nullptr };
     bool _isShuttingDown { false };
 };
 
@@ -13,11 +13,14 @@
 
 #include <mutex>
 
+#include <QtCore/QJsonDocument>
+
 #include <AudioConstants.h>
 #include <AudioInjectorManager.h>
 #include <ClientServerUtils.h>
 #include <EntityNodeData.h>
 #include <EntityScriptingInterface.h>
+#include <EntityScriptProgramCache.h>
 #include <LogHandler.h>
 #include <MessagesClient.h>
 #include <plugins/CodecPlugin.h>
@@ -104,7 +107,8 @@ void EntityScriptServer::handleReloadEntityServerScriptPacket(QSharedPointer<Rec
 
         if (_entityViewer.getTree() && !_shuttingDown) {
             qCDebug(entity_script_server) << "Reloading: " << entityID;
-            _entitiesScriptEngine->unloadEntityScript(entityID);
+            // released so the script goes to the engine of its current script group
+            unloadEntityScript(entityID);
             checkAndCallPreload(entityID, true);
         }
     }
@@ -122,7 +126,8 @@ void EntityScriptServer::handleEntityScriptGetStatusPacket(QSharedPointer<Receiv
         replyPacketList->writePrimitive(messageID);
 
         EntityScriptDetails details;
-        if (_entitiesScriptEngine->getEntityScriptDetails(entityID, details)) {
+        auto engine = _entitiesScriptEngines.find(entityID);
+        if (engine && engine->getEntityScriptDetails(entityID, details)) {
             replyPacketList->writePrimitive(true);
             replyPacketList->writePrimitive(details.status);
             replyPacketList->writeString(details.errorInfo);
@@ -151,6 +156,12 @@ void EntityScriptServer::handleSettings() {
 
     auto entityScriptServerSettings = settingsObject[ENTITY_SCRIPT_SERVER_SETTINGS_KEY].toObject();
 
+    static const QString ENTITY_SCRIPT_ENGINES_OPTION = "entity_script_engines";
+    if (entityScriptServerSettings.contains(ENTITY_SCRIPT_ENGINES_OPTION)) {
+        int numEngines = entityScriptServerSettings[ENTITY_SCRIPT_ENGINES_OPTION].toInt();
+        setNumEntitiesScriptEngines(std::max(1, std::min(numEngines, MAX_ENTITY_SCRIPT_ENGINES)));
+    }
+
     static const QString MAX_ENTITY_PPS_OPTION = "max_total_entity_pps";
     static const QString ENTITY_PPS_PER_SCRIPT = "entity_pps_per_script";
 
@@ -167,7 +178,7 @@ void EntityScriptServer::handleSettings() {
 }
 
 void EntityScriptServer::updateEntityPPS() {
-    int numRunningScripts = _entitiesScriptEngine->getNumRunningEntityScripts();
+    int numRunningScripts = _entitiesScriptEngines.getNumRunningEntityScripts();
     int pps;
     if (std::numeric_limits<int>::max() / _entityPPSPerScript < numRunningScripts) {
         qWarning() << QString("Integer multiplaction would overflow, clamping to maxint: %1 * %2").arg(numRunningScripts).arg(_entityPPSPerScript);
@@ -254,8 +265,9 @@ void EntityScriptServer::run() {
         NodeType::EntityServer, NodeType::MessagesMixer, NodeType::AssetServer
     });
 
-    // Setup Script Engine
-    resetEntitiesScriptEngine();
+    // Setup Script Engines
+    resetEntitiesScriptEngines();
+    DependencyManager::get<EntityScriptingInterface>()->setEntitiesScriptEngine(&_entitiesScriptEngines);
 
     // we need to make sure that init has been called for our EntityScriptingInterface
     // so that it actually has a jurisdiction listener when we ask it for it next
@@ -414,7 +426,7 @@ void EntityScriptServer::selectAudioFormat(const QString& selectedCodecName) {
     }
 }
 
-void EntityScriptServer::resetEntitiesScriptEngine() {
+QSharedPointer<ScriptEngine> EntityScriptServer::createEntitiesScriptEngine() {
     auto engineName = QString("about:Entities %1").arg(++_entitiesScriptEngineCount);
     auto newEngine = QSharedPointer<ScriptEngine>(new ScriptEngine(ScriptEngine::ENTITY_SERVER_SCRIPT, NO_SCRIPT, engineName),
                                                   &ScriptEngine::deleteLater);
@@ -431,40 +443,71 @@ void EntityScriptServer::resetEntitiesScriptEngine() {
     connect(newEngine.data(), &ScriptEngine::warningMessage, scriptEngines, &ScriptEngines::onWarningMessage);
     connect(newEngine.data(), &ScriptEngine::infoMessage, scriptEngines, &ScriptEngines::onInfoMessage);
 
-    connect(newEngine.data(), &ScriptEngine::update, this, [this] {
+    connect(newEngine.data(), &ScriptEngine::entityScriptDetailsUpdated, this, &EntityScriptServer::updateEntityPPS);
+
+    newEngine->runInThread();
+    return newEngine;
+}
+
+void EntityScriptServer::resetEntitiesScriptEngines() {
+    std::vector<QSharedPointer<ScriptEngine>> newEngines;
+    for (int i = 0; i < _numEntitiesScriptEngines; i++) {
+        newEngines.push_back(createEntitiesScriptEngine());
+    }
+
+    // the tree only needs to be updated once per frame, the first engine drives it
+    connect(newEngines.front().data(), &ScriptEngine::update, this, [this] {
         _entityViewer.queryOctree();
         _entityViewer.getTree()->update();
     });
 
+    for (auto& oldEngine : _entitiesScriptEngines.getEngines()) {
+        disconnect(oldEngine.data(), &ScriptEngine::entityScriptDetailsUpdated, this, &EntityScriptServer::updateEntityPPS);
+    }
+    _entitiesScriptEngines.setEngines(newEngines);
+}
 
-    newEngine->runInThread();
-    DependencyManager::get<EntityScriptingInterface>()->setEntitiesScriptEngine(newEngine.data());
+void EntityScriptServer::setNumEntitiesScriptEngines(int numEngines) {
+    if (numEngines == _numEntitiesScriptEngines) {
+        return;
+    }
+    qCDebug(entity_script_server) << "Running entity scripts on" << numEngines << "engines";
+    _numEntitiesScriptEngines = numEngines;
+    if (_shuttingDown || _entitiesScriptEngines.isEmpty()) {
+        return;
+    }
 
-    disconnect(_entitiesScriptEngine.data(), &ScriptEngine::entityScriptDetailsUpdated, this, &EntityScriptServer::updateEntityPPS);
-    _entitiesScriptEngine.swap(newEngine);
-    connect(_entitiesScriptEngine.data(), &ScriptEngine::entityScriptDetailsUpdated, this, &EntityScriptServer::updateEntityPPS);
+    // move every running script to its engine in the new pool
+    auto entityIDs = _entitiesScriptEngines.getAssignedEntities();
+    for (auto& engine : _entitiesScriptEngines.getEngines()) {
+        engine->unloadAllEntityScripts();
+        engine->stop();
+    }
+    resetEntitiesScriptEngines();
+    for (const auto& entityID : entityIDs) {
+        checkAndCallPreload(entityID);
+    }
 }
 
-
 void EntityScriptServer::clear() {
-    // unload and stop the engine
-    if (_entitiesScriptEngine) {
+    // unload and stop the engines
+    for (auto& engine : _entitiesScriptEngines.getEngines()) {
         // do this here (instead of in deleter) to avoid marshalling unload signals back to this thread
-        _entitiesScriptEngine->unloadAllEntityScripts();
-        _entitiesScriptEngine->stop();
+        engine->unloadAllEntityScripts();
+        engine->stop();
     }
 
     _entityViewer.clear();
 
-    // reset the engine
+    // reset the engines
     if (!_shuttingDown) {
-        resetEntitiesScriptEngine();
+        resetEntitiesScriptEngines();
     }
 }
 
 void EntityScriptServer::shutdownScriptEngine() {
-    if (_entitiesScriptEngine) {
-        _entitiesScriptEngine->disconnectNonEssentialSignals(); // disconnect all slots/signals from the script engine, except essential
+    for (auto& engine : _entitiesScriptEngines.getEngines()) {
+        engine->disconnectNonEssentialSignals(); // disconnect all slots/signals from the script engine, except essential
     }
     _shuttingDown = true;
 
@@ -476,37 +519,74 @@ void EntityScriptServer::addingEntity(const EntityItemID& entityID) {
 }
 
 void EntityScriptServer::deletingEntity(const EntityItemID& entityID) {
-    if (_entityViewer.getTree() && !_shuttingDown && _entitiesScriptEngine) {
-        _entitiesScriptEngine->unloadEntityScript(entityID, true);
+    if (_entityViewer.getTree() && !_shuttingDown) {
+        unloadEntityScript(entityID, true);
     }
 }
 
 void EntityScriptServer::entityServerScriptChanging(const EntityItemID& entityID, const bool reload) {
     if (_entityViewer.getTree() && !_shuttingDown) {
-        _entitiesScriptEngine->unloadEntityScript(entityID, true);
+        unloadEntityScript(entityID, true);
         checkAndCallPreload(entityID, reload);
     }
 }
 
+void EntityScriptServer::unloadEntityScript(const EntityItemID& entityID, const bool shouldRemoveFromMap) {
+    if (auto engine = _entitiesScriptEngines.find(entityID)) {
+        engine->unloadEntityScript(entityID, shouldRemoveFromMap);
+        _entitiesScriptEngines.release(entityID);
+    }
+}
+
+// Entities with the same "serverScriptGroup" in their user data share an engine, so busy scripts can be kept
+// away from the others by giving them a group of their own
+static QString getServerScriptGroup(const EntityItemPointer& entity) {
+    static const QString SERVER_SCRIPT_GROUP_KEY = "serverScriptGroup";
+    QString userData = entity->getUserData();
+    if (!userData.contains(SERVER_SCRIPT_GROUP_KEY)) {
+        return QString();
+    }
+    return QJsonDocument::fromJson(userData.toUtf8()).object()[SERVER_SCRIPT_GROUP_KEY].toString();
+}
+
 void EntityScriptServer::checkAndCallPreload(const EntityItemID& entityID, const bool reload) {
-    if (_entityViewer.getTree() && !_shuttingDown && _entitiesScriptEngine) {
+    if (_entityViewer.getTree() && !_shuttingDown && !_entitiesScriptEngines.isEmpty()) {
 
         EntityItemPointer entity = _entityViewer.getTree()->findEntityByEntityItemID(entityID);
         EntityScriptDetails details;
-        bool notRunning = !_entitiesScriptEngine->getEntityScriptDetails(entityID, details);
+        auto engine = _entitiesScriptEngines.find(entityID);
+        bool notRunning = !engine || !engine->getEntityScriptDetails(entityID, details);
         if (entity && (reload || notRunning || details.scriptText != entity->getServerScripts())) {
             QString scriptUrl = entity->getServerScripts();
             if (!scriptUrl.isEmpty()) {
                 scriptUrl = ResourceManager::normalizeURL(scriptUrl);
-                qCDebug(entity_script_server) << "Loading entity server script" << scriptUrl << "for" << entityID;
-                _entitiesScriptEngine->loadEntityScript(entityID, scriptUrl, reload);
+                engine = _entitiesScriptEngines.assign(entityID, getServerScriptGroup(entity));
+                qCDebug(entity_script_server) << "Loading entity server script" << scriptUrl << "for" << entityID
+                    << "on" << engine->getFilename();
+                engine->loadEntityScript(entityID, scriptUrl, reload);
             }
         }
     }
 }
 
 void EntityScriptServer::sendStatsPacket() {
+    // per engine load, a hot engine's entities can be spread out with script groups
+    QJsonObject enginesStats;
+    auto engineStats = _entitiesScriptEngines.takeStats();
+    for (size_t i = 0; i < engineStats.size(); i++) {
+        QJsonObject engineObject;
+        engineObject["assigned_entities"] = engineStats[i].assignedEntities;
+        engineObject["running_scripts"] = engineStats[i].runningScripts;
+        engineObject["timers"] = engineStats[i].timers;
+        engineObject["avg_frame_busy_ms"] = engineStats[i].averageFrameMsecs;
+        enginesStats[QString("engine_%1").arg(i)] = engineObject;
+    }
 
+    QJsonObject statsObject;
+    statsObject["script_engines"] = enginesStats;
+    // load costs per distinct script, keyed by url
+    statsObject["entity_script_programs"] = EntityScriptProgramCache::instance().getStats();
+    addPacketStatsAndSendStatsPacket(statsObject);
 }
 
 void EntityScriptServer::handleOctreePacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer senderNode) {
@@ -552,8 +632,9 @@ void EntityScriptServer::handleJurisdictionPacket(QSharedPointer<ReceivedMessage
 void EntityScriptServer::aboutToFinish() {
     shutdownScriptEngine();
 
-    // our entity tree is going to go away so tell that to the EntityScriptingInterface
+    // our entity tree and engines are going to go away so tell that to the EntityScriptingInterface
     DependencyManager::get<EntityScriptingInterface>()->setEntityTree(nullptr);
+    DependencyManager::get<EntityScriptingInterface>()->setEntitiesScriptEngine(nullptr);
 
     ResourceManager::cleanup();
 
@@ -19,6 +19,7 @@
 #include <QtCore/QUuid>
 
 #include <EntityEditPacketSender.h>
+#include <EntityScriptEnginePool.h>
 #include <EntityTreeHeadlessViewer.h>
 #include <plugins/CodecPlugin.h>
 #include <ScriptEngine.h>
@@ -26,6 +27,8 @@
 
 static const int DEFAULT_MAX_ENTITY_PPS = 9000;
 static const int DEFAULT_ENTITY_PPS_PER_SCRIPT = 900;
+static const int DEFAULT_ENTITY_SCRIPT_ENGINES = 1;
+static const int MAX_ENTITY_SCRIPT_ENGINES = 16;
 
 class EntityScriptServer : public ThreadedAssignment {
     Q_OBJECT
@@ -61,7 +64,9 @@ private:
     void negotiateAudioFormat();
     void selectAudioFormat(const QString& selectedCodecName);
 
-    void resetEntitiesScriptEngine();
+    void resetEntitiesScriptEngines();
+    QSharedPointer<ScriptEngine> createEntitiesScriptEngine();
+    void setNumEntitiesScriptEngines(int numEngines);
     void clear();
     void shutdownScriptEngine();
 
@@ -69,13 +74,15 @@ private:
     void deletingEntity(const EntityItemID& entityID);
     void entityServerScriptChanging(const EntityItemID& entityID, const bool reload);
     void checkAndCallPreload(const EntityItemID& entityID, const bool reload = false);
+    void unloadEntityScript(const EntityItemID& entityID, const bool shouldRemoveFromMap = false);
 
     void cleanupOldKilledListeners();
 
     bool _shuttingDown { false };
 
     static int _entitiesScriptEngineCount;
-    QSharedPointer<ScriptEngine> _entitiesScriptEngine;
+    int _numEntitiesScriptEngines { DEFAULT_ENTITY_SCRIPT_ENGINES };
+    EntityScriptEnginePool _entitiesScriptEngines;
     EntityEditPacketSender _entityEditSender;
     EntityTreeHeadlessViewer _entityViewer;
 
@@ -21,6 +21,7 @@
 #include <QtCore/QAbstractNativeEventFilter>
 #include <QtCore/QCommandLineParser>
 #include <QtCore/QMimeData>
+#include <QtCore/QStandardPaths>
 #include <QtCore/QThreadPool>
 
 #include <QtGui/QScreen>
@@ -71,6 +72,7 @@
 #include <FramebufferCache.h>
 #include <gpu/Batch.h>
 #include <gpu/Context.h>
+#include <gpu/FrameIO.h>
 #include <gpu/gl/GLBackend.h>
 #include <HFActionEvent.h>
 #include <HFBackEvent.h>
@@ -472,7 +474,7 @@ bool setupEssentials(int& argc, char** argv) {
     DependencyManager::set<AddressManager>();
     DependencyManager::set<NodeList>(NodeType::Agent, listenPort);
     DependencyManager::set<GeometryCache>();
-    DependencyManager::set<ModelCache>();
+    DependencyManager::set<ModelCache>(true);
     DependencyManager::set<ScriptCache>();
     DependencyManager::set<SoundCache>();
     DependencyManager::set<Faceshift>();
@@ -902,6 +904,9 @@ Application::Application(int& argc, char** argv, QElapsedTimer& startupTimer, bo
         concurrentDownloads = MAX_CONCURRENT_RESOURCE_DOWNLOADS;
     }
     ResourceCache::setRequestLimit(concurrentDownloads);
+    // Keep a few slots for models and sounds when entering a domain with a lot of textures
+    const float TEXTURE_REQUEST_SHARE = 0.75f;
+    ResourceCache::setRequestShare(ResourceRequestCategory::Texture, TEXTURE_REQUEST_SHARE);
 
     _glWidget = new GLCanvas();
     getApplicationCompositor().setRenderingWidget(_glWidget);
@@ -2302,6 +2307,17 @@ void Application::paintGL() {
         DependencyManager::get<FramebufferCache>()->releaseFramebuffer(framebuffer);
     };
     frame->overlay = _applicationOverlay.getOverlayTexture();
+    if (_captureNextFrame) {
+        _captureNextFrame = false;
+        QString path = QStandardPaths::writableLocation(QStandardPaths::DocumentsLocation) +
+            QString("/frame-%1.hfframe").arg(_frameCount);
+        QFile file(path);
+        if (file.open(QIODevice::WriteOnly) && file.write(gpu::writeFrame(*frame)) > 0) {
+            qCDebug(interfaceapp) << "Captured frame to" << path;
+        } else {
+            qCWarning(interfaceapp) << "Failed to capture frame to" << path;
+        }
+    }
     // deliver final scene rendering commands to the display plugin
     {
         PROFILE_RANGE(render, "/pluginOutput");
@@ -3875,6 +3891,7 @@ void Application::init() {
     });
 
     ObjectMotionState::setShapeManager(&_shapeManager);
+    _shapeManager.setCacheDirectory(PathUtils::getAppLocalDataFilePath("shapes"));
     _physicsEngine->init();
 
     EntityTreePointer tree = getEntities()->getTree();
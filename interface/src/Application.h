@@ -401,6 +401,8 @@ public slots:
 
     Q_INVOKABLE void toggleMuteAudio();
     void loadLODToolsDialog();
+    // writes the next rendered frame to the documents folder, for the frame-replay tool
+    void captureNextFrame() { _captureNextFrame = true; }
     void loadEntityStatisticsDialog();
     void loadDomainConnectionDialog();
     void showScriptLogs();
@@ -528,6 +530,7 @@ private:
     UndoStackScriptingInterface _undoStackScriptingInterface;
 
     uint32_t _frameCount { 0 };
+    bool _captureNextFrame { false };
 
     // Frame Rate Measurement
     RateCounter<> _frameCounter;
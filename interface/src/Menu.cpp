@@ -402,6 +402,10 @@ Menu::Menu() {
     addActionToQMenuAndActionHash(renderOptionsMenu, MenuOption::LodTools, 0,
                                   qApp, SLOT(loadLODToolsDialog()));
 
+    // Developer > Render > Capture Frame
+    addActionToQMenuAndActionHash(renderOptionsMenu, MenuOption::CaptureFrame, 0,
+                                  qApp, SLOT(captureNextFrame()));
+
     // HACK enable texture decimation
     {
         auto action = addCheckableActionToQMenuAndActionHash(renderOptionsMenu, "Decimate Textures");
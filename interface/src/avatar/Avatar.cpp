@@ -1150,7 +1150,7 @@ void Avatar::setAttachmentData(const QVector<AttachmentData>& attachmentData) {
 }
 
 
-int Avatar::parseDataFromBuffer(const QByteArray& buffer) {
+void Avatar::applyDataUpdate(const AvatarDataUpdate& update) {
     PerformanceTimer perfTimer("unpack");
     if (!_initialized) {
         // now that we have data for this Avatar we are go for init
@@ -1160,7 +1160,7 @@ int Avatar::parseDataFromBuffer(const QByteArray& buffer) {
     // change in position implies movement
     glm::vec3 oldPosition = getPosition();
 
-    int bytesRead = AvatarData::parseDataFromBuffer(buffer);
+    AvatarData::applyDataUpdate(update);
 
     const float MOVE_DISTANCE_THRESHOLD = 0.001f;
     _moving = glm::distance(oldPosition, getPosition()) > MOVE_DISTANCE_THRESHOLD;
@@ -1170,8 +1170,6 @@ int Avatar::parseDataFromBuffer(const QByteArray& buffer) {
     if (_moving || _hasNewJointData) {
         locationChanged();
     }
-
-    return bytesRead;
 }
 
 int Avatar::_jointConesID = GeometryCache::UNKNOWN_ID;
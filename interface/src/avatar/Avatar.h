@@ -152,7 +152,7 @@ public:
     void setShowDisplayName(bool showDisplayName);
     virtual void setSessionDisplayName(const QString& sessionDisplayName) override { }; // no-op
 
-    virtual int parseDataFromBuffer(const QByteArray& buffer) override;
+    virtual void applyDataUpdate(const AvatarDataUpdate& update) override;
 
     static void renderJointConnectingCone( gpu::Batch& batch, glm::vec3 position1, glm::vec3 position2,
                                                 float radius1, float radius2, const glm::vec4& color);
@@ -76,9 +76,8 @@ AvatarManager::AvatarManager(QObject* parent) :
 
     auto nodeList = DependencyManager::get<NodeList>();
     auto& packetReceiver = nodeList->getPacketReceiver();
-    packetReceiver.registerListener(PacketType::BulkAvatarData, this, "processAvatarDataPacket");
-    packetReceiver.registerListener(PacketType::KillAvatar, this, "processKillAvatar");
-    packetReceiver.registerListener(PacketType::AvatarIdentity, this, "processAvatarIdentityPacket");
+    // avatar data and identities are decoded away from the main thread, which only has to copy them into the avatars
+    registerPacketDecoder(packetReceiver);
     packetReceiver.registerListener(PacketType::ExitingSpaceBubble, this, "processExitingSpaceBubble");
 
     // when we hear that the user has ignored an avatar by session UUID
@@ -332,35 +331,31 @@ AvatarSharedPointer AvatarManager::newSharedAvatar() {
     return std::make_shared<Avatar>(std::make_shared<Rig>());
 }
 
-void AvatarManager::processAvatarDataPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode) {
-    PerformanceTimer perfTimer("receiveAvatar");
-    // enumerate over all of the avatars in this packet
-    // only add them if mixerWeakPointer points to something (meaning that mixer is still around)
-    while (message->getBytesLeftToRead()) {
-        AvatarSharedPointer avatarData = parseAvatarData(message, sendingNode);
-        if (avatarData) {
-            auto avatar = std::static_pointer_cast<Avatar>(avatarData);
-            if (avatar->isInScene()) {
-                if (!_shouldRender) {
-                    // rare transition so we process the transaction immediately
-                    render::ScenePointer scene = qApp->getMain3DScene();
-                    if (scene) {
-                        render::Transaction transaction;
-                        avatar->removeFromScene(avatar, scene, transaction);
-                        scene->enqueueTransaction(transaction);
-                    }
-                }
-            } else if (_shouldRender) {
-                // very rare transition so we process the transaction immediately
+AvatarSharedPointer AvatarManager::applyAvatarData(const AvatarDataUpdate& update, const QWeakPointer<Node>& mixerWeakPointer) {
+    AvatarSharedPointer avatarData = AvatarHashMap::applyAvatarData(update, mixerWeakPointer);
+    if (avatarData) {
+        auto avatar = std::static_pointer_cast<Avatar>(avatarData);
+        if (avatar->isInScene()) {
+            if (!_shouldRender) {
+                // rare transition so we process the transaction immediately
                 render::ScenePointer scene = qApp->getMain3DScene();
                 if (scene) {
                     render::Transaction transaction;
-                    avatar->addToScene(avatar, scene, transaction);
+                    avatar->removeFromScene(avatar, scene, transaction);
                     scene->enqueueTransaction(transaction);
                 }
             }
+        } else if (_shouldRender) {
+            // very rare transition so we process the transaction immediately
+            render::ScenePointer scene = qApp->getMain3DScene();
+            if (scene) {
+                render::Transaction transaction;
+                avatar->addToScene(avatar, scene, transaction);
+                scene->enqueueTransaction(transaction);
+            }
         }
     }
+    return avatarData;
 }
 
 void AvatarManager::handleRemovedAvatar(const AvatarSharedPointer& removedAvatar, KillAvatarReason removalReason) {
@@ -14,6 +14,7 @@
 #include <AbstractViewStateInterface.h>
 #include <MeshPartPayload.h>
 #include <PerfStat.h>
+#include <SkinningBatch.h>
 
 #include "CauterizedMeshPartPayload.h"
 
@@ -95,38 +96,12 @@ void CauterizedModel::createCollisionRenderItemSet() {
     Model::createCollisionRenderItemSet();
 }
 
-void CauterizedModel::updateClusterMatrices() {
-    PerformanceTimer perfTimer("CauterizedModel::updateClusterMatrices");
-
-    if (!_needsUpdateClusterMatrices || !isLoaded()) {
-        return;
-    }
-    _needsUpdateClusterMatrices = false;
-    const FBXGeometry& geometry = getFBXGeometry();
-
-    for (int i = 0; i < _meshStates.size(); i++) {
-        Model::MeshState& state = _meshStates[i];
-        const FBXMesh& mesh = geometry.meshes.at(i);
-        for (int j = 0; j < mesh.clusters.size(); j++) {
-            const FBXCluster& cluster = mesh.clusters.at(j);
-            auto jointMatrix = _rig->getJointTransform(cluster.jointIndex);
-            glm_mat4u_mul(jointMatrix, cluster.inverseBindMatrix, state.clusterMatrices[j]);
-        }
-
-        // Once computed the cluster matrices, update the buffer(s)
-        if (mesh.clusters.size() > 1) {
-            if (!state.clusterBuffer) {
-                state.clusterBuffer = std::make_shared<gpu::Buffer>(state.clusterMatrices.size() * sizeof(glm::mat4),
-                                                                    (const gpu::Byte*) state.clusterMatrices.constData());
-            } else {
-                state.clusterBuffer->setSubData(0, state.clusterMatrices.size() * sizeof(glm::mat4),
-                                                (const gpu::Byte*) state.clusterMatrices.constData());
-            }
-        }
-    }
+void CauterizedModel::addClusterMatrices(SkinningBatch& batch) {
+    Model::addClusterMatrices(batch);
 
     // as an optimization, don't build cautrizedClusterMatrices if the boneSet is empty.
     if (!_cauterizeBoneSet.empty()) {
+        const FBXGeometry& geometry = getFBXGeometry();
         static const glm::mat4 zeroScale(
             glm::vec4(0.0f, 0.0f, 0.0f, 0.0f),
             glm::vec4(0.0f, 0.0f, 0.0f, 0.0f),
@@ -135,18 +110,27 @@ void CauterizedModel::updateClusterMatrices() {
         auto cauterizeMatrix = _rig->getJointTransform(geometry.neckJointIndex) * zeroScale;
 
         for (int i = 0; i < _cauterizeMeshStates.size(); i++) {
-            Model::MeshState& state = _cauterizeMeshStates[i];
             const FBXMesh& mesh = geometry.meshes.at(i);
+            glm::mat4* clusterMatrices = _cauterizeMeshStates[i].clusterMatrices.data();
             for (int j = 0; j < mesh.clusters.size(); j++) {
                 const FBXCluster& cluster = mesh.clusters.at(j);
-                auto jointMatrix = _rig->getJointTransform(cluster.jointIndex);
                 if (_cauterizeBoneSet.find(cluster.jointIndex) != _cauterizeBoneSet.end()) {
-                    jointMatrix = cauterizeMatrix;
+                    batch.add(cauterizeMatrix, cluster.inverseBindMatrix, clusterMatrices + j);
+                } else {
+                    batch.add(_rig->getJointTransform(cluster.jointIndex), cluster.inverseBindMatrix, clusterMatrices + j);
                 }
-                glm_mat4u_mul(jointMatrix, cluster.inverseBindMatrix, state.clusterMatrices[j]);
             }
+        }
+    }
+}
 
-            if (!_cauterizeBoneSet.empty() && (state.clusterMatrices.size() > 1)) {
+void CauterizedModel::uploadClusterMatrices() {
+    Model::uploadClusterMatrices();
+
+    if (!_cauterizeBoneSet.empty()) {
+        for (int i = 0; i < _cauterizeMeshStates.size(); i++) {
+            Model::MeshState& state = _cauterizeMeshStates[i];
+            if (state.clusterMatrices.size() > 1) {
                 if (!state.clusterBuffer) {
                     state.clusterBuffer =
                         std::make_shared<gpu::Buffer>(state.clusterMatrices.size() * sizeof(glm::mat4),
@@ -158,12 +142,6 @@ void CauterizedModel::updateClusterMatrices() {
             }
         }
     }
-
-    // post the blender if we're not currently waiting for one to finish
-    if (geometry.hasBlendedMeshes() && _blendshapeCoefficients != _blendedBlendshapeCoefficients) {
-        _blendedBlendshapeCoefficients = _blendshapeCoefficients;
-        DependencyManager::get<ModelBlender>()->noteRequiresBlend(getThisPointer());
-    }
 }
 
 void CauterizedModel::updateRenderItems() {
@@ -177,7 +155,7 @@ void CauterizedModel::updateRenderItems() {
             // _collisionGeometry is already scaled
             scale = glm::vec3(1.0f);
         }
-        _needsUpdateClusterMatrices = true;
+        queueClusterMatricesUpdate();
         _renderItemsNeedUpdate = false;
 
         // queue up this work for later processing, at the end of update and just before rendering.
@@ -192,6 +170,7 @@ void CauterizedModel::updateRenderItems() {
             }
 
             // lazy update of cluster matrices used for rendering.  We need to update them here, so we can correctly update the bounding box.
+            Model::updatePendingClusterMatrices();
             self->updateClusterMatrices();
 
             render::ScenePointer scene = AbstractViewStateInterface::instance()->getMain3DScene();
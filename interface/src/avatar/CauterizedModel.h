@@ -37,12 +37,14 @@ public:
 	void createVisibleRenderItemSet() override;
     void createCollisionRenderItemSet() override;
 
-    virtual void updateClusterMatrices() override;
     void updateRenderItems() override;
 
     const Model::MeshState& getCauterizeMeshState(int index) const;
 
 protected:
+    void addClusterMatrices(SkinningBatch& batch) override;
+    void uploadClusterMatrices() override;
+
     std::unordered_set<int> _cauterizeBoneSet;
 	QVector<Model::MeshState> _cauterizeMeshStates;
     bool _isCauterized { false };
@@ -1064,11 +1064,9 @@ AttachmentData MyAvatar::loadAttachmentData(const QUrl& modelURL, const QString&
     return attachment;
 }
 
-int MyAvatar::parseDataFromBuffer(const QByteArray& buffer) {
+void MyAvatar::applyDataUpdate(const AvatarDataUpdate& update) {
     qCDebug(interfaceapp) << "Error: ignoring update packet for MyAvatar"
-        << " packetLength = " << buffer.size();
-    // this packet is just bad, so we pretend that we unpacked it ALL
-    return buffer.size();
+        << " packetLength = " << update.numBytesRead;
 }
 
 void MyAvatar::updateLookAtTargetAvatar() {
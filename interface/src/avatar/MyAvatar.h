@@ -530,7 +530,7 @@ private:
     void setShouldRenderLocally(bool shouldRender) { _shouldRender = shouldRender; setEnableMeshVisible(shouldRender); }
     bool getShouldRenderLocally() const { return _shouldRender; }
     bool isMyAvatar() const override { return true; }
-    virtual int parseDataFromBuffer(const QByteArray& buffer) override;
+    virtual void applyDataUpdate(const AvatarDataUpdate& update) override;
     virtual glm::vec3 getSkeletonPosition() const override;
 
     glm::vec3 getScriptedMotorVelocity() const { return _scriptedMotorVelocity; }
@@ -37,17 +37,12 @@ int SoftAttachmentModel::getJointIndexOverride(int i) const {
 
 // virtual
 // use the _rigOverride matrices instead of the Model::_rig
-void SoftAttachmentModel::updateClusterMatrices() {
-    if (!_needsUpdateClusterMatrices) {
-        return;
-    }
-    _needsUpdateClusterMatrices = false;
-
+void SoftAttachmentModel::addClusterMatrices(SkinningBatch& batch) {
     const FBXGeometry& geometry = getFBXGeometry();
 
     for (int i = 0; i < _meshStates.size(); i++) {
-        MeshState& state = _meshStates[i];
         const FBXMesh& mesh = geometry.meshes.at(i);
+        glm::mat4* clusterMatrices = _meshStates[i].clusterMatrices.data();
 
         for (int j = 0; j < mesh.clusters.size(); j++) {
             const FBXCluster& cluster = mesh.clusters.at(j);
@@ -60,24 +55,7 @@ void SoftAttachmentModel::updateClusterMatrices() {
             } else {
                 jointMatrix = _rig->getJointTransform(cluster.jointIndex);
             }
-            glm_mat4u_mul(jointMatrix, cluster.inverseBindMatrix, state.clusterMatrices[j]);
-        }
-
-        // Once computed the cluster matrices, update the buffer(s)
-        if (mesh.clusters.size() > 1) {
-            if (!state.clusterBuffer) {
-                state.clusterBuffer = std::make_shared<gpu::Buffer>(state.clusterMatrices.size() * sizeof(glm::mat4),
-                                                                    (const gpu::Byte*) state.clusterMatrices.constData());
-            } else {
-                state.clusterBuffer->setSubData(0, state.clusterMatrices.size() * sizeof(glm::mat4),
-                                                (const gpu::Byte*) state.clusterMatrices.constData());
-            }
+            batch.add(jointMatrix, cluster.inverseBindMatrix, clusterMatrices + j);
         }
     }
-
-    // post the blender if we're not currently waiting for one to finish
-    if (geometry.hasBlendedMeshes() && _blendshapeCoefficients != _blendedBlendshapeCoefficients) {
-        _blendedBlendshapeCoefficients = _blendshapeCoefficients;
-        DependencyManager::get<ModelBlender>()->noteRequiresBlend(getThisPointer());
-    }
 }
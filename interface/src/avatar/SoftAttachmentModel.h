@@ -30,9 +30,12 @@ public:
     ~SoftAttachmentModel();
 
     void updateRig(float deltaTime, glm::mat4 parentTransform) override;
-    void updateClusterMatrices() override;
 
 protected:
+    void addClusterMatrices(SkinningBatch& batch) override;
+    // only the regular mesh states, soft attachments aren't cauterized
+    void uploadClusterMatrices() override { Model::uploadClusterMatrices(); }
+
     int getJointIndexOverride(int i) const;
 
     RigPointer _rigOverride;
@@ -8,6 +8,8 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <QCryptographicHash>
+
 #include "GLMHelpers.h"
 #include "AnimClip.h"
 #include "AnimationLogging.h"
@@ -50,32 +52,33 @@ const AnimPoseVec& AnimClip::evaluate(const AnimVariantMap& animVars, const Anim
         _networkAnim.reset();
     }
 
-    if (_anim.size()) {
-
-        // lazy creation of mirrored animation frames.
-        if (_mirrorFlag && _anim.size() != _mirrorAnim.size()) {
-            buildMirrorAnim();
-        }
+    if (_clip && _clip->getFrameCount() > 0) {
 
-        int prevIndex = (int)glm::floor(_frame);
-        int nextIndex;
         if (_loopFlag && _frame >= _endFrame) {
-            nextIndex = (int)glm::ceil(_startFrame);
+            // wrapping around, the two frames aren't next to each other in the clip
+            int prevIndex = (int)glm::floor(_frame);
+            int nextIndex = (int)glm::ceil(_startFrame);
+
+            // It can be quite possible for the user to set _startFrame and _endFrame to
+            // values before or past valid ranges.  We clamp the frames here.
+            int frameCount = _clip->getFrameCount();
+            prevIndex = std::min(std::max(0, prevIndex), frameCount - 1);
+            nextIndex = std::min(std::max(0, nextIndex), frameCount - 1);
+
+            _clip->sampleFrame(prevIndex, &_poses[0]);
+            float alpha = glm::fract(_frame);
+            if (nextIndex != prevIndex && alpha > 0.0f) {
+                _clip->sampleFrame(nextIndex, &_nextPoses[0]);
+                ::blend(_poses.size(), &_poses[0], &_nextPoses[0], alpha, &_poses[0]);
+            }
         } else {
-            nextIndex = (int)glm::ceil(_frame);
+            // the clip clamps the frame to its range
+            _clip->sampleFrame(_frame, &_poses[0], _clipCursor);
         }
 
-        // It can be quite possible for the user to set _startFrame and _endFrame to
-        // values before or past valid ranges.  We clamp the frames here.
-        int frameCount = (int)_anim.size();
-        prevIndex = std::min(std::max(0, prevIndex), frameCount - 1);
-        nextIndex = std::min(std::max(0, nextIndex), frameCount - 1);
-
-        const AnimPoseVec& prevFrame = _mirrorFlag ? _mirrorAnim[prevIndex] : _anim[prevIndex];
-        const AnimPoseVec& nextFrame = _mirrorFlag ? _mirrorAnim[nextIndex] : _anim[nextIndex];
-        float alpha = glm::fract(_frame);
-
-        ::blend(_poses.size(), &prevFrame[0], &nextFrame[0], alpha, &_poses[0]);
+        if (_mirrorFlag) {
+            _skeleton->mirrorRelativePoses(_poses);
+        }
     }
 
     return _poses;
@@ -94,16 +97,54 @@ void AnimClip::setCurrentFrameInternal(float frame) {
     _frame = ::accumulateTime(_startFrame, _endFrame, _timeScale, frame + _startFrame, dt, _loopFlag, _id, triggers);
 }
 
+QString AnimClip::evalCompressedClipKey(const FBXGeometry& geom, const AnimSkeleton& animSkeleton) const {
+    // the retargeted poses only depend on the contents of the animation and on these properties of the skeleton,
+    // the url alone would keep serving the old clip after the animation changed
+    QCryptographicHash hasher(QCryptographicHash::Md5);
+    hasher.addData(usePreAndPostPoseFromAnim ? "1" : "0");
+    const auto animJointCount = animSkeleton.getNumJoints();
+    for (int i = 0; i < animJointCount; i++) {
+        hasher.addData(animSkeleton.getJointName(i).toUtf8());
+        hasher.addData(reinterpret_cast<const char*>(&animSkeleton.getPreRotationPose(i)), sizeof(AnimPose));
+        hasher.addData(reinterpret_cast<const char*>(&animSkeleton.getPostRotationPose(i)), sizeof(AnimPose));
+    }
+    for (const auto& animFrame : geom.animationFrames) {
+        hasher.addData(reinterpret_cast<const char*>(animFrame.rotations.constData()),
+                       animFrame.rotations.size() * sizeof(glm::quat));
+        hasher.addData(reinterpret_cast<const char*>(animFrame.translations.constData()),
+                       animFrame.translations.size() * sizeof(glm::vec3));
+    }
+    const auto jointCount = _skeleton->getNumJoints();
+    for (int i = 0; i < jointCount; i++) {
+        hasher.addData(_skeleton->getJointName(i).toUtf8());
+        hasher.addData(reinterpret_cast<const char*>(&_skeleton->getRelativeDefaultPose(i)), sizeof(AnimPose));
+        hasher.addData(reinterpret_cast<const char*>(&_skeleton->getRelativeBindPose(i)), sizeof(AnimPose));
+    }
+    return _url + "#" + hasher.result().toHex();
+}
+
 void AnimClip::copyFromNetworkAnim() {
     assert(_networkAnim && _networkAnim->isLoaded() && _skeleton);
-    _anim.clear();
+    const auto skeletonJointCount = _skeleton->getNumJoints();
+    _poses.resize(skeletonJointCount);
+    _nextPoses.resize(skeletonJointCount);
 
-    // build a mapping from animation joint indices to skeleton joint indices.
-    // by matching joints with the same name.
     const FBXGeometry& geom = _networkAnim->getGeometry();
     AnimSkeleton animSkeleton(geom);
+
+    auto animCache = DependencyManager::get<AnimationCache>();
+    QString clipKey = evalCompressedClipKey(geom, animSkeleton);
+    _clip = animCache->getCompressedClip(clipKey);
+    if (_clip) {
+        return;
+    }
+
+    // frames[frame][joint], retargeted onto the skeleton
+    std::vector<AnimPoseVec> frames;
+
+    // build a mapping from animation joint indices to skeleton joint indices.
+    // by matching joints with the same name.
     const auto animJointCount = animSkeleton.getNumJoints();
-    const auto skeletonJointCount = _skeleton->getNumJoints();
     std::vector<int> jointMap;
     jointMap.reserve(animJointCount);
     for (int i = 0; i < animJointCount; i++) {
@@ -115,7 +156,7 @@ void AnimClip::copyFromNetworkAnim() {
     }
 
     const int frameCount = geom.animationFrames.size();
-    _anim.resize(frameCount);
+    frames.resize(frameCount);
 
     for (int frame = 0; frame < frameCount; frame++) {
 
@@ -123,9 +164,9 @@ void AnimClip::copyFromNetworkAnim() {
 
         // init all joints in animation to default pose
         // this will give us a resonable result for bones in the model skeleton but not in the animation.
-        _anim[frame].reserve(skeletonJointCount);
+        frames[frame].reserve(skeletonJointCount);
         for (int skeletonJoint = 0; skeletonJoint < skeletonJointCount; skeletonJoint++) {
-            _anim[frame].push_back(_skeleton->getRelativeDefaultPose(skeletonJoint));
+            frames[frame].push_back(_skeleton->getRelativeDefaultPose(skeletonJoint));
         }
 
         for (int animJoint = 0; animJoint < animJointCount; animJoint++) {
@@ -165,26 +206,12 @@ void AnimClip::copyFromNetworkAnim() {
 
                 AnimPose trans = AnimPose(glm::vec3(1.0f), glm::quat(), relDefaultPose.trans() + boneLengthScale * (fbxAnimTrans - fbxZeroTrans));
 
-                _anim[frame][skeletonJoint] = trans * preRot * rot * postRot;
+                frames[frame][skeletonJoint] = trans * preRot * rot * postRot;
             }
         }
     }
 
-    // mirrorAnim will be re-built on demand, if needed.
-    _mirrorAnim.clear();
-
-    _poses.resize(skeletonJointCount);
-}
-
-void AnimClip::buildMirrorAnim() {
-    assert(_skeleton);
-
-    _mirrorAnim.clear();
-    _mirrorAnim.reserve(_anim.size());
-    for (auto& relPoses : _anim) {
-        _mirrorAnim.push_back(relPoses);
-        _skeleton->mirrorRelativePoses(_mirrorAnim.back());
-    }
+    _clip = animCache->addCompressedClip(clipKey, std::make_shared<AnimCompressedClip>(frames));
 }
 
 const AnimPoseVec& AnimClip::getPosesInternal() const {
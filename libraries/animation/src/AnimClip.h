@@ -59,7 +59,7 @@ protected:
     virtual void setCurrentFrameInternal(float frame) override;
 
     void copyFromNetworkAnim();
-    void buildMirrorAnim();
+    QString evalCompressedClipKey(const FBXGeometry& geom, const AnimSkeleton& animSkeleton) const;
 
     // for AnimDebugDraw rendering
     virtual const AnimPoseVec& getPosesInternal() const override;
@@ -67,9 +67,10 @@ protected:
     AnimationPointer _networkAnim;
     AnimPoseVec _poses;
 
-    // _anim[frame][joint]
-    std::vector<AnimPoseVec> _anim;
-    std::vector<AnimPoseVec> _mirrorAnim;
+    // shared with every clip playing the same url on an equivalent skeleton, mirrored at sample time.
+    AnimCompressedClip::ConstPointer _clip;
+    AnimCompressedClip::Cursor _clipCursor;
+    AnimPoseVec _nextPoses; // the frame wrapped around to when looping
 
     QString _url;
     float _startFrame;
@@ -0,0 +1,227 @@
+//
+//  AnimCompressedClip.cpp
+//
+//  Copyright (c) 2017 High Fidelity, Inc. All rights reserved.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AnimCompressedClip.h"
+
+#include <algorithm>
+
+#include "GLMHelpers.h"
+
+const float AnimCompressedClip::TRANSLATION_TOLERANCE = 0.0001f;
+const float AnimCompressedClip::ROTATION_TOLERANCE = 0.00001f;  // about half a degree
+const float AnimCompressedClip::SCALE_TOLERANCE = 0.0001f;
+
+static const float QUANTIZATION_SCALE = 32767.0f;
+
+static float vec3Error(const glm::vec3& a, const glm::vec3& b) {
+    glm::vec3 delta = glm::abs(a - b);
+    return std::max(delta.x, std::max(delta.y, delta.z));
+}
+
+static float quatError(const glm::quat& a, const glm::quat& b) {
+    return 1.0f - fabsf(glm::dot(a, b));
+}
+
+static glm::quat nlerp(const glm::quat& a, const glm::quat& b, float alpha) {
+    glm::quat target = glm::dot(a, b) < 0.0f ? -b : b;
+    return glm::normalize(glm::lerp(a, target, alpha));
+}
+
+// Greedy key reduction: extend the current segment as long as linearly interpolating between its end points
+// reconstructs every frame it covers within the tolerance.  keyValues are the values as they will be decoded,
+// reference the exact ones.
+template <typename T, typename Interpolate, typename Error>
+static std::vector<uint32_t> reduceKeys(const std::vector<T>& keyValues, const std::vector<T>& reference,
+                                        float tolerance, Interpolate interpolate, Error error) {
+    const uint32_t count = (uint32_t)reference.size();
+    std::vector<uint32_t> keys;
+    keys.push_back(0);
+
+    bool isConstant = true;
+    for (uint32_t i = 1; i < count && isConstant; i++) {
+        isConstant = error(keyValues[0], reference[i]) <= tolerance;
+    }
+    if (isConstant) {
+        return keys;
+    }
+
+    uint32_t anchor = 0;
+    for (uint32_t end = anchor + 2; end < count; end++) {
+        for (uint32_t i = anchor + 1; i < end; i++) {
+            float alpha = (float)(i - anchor) / (float)(end - anchor);
+            if (error(interpolate(keyValues[anchor], keyValues[end], alpha), reference[i]) > tolerance) {
+                anchor = end - 1;
+                keys.push_back(anchor);
+                break;
+            }
+        }
+    }
+    keys.push_back(count - 1);
+    return keys;
+}
+
+AnimCompressedClip::AnimCompressedClip(const std::vector<AnimPoseVec>& frames) {
+    _frameCount = (int)frames.size();
+    _jointCount = _frameCount > 0 ? (int)frames[0].size() : 0;
+
+    _transTracks.resize(_jointCount);
+    _rotTracks.resize(_jointCount);
+    _scaleTracks.resize(_jointCount);
+
+    std::vector<glm::vec3> translations(_frameCount);
+    std::vector<glm::quat> rotations(_frameCount);
+    std::vector<glm::vec3> scales(_frameCount);
+    for (int joint = 0; joint < _jointCount; joint++) {
+        for (int frame = 0; frame < _frameCount; frame++) {
+            const AnimPose& pose = frames[frame][joint];
+            translations[frame] = pose.trans();
+            rotations[frame] = pose.rot();
+            scales[frame] = pose.scale();
+        }
+        buildVec3Track(translations, TRANSLATION_TOLERANCE, _transTracks[joint]);
+        buildQuatTrack(rotations, _rotTracks[joint]);
+        buildVec3Track(scales, SCALE_TOLERANCE, _scaleTracks[joint]);
+    }
+
+    _vec3KeyFrames.shrink_to_fit();
+    _vec3Values.shrink_to_fit();
+    _rotKeyFrames.shrink_to_fit();
+    _rotValues.shrink_to_fit();
+}
+
+AnimCompressedClip::QuantizedQuat AnimCompressedClip::quantize(const glm::quat& q) {
+    glm::quat n = glm::normalize(q);
+    return {
+        (int16_t)glm::round(n.x * QUANTIZATION_SCALE),
+        (int16_t)glm::round(n.y * QUANTIZATION_SCALE),
+        (int16_t)glm::round(n.z * QUANTIZATION_SCALE),
+        (int16_t)glm::round(n.w * QUANTIZATION_SCALE)
+    };
+}
+
+glm::quat AnimCompressedClip::dequantize(const QuantizedQuat& q) {
+    const float INV_SCALE = 1.0f / QUANTIZATION_SCALE;
+    return glm::normalize(glm::quat(q.w * INV_SCALE, q.x * INV_SCALE, q.y * INV_SCALE, q.z * INV_SCALE));
+}
+
+void AnimCompressedClip::buildVec3Track(const std::vector<glm::vec3>& values, float tolerance, Track& track) {
+    auto lerpVec3 = [](const glm::vec3& a, const glm::vec3& b, float alpha) { return lerp(a, b, alpha); };
+    auto keys = reduceKeys(values, values, tolerance, lerpVec3, vec3Error);
+
+    track.firstKey = (uint32_t)_vec3KeyFrames.size();
+    track.numKeys = (uint32_t)keys.size();
+    for (auto key : keys) {
+        _vec3KeyFrames.push_back(key);
+        _vec3Values.push_back(values[key]);
+    }
+}
+
+void AnimCompressedClip::buildQuatTrack(const std::vector<glm::quat>& values, Track& track) {
+    // keep consecutive rotations in the same hemisphere so segments interpolate along the short arc
+    std::vector<glm::quat> reference(values.size());
+    std::vector<glm::quat> decoded(values.size());
+    std::vector<QuantizedQuat> quantized(values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        reference[i] = (i > 0 && glm::dot(reference[i - 1], values[i]) < 0.0f) ? -values[i] : values[i];
+        quantized[i] = quantize(reference[i]);
+        decoded[i] = dequantize(quantized[i]);
+    }
+
+    auto keys = reduceKeys(decoded, reference, ROTATION_TOLERANCE, nlerp, quatError);
+
+    track.firstKey = (uint32_t)_rotKeyFrames.size();
+    track.numKeys = (uint32_t)keys.size();
+    for (auto key : keys) {
+        _rotKeyFrames.push_back(key);
+        _rotValues.push_back(quantized[key]);
+    }
+}
+
+void AnimCompressedClip::findSegment(const std::vector<uint32_t>& keys, const Track& track, float frame,
+                                     uint32_t& key) {
+    const uint32_t firstSegment = track.firstKey;
+    const uint32_t lastSegment = track.firstKey + track.numKeys - 2;
+    auto contains = [&](uint32_t segment) {
+        return (float)keys[segment] <= frame && (segment == lastSegment || frame < (float)keys[segment + 1]);
+    };
+
+    key = glm::clamp(key, firstSegment, lastSegment);
+    if (contains(key)) {
+        return;
+    }
+    if (key < lastSegment && contains(key + 1)) {
+        key++;
+        return;
+    }
+    // first key strictly after frame, the segment starts right before it
+    auto begin = keys.begin() + track.firstKey;
+    auto end = begin + track.numKeys;
+    auto next = std::upper_bound(begin + 1, end - 1, frame, [](float value, uint32_t keyFrame) {
+        return value < (float)keyFrame;
+    });
+    key = (uint32_t)(next - keys.begin()) - 1;
+}
+
+glm::vec3 AnimCompressedClip::sampleVec3Track(const Track& track, float frame, uint32_t& key) const {
+    if (track.numKeys == 1) {
+        return _vec3Values[track.firstKey];
+    }
+    findSegment(_vec3KeyFrames, track, frame, key);
+    float start = (float)_vec3KeyFrames[key];
+    float end = (float)_vec3KeyFrames[key + 1];
+    float alpha = glm::clamp((frame - start) / (end - start), 0.0f, 1.0f);
+    return lerp(_vec3Values[key], _vec3Values[key + 1], alpha);
+}
+
+glm::quat AnimCompressedClip::sampleQuatTrack(const Track& track, float frame, uint32_t& key) const {
+    if (track.numKeys == 1) {
+        return dequantize(_rotValues[track.firstKey]);
+    }
+    findSegment(_rotKeyFrames, track, frame, key);
+    float start = (float)_rotKeyFrames[key];
+    float end = (float)_rotKeyFrames[key + 1];
+    float alpha = glm::clamp((frame - start) / (end - start), 0.0f, 1.0f);
+    return nlerp(dequantize(_rotValues[key]), dequantize(_rotValues[key + 1]), alpha);
+}
+
+void AnimCompressedClip::sampleFrame(float frame, AnimPose* poses, Cursor& cursor) const {
+    if (cursor._keys.size() != 3 * (size_t)_jointCount) {
+        cursor._keys.assign(3 * _jointCount, 0);
+    }
+    uint32_t* transKeys = cursor._keys.data();
+    uint32_t* rotKeys = transKeys + _jointCount;
+    uint32_t* scaleKeys = rotKeys + _jointCount;
+
+    float clampedFrame = glm::clamp(frame, 0.0f, (float)std::max(_frameCount - 1, 0));
+    for (int joint = 0; joint < _jointCount; joint++) {
+        AnimPose& pose = poses[joint];
+        pose.trans() = sampleVec3Track(_transTracks[joint], clampedFrame, transKeys[joint]);
+        pose.rot() = sampleQuatTrack(_rotTracks[joint], clampedFrame, rotKeys[joint]);
+        pose.scale() = sampleVec3Track(_scaleTracks[joint], clampedFrame, scaleKeys[joint]);
+    }
+}
+
+void AnimCompressedClip::sampleFrame(int frame, AnimPose* poses) const {
+    float clampedFrame = (float)glm::clamp(frame, 0, std::max(_frameCount - 1, 0));
+    for (int joint = 0; joint < _jointCount; joint++) {
+        AnimPose& pose = poses[joint];
+        uint32_t key = 0;
+        pose.trans() = sampleVec3Track(_transTracks[joint], clampedFrame, key);
+        key = 0;
+        pose.rot() = sampleQuatTrack(_rotTracks[joint], clampedFrame, key);
+        key = 0;
+        pose.scale() = sampleVec3Track(_scaleTracks[joint], clampedFrame, key);
+    }
+}
+
+size_t AnimCompressedClip::getByteSize() const {
+    return sizeof(Track) * (_transTracks.size() + _rotTracks.size() + _scaleTracks.size()) +
+        sizeof(uint32_t) * (_vec3KeyFrames.size() + _rotKeyFrames.size()) +
+        sizeof(glm::vec3) * _vec3Values.size() + sizeof(QuantizedQuat) * _rotValues.size();
+}
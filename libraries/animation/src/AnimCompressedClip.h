@@ -0,0 +1,95 @@
+//
+//  AnimCompressedClip.h
+//
+//  Copyright (c) 2017 High Fidelity, Inc. All rights reserved.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AnimCompressedClip_h
+#define hifi_AnimCompressedClip_h
+
+#include <memory>
+#include <vector>
+
+#include "AnimPose.h"
+
+// Immutable, compressed storage for the relative poses of an animation retargeted onto a skeleton.
+// Each joint has a translation, a rotation and a scale track.  A track whose values stay within the error bounds
+// is stored as a single constant, otherwise only the key frames needed to linearly reconstruct every frame
+// within the bounds are kept.  Rotations are quantized to 16 bits per component.
+// Instances are shared between all the AnimClip nodes playing the same url on the same skeleton.
+
+class AnimCompressedClip {
+public:
+    using Pointer = std::shared_ptr<AnimCompressedClip>;
+    using ConstPointer = std::shared_ptr<const AnimCompressedClip>;
+
+    // maximum reconstruction error, in meters for translations.
+    static const float TRANSLATION_TOLERANCE;
+    // maximum reconstruction error, 1 - |dot(q, q')| for rotations.
+    static const float ROTATION_TOLERANCE;
+    static const float SCALE_TOLERANCE;
+
+    // frames[frame][joint], every frame must have the same number of joints.
+    explicit AnimCompressedClip(const std::vector<AnimPoseVec>& frames);
+
+    int getFrameCount() const { return _frameCount; }
+    int getJointCount() const { return _jointCount; }
+
+    // Segment of each track a player sampled last.  Playing forward stays in it or moves to the next one, so the
+    // keys only have to be searched after a jump.  Belongs to one player, works with any clip.
+    class Cursor {
+    private:
+        friend class AnimCompressedClip;
+        std::vector<uint32_t> _keys; // per track, translations, rotations then scales of every joint
+    };
+
+    // Reconstructs the relative poses at a fractional frame, poses must hold getJointCount() elements.
+    // In between frames the poses are interpolated within the key segments, like blending the two frames would.
+    void sampleFrame(float frame, AnimPose* poses, Cursor& cursor) const;
+    // Reconstructs the relative poses of one frame, poses must hold getJointCount() elements.
+    void sampleFrame(int frame, AnimPose* poses) const;
+
+    // Memory used by the tracks, in bytes.
+    size_t getByteSize() const;
+
+protected:
+    struct QuantizedQuat {
+        int16_t x, y, z, w;
+    };
+
+    // range of keys in the key and value pools, a single key is a constant track.
+    struct Track {
+        uint32_t firstKey { 0 };
+        uint32_t numKeys { 0 };
+    };
+
+    static QuantizedQuat quantize(const glm::quat& q);
+    static glm::quat dequantize(const QuantizedQuat& q);
+
+    void buildVec3Track(const std::vector<glm::vec3>& values, float tolerance, Track& track);
+    void buildQuatTrack(const std::vector<glm::quat>& values, Track& track);
+
+    // key starts the segment holding frame, it is where the search starts and where the segment found is returned
+    static void findSegment(const std::vector<uint32_t>& keys, const Track& track, float frame, uint32_t& key);
+    glm::vec3 sampleVec3Track(const Track& track, float frame, uint32_t& key) const;
+    glm::quat sampleQuatTrack(const Track& track, float frame, uint32_t& key) const;
+
+    int _frameCount { 0 };
+    int _jointCount { 0 };
+
+    // per joint tracks
+    std::vector<Track> _transTracks;
+    std::vector<Track> _rotTracks;
+    std::vector<Track> _scaleTracks;
+
+    // pools of keys, shared by all the tracks of one kind
+    std::vector<uint32_t> _vec3KeyFrames;
+    std::vector<glm::vec3> _vec3Values;
+    std::vector<uint32_t> _rotKeyFrames;
+    std::vector<QuantizedQuat> _rotValues;
+};
+
+#endif // hifi_AnimCompressedClip_h
@@ -38,6 +38,31 @@ AnimationPointer AnimationCache::getAnimation(const QUrl& url) {
     return getResource(url).staticCast<Animation>();
 }
 
+AnimCompressedClip::ConstPointer AnimationCache::getCompressedClip(const QString& key) {
+    std::lock_guard<std::mutex> lock(_compressedClipsMutex);
+    return _compressedClips.value(key).lock();
+}
+
+AnimCompressedClip::ConstPointer AnimationCache::addCompressedClip(const QString& key,
+                                                                  const AnimCompressedClip::ConstPointer& clip) {
+    std::lock_guard<std::mutex> lock(_compressedClipsMutex);
+    auto existing = _compressedClips.value(key).lock();
+    if (existing) {
+        return existing;
+    }
+
+    // forget the clips nobody plays anymore
+    for (auto it = _compressedClips.begin(); it != _compressedClips.end();) {
+        if (it.value().expired()) {
+            it = _compressedClips.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    _compressedClips.insert(key, clip);
+    return clip;
+}
+
 QSharedPointer<Resource> AnimationCache::createResource(const QUrl& url, const QSharedPointer<Resource>& fallback,
     const void* extra) {
     return QSharedPointer<Resource>(new Animation(url), &Resource::deleter);
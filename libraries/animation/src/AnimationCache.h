@@ -12,6 +12,8 @@
 #ifndef hifi_AnimationCache_h
 #define hifi_AnimationCache_h
 
+#include <mutex>
+
 #include <QtCore/QRunnable>
 #include <QtScript/QScriptEngine>
 #include <QtScript/QScriptValue>
@@ -20,6 +22,8 @@
 #include <FBXReader.h>
 #include <ResourceCache.h>
 
+#include "AnimCompressedClip.h"
+
 class Animation;
 
 typedef QSharedPointer<Animation> AnimationPointer;
@@ -45,6 +49,13 @@ public:
     Q_INVOKABLE AnimationPointer getAnimation(const QString& url) { return getAnimation(QUrl(url)); }
     Q_INVOKABLE AnimationPointer getAnimation(const QUrl& url);
 
+    /// Returns the compressed clip registered under key, if it is still in use.
+    AnimCompressedClip::ConstPointer getCompressedClip(const QString& key);
+
+    /// Shares a compressed clip with the AnimClip nodes that will ask for the same key.
+    /// If another clip was registered in the meantime, that one is returned instead.
+    AnimCompressedClip::ConstPointer addCompressedClip(const QString& key, const AnimCompressedClip::ConstPointer& clip);
+
 protected:
 
     virtual QSharedPointer<Resource> createResource(const QUrl& url, const QSharedPointer<Resource>& fallback,
@@ -53,6 +64,9 @@ private:
     explicit AnimationCache(QObject* parent = NULL);
     virtual ~AnimationCache() { }
 
+    // only weak references, a clip lives as long as an AnimClip node plays it
+    std::mutex _compressedClipsMutex;
+    QHash<QString, std::weak_ptr<const AnimCompressedClip>> _compressedClips;
 };
 
 Q_DECLARE_METATYPE(AnimationPointer)
@@ -66,6 +80,7 @@ public:
     explicit Animation(const QUrl& url);
 
     QString getType() const override { return "Animation"; }
+    ResourceRequestCategory getRequestCategory() const override { return ResourceRequestCategory::Animation; }
 
     const FBXGeometry& getGeometry() const { return *_geometry; }
 
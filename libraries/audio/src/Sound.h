@@ -23,7 +23,9 @@ class Sound : public Resource {
 
 public:
     Sound(const QUrl& url, bool isStereo = false, bool isAmbisonic = false);
-    
+
+    ResourceRequestCategory getRequestCategory() const override { return ResourceRequestCategory::Sound; }
+
     bool isStereo() const { return _isStereo; }    
     bool isAmbisonic() const { return _isAmbisonic; }    
     bool isReady() const { return _isReady; }
@@ -12,6 +12,7 @@
 
 #include "AvatarData.h"
 
+#include <atomic>
 #include <cstdio>
 #include <cstring>
 #include <stdint.h>
@@ -666,7 +667,7 @@ bool AvatarData::shouldLogError(const quint64& now) {
 }
 
 
-const unsigned char* unpackFauxJoint(const unsigned char* sourceBuffer, ThreadSafeValueCache<glm::mat4>& matrixCache) {
+static const unsigned char* unpackFauxJoint(const unsigned char* sourceBuffer, glm::mat4& matrix) {
     glm::quat orientation;
     glm::vec3 position;
     Transform transform;
@@ -674,33 +675,55 @@ const unsigned char* unpackFauxJoint(const unsigned char* sourceBuffer, ThreadSa
     sourceBuffer += unpackFloatVec3FromSignedTwoByteFixed(sourceBuffer, position, TRANSLATION_COMPRESSION_RADIX);
     transform.setTranslation(position);
     transform.setRotation(orientation);
-    matrixCache.set(transform.getMatrix());
+    matrix = transform.getMatrix();
     return sourceBuffer;
 }
 
+// decoding happens away from the avatar, so its errors are filtered for all avatars at once
+static std::atomic<quint64> decodeErrorLogExpiry { 0 };
+
+static bool shouldLogDecodeError(quint64 now) {
+#ifdef WANT_DEBUG
+    if (now > 0) {
+        return true;
+    }
+#endif
+
+    quint64 expiry = decodeErrorLogExpiry;
+    return now > expiry && decodeErrorLogExpiry.compare_exchange_strong(expiry, now + DEFAULT_FILTERED_LOG_EXPIRY);
+}
 
 #define PACKET_READ_CHECK(ITEM_NAME, SIZE_TO_READ)                                        \
     if ((endPosition - sourceBuffer) < (int)SIZE_TO_READ) {                               \
-        if (shouldLogError(now)) {                                                        \
+        if (shouldLogDecodeError(now)) {                                                  \
             qCWarning(avatars) << "AvatarData packet too small, attempting to read " <<   \
                 #ITEM_NAME << ", only " << (endPosition - sourceBuffer) <<                \
-                " bytes left, " << getSessionUUID();                                      \
+                " bytes left, " << update.sessionUUID;                                    \
         }                                                                                 \
-        return buffer.size();                                                             \
+        update.numBytesRead = buffer.size();                                              \
+        return;                                                                           \
     }
 
 // read data in packet starting at byte offset and return number of bytes parsed
 int AvatarData::parseDataFromBuffer(const QByteArray& buffer) {
-    // lazily allocate memory for HeadData in case we're not an Avatar instance
-    lazyInitHeadData();
+    AvatarDataUpdate update;
+    update.sessionUUID = getSessionUUID();
+    decodeDataFromBuffer(buffer, update);
+    applyDataUpdate(update);
+    return update.numBytesRead;
+}
 
+void AvatarData::decodeDataFromBuffer(const QByteArray& buffer, AvatarDataUpdate& update) {
     AvatarDataPacket::HasFlags packetStateFlags;
 
     const unsigned char* startPosition = reinterpret_cast<const unsigned char*>(buffer.data());
     const unsigned char* endPosition = startPosition + buffer.size();
     const unsigned char* sourceBuffer = startPosition;
 
+    quint64 now = usecTimestampNow();
+
     // read the packet flags
+    PACKET_READ_CHECK(HasFlags, sizeof(packetStateFlags));
     memcpy(&packetStateFlags, sourceBuffer, sizeof(packetStateFlags));
     sourceBuffer += sizeof(packetStateFlags);
 
@@ -719,132 +742,76 @@ int AvatarData::parseDataFromBuffer(const QByteArray& buffer) {
     bool hasFaceTrackerInfo      = HAS_FLAG(packetStateFlags, AvatarDataPacket::PACKET_HAS_FACE_TRACKER_INFO);
     bool hasJointData            = HAS_FLAG(packetStateFlags, AvatarDataPacket::PACKET_HAS_JOINT_DATA);
 
-    quint64 now = usecTimestampNow();
-
     if (hasAvatarGlobalPosition) {
-        auto startSection = sourceBuffer;
-
         PACKET_READ_CHECK(AvatarGlobalPosition, sizeof(AvatarDataPacket::AvatarGlobalPosition));
         auto data = reinterpret_cast<const AvatarDataPacket::AvatarGlobalPosition*>(sourceBuffer);
-        auto newValue = glm::vec3(data->globalPosition[0], data->globalPosition[1], data->globalPosition[2]);
-        if (_globalPosition != newValue) {
-            _globalPosition = newValue;
-            _globalPositionChanged = usecTimestampNow();
-        }
+        update.globalPosition = glm::vec3(data->globalPosition[0], data->globalPosition[1], data->globalPosition[2]);
         sourceBuffer += sizeof(AvatarDataPacket::AvatarGlobalPosition);
-        int numBytesRead = sourceBuffer - startSection;
-        _globalPositionRate.increment(numBytesRead);
-        _globalPositionUpdateRate.increment();
-
-        // if we don't have a parent, make sure to also set our local position
-        if (!hasParent()) {
-            setLocalPosition(newValue);
-        }
+        update.hasFlags |= AvatarDataPacket::PACKET_HAS_AVATAR_GLOBAL_POSITION;
     }
 
     if (hasAvatarBoundingBox) {
-        auto startSection = sourceBuffer;
-
         PACKET_READ_CHECK(AvatarBoundingBox, sizeof(AvatarDataPacket::AvatarBoundingBox));
         auto data = reinterpret_cast<const AvatarDataPacket::AvatarBoundingBox*>(sourceBuffer);
-        auto newDimensions = glm::vec3(data->avatarDimensions[0], data->avatarDimensions[1], data->avatarDimensions[2]);
-        auto newOffset = glm::vec3(data->boundOriginOffset[0], data->boundOriginOffset[1], data->boundOriginOffset[2]);
-
-
-        if (_globalBoundingBoxDimensions != newDimensions) {
-            _globalBoundingBoxDimensions = newDimensions;
-            _avatarBoundingBoxChanged = usecTimestampNow();
-        }
-        if (_globalBoundingBoxOffset != newOffset) {
-            _globalBoundingBoxOffset = newOffset;
-            _avatarBoundingBoxChanged = usecTimestampNow();
-        }
-
+        update.boundingBoxDimensions = glm::vec3(data->avatarDimensions[0], data->avatarDimensions[1], data->avatarDimensions[2]);
+        update.boundingBoxOffset = glm::vec3(data->boundOriginOffset[0], data->boundOriginOffset[1], data->boundOriginOffset[2]);
         sourceBuffer += sizeof(AvatarDataPacket::AvatarBoundingBox);
-        int numBytesRead = sourceBuffer - startSection;
-        _avatarBoundingBoxRate.increment(numBytesRead);
-        _avatarBoundingBoxUpdateRate.increment();
+        update.hasFlags |= AvatarDataPacket::PACKET_HAS_AVATAR_BOUNDING_BOX;
     }
 
     if (hasAvatarOrientation) {
-        auto startSection = sourceBuffer;
         PACKET_READ_CHECK(AvatarOrientation, sizeof(AvatarDataPacket::AvatarOrientation));
-        glm::quat newOrientation;
-        sourceBuffer += unpackOrientationQuatFromSixBytes(sourceBuffer, newOrientation);
-        glm::quat currentOrientation = getLocalOrientation();
-
-        if (currentOrientation != newOrientation) {
-            _hasNewJointData = true;
-            setLocalOrientation(newOrientation);
-        }
-        int numBytesRead = sourceBuffer - startSection;
-        _avatarOrientationRate.increment(numBytesRead);
-        _avatarOrientationUpdateRate.increment();
+        sourceBuffer += unpackOrientationQuatFromSixBytes(sourceBuffer, update.orientation);
+        update.hasFlags |= AvatarDataPacket::PACKET_HAS_AVATAR_ORIENTATION;
     }
 
     if (hasAvatarScale) {
-        auto startSection = sourceBuffer;
-
         PACKET_READ_CHECK(AvatarScale, sizeof(AvatarDataPacket::AvatarScale));
         auto data = reinterpret_cast<const AvatarDataPacket::AvatarScale*>(sourceBuffer);
-        float scale;
-        unpackFloatRatioFromTwoByte((uint8_t*)&data->scale, scale);
-        if (isNaN(scale)) {
-            if (shouldLogError(now)) {
-                qCWarning(avatars) << "Discard AvatarData packet: scale NaN, uuid " << getSessionUUID();
+        unpackFloatRatioFromTwoByte((uint8_t*)&data->scale, update.scale);
+        if (isNaN(update.scale)) {
+            if (shouldLogDecodeError(now)) {
+                qCWarning(avatars) << "Discard AvatarData packet: scale NaN, uuid " << update.sessionUUID;
             }
-            return buffer.size();
+            update.numBytesRead = buffer.size();
+            return;
         }
-        setTargetScale(scale);
         sourceBuffer += sizeof(AvatarDataPacket::AvatarScale);
-        int numBytesRead = sourceBuffer - startSection;
-        _avatarScaleRate.increment(numBytesRead);
-        _avatarScaleUpdateRate.increment();
+        update.hasFlags |= AvatarDataPacket::PACKET_HAS_AVATAR_SCALE;
     }
 
     if (hasLookAtPosition) {
-        auto startSection = sourceBuffer;
-
         PACKET_READ_CHECK(LookAtPosition, sizeof(AvatarDataPacket::LookAtPosition));
         auto data = reinterpret_cast<const AvatarDataPacket::LookAtPosition*>(sourceBuffer);
-        glm::vec3 lookAt = glm::vec3(data->lookAtPosition[0], data->lookAtPosition[1], data->lookAtPosition[2]);
-        if (isNaN(lookAt)) {
-            if (shouldLogError(now)) {
-                qCWarning(avatars) << "Discard AvatarData packet: lookAtPosition is NaN, uuid " << getSessionUUID();
+        update.lookAtPosition = glm::vec3(data->lookAtPosition[0], data->lookAtPosition[1], data->lookAtPosition[2]);
+        if (isNaN(update.lookAtPosition)) {
+            if (shouldLogDecodeError(now)) {
+                qCWarning(avatars) << "Discard AvatarData packet: lookAtPosition is NaN, uuid " << update.sessionUUID;
             }
-            return buffer.size();
+            update.numBytesRead = buffer.size();
+            return;
         }
-        _headData->setLookAtPosition(lookAt);
         sourceBuffer += sizeof(AvatarDataPacket::LookAtPosition);
-        int numBytesRead = sourceBuffer - startSection;
-        _lookAtPositionRate.increment(numBytesRead);
-        _lookAtPositionUpdateRate.increment();
+        update.hasFlags |= AvatarDataPacket::PACKET_HAS_LOOK_AT_POSITION;
     }
 
     if (hasAudioLoudness) {
-        auto startSection = sourceBuffer;
-
         PACKET_READ_CHECK(AudioLoudness, sizeof(AvatarDataPacket::AudioLoudness));
         auto data = reinterpret_cast<const AvatarDataPacket::AudioLoudness*>(sourceBuffer);
-        float audioLoudness;
-        audioLoudness = unpackFloatGainFromByte(data->audioLoudness) * AUDIO_LOUDNESS_SCALE;
+        update.audioLoudness = unpackFloatGainFromByte(data->audioLoudness) * AUDIO_LOUDNESS_SCALE;
         sourceBuffer += sizeof(AvatarDataPacket::AudioLoudness);
 
-        if (isNaN(audioLoudness)) {
-            if (shouldLogError(now)) {
-                qCWarning(avatars) << "Discard AvatarData packet: audioLoudness is NaN, uuid " << getSessionUUID();
+        if (isNaN(update.audioLoudness)) {
+            if (shouldLogDecodeError(now)) {
+                qCWarning(avatars) << "Discard AvatarData packet: audioLoudness is NaN, uuid " << update.sessionUUID;
             }
-            return buffer.size();
+            update.numBytesRead = buffer.size();
+            return;
         }
-        setAudioLoudness(audioLoudness);
-        int numBytesRead = sourceBuffer - startSection;
-        _audioLoudnessRate.increment(numBytesRead);
-        _audioLoudnessUpdateRate.increment();
+        update.hasFlags |= AvatarDataPacket::PACKET_HAS_AUDIO_LOUDNESS;
     }
 
     if (hasSensorToWorldMatrix) {
-        auto startSection = sourceBuffer;
-
         PACKET_READ_CHECK(SensorToWorldMatrix, sizeof(AvatarDataPacket::SensorToWorldMatrix));
         auto data = reinterpret_cast<const AvatarDataPacket::SensorToWorldMatrix*>(sourceBuffer);
         glm::quat sensorToWorldQuat;
@@ -852,26 +819,18 @@ int AvatarData::parseDataFromBuffer(const QByteArray& buffer) {
         float sensorToWorldScale;
         unpackFloatScalarFromSignedTwoByteFixed((int16_t*)&data->sensorToWorldScale, &sensorToWorldScale, SENSOR_TO_WORLD_SCALE_RADIX);
         glm::vec3 sensorToWorldTrans(data->sensorToWorldTrans[0], data->sensorToWorldTrans[1], data->sensorToWorldTrans[2]);
-        glm::mat4 sensorToWorldMatrix = createMatFromScaleQuatAndPos(glm::vec3(sensorToWorldScale), sensorToWorldQuat, sensorToWorldTrans);
-        if (_sensorToWorldMatrixCache.get() != sensorToWorldMatrix) {
-            _sensorToWorldMatrixCache.set(sensorToWorldMatrix);
-            _sensorToWorldMatrixChanged = usecTimestampNow();
-        }
+        update.sensorToWorldMatrix = createMatFromScaleQuatAndPos(glm::vec3(sensorToWorldScale), sensorToWorldQuat, sensorToWorldTrans);
         sourceBuffer += sizeof(AvatarDataPacket::SensorToWorldMatrix);
-        int numBytesRead = sourceBuffer - startSection;
-        _sensorToWorldRate.increment(numBytesRead);
-        _sensorToWorldUpdateRate.increment();
+        update.hasFlags |= AvatarDataPacket::PACKET_HAS_SENSOR_TO_WORLD_MATRIX;
     }
 
     if (hasAdditionalFlags) {
-        auto startSection = sourceBuffer;
-
         PACKET_READ_CHECK(AdditionalFlags, sizeof(AvatarDataPacket::AdditionalFlags));
         auto data = reinterpret_cast<const AvatarDataPacket::AdditionalFlags*>(sourceBuffer);
         uint8_t bitItems = data->flags;
 
         // key state, stored as a semi-nibble in the bitItems
-        auto newKeyState = (KeyState)getSemiNibbleAt(bitItems, KEY_STATE_START_BIT);
+        update.keyState = (KeyState)getSemiNibbleAt(bitItems, KEY_STATE_START_BIT);
 
         // hand state, stored as a semi-nibble plus a bit in the bitItems
         // we store the hand state as well as other items in a shared bitset. The hand state is an octal, but is split
@@ -880,75 +839,40 @@ int AvatarData::parseDataFromBuffer(const QByteArray& buffer) {
         //     |x,x|H0,H1|x,x,x|H2|
         //     +---+-----+-----+--+
         // Hand state - H0,H1,H2 is found in the 3rd, 4th, and 8th bits
-        auto newHandState = getSemiNibbleAt(bitItems, HAND_STATE_START_BIT)
+        update.handState = getSemiNibbleAt(bitItems, HAND_STATE_START_BIT)
             + (oneAtBit(bitItems, HAND_STATE_FINGER_POINTING_BIT) ? IS_FINGER_POINTING_FLAG : 0);
 
-        auto newFaceTrackerConnected = oneAtBit(bitItems, IS_FACESHIFT_CONNECTED);
-        auto newEyeTrackerConnected = oneAtBit(bitItems, IS_EYE_TRACKER_CONNECTED);
-
-        bool keyStateChanged = (_keyState != newKeyState);
-        bool handStateChanged = (_handState != newHandState);
-        bool faceStateChanged = (_headData->_isFaceTrackerConnected != newFaceTrackerConnected);
-        bool eyeStateChanged = (_headData->_isEyeTrackerConnected != newEyeTrackerConnected);
-        bool somethingChanged = keyStateChanged || handStateChanged || faceStateChanged || eyeStateChanged;
-
-        _keyState = newKeyState;
-        _handState = newHandState;
-        _headData->_isFaceTrackerConnected = newFaceTrackerConnected;
-        _headData->_isEyeTrackerConnected = newEyeTrackerConnected;
+        update.isFaceTrackerConnected = oneAtBit(bitItems, IS_FACESHIFT_CONNECTED);
+        update.isEyeTrackerConnected = oneAtBit(bitItems, IS_EYE_TRACKER_CONNECTED);
 
         sourceBuffer += sizeof(AvatarDataPacket::AdditionalFlags);
-
-        if (somethingChanged) {
-            _additionalFlagsChanged = usecTimestampNow();
-        }
-        int numBytesRead = sourceBuffer - startSection;
-        _additionalFlagsRate.increment(numBytesRead);
-        _additionalFlagsUpdateRate.increment();
+        update.hasFlags |= AvatarDataPacket::PACKET_HAS_ADDITIONAL_FLAGS;
     }
 
     if (hasParentInfo) {
-        auto startSection = sourceBuffer;
         PACKET_READ_CHECK(ParentInfo, sizeof(AvatarDataPacket::ParentInfo));
         auto parentInfo = reinterpret_cast<const AvatarDataPacket::ParentInfo*>(sourceBuffer);
         sourceBuffer += sizeof(AvatarDataPacket::ParentInfo);
 
         QByteArray byteArray((const char*)parentInfo->parentUUID, NUM_BYTES_RFC4122_UUID);
-
-        auto newParentID = QUuid::fromRfc4122(byteArray);
-
-        if ((getParentID() != newParentID) || (getParentJointIndex() != parentInfo->parentJointIndex)) {
-            SpatiallyNestable::setParentID(newParentID);
-            SpatiallyNestable::setParentJointIndex(parentInfo->parentJointIndex);
-            _parentChanged = usecTimestampNow();
-        }
-
-        int numBytesRead = sourceBuffer - startSection;
-        _parentInfoRate.increment(numBytesRead);
-        _parentInfoUpdateRate.increment();
+        update.parentID = QUuid::fromRfc4122(byteArray);
+        update.parentJointIndex = parentInfo->parentJointIndex;
+        update.hasFlags |= AvatarDataPacket::PACKET_HAS_PARENT_INFO;
     }
 
     if (hasAvatarLocalPosition) {
-        auto startSection = sourceBuffer;
-
         PACKET_READ_CHECK(AvatarLocalPosition, sizeof(AvatarDataPacket::AvatarLocalPosition));
         auto data = reinterpret_cast<const AvatarDataPacket::AvatarLocalPosition*>(sourceBuffer);
-        glm::vec3 position = glm::vec3(data->localPosition[0], data->localPosition[1], data->localPosition[2]);
-        if (isNaN(position)) {
-            if (shouldLogError(now)) {
-                qCWarning(avatars) << "Discard AvatarData packet: position NaN, uuid " << getSessionUUID();
+        update.localPosition = glm::vec3(data->localPosition[0], data->localPosition[1], data->localPosition[2]);
+        if (isNaN(update.localPosition)) {
+            if (shouldLogDecodeError(now)) {
+                qCWarning(avatars) << "Discard AvatarData packet: position NaN, uuid " << update.sessionUUID;
             }
-            return buffer.size();
-        }
-        if (hasParent()) {
-            setLocalPosition(position);
-        } else {
-            qCWarning(avatars) << "received localPosition for avatar with no parent";
+            update.numBytesRead = buffer.size();
+            return;
         }
         sourceBuffer += sizeof(AvatarDataPacket::AvatarLocalPosition);
-        int numBytesRead = sourceBuffer - startSection;
-        _localPositionRate.increment(numBytesRead);
-        _localPositionUpdateRate.increment();
+        update.hasFlags |= AvatarDataPacket::PACKET_HAS_AVATAR_LOCAL_POSITION;
     }
 
     if (hasFaceTrackerInfo) {
@@ -958,20 +882,19 @@ int AvatarData::parseDataFromBuffer(const QByteArray& buffer) {
         auto faceTrackerInfo = reinterpret_cast<const AvatarDataPacket::FaceTrackerInfo*>(sourceBuffer);
         sourceBuffer += sizeof(AvatarDataPacket::FaceTrackerInfo);
 
-        _headData->_leftEyeBlink = faceTrackerInfo->leftEyeBlink;
-        _headData->_rightEyeBlink = faceTrackerInfo->rightEyeBlink;
-        _headData->_averageLoudness = faceTrackerInfo->averageLoudness;
-        _headData->_browAudioLift = faceTrackerInfo->browAudioLift;
+        update.leftEyeBlink = faceTrackerInfo->leftEyeBlink;
+        update.rightEyeBlink = faceTrackerInfo->rightEyeBlink;
+        update.averageLoudness = faceTrackerInfo->averageLoudness;
+        update.browAudioLift = faceTrackerInfo->browAudioLift;
 
         int numCoefficients = faceTrackerInfo->numBlendshapeCoefficients;
         const int coefficientsSize = sizeof(float) * numCoefficients;
         PACKET_READ_CHECK(FaceTrackerCoefficients, coefficientsSize);
-        _headData->_blendshapeCoefficients.resize(numCoefficients);  // make sure there's room for the copy!
-        memcpy(_headData->_blendshapeCoefficients.data(), sourceBuffer, coefficientsSize);
+        update.blendshapeCoefficients.resize(numCoefficients);  // make sure there's room for the copy!
+        memcpy(update.blendshapeCoefficients.data(), sourceBuffer, coefficientsSize);
         sourceBuffer += coefficientsSize;
-        int numBytesRead = sourceBuffer - startSection;
-        _faceTrackerRate.increment(numBytesRead);
-        _faceTrackerUpdateRate.increment();
+        update.faceTrackerBytes = sourceBuffer - startSection;
+        update.hasFlags |= AvatarDataPacket::PACKET_HAS_FACE_TRACKER_INFO;
     }
 
     if (hasJointData) {
@@ -1002,17 +925,15 @@ int AvatarData::parseDataFromBuffer(const QByteArray& buffer) {
         }
 
         // each joint rotation is stored in 6 bytes.
-        QWriteLocker writeLock(&_jointDataLock);
-        _jointData.resize(numJoints);
+        update.jointData.resize(numJoints);
 
         const int COMPRESSED_QUATERNION_SIZE = 6;
         PACKET_READ_CHECK(JointRotations, numValidJointRotations * COMPRESSED_QUATERNION_SIZE);
         for (int i = 0; i < numJoints; i++) {
-            JointData& data = _jointData[i];
+            JointData& data = update.jointData[i];
+            data.rotationSet = validRotations[i];
             if (validRotations[i]) {
                 sourceBuffer += unpackOrientationQuatFromSixBytes(sourceBuffer, data.rotation);
-                _hasNewJointData = true;
-                data.rotationSet = true;
             }
         }
 
@@ -1043,11 +964,10 @@ int AvatarData::parseDataFromBuffer(const QByteArray& buffer) {
         PACKET_READ_CHECK(JointTranslation, numValidJointTranslations * COMPRESSED_TRANSLATION_SIZE);
 
         for (int i = 0; i < numJoints; i++) {
-            JointData& data = _jointData[i];
+            JointData& data = update.jointData[i];
+            data.translationSet = validTranslations[i];
             if (validTranslations[i]) {
                 sourceBuffer += unpackFloatVec3FromSignedTwoByteFixed(sourceBuffer, data.translation, TRANSLATION_COMPRESSION_RADIX);
-                _hasNewJointData = true;
-                data.translationSet = true;
             }
         }
 
@@ -1059,21 +979,171 @@ int AvatarData::parseDataFromBuffer(const QByteArray& buffer) {
         }
 #endif
         // faux joints
-        sourceBuffer = unpackFauxJoint(sourceBuffer, _controllerLeftHandMatrixCache);
-        sourceBuffer = unpackFauxJoint(sourceBuffer, _controllerRightHandMatrixCache);
+        const int NUM_FAUX_JOINTS = 2;
+        PACKET_READ_CHECK(FauxJoints, NUM_FAUX_JOINTS * (COMPRESSED_QUATERNION_SIZE + COMPRESSED_TRANSLATION_SIZE));
+        sourceBuffer = unpackFauxJoint(sourceBuffer, update.controllerLeftHandMatrix);
+        sourceBuffer = unpackFauxJoint(sourceBuffer, update.controllerRightHandMatrix);
 
-        int numBytesRead = sourceBuffer - startSection;
-        _jointDataRate.increment(numBytesRead);
-        _jointDataUpdateRate.increment();
+        update.jointDataBytes = sourceBuffer - startSection;
+        update.hasFlags |= AvatarDataPacket::PACKET_HAS_JOINT_DATA;
+    }
+
+    update.numBytesRead = sourceBuffer - startPosition;
+    update.isComplete = true;
+}
+
+void AvatarData::applyDataUpdate(const AvatarDataUpdate& update) {
+    // lazily allocate memory for HeadData in case we're not an Avatar instance
+    lazyInitHeadData();
+
+    quint64 now = usecTimestampNow();
+
+    if (update.hasFlags & AvatarDataPacket::PACKET_HAS_AVATAR_GLOBAL_POSITION) {
+        if (_globalPosition != update.globalPosition) {
+            _globalPosition = update.globalPosition;
+            _globalPositionChanged = now;
+        }
+        _globalPositionRate.increment(sizeof(AvatarDataPacket::AvatarGlobalPosition));
+        _globalPositionUpdateRate.increment();
+
+        // if we don't have a parent, make sure to also set our local position
+        if (!hasParent()) {
+            setLocalPosition(update.globalPosition);
+        }
+    }
+
+    if (update.hasFlags & AvatarDataPacket::PACKET_HAS_AVATAR_BOUNDING_BOX) {
+        if (_globalBoundingBoxDimensions != update.boundingBoxDimensions) {
+            _globalBoundingBoxDimensions = update.boundingBoxDimensions;
+            _avatarBoundingBoxChanged = now;
+        }
+        if (_globalBoundingBoxOffset != update.boundingBoxOffset) {
+            _globalBoundingBoxOffset = update.boundingBoxOffset;
+            _avatarBoundingBoxChanged = now;
+        }
+        _avatarBoundingBoxRate.increment(sizeof(AvatarDataPacket::AvatarBoundingBox));
+        _avatarBoundingBoxUpdateRate.increment();
+    }
+
+    if (update.hasFlags & AvatarDataPacket::PACKET_HAS_AVATAR_ORIENTATION) {
+        if (getLocalOrientation() != update.orientation) {
+            _hasNewJointData = true;
+            setLocalOrientation(update.orientation);
+        }
+        _avatarOrientationRate.increment(sizeof(AvatarDataPacket::AvatarOrientation));
+        _avatarOrientationUpdateRate.increment();
+    }
+
+    if (update.hasFlags & AvatarDataPacket::PACKET_HAS_AVATAR_SCALE) {
+        setTargetScale(update.scale);
+        _avatarScaleRate.increment(sizeof(AvatarDataPacket::AvatarScale));
+        _avatarScaleUpdateRate.increment();
+    }
+
+    if (update.hasFlags & AvatarDataPacket::PACKET_HAS_LOOK_AT_POSITION) {
+        _headData->setLookAtPosition(update.lookAtPosition);
+        _lookAtPositionRate.increment(sizeof(AvatarDataPacket::LookAtPosition));
+        _lookAtPositionUpdateRate.increment();
+    }
+
+    if (update.hasFlags & AvatarDataPacket::PACKET_HAS_AUDIO_LOUDNESS) {
+        setAudioLoudness(update.audioLoudness);
+        _audioLoudnessRate.increment(sizeof(AvatarDataPacket::AudioLoudness));
+        _audioLoudnessUpdateRate.increment();
+    }
+
+    if (update.hasFlags & AvatarDataPacket::PACKET_HAS_SENSOR_TO_WORLD_MATRIX) {
+        if (_sensorToWorldMatrixCache.get() != update.sensorToWorldMatrix) {
+            _sensorToWorldMatrixCache.set(update.sensorToWorldMatrix);
+            _sensorToWorldMatrixChanged = now;
+        }
+        _sensorToWorldRate.increment(sizeof(AvatarDataPacket::SensorToWorldMatrix));
+        _sensorToWorldUpdateRate.increment();
     }
 
-    int numBytesRead = sourceBuffer - startPosition;
-    _averageBytesReceived.updateAverage(numBytesRead);
+    if (update.hasFlags & AvatarDataPacket::PACKET_HAS_ADDITIONAL_FLAGS) {
+        bool keyStateChanged = (_keyState != update.keyState);
+        bool handStateChanged = (_handState != update.handState);
+        bool faceStateChanged = (_headData->_isFaceTrackerConnected != update.isFaceTrackerConnected);
+        bool eyeStateChanged = (_headData->_isEyeTrackerConnected != update.isEyeTrackerConnected);
+        bool somethingChanged = keyStateChanged || handStateChanged || faceStateChanged || eyeStateChanged;
 
-    _parseBufferRate.increment(numBytesRead);
-    _parseBufferUpdateRate.increment();
+        _keyState = update.keyState;
+        _handState = update.handState;
+        _headData->_isFaceTrackerConnected = update.isFaceTrackerConnected;
+        _headData->_isEyeTrackerConnected = update.isEyeTrackerConnected;
 
-    return numBytesRead;
+        if (somethingChanged) {
+            _additionalFlagsChanged = now;
+        }
+        _additionalFlagsRate.increment(sizeof(AvatarDataPacket::AdditionalFlags));
+        _additionalFlagsUpdateRate.increment();
+    }
+
+    if (update.hasFlags & AvatarDataPacket::PACKET_HAS_PARENT_INFO) {
+        if ((getParentID() != update.parentID) || (getParentJointIndex() != update.parentJointIndex)) {
+            SpatiallyNestable::setParentID(update.parentID);
+            SpatiallyNestable::setParentJointIndex(update.parentJointIndex);
+            _parentChanged = now;
+        }
+        _parentInfoRate.increment(sizeof(AvatarDataPacket::ParentInfo));
+        _parentInfoUpdateRate.increment();
+    }
+
+    if (update.hasFlags & AvatarDataPacket::PACKET_HAS_AVATAR_LOCAL_POSITION) {
+        if (hasParent()) {
+            setLocalPosition(update.localPosition);
+        } else {
+            qCWarning(avatars) << "received localPosition for avatar with no parent";
+        }
+        _localPositionRate.increment(sizeof(AvatarDataPacket::AvatarLocalPosition));
+        _localPositionUpdateRate.increment();
+    }
+
+    if (update.hasFlags & AvatarDataPacket::PACKET_HAS_FACE_TRACKER_INFO) {
+        _headData->_leftEyeBlink = update.leftEyeBlink;
+        _headData->_rightEyeBlink = update.rightEyeBlink;
+        _headData->_averageLoudness = update.averageLoudness;
+        _headData->_browAudioLift = update.browAudioLift;
+        _headData->_blendshapeCoefficients = update.blendshapeCoefficients;
+        _faceTrackerRate.increment(update.faceTrackerBytes);
+        _faceTrackerUpdateRate.increment();
+    }
+
+    if (update.hasFlags & AvatarDataPacket::PACKET_HAS_JOINT_DATA) {
+        // the joints that weren't sent keep their last values
+        QWriteLocker writeLock(&_jointDataLock);
+        int numJoints = update.jointData.size();
+        _jointData.resize(numJoints);
+        for (int i = 0; i < numJoints; i++) {
+            const JointData& sent = update.jointData[i];
+            JointData& data = _jointData[i];
+            if (sent.rotationSet) {
+                data.rotation = sent.rotation;
+                data.rotationSet = true;
+                _hasNewJointData = true;
+            }
+            if (sent.translationSet) {
+                data.translation = sent.translation;
+                data.translationSet = true;
+                _hasNewJointData = true;
+            }
+        }
+        writeLock.unlock();
+
+        _controllerLeftHandMatrixCache.set(update.controllerLeftHandMatrix);
+        _controllerRightHandMatrixCache.set(update.controllerRightHandMatrix);
+
+        _jointDataRate.increment(update.jointDataBytes);
+        _jointDataUpdateRate.increment();
+    }
+
+    if (update.isComplete) {
+        _averageBytesReceived.updateAverage(update.numBytesRead);
+
+        _parseBufferRate.increment(update.numBytesRead);
+        _parseBufferUpdateRate.increment();
+    }
 }
 
 float AvatarData::getDataRate(const QString& rateName) const {
@@ -318,6 +318,46 @@ public:
     bool operator<(const AvatarPriority& other) const { return priority < other.priority; }
 };
 
+// The contents of one avatar's AvatarData, decoded by AvatarData::decodeDataFromBuffer without touching the avatar,
+// so that the decoding can be done on any thread.  AvatarData::applyDataUpdate copies it into the avatar.
+class AvatarDataUpdate {
+public:
+    QUuid sessionUUID;
+    AvatarDataPacket::HasFlags hasFlags { 0 }; // the sections that were read, a section that failed to read is not set
+    bool isComplete { false }; // false if the data was truncated or invalid, the sections before that are still applied
+    int numBytesRead { 0 };
+
+    glm::vec3 globalPosition;
+    glm::vec3 boundingBoxDimensions;
+    glm::vec3 boundingBoxOffset;
+    glm::quat orientation;
+    float scale { 1.0f };
+    glm::vec3 lookAtPosition;
+    float audioLoudness { 0.0f };
+    glm::mat4 sensorToWorldMatrix;
+
+    KeyState keyState { NO_KEY_DOWN };
+    char handState { 0 };
+    bool isFaceTrackerConnected { false };
+    bool isEyeTrackerConnected { false };
+
+    QUuid parentID;
+    uint16_t parentJointIndex { 0 };
+    glm::vec3 localPosition;
+
+    float leftEyeBlink { 0.0f };
+    float rightEyeBlink { 0.0f };
+    float averageLoudness { 0.0f };
+    float browAudioLift { 0.0f };
+    QVector<float> blendshapeCoefficients;
+    int faceTrackerBytes { 0 };
+
+    QVector<JointData> jointData; // rotationSet and translationSet are true for the joints that were sent
+    glm::mat4 controllerLeftHandMatrix;
+    glm::mat4 controllerRightHandMatrix;
+    int jointDataBytes { 0 };
+};
+
 class AvatarData : public QObject, public SpatiallyNestable {
     Q_OBJECT
 
@@ -397,7 +437,13 @@ public:
     /// \param packet byte array of data
     /// \param offset number of bytes into packet where data starts
     /// \return number of bytes parsed
-    virtual int parseDataFromBuffer(const QByteArray& buffer);
+    int parseDataFromBuffer(const QByteArray& buffer);
+
+    /// decodes buffer into update, may be called from any thread
+    static void decodeDataFromBuffer(const QByteArray& buffer, AvatarDataUpdate& update);
+
+    /// copies the decoded sections of update into this avatar
+    virtual void applyDataUpdate(const AvatarDataUpdate& update);
 
     // Body Rotation (degrees)
     float getBodyYaw() const;
@@ -25,6 +25,27 @@ AvatarHashMap::AvatarHashMap() {
     connect(nodeList.data(), &NodeList::uuidChanged, this, &AvatarHashMap::sessionUUIDChanged);
 }
 
+AvatarHashMap::~AvatarHashMap() {
+    if (_packetDecoder) {
+        _packetDecoderThread.quit();
+        _packetDecoderThread.wait();
+        delete _packetDecoder;
+    }
+}
+
+void AvatarHashMap::registerPacketDecoder(PacketReceiver& packetReceiver) {
+    Q_ASSERT(!_packetDecoder);
+    _packetDecoder = new AvatarPacketDecoder();
+    _packetDecoderThread.setObjectName("Avatar Packet Decoder Thread");
+    _packetDecoder->moveToThread(&_packetDecoderThread);
+    connect(_packetDecoder, &AvatarPacketDecoder::packetsDecoded, this, &AvatarHashMap::processDecodedPackets);
+    _packetDecoderThread.start();
+
+    packetReceiver.registerListener(PacketType::BulkAvatarData, _packetDecoder, "processAvatarDataPacket");
+    packetReceiver.registerListener(PacketType::KillAvatar, _packetDecoder, "processKillAvatar");
+    packetReceiver.registerListener(PacketType::AvatarIdentity, _packetDecoder, "processAvatarIdentityPacket");
+}
+
 QVector<QUuid> AvatarHashMap::getAvatarIdentifiers() {
     QReadLocker locker(&_hashLock);
     return _avatarHash.keys().toVector();
@@ -99,36 +120,55 @@ void AvatarHashMap::processAvatarDataPacket(QSharedPointer<ReceivedMessage> mess
     }
 }
 
-AvatarSharedPointer AvatarHashMap::parseAvatarData(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode) {
-    QUuid sessionUUID = QUuid::fromRfc4122(message->readWithoutCopy(NUM_BYTES_RFC4122_UUID));
-
-    int positionBeforeRead = message->getPosition();
+void AvatarHashMap::processDecodedPackets() {
+    PerformanceTimer perfTimer("receiveAvatar");
+    _packetDecoder->takeDecodedPackets(_decodedPackets);
+    applyDecodedPackets(_decodedPackets);
+    // keep the storage, it is swapped back to the decoder on the next take
+    _decodedPackets.clear();
+}
+
+void AvatarHashMap::applyDecodedPackets(const AvatarPacketDecoder::DecodedPackets& decodedPackets) {
+    for (const auto& decoded : decodedPackets) {
+        if (decoded.isKill) {
+            removeAvatar(decoded.update.sessionUUID, decoded.killReason);
+        } else if (decoded.isIdentity) {
+            applyAvatarIdentity(decoded.identity, decoded.mixer);
+        } else {
+            applyAvatarData(decoded.update, decoded.mixer);
+        }
+    }
+}
 
-    QByteArray byteArray = message->readWithoutCopy(message->getBytesLeftToRead());
+AvatarSharedPointer AvatarHashMap::parseAvatarData(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode) {
+    AvatarDataUpdate update;
+    AvatarPacketDecoder::decodeAvatarData(*message, update);
+    return applyAvatarData(update, sendingNode);
+}
 
+AvatarSharedPointer AvatarHashMap::applyAvatarData(const AvatarDataUpdate& update, const QWeakPointer<Node>& mixerWeakPointer) {
     // make sure this isn't our own avatar data or for a previously ignored node
     auto nodeList = DependencyManager::get<NodeList>();
 
-    if (sessionUUID != _lastOwnerSessionUUID && (!nodeList->isIgnoringNode(sessionUUID) || nodeList->getRequestsDomainListData())) {
-        auto avatar = newOrExistingAvatar(sessionUUID, sendingNode);
+    if (update.sessionUUID != _lastOwnerSessionUUID &&
+            (!nodeList->isIgnoringNode(update.sessionUUID) || nodeList->getRequestsDomainListData())) {
+        auto avatar = newOrExistingAvatar(update.sessionUUID, mixerWeakPointer);
 
-        // have the matching (or new) avatar parse the data from the packet
-        int bytesRead = avatar->parseDataFromBuffer(byteArray);
-        message->seek(positionBeforeRead + bytesRead);
+        // have the matching (or new) avatar take the data from the packet
+        avatar->applyDataUpdate(update);
         return avatar;
-    } else {
-        // create a dummy AvatarData class to throw this data on the ground
-        AvatarData dummyData;
-        int bytesRead = dummyData.parseDataFromBuffer(byteArray);
-        message->seek(positionBeforeRead + bytesRead);
-        return std::make_shared<AvatarData>();
     }
+    // the data is thrown on the ground
+    return AvatarSharedPointer();
 }
 
 void AvatarHashMap::processAvatarIdentityPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode) {
     AvatarData::Identity identity;
     AvatarData::parseAvatarIdentityPacket(message->getMessage(), identity);
+    applyAvatarIdentity(identity, sendingNode);
+}
 
+void AvatarHashMap::applyAvatarIdentity(AvatarData::Identity identity, const QWeakPointer<Node>& mixerWeakPointer) {
     // make sure this isn't for an ignored avatar
     auto nodeList = DependencyManager::get<NodeList>();
     static auto EMPTY = QUuid();
@@ -145,7 +185,7 @@ void AvatarHashMap::processAvatarIdentityPacket(QSharedPointer<ReceivedMessage>
     }
     if (!nodeList->isIgnoringNode(identity.uuid) || nodeList->getRequestsDomainListData()) {
         // mesh URL for a UUID, find avatar in our list
-        auto avatar = newOrExistingAvatar(identity.uuid, sendingNode);
+        auto avatar = newOrExistingAvatar(identity.uuid, mixerWeakPointer);
         bool identityChanged = false;
         bool displayNameChanged = false;
         avatar->processAvatarIdentity(identity, identityChanged, displayNameChanged);
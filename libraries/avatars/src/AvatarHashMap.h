@@ -14,6 +14,7 @@
 
 #include <QtCore/QHash>
 #include <QtCore/QSharedPointer>
+#include <QtCore/QThread>
 #include <QtCore/QUuid>
 
 #include <functional>
@@ -24,16 +25,20 @@
 #include <DependencyManager.h>
 #include <NLPacket.h>
 #include <Node.h>
+#include <PacketReceiver.h>
 
 #include "ScriptAvatarData.h"
 
 #include "AvatarData.h"
+#include "AvatarPacketDecoder.h"
 
 class AvatarHashMap : public QObject, public Dependency {
     Q_OBJECT
     SINGLETON_DEPENDENCY
 
 public:
+    ~AvatarHashMap();
+
     AvatarHash getHashCopy() { QReadLocker lock(&_hashLock); return _avatarHash; }
     int size() { return _avatarHash.size(); }
 
@@ -62,10 +67,24 @@ protected slots:
     void processKillAvatar(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode);
     void processExitingSpaceBubble(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode);
 
+    void processDecodedPackets();
+
 protected:
     AvatarHashMap();
 
-    virtual AvatarSharedPointer parseAvatarData(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode);
+    /// listens for BulkAvatarData, KillAvatar and AvatarIdentity packets with a decoder on a thread of its own,
+    /// instead of with processAvatarDataPacket, processKillAvatar and processAvatarIdentityPacket on the thread of
+    /// the hash map
+    void registerPacketDecoder(PacketReceiver& packetReceiver);
+
+    /// applies the kills, identities and data in the order the decoder queued them
+    void applyDecodedPackets(const AvatarPacketDecoder::DecodedPackets& decodedPackets);
+
+    AvatarSharedPointer parseAvatarData(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode);
+    void applyAvatarIdentity(AvatarData::Identity identity, const QWeakPointer<Node>& mixerWeakPointer);
+
+    /// \return the avatar the update was applied to, or nullptr if it is ignored
+    virtual AvatarSharedPointer applyAvatarData(const AvatarDataUpdate& update, const QWeakPointer<Node>& mixerWeakPointer);
     virtual AvatarSharedPointer newSharedAvatar();
     virtual AvatarSharedPointer addAvatar(const QUuid& sessionUUID, const QWeakPointer<Node>& mixerWeakPointer);
     AvatarSharedPointer newOrExistingAvatar(const QUuid& sessionUUID, const QWeakPointer<Node>& mixerWeakPointer);
@@ -81,6 +100,10 @@ protected:
 
 private:
     QUuid _lastOwnerSessionUUID;
+
+    QThread _packetDecoderThread;
+    AvatarPacketDecoder* _packetDecoder { nullptr };
+    AvatarPacketDecoder::DecodedPackets _decodedPackets;
 };
 
 #endif // hifi_AvatarHashMap_h
@@ -0,0 +1,84 @@
+//
+//  AvatarPacketDecoder.cpp
+//  libraries/avatars/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AvatarPacketDecoder.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include <Profile.h>
+#include <UUID.h>
+
+void AvatarPacketDecoder::decodeAvatarData(ReceivedMessage& message, AvatarDataUpdate& update) {
+    update.sessionUUID = QUuid::fromRfc4122(message.readWithoutCopy(NUM_BYTES_RFC4122_UUID));
+
+    int positionBeforeRead = message.getPosition();
+    AvatarData::decodeDataFromBuffer(message.readWithoutCopy(message.getBytesLeftToRead()), update);
+    message.seek(positionBeforeRead + update.numBytesRead);
+}
+
+void AvatarPacketDecoder::takeDecodedPackets(DecodedPackets& decodedPackets) {
+    std::lock_guard<std::mutex> lock(_decodedPacketsLock);
+    decodedPackets.swap(_decodedPackets);
+}
+
+void AvatarPacketDecoder::processAvatarDataPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode) {
+    PROFILE_RANGE(network, "decodeAvatar");
+    // enumerate over all of the avatars in this packet
+    while (message->getBytesLeftToRead()) {
+        _decodingPackets.emplace_back();
+        DecodedPacket& decoded = _decodingPackets.back();
+        decodeAvatarData(*message, decoded.update);
+        decoded.mixer = sendingNode;
+    }
+    queueDecodedPackets();
+}
+
+void AvatarPacketDecoder::processKillAvatar(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode) {
+    _decodingPackets.emplace_back();
+    DecodedPacket& decoded = _decodingPackets.back();
+    decoded.update.sessionUUID = QUuid::fromRfc4122(message->readWithoutCopy(NUM_BYTES_RFC4122_UUID));
+    message->readPrimitive(&decoded.killReason);
+    decoded.mixer = sendingNode;
+    decoded.isKill = true;
+    queueDecodedPackets();
+}
+
+void AvatarPacketDecoder::processAvatarIdentityPacket(QSharedPointer<ReceivedMessage> message,
+                                                      SharedNodePointer sendingNode) {
+    _decodingPackets.emplace_back();
+    DecodedPacket& decoded = _decodingPackets.back();
+    AvatarData::parseAvatarIdentityPacket(message->getMessage(), decoded.identity);
+    decoded.mixer = sendingNode;
+    decoded.isIdentity = true;
+    queueDecodedPackets();
+}
+
+void AvatarPacketDecoder::queueDecodedPackets() {
+    if (_decodingPackets.empty()) {
+        return;
+    }
+    bool wasEmpty;
+    {
+        std::lock_guard<std::mutex> lock(_decodedPacketsLock);
+        wasEmpty = _decodedPackets.empty();
+        if (wasEmpty) {
+            _decodedPackets.swap(_decodingPackets);
+        } else {
+            std::move(_decodingPackets.begin(), _decodingPackets.end(), std::back_inserter(_decodedPackets));
+        }
+    }
+    _decodingPackets.clear();
+
+    // the packets queued since the last take are picked up by the one already signaled
+    if (wasEmpty) {
+        emit packetsDecoded();
+    }
+}
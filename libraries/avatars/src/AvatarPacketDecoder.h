@@ -0,0 +1,67 @@
+//
+//  AvatarPacketDecoder.h
+//  libraries/avatars/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_AvatarPacketDecoder_h
+#define hifi_AvatarPacketDecoder_h
+
+#include <mutex>
+#include <vector>
+
+#include <QtCore/QObject>
+#include <QtCore/QSharedPointer>
+
+#include <Node.h>
+#include <ReceivedMessage.h>
+
+#include "AvatarData.h"
+
+// Decodes BulkAvatarData packets on the thread it lives on, so that the thread of the AvatarHashMap only has to
+// copy the decoded values into its avatars.  KillAvatar and AvatarIdentity packets go through the same queue, so that
+// the data of an avatar that arrived before it was killed can't bring it back, and an identity that arrived after
+// the kill isn't dropped by it.
+class AvatarPacketDecoder : public QObject {
+    Q_OBJECT
+
+public:
+    class DecodedPacket {
+    public:
+        AvatarDataUpdate update;
+        QWeakPointer<Node> mixer;
+        bool isKill { false };
+        KillAvatarReason killReason { KillAvatarReason::NoReason };
+        bool isIdentity { false };
+        AvatarData::Identity identity;
+    };
+    using DecodedPackets = std::vector<DecodedPacket>;
+
+    /// reads the session UUID and the AvatarData of the next avatar in a BulkAvatarData message
+    static void decodeAvatarData(ReceivedMessage& message, AvatarDataUpdate& update);
+
+    /// swaps the packets decoded since the last call, in the order they arrived, into decodedPackets
+    void takeDecodedPackets(DecodedPackets& decodedPackets);
+
+signals:
+    /// emitted when packets are decoded after the last call to takeDecodedPackets
+    void packetsDecoded();
+
+public slots:
+    void processAvatarDataPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode);
+    void processKillAvatar(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode);
+    void processAvatarIdentityPacket(QSharedPointer<ReceivedMessage> message, SharedNodePointer sendingNode);
+
+private:
+    void queueDecodedPackets();
+
+    DecodedPackets _decodingPackets; // only used on the thread of the decoder
+    std::mutex _decodedPacketsLock;
+    DecodedPackets _decodedPackets;
+};
+
+#endif // hifi_AvatarPacketDecoder_h
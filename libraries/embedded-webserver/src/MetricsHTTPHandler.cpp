@@ -0,0 +1,32 @@
+//
+//  MetricsHTTPHandler.cpp
+//  libraries/embedded-webserver/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "MetricsHTTPHandler.h"
+
+#include <MetricsRegistry.h>
+
+#include "HTTPConnection.h"
+
+const QString MetricsHTTPHandler::METRICS_PATH = "/metrics";
+
+bool MetricsHTTPHandler::handleHTTPRequest(HTTPConnection* connection, const QUrl& url, bool skipSubHandler) {
+    if (url.path() != METRICS_PATH) {
+        return false;
+    }
+
+    auto registry = DependencyManager::get<MetricsRegistry>();
+    if (!registry) {
+        connection->respond(HTTPConnection::StatusCode404);
+        return true;
+    }
+
+    connection->respond(HTTPConnection::StatusCode200, registry->toPrometheusText(), "text/plain; version=0.0.4");
+    return true;
+}
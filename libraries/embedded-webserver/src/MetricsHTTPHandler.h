@@ -0,0 +1,24 @@
+//
+//  MetricsHTTPHandler.h
+//  libraries/embedded-webserver/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_MetricsHTTPHandler_h
+#define hifi_MetricsHTTPHandler_h
+
+#include "HTTPManager.h"
+
+/// Serves the process' MetricsRegistry in the Prometheus text format on /metrics
+class MetricsHTTPHandler : public HTTPRequestHandler {
+public:
+    static const QString METRICS_PATH;
+
+    bool handleHTTPRequest(HTTPConnection* connection, const QUrl& url, bool skipSubHandler = false) override;
+};
+
+#endif // hifi_MetricsHTTPHandler_h
@@ -10,8 +10,11 @@
 //
 
 #include <math.h>
+#include <mutex>
 #include <QObject>
 #include <QByteArray>
+#include <QThread>
+#include <QThreadPool>
 #include <QtConcurrent/QtConcurrentRun>
 #include <glm/gtx/transform.hpp>
 #include "ModelScriptingInterface.h"
@@ -50,12 +53,25 @@
 #include "polyvox_vert.h"
 #include "polyvox_frag.h"
 #include "RenderablePolyVoxEntityItem.h"
+#include "VoxelChunkGrid.h"
 #include "EntityEditPacketSender.h"
 #include "PhysicalEntitySimulation.h"
 
 gpu::PipelinePointer RenderablePolyVoxEntityItem::_pipeline = nullptr;
 gpu::PipelinePointer RenderablePolyVoxEntityItem::_wireframePipeline = nullptr;
 
+// the polyvox jobs run on their own bounded pool so that sculpting can't starve the global one
+static QThreadPool* getPolyVoxThreadPool() {
+    static QThreadPool pool;
+    static std::once_flag once;
+    std::call_once(once, [] {
+        pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() / 2));
+    });
+    return &pool;
+}
+
+const int VoxelChunkGrid::CHUNK_SIZE;
+
 const float MARCHING_CUBE_COLLISION_HULL_OFFSET = 0.5;
 
 
@@ -85,8 +101,13 @@ const float MARCHING_CUBE_COLLISION_HULL_OFFSET = 0.5;
   send a packet to the entity-server.
 
   decompressVolumeData, recomputeMesh, computeShapeInfoWorker, and compressVolumeDataAndSendEditPacket are too expensive
-  to run on a thread that has other things to do.  These use QtConcurrent::run to spawn a thread.  As each thread
-  finishes, it adjusts the dirty flags so that the next call to render() will kick off the next step.
+  to run on a thread that has other things to do.  These run on a dedicated, bounded QThreadPool.  As each job
+  finishes, it adjusts the dirty flags so that the next call to render() will kick off the next step.  recomputeMesh
+  and compressVolumeDataAndSendEditPacket never have more than one job in flight per entity, requests made while one
+  runs are coalesced into a single rerun.
+
+  _volData is meshed in chunks (see VoxelChunkGrid).  Changing a voxel flags the chunks whose triangles depend on it,
+  and recomputeMesh only runs the surface extractor over those before stitching all the chunks into _mesh.
 
   polyvoxes are designed to seemlessly fit up against neighbors.  If voxels go right up to the edge of polyvox,
   the resulting mesh wont be closed -- the library assumes you'll have another polyvox next to it to continue the
@@ -182,6 +203,8 @@ void RenderablePolyVoxEntityItem::setVoxelSurfaceStyle(PolyVoxSurfaceStyle voxel
         } else {
             _volDataDirty = true;
             _voxelSurfaceStyle = voxelSurfaceStyle;
+            // a different extractor, every chunk has to be redone
+            resetChunks();
         }
     });
 
@@ -933,9 +956,26 @@ void RenderablePolyVoxEntityItem::setVoxelVolumeSize(glm::vec3 voxelVolumeSize)
 
         // having the "outside of voxel-space" value be 255 has helped me notice some problems.
         _volData->setBorderValue(255);
+        resetChunks();
     });
 }
 
+void RenderablePolyVoxEntityItem::resetChunks() {
+    // the caller holds the write lock.  a mesh job still working on the previous grid will drop its results.
+    _chunks = _volData ? std::make_shared<VoxelChunkGrid>(_volData->getEnclosingRegion(), _voxelSurfaceStyle) : nullptr;
+}
+
+void RenderablePolyVoxEntityItem::setVolDataVoxel(int x, int y, int z, uint8_t toValue) {
+    // the caller holds the write lock
+    if (_volData->getVoxelAt(x, y, z) == toValue) {
+        return;
+    }
+    _volData->setVoxelAt(x, y, z, toValue);
+    if (_chunks) {
+        _chunks->markDirty(x, y, z);
+    }
+}
+
 
 bool inUserBounds(const PolyVox::SimpleVolume<uint8_t>* vol,
                   PolyVoxEntityItem::PolyVoxSurfaceStyle surfaceStyle,
@@ -992,9 +1032,9 @@ bool RenderablePolyVoxEntityItem::setVoxelInternal(int x, int y, int z, uint8_t
     result = updateOnCount(x, y, z, toValue);
 
     if (isEdged(_voxelSurfaceStyle)) {
-        _volData->setVoxelAt(x + 1, y + 1, z + 1, toValue);
+        setVolDataVoxel(x + 1, y + 1, z + 1, toValue);
     } else {
-        _volData->setVoxelAt(x, y, z, toValue);
+        setVolDataVoxel(x, y, z, toValue);
     }
 
     if (x == 0 || y == 0 || z == 0) {
@@ -1039,7 +1079,7 @@ void RenderablePolyVoxEntityItem::decompressVolumeData() {
         voxelData = _voxelData;
     });
 
-    QtConcurrent::run([=] {
+    QtConcurrent::run(getPolyVoxThreadPool(), [=] {
         QDataStream reader(voxelData);
         quint16 voxelXSize, voxelYSize, voxelZSize;
         reader >> voxelXSize;
@@ -1093,6 +1133,11 @@ void RenderablePolyVoxEntityItem::compressVolumeDataAndSendEditPacket() {
     // compress the data in _volData and save the results.  The compressed form is used during
     // saves to disk and for transmission over the wire to the entity-server
 
+    if (!_compressJob.tryStart()) {
+        // the running job will start another one when it's done, which will pick up this edit
+        return;
+    }
+
     EntityItemPointer entity = getThisPointer();
 
     quint16 voxelXSize;
@@ -1107,7 +1152,7 @@ void RenderablePolyVoxEntityItem::compressVolumeDataAndSendEditPacket() {
     EntityTreeElementPointer element = getElement();
     EntityTreePointer tree = element ? element->getTree() : nullptr;
 
-    QtConcurrent::run([voxelXSize, voxelYSize, voxelZSize, entity, tree] {
+    QtConcurrent::run(getPolyVoxThreadPool(), [voxelXSize, voxelYSize, voxelZSize, entity, tree] {
         auto polyVoxEntity = std::static_pointer_cast<RenderablePolyVoxEntityItem>(entity);
         QByteArray uncompressedData = polyVoxEntity->volDataToArray(voxelXSize, voxelYSize, voxelZSize);
 
@@ -1124,27 +1169,40 @@ void RenderablePolyVoxEntityItem::compressVolumeDataAndSendEditPacket() {
             // HACK -- until we have a way to allow for properties larger than MTU, don't update.
             // revert the active voxel-space to the last version that fit.
             qCDebug(entities) << "compressed voxel data is too large" << entity->getName() << entity->getID();
-            return;
+        } else {
+            auto now = usecTimestampNow();
+            entity->setLastEdited(now);
+            entity->setLastBroadcast(now);
+
+            // _volData already has these voxels, and maybe newer ones, don't decompress them back
+            polyVoxEntity->setVoxelDataFromVolData(newVoxelData);
+
+            if (tree) {
+                tree->withReadLock([&] {
+                    EntityItemProperties properties = entity->getProperties();
+                    properties.setVoxelDataDirty();
+                    properties.setLastEdited(now);
+
+                    EntitySimulationPointer simulation = tree->getSimulation();
+                    PhysicalEntitySimulationPointer peSimulation =
+                        std::static_pointer_cast<PhysicalEntitySimulation>(simulation);
+                    EntityEditPacketSender* packetSender = peSimulation ? peSimulation->getPacketSender() : nullptr;
+                    if (packetSender) {
+                        packetSender->queueEditEntityMessage(PacketType::EntityEdit, tree, entity->getID(), properties);
+                    }
+                });
+            }
         }
 
-        auto now = usecTimestampNow();
-        entity->setLastEdited(now);
-        entity->setLastBroadcast(now);
-
-        std::static_pointer_cast<RenderablePolyVoxEntityItem>(entity)->setVoxelData(newVoxelData);
-
-        tree->withReadLock([&] {
-            EntityItemProperties properties = entity->getProperties();
-            properties.setVoxelDataDirty();
-            properties.setLastEdited(now);
+        if (polyVoxEntity->_compressJob.finish()) {
+            polyVoxEntity->compressVolumeDataAndSendEditPacket();
+        }
+    });
+}
 
-            EntitySimulationPointer simulation = tree ? tree->getSimulation() : nullptr;
-            PhysicalEntitySimulationPointer peSimulation = std::static_pointer_cast<PhysicalEntitySimulation>(simulation);
-            EntityEditPacketSender* packetSender = peSimulation ? peSimulation->getPacketSender() : nullptr;
-            if (packetSender) {
-                packetSender->queueEditEntityMessage(PacketType::EntityEdit, tree, entity->getID(), properties);
-            }
-        });
+void RenderablePolyVoxEntityItem::setVoxelDataFromVolData(QByteArray voxelData) {
+    withWriteLock([&] {
+        _voxelData = voxelData;
     });
 }
 
@@ -1208,7 +1266,7 @@ void RenderablePolyVoxEntityItem::copyUpperEdgesFromNeighbors() {
                     if ((y == 0 || z == 0) && _volData->getVoxelAt(_volData->getWidth() - 1, y, z) != neighborValue) {
                         bonkNeighbors();
                     }
-                    _volData->setVoxelAt(_volData->getWidth() - 1, y, z, neighborValue);
+                    setVolDataVoxel(_volData->getWidth() - 1, y, z, neighborValue);
                 }
             }
         });
@@ -1223,7 +1281,7 @@ void RenderablePolyVoxEntityItem::copyUpperEdgesFromNeighbors() {
                     if ((x == 0 || z == 0) && _volData->getVoxelAt(x, _volData->getHeight() - 1, z) != neighborValue) {
                         bonkNeighbors();
                     }
-                    _volData->setVoxelAt(x, _volData->getHeight() - 1, z, neighborValue);
+                    setVolDataVoxel(x, _volData->getHeight() - 1, z, neighborValue);
                 }
             }
         });
@@ -1235,11 +1293,11 @@ void RenderablePolyVoxEntityItem::copyUpperEdgesFromNeighbors() {
             for (int x = 0; x < _volData->getWidth(); x++) {
                 for (int y = 0; y < _volData->getHeight(); y++) {
                     uint8_t neighborValue = currentZPNeighbor->getVoxel(x, y, 0);
-                    _volData->setVoxelAt(x, y, _volData->getDepth() - 1, neighborValue);
+                    setVolDataVoxel(x, y, _volData->getDepth() - 1, neighborValue);
                     if ((x == 0 || y == 0) && _volData->getVoxelAt(x, y, _volData->getDepth() - 1) != neighborValue) {
                         bonkNeighbors();
                     }
-                    _volData->setVoxelAt(x, y, _volData->getDepth() - 1, neighborValue);
+                    setVolDataVoxel(x, y, _volData->getDepth() - 1, neighborValue);
                 }
             }
         });
@@ -1256,79 +1314,117 @@ void RenderablePolyVoxEntityItem::recomputeMesh() {
     cacheNeighbors();
     copyUpperEdgesFromNeighbors();
 
+    if (!_meshJob.tryStart()) {
+        // the running job will flag _volData as dirty again when it's done
+        return;
+    }
+
     auto entity = std::static_pointer_cast<RenderablePolyVoxEntityItem>(getThisPointer());
+    std::shared_ptr<VoxelChunkGrid> chunks;
+    withReadLock([&] {
+        chunks = _chunks;
+    });
 
-    QtConcurrent::run([entity, voxelSurfaceStyle] {
-        model::MeshPointer mesh(new model::Mesh());
+    QtConcurrent::run(getPolyVoxThreadPool(), [entity, voxelSurfaceStyle, chunks] {
+        if (!chunks) {
+            // there is no _volData yet, allocating it will start over
+            entity->_meshJob.finish();
+            return;
+        }
 
-        // A mesh object to hold the result of surface extraction
-        PolyVox::SurfaceMesh<PolyVox::PositionMaterialNormal> polyVoxMesh;
+        bool chunksAreCurrent = true;
+        std::vector<int> dirtyChunks;
+        entity->withWriteLock([&] {
+            chunksAreCurrent = entity->_chunks == chunks;
+            if (chunksAreCurrent) {
+                dirtyChunks = chunks->takeDirtyChunks();
+            }
+        });
 
-        entity->withReadLock([&] {
-            PolyVox::SimpleVolume<uint8_t>* volData = entity->getVolData();
-            switch (voxelSurfaceStyle) {
-                case PolyVoxEntityItem::SURFACE_EDGED_MARCHING_CUBES: {
-                    PolyVox::MarchingCubesSurfaceExtractor<PolyVox::SimpleVolume<uint8_t>> surfaceExtractor
-                        (volData, volData->getEnclosingRegion(), &polyVoxMesh);
-                    surfaceExtractor.execute();
-                    break;
-                }
-                case PolyVoxEntityItem::SURFACE_MARCHING_CUBES: {
-                    PolyVox::MarchingCubesSurfaceExtractor<PolyVox::SimpleVolume<uint8_t>> surfaceExtractor
-                        (volData, volData->getEnclosingRegion(), &polyVoxMesh);
-                    surfaceExtractor.execute();
-                    break;
-                }
-                case PolyVoxEntityItem::SURFACE_EDGED_CUBIC: {
-                    PolyVox::CubicSurfaceExtractorWithNormals<PolyVox::SimpleVolume<uint8_t>> surfaceExtractor
-                        (volData, volData->getEnclosingRegion(), &polyVoxMesh);
-                    surfaceExtractor.execute();
-                    break;
+        // only extract the chunks that changed.  edits made meanwhile flag their chunks again, each chunk is
+        // extracted under its own read lock so that they don't have to wait for the whole volume.
+        for (int index : dirtyChunks) {
+            PolyVox::Region region = chunks->getChunkRegion(index);
+
+            // A mesh object to hold the result of surface extraction
+            PolyVox::SurfaceMesh<PolyVox::PositionMaterialNormal> polyVoxMesh;
+
+            entity->withReadLock([&] {
+                if (entity->_chunks != chunks) {
+                    // _volData was reallocated, this grid is stale and the new one has every chunk dirty
+                    chunksAreCurrent = false;
+                    return;
                 }
-                case PolyVoxEntityItem::SURFACE_CUBIC: {
-                    PolyVox::CubicSurfaceExtractorWithNormals<PolyVox::SimpleVolume<uint8_t>> surfaceExtractor
-                        (volData, volData->getEnclosingRegion(), &polyVoxMesh);
-                    surfaceExtractor.execute();
-                    break;
+                extractVoxelSurface(entity->getVolData(), region, voxelSurfaceStyle, polyVoxMesh);
+            });
+            if (!chunksAreCurrent) {
+                break;
+            }
+            chunks->setChunkMesh(index, polyVoxMesh);
+        }
+
+        if (chunksAreCurrent) {
+            // stitch the chunks back into a single mesh, so it still renders in one draw call
+            size_t numVertices = 0;
+            size_t numIndices = 0;
+            for (int i = 0; i < chunks->getNumChunks(); i++) {
+                numVertices += chunks->getChunk(i).vertices.size();
+                numIndices += chunks->getChunk(i).indices.size();
+            }
+            std::vector<PolyVox::PositionMaterialNormal> vecVertices;
+            std::vector<uint32_t> vecIndices;
+            vecVertices.reserve(numVertices);
+            vecIndices.reserve(numIndices);
+            for (int i = 0; i < chunks->getNumChunks(); i++) {
+                const VoxelChunkGrid::Chunk& chunk = chunks->getChunk(i);
+                uint32_t baseVertex = (uint32_t)vecVertices.size();
+                vecVertices.insert(vecVertices.end(), chunk.vertices.begin(), chunk.vertices.end());
+                for (uint32_t index : chunk.indices) {
+                    vecIndices.push_back(baseVertex + index);
                 }
             }
-        });
 
-        // convert PolyVox mesh to a Sam mesh
-        const std::vector<uint32_t>& vecIndices = polyVoxMesh.getIndices();
-        auto indexBuffer = std::make_shared<gpu::Buffer>(vecIndices.size() * sizeof(uint32_t),
-                                                         (gpu::Byte*)vecIndices.data());
-        auto indexBufferPtr = gpu::BufferPointer(indexBuffer);
-        gpu::BufferView indexBufferView(indexBufferPtr, gpu::Element(gpu::SCALAR, gpu::UINT32, gpu::INDEX));
-        mesh->setIndexBuffer(indexBufferView);
-
-        const std::vector<PolyVox::PositionMaterialNormal>& vecVertices = polyVoxMesh.getRawVertexData();
-        auto vertexBuffer = std::make_shared<gpu::Buffer>(vecVertices.size() * sizeof(PolyVox::PositionMaterialNormal),
-                                                          (gpu::Byte*)vecVertices.data());
-        auto vertexBufferPtr = gpu::BufferPointer(vertexBuffer);
-        gpu::BufferView vertexBufferView(vertexBufferPtr, 0,
-                                         vertexBufferPtr->getSize(),
-                                         sizeof(PolyVox::PositionMaterialNormal),
-                                         gpu::Element(gpu::VEC3, gpu::FLOAT, gpu::XYZ));
-        mesh->setVertexBuffer(vertexBufferView);
-
-
-        // TODO -- use 3-byte normals rather than 3-float normals
-        mesh->addAttribute(gpu::Stream::NORMAL,
-                           gpu::BufferView(vertexBufferPtr,
-                                           sizeof(float) * 3, // polyvox mesh is packed: position, normal, material
-                                           vertexBufferPtr->getSize(),
-                                           sizeof(PolyVox::PositionMaterialNormal),
-                                           gpu::Element(gpu::VEC3, gpu::FLOAT, gpu::XYZ)));
-
-        std::vector<model::Mesh::Part> parts;
-        parts.emplace_back(model::Mesh::Part((model::Index)0, // startIndex
-                                             (model::Index)vecIndices.size(), // numIndices
-                                             (model::Index)0, // baseVertex
-                                             model::Mesh::TRIANGLES)); // topology
-        mesh->setPartBuffer(gpu::BufferView(new gpu::Buffer(parts.size() * sizeof(model::Mesh::Part),
-                                                            (gpu::Byte*) parts.data()), gpu::Element::PART_DRAWCALL));
-        entity->setMesh(mesh);
+            model::MeshPointer mesh(new model::Mesh());
+
+            // convert PolyVox mesh to a Sam mesh
+            auto indexBuffer = std::make_shared<gpu::Buffer>(vecIndices.size() * sizeof(uint32_t),
+                                                             (gpu::Byte*)vecIndices.data());
+            auto indexBufferPtr = gpu::BufferPointer(indexBuffer);
+            gpu::BufferView indexBufferView(indexBufferPtr, gpu::Element(gpu::SCALAR, gpu::UINT32, gpu::INDEX));
+            mesh->setIndexBuffer(indexBufferView);
+
+            auto vertexBuffer = std::make_shared<gpu::Buffer>(vecVertices.size() * sizeof(PolyVox::PositionMaterialNormal),
+                                                              (gpu::Byte*)vecVertices.data());
+            auto vertexBufferPtr = gpu::BufferPointer(vertexBuffer);
+            gpu::BufferView vertexBufferView(vertexBufferPtr, 0,
+                                             vertexBufferPtr->getSize(),
+                                             sizeof(PolyVox::PositionMaterialNormal),
+                                             gpu::Element(gpu::VEC3, gpu::FLOAT, gpu::XYZ));
+            mesh->setVertexBuffer(vertexBufferView);
+
+
+            // TODO -- use 3-byte normals rather than 3-float normals
+            mesh->addAttribute(gpu::Stream::NORMAL,
+                               gpu::BufferView(vertexBufferPtr,
+                                               sizeof(float) * 3, // polyvox mesh is packed: position, normal, material
+                                               vertexBufferPtr->getSize(),
+                                               sizeof(PolyVox::PositionMaterialNormal),
+                                               gpu::Element(gpu::VEC3, gpu::FLOAT, gpu::XYZ)));
+
+            std::vector<model::Mesh::Part> parts;
+            parts.emplace_back(model::Mesh::Part((model::Index)0, // startIndex
+                                                 (model::Index)vecIndices.size(), // numIndices
+                                                 (model::Index)0, // baseVertex
+                                                 model::Mesh::TRIANGLES)); // topology
+            mesh->setPartBuffer(gpu::BufferView(new gpu::Buffer(parts.size() * sizeof(model::Mesh::Part),
+                                                                (gpu::Byte*) parts.data()), gpu::Element::PART_DRAWCALL));
+            entity->setMesh(mesh);
+        }
+
+        if (entity->_meshJob.finish() || !chunksAreCurrent) {
+            // let the next render kick off another pass
+            entity->setVolDataDirty();
+        }
     });
 }
 
@@ -1369,7 +1465,7 @@ void RenderablePolyVoxEntityItem::computeShapeInfoWorker() {
         mesh = _mesh;
     });
 
-    QtConcurrent::run([entity, voxelSurfaceStyle, voxelVolumeSize, mesh] {
+    QtConcurrent::run(getPolyVoxThreadPool(), [entity, voxelSurfaceStyle, voxelVolumeSize, mesh] {
         auto polyVoxEntity = std::static_pointer_cast<RenderablePolyVoxEntityItem>(entity);
         QVector<QVector<glm::vec3>> pointCollection;
         AABox box;
@@ -24,6 +24,8 @@
 #include "RenderableEntityItem.h"
 #include "gpu/Context.h"
 
+class VoxelChunkGrid;
+
 class PolyVoxPayload {
 public:
     PolyVoxPayload(EntityItemPointer owner) : _owner(owner), _bounds(AABox()) { }
@@ -152,6 +154,29 @@ protected:
     virtual void locationChanged(bool tellPhysics = true) override;
 
 private:
+    // At most one job of a kind runs per entity.  A request made while one runs is folded into a single rerun
+    // once it finishes, so a brush stroke doesn't queue one job per sample.
+    class CoalescedJob {
+    public:
+        // true if the caller should start the job now
+        bool tryStart() {
+            _requested = true;
+            if (_running.exchange(true)) {
+                return false;
+            }
+            _requested = false;
+            return true;
+        }
+        // true if the job was requested again while it ran
+        bool finish() {
+            _running = false;
+            return _requested;
+        }
+    private:
+        std::atomic<bool> _running { false };
+        std::atomic<bool> _requested { false };
+    };
+
     // The PolyVoxEntityItem class has _voxelData which contains dimensions and compressed voxel data.  The dimensions
     // may not match _voxelVolumeSize.
 
@@ -173,6 +198,16 @@ private:
 
     PolyVox::SimpleVolume<uint8_t>* _volData = nullptr;
     bool _volDataDirty = false; // does recomputeMesh need to be called?
+
+    // _volData is meshed in chunks, only the chunks touched since the last recomputeMesh are extracted again.
+    // Replaced, with every chunk dirty, when _volData is reallocated or the surface style changes.
+    std::shared_ptr<VoxelChunkGrid> _chunks;
+    void resetChunks();
+    // volume coordinates, already adjusted for the edge.  Flags the chunks whose mesh depends on the voxel.
+    void setVolDataVoxel(int x, int y, int z, uint8_t toValue);
+
+    CoalescedJob _meshJob;
+    CoalescedJob _compressJob;
     int _onCount; // how many non-zero voxels are in _volData
 
     bool _neighborsNeedUpdate { false };
@@ -183,6 +218,7 @@ private:
     // these are run off the main thread
     void decompressVolumeData();
     void compressVolumeDataAndSendEditPacket();
+    void setVoxelDataFromVolData(QByteArray voxelData);
     virtual void recomputeMesh() override; // recompute mesh
     void computeShapeInfoWorker();
 
@@ -0,0 +1,146 @@
+//
+//  VoxelChunkGrid.h
+//  libraries/entities-renderer/src/
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_VoxelChunkGrid_h
+#define hifi_VoxelChunkGrid_h
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#ifdef _WIN32
+#pragma warning(push)
+#pragma warning( disable : 4267 )
+#endif
+#include <PolyVoxCore/CubicSurfaceExtractorWithNormals.h>
+#include <PolyVoxCore/MarchingCubesSurfaceExtractor.h>
+#include <PolyVoxCore/SurfaceMesh.h>
+#include <PolyVoxCore/SimpleVolume.h>
+#include <PolyVoxCore/Material.h>
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+
+#include "PolyVoxEntityItem.h"
+
+inline bool isCubicSurfaceStyle(PolyVoxEntityItem::PolyVoxSurfaceStyle surfaceStyle) {
+    return surfaceStyle == PolyVoxEntityItem::SURFACE_CUBIC || surfaceStyle == PolyVoxEntityItem::SURFACE_EDGED_CUBIC;
+}
+
+// Runs the extractor of surfaceStyle over region of volData, the mesh positions are relative to the lower corner of region
+inline void extractVoxelSurface(PolyVox::SimpleVolume<uint8_t>* volData, const PolyVox::Region& region,
+                                PolyVoxEntityItem::PolyVoxSurfaceStyle surfaceStyle,
+                                PolyVox::SurfaceMesh<PolyVox::PositionMaterialNormal>& mesh) {
+    if (isCubicSurfaceStyle(surfaceStyle)) {
+        PolyVox::CubicSurfaceExtractorWithNormals<PolyVox::SimpleVolume<uint8_t>> surfaceExtractor(volData, region, &mesh);
+        surfaceExtractor.execute();
+    } else {
+        PolyVox::MarchingCubesSurfaceExtractor<PolyVox::SimpleVolume<uint8_t>> surfaceExtractor(volData, region, &mesh);
+        surfaceExtractor.execute();
+    }
+}
+
+// Splits a volume into chunks that can be extracted on their own and give the same triangles as extracting the whole
+// volume.  The extractors don't own the same things:
+//  - marching cubes meshes the cells, the cubes between 8 voxels.  A chunk is CHUNK_SIZE^3 cells, chunk i along an
+//    axis covers the voxels [i * CHUNK_SIZE, (i + 1) * CHUNK_SIZE] and neighboring chunks share the voxels of their seam.
+//  - the cubic extractors mesh the faces between each voxel and its neighbors above.  A chunk is CHUNK_SIZE^3 voxels,
+//    chunk i along an axis covers the voxels [i * CHUNK_SIZE, (i + 1) * CHUNK_SIZE - 1] so no face is made twice.
+class VoxelChunkGrid {
+public:
+    static const int CHUNK_SIZE = 16;
+
+    class Chunk {
+    public:
+        std::vector<PolyVox::PositionMaterialNormal> vertices; // in volume coordinates
+        std::vector<uint32_t> indices;
+    };
+
+    VoxelChunkGrid(const PolyVox::Region& region, PolyVoxEntityItem::PolyVoxSurfaceStyle surfaceStyle) :
+        _lower(region.getLowerCorner().getX(), region.getLowerCorner().getY(), region.getLowerCorner().getZ()),
+        _upper(region.getUpperCorner().getX(), region.getUpperCorner().getY(), region.getUpperCorner().getZ()),
+        _isCubic(isCubicSurfaceStyle(surfaceStyle))
+    {
+        // the cells or voxels split into chunks, by their lower corner
+        _lastUnit = _isCubic ? _upper : glm::max(_upper - glm::ivec3(1), _lower);
+        glm::ivec3 units = _lastUnit - _lower + glm::ivec3(1);
+        _counts = (units + glm::ivec3(CHUNK_SIZE - 1)) / CHUNK_SIZE;
+        int numChunks = _counts.x * _counts.y * _counts.z;
+        _chunks.resize(numChunks);
+        _dirty.resize(numChunks, true);
+    }
+
+    PolyVox::Region getChunkRegion(int index) const {
+        glm::ivec3 chunk(index % _counts.x, (index / _counts.x) % _counts.y, index / (_counts.x * _counts.y));
+        glm::ivec3 lower = _lower + chunk * CHUNK_SIZE;
+        glm::ivec3 upper = glm::min(lower + glm::ivec3(_isCubic ? CHUNK_SIZE - 1 : CHUNK_SIZE), _upper);
+        return PolyVox::Region(PolyVox::Vector3DInt32(lower.x, lower.y, lower.z),
+                               PolyVox::Vector3DInt32(upper.x, upper.y, upper.z));
+    }
+
+    // Flags the chunks whose triangles depend on the voxel.  With marching cubes a voxel is a corner of the cells on
+    // either side of it, and the normals are central differences which reach one voxel further.  With the cubic
+    // extractors the voxel only shares faces with its neighbors, the one below owns the face between them.
+    void markDirty(int x, int y, int z) {
+        glm::ivec3 voxel(x, y, z);
+        glm::ivec3 lowUnit = glm::clamp(voxel - glm::ivec3(_isCubic ? 1 : 2), _lower, _lastUnit);
+        glm::ivec3 highUnit = glm::clamp(voxel + glm::ivec3(_isCubic ? 0 : 1), _lower, _lastUnit);
+        glm::ivec3 lowChunk = glm::clamp((lowUnit - _lower) / CHUNK_SIZE, glm::ivec3(0), _counts - glm::ivec3(1));
+        glm::ivec3 highChunk = glm::clamp((highUnit - _lower) / CHUNK_SIZE, glm::ivec3(0), _counts - glm::ivec3(1));
+        for (int k = lowChunk.z; k <= highChunk.z; k++) {
+            for (int j = lowChunk.y; j <= highChunk.y; j++) {
+                for (int i = lowChunk.x; i <= highChunk.x; i++) {
+                    _dirty[(k * _counts.y + j) * _counts.x + i] = true;
+                }
+            }
+        }
+    }
+
+    // the caller holds the entity's write lock
+    std::vector<int> takeDirtyChunks() {
+        std::vector<int> result;
+        for (int i = 0; i < (int)_dirty.size(); i++) {
+            if (_dirty[i]) {
+                result.push_back(i);
+                _dirty[i] = false;
+            }
+        }
+        return result;
+    }
+
+    // only touched by the mesh job, of which there is one at a time
+    int getNumChunks() const { return (int)_chunks.size(); }
+    Chunk& getChunk(int index) { return _chunks[index]; }
+
+    // keeps the mesh extracted from the region of a chunk, moved from region to volume coordinates
+    void setChunkMesh(int index, const PolyVox::SurfaceMesh<PolyVox::PositionMaterialNormal>& mesh) {
+        PolyVox::Region region = getChunkRegion(index);
+        Chunk& chunk = _chunks[index];
+        chunk.vertices = mesh.getRawVertexData();
+        chunk.indices = mesh.getIndices();
+        PolyVox::Vector3DFloat offset((float)region.getLowerCorner().getX(),
+                                      (float)region.getLowerCorner().getY(),
+                                      (float)region.getLowerCorner().getZ());
+        for (auto& vertex : chunk.vertices) {
+            vertex.setPosition(vertex.getPosition() + offset);
+        }
+    }
+
+private:
+    glm::ivec3 _lower;
+    glm::ivec3 _upper;
+    glm::ivec3 _lastUnit;
+    glm::ivec3 _counts;
+    bool _isCubic;
+    std::vector<bool> _dirty;
+    std::vector<Chunk> _chunks;
+};
+
+#endif // hifi_VoxelChunkGrid_h
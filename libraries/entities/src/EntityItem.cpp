@@ -11,6 +11,8 @@
 
 #include "EntityItem.h"
 
+#include <algorithm>
+
 #include <QtCore/QObject>
 #include <QtEndian>
 
@@ -31,6 +33,7 @@
 #include "EntityTree.h"
 #include "EntitySimulation.h"
 #include "EntityActionFactoryInterface.h"
+#include "EntityQueryFilter.h"
 
 
 int EntityItem::_maxActionsDataSize = 800;
@@ -189,7 +192,32 @@ OctreeElement::AppendState EntityItem::appendEntityData(OctreePacketData* packet
         requestedProperties = entityTreeElementExtraEncodeData->entities.value(getEntityItemID());
     }
 
+    // The encoding doesn't depend on the viewer, except for AVATAR_SELF_ID parents which are resolved per node.
+    // If nothing changed since another viewer got this entity with the same requested properties, reuse its bytes.
+    bool canUseEncodedData = getParentID() != AVATAR_SELF_ID;
+    EncodedData encodedDataKey;
+    if (canUseEncodedData) {
+        encodedDataKey.requestedProperties = requestedProperties;
+        encodedDataKey.generation = _encodedDataGeneration;
+        encodedDataKey.lastEdited = getLastEdited();
+        encodedDataKey.lastUpdated = getLastUpdated();
+        encodedDataKey.lastSimulated = getLastSimulated();
+        encodedDataKey.changedOnServer = getLastChangedOnServer();
+
+        QByteArray encodedData;
+        if (findEncodedData(encodedDataKey, encodedData)) {
+            if (!packetData->appendRawData(encodedData)) {
+                // the whole entity doesn't fit, fall through to encode as many properties as possible
+                canUseEncodedData = false;
+            } else {
+                params.trackSend(getID(), getLastEdited());
+                return OctreeElement::COMPLETED;
+            }
+        }
+    }
+
     LevelDetails entityLevel = packetData->startLevel();
+    int startOfEntity = packetData->getUncompressedByteOffset();
 
     quint64 lastEdited = getLastEdited();
 
@@ -340,9 +368,51 @@ OctreeElement::AppendState EntityItem::appendEntityData(OctreePacketData* packet
         params.trackSend(getID(), getLastEdited());
     }
 
+    // only complete encodings are shared, a partial one depends on how much room this packet had left
+    if (canUseEncodedData && appendState == OctreeElement::COMPLETED) {
+        int endOfEntity = packetData->getUncompressedByteOffset();
+        encodedDataKey.bytes = QByteArray((const char*)packetData->getUncompressedData(startOfEntity),
+                                          endOfEntity - startOfEntity);
+        storeEncodedData(std::move(encodedDataKey));
+    }
+
     return appendState;
 }
 
+const size_t EntityItem::MAX_ENCODED_DATA_CACHE_SIZE = 2; // the full property set and the most common subset
+
+bool EntityItem::findEncodedData(const EncodedData& key, QByteArray& bytes) const {
+    std::lock_guard<std::mutex> lock(_encodedDataCacheMutex);
+    for (auto itr = _encodedDataCache.begin(); itr != _encodedDataCache.end(); ++itr) {
+        if (itr->requestedProperties == key.requestedProperties) {
+            if (itr->generation != key.generation || itr->lastEdited != key.lastEdited ||
+                itr->lastUpdated != key.lastUpdated || itr->lastSimulated != key.lastSimulated ||
+                itr->changedOnServer != key.changedOnServer) {
+                // stale, the next complete encoding will replace it
+                _encodedDataCache.erase(itr);
+                return false;
+            }
+            bytes = itr->bytes;
+            std::rotate(_encodedDataCache.begin(), itr, itr + 1);
+            return true;
+        }
+    }
+    return false;
+}
+
+void EntityItem::storeEncodedData(EncodedData&& data) const {
+    std::lock_guard<std::mutex> lock(_encodedDataCacheMutex);
+    auto itr = std::find_if(_encodedDataCache.begin(), _encodedDataCache.end(), [&](const EncodedData& entry) {
+        return entry.requestedProperties == data.requestedProperties;
+    });
+    if (itr != _encodedDataCache.end()) {
+        _encodedDataCache.erase(itr);
+    } else if (_encodedDataCache.size() >= MAX_ENCODED_DATA_CACHE_SIZE) {
+        _encodedDataCache.pop_back();
+    }
+    _encodedDataCache.insert(_encodedDataCache.begin(), std::move(data));
+}
+
 // TODO: My goal is to get rid of this concept completely. The old code (and some of the current code) used this
 // result to calculate if a packet being sent to it was potentially bad or corrupt. I've adjusted this to now
 // only consider the minimum header bytes as being required. But it would be preferable to completely eliminate
@@ -2189,6 +2259,7 @@ void EntityItem::setActionDataInternal(QByteArray actionData) {
     if (_allActionsDataCache != actionData) {
         _allActionsDataCache = actionData;
         deserializeActionsInternal();
+        invalidateEncodedData();
     }
     checkWaitingToRemove();
 }
@@ -2293,6 +2364,7 @@ QList<EntityActionPointer> EntityItem::getActionsOfType(EntityActionType typeToG
 
 void EntityItem::locationChanged(bool tellPhysics) {
     requiresRecalcBoxes();
+    invalidateEncodedData();
     if (tellPhysics) {
         _dirtyFlags |= Simulation::DIRTY_TRANSFORM;
         EntityTreePointer tree = getTree();
@@ -2305,6 +2377,7 @@ void EntityItem::locationChanged(bool tellPhysics) {
 
 void EntityItem::dimensionsChanged() {
     requiresRecalcBoxes();
+    invalidateEncodedData();
     SpatiallyNestable::dimensionsChanged(); // Do what you have to do
 }
 
@@ -2333,29 +2406,15 @@ void EntityItem::globalizeProperties(EntityItemProperties& properties, const QSt
 
 
 bool EntityItem::matchesJSONFilters(const QJsonObject& jsonFilters) const {
-    
-    // The intention for the query JSON filter and this method is to be flexible to handle a variety of filters for
-    // ALL entity properties. Some work will need to be done to the property system so that it can be more flexible
-    // (to grab the value and default value of a property given the string representation of that property, for example)
-    
-    // currently the only property filter we handle is '+' for serverScripts
-    // which means that we only handle a filtered query asking for entities where the serverScripts property is non-default
-    
-    static const QString SERVER_SCRIPTS_PROPERTY = "serverScripts";
-    
-    foreach(const auto& property, jsonFilters.keys()) {
-        if (property == SERVER_SCRIPTS_PROPERTY  && jsonFilters[property] == EntityQueryFilterSymbol::NonDefault) {
-            // check if this entity has a non-default value for serverScripts
-            if (_serverScripts != ENTITY_ITEM_DEFAULT_SERVER_SCRIPTS) {
-                return true;
-            } else {
-                return false;
-            }
-        }
+    // the entity server compiles the filters once per query, see EntityNodeData::getQueryFilter()
+    return EntityQueryFilter(jsonFilters).matches(*this);
+}
+
+void EntityItem::addQueryFilterTraits(uint32_t traits) {
+    uint32_t previousTraits = _queryFilterTraits.fetch_or(traits);
+    if ((previousTraits & traits) != traits) {
+        EntityTreeElement::queryFilterTraitsChanged();
     }
-    
-    // the json filter syntax did not match what we expected, return a match
-    return true;
 }
 
 quint64 EntityItem::getLastSimulated() const {
@@ -2385,6 +2444,9 @@ void EntityItem::setLastEdited(quint64 lastEdited) {
         _lastEdited = _lastUpdated = lastEdited;
         _changedOnServer = glm::max(lastEdited, _changedOnServer);
     });
+    // an edit in the same microsecond as the last encoding, or one that restores an older edit time, keeps the
+    // timestamps of the encoded data key
+    invalidateEncodedData();
 }
 
 quint64 EntityItem::getLastBroadcast() const { 
@@ -2600,6 +2662,9 @@ void EntityItem::setServerScripts(const QString& serverScripts) {
         _serverScripts = serverScripts; 
         _serverScriptsChangedTimestamp = usecTimestampNow();
     });
+    if (serverScripts != ENTITY_ITEM_DEFAULT_SERVER_SCRIPTS) {
+        addQueryFilterTraits(EntityQueryFilter::SERVER_SCRIPTS_TRAIT);
+    }
 }
 
 QString EntityItem::getCollisionSoundURL() const { 
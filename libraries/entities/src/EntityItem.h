@@ -12,7 +12,9 @@
 #ifndef hifi_EntityItem_h
 #define hifi_EntityItem_h
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <stdint.h>
 
 #include <glm/glm.hpp>
@@ -472,6 +474,7 @@ public:
     void setLastEditedBy(QUuid value) { _lastEditedBy = value; }
 
     bool matchesJSONFilters(const QJsonObject& jsonFilters) const;
+    uint32_t getQueryFilterTraits() const { return _queryFilterTraits; } // EntityQueryFilter::Trait bits
 
     virtual bool getMeshes(MeshProxyList& result) { return true; }
 
@@ -485,6 +488,9 @@ protected:
     virtual void locationChanged(bool tellPhysics = true) override;
     virtual void dimensionsChanged() override;
 
+    // drops the encoded bytes for changes that don't go through setLastEdited(), like local frame changes
+    void invalidateEncodedData() { _encodedDataGeneration++; }
+
     EntityTypes::EntityType _type;
     quint64 _lastSimulated; // last time this entity called simulate(), this includes velocity, angular velocity,
                             // and physics changes
@@ -615,6 +621,30 @@ protected:
     quint64 _fadeStartTime { usecTimestampNow() };
     static std::function<bool()> _entitiesShouldFadeFunction;
     bool _isFading { _entitiesShouldFadeFunction() };
+
+    // The bytes appendEntityData() wrote for a set of requested properties, shared by every viewer the entity
+    // server sends this entity to.  An entry is only valid as long as all the timestamps that go in the
+    // header and the generation still match.
+    class EncodedData {
+    public:
+        EntityPropertyFlags requestedProperties;
+        quint64 lastEdited { 0 };
+        quint64 lastUpdated { 0 };
+        quint64 lastSimulated { 0 };
+        quint64 changedOnServer { 0 };
+        uint32_t generation { 0 };
+        QByteArray bytes;
+    };
+    static const size_t MAX_ENCODED_DATA_CACHE_SIZE;
+    bool findEncodedData(const EncodedData& key, QByteArray& bytes) const;
+    void storeEncodedData(EncodedData&& data) const;
+
+    mutable std::mutex _encodedDataCacheMutex;
+    mutable std::vector<EncodedData> _encodedDataCache; // most recently used first
+    std::atomic<uint32_t> _encodedDataGeneration { 0 };
+
+    void addQueryFilterTraits(uint32_t traits);
+    std::atomic<uint32_t> _queryFilterTraits { 0 };
 };
 
 #endif // hifi_EntityItem_h
@@ -11,6 +11,15 @@
 
 #include "EntityNodeData.h"
 
+const EntityQueryFilter& EntityNodeData::getQueryFilter() {
+    uint32_t version = getJSONParametersVersion();
+    if (version != _queryFilterVersion) {
+        _queryFilter = EntityQueryFilter(getJSONParameters());
+        _queryFilterVersion = version;
+    }
+    return _queryFilter;
+}
+
 bool EntityNodeData::insertFlaggedExtraEntity(const QUuid& filteredEntityID, const QUuid& extraEntityID) {
     _flaggedExtraEntities[filteredEntityID].insert(extraEntityID);
     return !_previousFlaggedExtraEntities[filteredEntityID].contains(extraEntityID);
@@ -28,3 +37,12 @@ bool EntityNodeData::isEntityFlaggedAsExtra(const QUuid& entityID) const {
 
     return false;
 }
+
+bool EntityNodeData::hasFlaggedExtraEntities() const {
+    foreach(const QSet<QUuid>& entitySet, _flaggedExtraEntities) {
+        if (!entitySet.isEmpty()) {
+            return true;
+        }
+    }
+    return false;
+}
@@ -16,6 +16,8 @@
 
 #include <OctreeQueryNode.h>
 
+#include "EntityQueryFilter.h"
+
 namespace EntityJSONQueryProperties {
     static const QString SERVER_SCRIPTS_PROPERTY = "serverScripts";
     static const QString FLAGS_PROPERTY = "flags";
@@ -27,6 +29,10 @@ class EntityNodeData : public OctreeQueryNode {
 public:
     virtual PacketType getMyPacketType() const override { return PacketType::EntityData; }
 
+    // the JSON parameters compiled into a filter, recompiled when they change
+    // can only be called from the OctreeSendThread for the given Node
+    const EntityQueryFilter& getQueryFilter();
+
     quint64 getLastDeletedEntitiesSentAt() const { return _lastDeletedEntitiesSentAt; }
     void setLastDeletedEntitiesSentAt(quint64 sentAt) { _lastDeletedEntitiesSentAt = sentAt; }
     
@@ -42,9 +48,13 @@ public:
     bool insertFlaggedExtraEntity(const QUuid& filteredEntityID, const QUuid& extraEntityID);
     
     bool isEntityFlaggedAsExtra(const QUuid& entityID) const;
+    bool hasFlaggedExtraEntities() const;
     void resetFlaggedExtraEntities() { _previousFlaggedExtraEntities = _flaggedExtraEntities; _flaggedExtraEntities.clear(); }
 
 private:
+    EntityQueryFilter _queryFilter;
+    uint32_t _queryFilterVersion { 0 };
+
     quint64 _lastDeletedEntitiesSentAt { usecTimestampNow() };
     QSet<QUuid> _sentFilteredEntities;
     QHash<QUuid, QSet<QUuid>> _flaggedExtraEntities;
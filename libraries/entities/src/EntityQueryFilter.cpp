@@ -0,0 +1,44 @@
+//
+//  EntityQueryFilter.cpp
+//  libraries/entities/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityQueryFilter.h"
+
+#include "EntityItem.h"
+#include "EntityNodeData.h"
+#include "EntityTree.h"
+
+EntityQueryFilter::EntityQueryFilter(const QJsonObject& jsonFilters) :
+    _hasFilters(!jsonFilters.isEmpty())
+{
+    // The intention for the query JSON filter is to be flexible to handle a variety of filters for ALL entity
+    // properties. Some work will need to be done to the property system so that it can be more flexible (to grab the
+    // value and default value of a property given the string representation of that property, for example)
+
+    // currently the only property filter we handle is '+' for serverScripts, anything else matches every entity
+    auto serverScripts = jsonFilters.find(EntityJSONQueryProperties::SERVER_SCRIPTS_PROPERTY);
+    if (serverScripts != jsonFilters.end() && serverScripts.value() == EntityQueryFilterSymbol::NonDefault) {
+        _terms.push_back({ Field::ServerScripts, Op::NonDefault });
+        _requiredTraits |= SERVER_SCRIPTS_TRAIT;
+    }
+}
+
+bool EntityQueryFilter::matches(const EntityItem& entity) const {
+    for (const auto& term : _terms) {
+        switch (term.field) {
+            case Field::ServerScripts:
+                // NonDefault is the only operator so far
+                if (entity.getServerScripts() == ENTITY_ITEM_DEFAULT_SERVER_SCRIPTS) {
+                    return false;
+                }
+                break;
+        }
+    }
+    return true;
+}
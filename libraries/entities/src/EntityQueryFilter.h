@@ -0,0 +1,60 @@
+//
+//  EntityQueryFilter.h
+//  libraries/entities/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityQueryFilter_h
+#define hifi_EntityQueryFilter_h
+
+#include <stdint.h>
+#include <vector>
+
+#include <QtCore/QJsonObject>
+
+class EntityItem;
+
+/// The JSON filter of an entity query, compiled once when the query is received so the entity server doesn't have
+/// to walk the QJsonObject for every entity it considers sending.
+class EntityQueryFilter {
+public:
+    /// Summary bits an entity exposes so whole subtrees of the octree can be skipped when none of their entities can
+    /// match.  A trait is sticky for the lifetime of the entity: an entity that stops matching still has to be sent
+    /// once more so the viewer learns it fell outside of the filter.
+    enum Trait : uint32_t {
+        SERVER_SCRIPTS_TRAIT = 1 << 0
+    };
+
+    EntityQueryFilter() {}
+    explicit EntityQueryFilter(const QJsonObject& jsonFilters);
+
+    /// true if the query had JSON parameters at all, in which case sent entities are tracked per node
+    bool hasFilters() const { return _hasFilters; }
+
+    bool matches(const EntityItem& entity) const;
+
+    /// false if no entity with only these traits can match
+    bool canMatchTraits(uint32_t traits) const { return (traits & _requiredTraits) == _requiredTraits; }
+
+private:
+    enum class Field : uint8_t {
+        ServerScripts
+    };
+    enum class Op : uint8_t {
+        NonDefault
+    };
+    struct Term {
+        Field field;
+        Op op;
+    };
+
+    std::vector<Term> _terms; // all of them have to match
+    uint32_t _requiredTraits { 0 };
+    bool _hasFilters { false };
+};
+
+#endif // hifi_EntityQueryFilter_h
@@ -14,6 +14,8 @@
 
 #include "EntityScriptingInterface.h"
 
+#include <limits>
+
 #include <QFutureWatcher>
 #include <QtConcurrent/QtConcurrentRun>
 
@@ -277,42 +279,69 @@ EntityItemProperties EntityScriptingInterface::getEntityProperties(QUuid identit
         _entityTree->withReadLock([&] {
             EntityItemPointer entity = _entityTree->findEntityByEntityItemID(EntityItemID(identity));
             if (entity) {
-                if (desiredProperties.getHasProperty(PROP_POSITION) ||
-                    desiredProperties.getHasProperty(PROP_ROTATION) ||
-                    desiredProperties.getHasProperty(PROP_LOCAL_POSITION) ||
-                    desiredProperties.getHasProperty(PROP_LOCAL_ROTATION)) {
-                    // if we are explicitly getting position or rotation, we need parent information to make sense of them.
-                    desiredProperties.setHasProperty(PROP_PARENT_ID);
-                    desiredProperties.setHasProperty(PROP_PARENT_JOINT_INDEX);
-                }
+                results = getEntityPropertiesLocked(entity, desiredProperties);
+            }
+        });
+    }
 
-                if (desiredProperties.isEmpty()) {
-                    // these are left out of EntityItem::getEntityProperties so that localPosition and localRotation
-                    // don't end up in json saves, etc.  We still want them here, though.
-                    EncodeBitstreamParams params; // unknown
-                    desiredProperties = entity->getEntityProperties(params);
-                    desiredProperties.setHasProperty(PROP_LOCAL_POSITION);
-                    desiredProperties.setHasProperty(PROP_LOCAL_ROTATION);
-                }
+    return convertLocationToScriptSemantics(results);
+}
 
-                results = entity->getProperties(desiredProperties);
+QVector<EntityItemProperties> EntityScriptingInterface::getMultipleEntityProperties(const QVector<QUuid>& entityIDs,
+                                                                                    EntityPropertyFlags desiredProperties) {
+    PROFILE_RANGE(script_entities, __FUNCTION__);
 
-                // TODO: improve naturalDimensions in the future,
-                //       for now we've added this hack for setting natural dimensions of models
-                if (entity->getType() == EntityTypes::Model) {
-                    const FBXGeometry* geometry = _entityTree->getGeometryForEntity(entity);
-                    if (geometry) {
-                        Extents meshExtents = geometry->getUnscaledMeshExtents();
-                        results.setNaturalDimensions(meshExtents.maximum - meshExtents.minimum);
-                        results.calculateNaturalPosition(meshExtents.minimum, meshExtents.maximum);
-                    }
+    QVector<EntityItemProperties> results(entityIDs.size());
+    if (_entityTree) {
+        _entityTree->withReadLock([&] {
+            for (int i = 0; i < entityIDs.size(); i++) {
+                EntityItemPointer entity = _entityTree->findEntityByEntityItemID(EntityItemID(entityIDs[i]));
+                if (entity) {
+                    results[i] = getEntityPropertiesLocked(entity, desiredProperties);
                 }
-
             }
         });
     }
 
-    return convertLocationToScriptSemantics(results);
+    for (auto& properties : results) {
+        properties = convertLocationToScriptSemantics(properties);
+    }
+    return results;
+}
+
+EntityItemProperties EntityScriptingInterface::getEntityPropertiesLocked(const EntityItemPointer& entity,
+                                                                         EntityPropertyFlags desiredProperties) {
+    if (desiredProperties.getHasProperty(PROP_POSITION) ||
+        desiredProperties.getHasProperty(PROP_ROTATION) ||
+        desiredProperties.getHasProperty(PROP_LOCAL_POSITION) ||
+        desiredProperties.getHasProperty(PROP_LOCAL_ROTATION)) {
+        // if we are explicitly getting position or rotation, we need parent information to make sense of them.
+        desiredProperties.setHasProperty(PROP_PARENT_ID);
+        desiredProperties.setHasProperty(PROP_PARENT_JOINT_INDEX);
+    }
+
+    if (desiredProperties.isEmpty()) {
+        // these are left out of EntityItem::getEntityProperties so that localPosition and localRotation
+        // don't end up in json saves, etc.  We still want them here, though.
+        EncodeBitstreamParams params; // unknown
+        desiredProperties = entity->getEntityProperties(params);
+        desiredProperties.setHasProperty(PROP_LOCAL_POSITION);
+        desiredProperties.setHasProperty(PROP_LOCAL_ROTATION);
+    }
+
+    EntityItemProperties results = entity->getProperties(desiredProperties);
+
+    // TODO: improve naturalDimensions in the future,
+    //       for now we've added this hack for setting natural dimensions of models
+    if (entity->getType() == EntityTypes::Model) {
+        const FBXGeometry* geometry = _entityTree->getGeometryForEntity(entity);
+        if (geometry) {
+            Extents meshExtents = geometry->getUnscaledMeshExtents();
+            results.setNaturalDimensions(meshExtents.maximum - meshExtents.minimum);
+            results.calculateNaturalPosition(meshExtents.minimum, meshExtents.maximum);
+        }
+    }
+    return results;
 }
 
 QUuid EntityScriptingInterface::editEntity(QUuid id, const EntityItemProperties& scriptSideProperties) {
@@ -321,19 +350,14 @@ QUuid EntityScriptingInterface::editEntity(QUuid id, const EntityItemProperties&
     _activityTracking.editedEntityCount++;
 
     EntityItemProperties properties = scriptSideProperties;
-
-    auto dimensions = properties.getDimensions();
-    float volume = dimensions.x * dimensions.y * dimensions.z;
-    auto density = properties.getDensity();
-    auto newVelocity = properties.getVelocity().length();
-    float oldVelocity = { 0.0f };
-
     EntityItemID entityID(id);
     if (!_entityTree) {
         queueEntityMessage(PacketType::EntityEdit, entityID, properties);
 
         //if there is no local entity entity tree, no existing velocity, use 0.
-        float cost = calculateCost(density * volume, oldVelocity, newVelocity);
+        auto dimensions = properties.getDimensions();
+        float volume = dimensions.x * dimensions.y * dimensions.z;
+        float cost = calculateCost(properties.getDensity() * volume, 0.0f, properties.getVelocity().length());
         cost *= costMultiplier;
 
         if (cost > _currentAvatarEnergy) {
@@ -347,55 +371,8 @@ QUuid EntityScriptingInterface::editEntity(QUuid id, const EntityItemProperties&
     }
     // If we have a local entity tree set, then also update it.
 
-    bool updatedEntity = false;
     _entityTree->withWriteLock([&] {
-        EntityItemPointer entity = _entityTree->findEntityByEntityItemID(entityID);
-        if (!entity) {
-            return;
-        }
-
-        auto nodeList = DependencyManager::get<NodeList>();
-        if (entity->getClientOnly() && entity->getOwningAvatarID() != nodeList->getSessionUUID()) {
-            // don't edit other avatar's avatarEntities
-            return;
-        }
-
-        if (scriptSideProperties.parentRelatedPropertyChanged()) {
-            // All of parentID, parentJointIndex, position, rotation are needed to make sense of any of them.
-            // If any of these changed, pull any missing properties from the entity.
-
-            //existing entity, retrieve old velocity for check down below
-            oldVelocity = entity->getVelocity().length();
-
-            if (!scriptSideProperties.parentIDChanged()) {
-                properties.setParentID(entity->getParentID());
-            }
-            if (!scriptSideProperties.parentJointIndexChanged()) {
-                properties.setParentJointIndex(entity->getParentJointIndex());
-            }
-            if (!scriptSideProperties.localPositionChanged() && !scriptSideProperties.positionChanged()) {
-                properties.setPosition(entity->getPosition());
-            }
-            if (!scriptSideProperties.localRotationChanged() && !scriptSideProperties.rotationChanged()) {
-                properties.setRotation(entity->getOrientation());
-            }
-        }
-        properties = convertLocationFromScriptSemantics(properties);
-        properties.setClientOnly(entity->getClientOnly());
-        properties.setOwningAvatarID(entity->getOwningAvatarID());
-
-        float cost = calculateCost(density * volume, oldVelocity, newVelocity);
-        cost *= costMultiplier;
-
-        if (cost > _currentAvatarEnergy) {
-            updatedEntity = false;
-        } else {
-            //debit the avatar energy and continue
-            updatedEntity = _entityTree->updateEntity(entityID, properties);
-            if (updatedEntity) {
-                emit debitEnergySource(cost);
-            }
-        }
+        updateEntityLocked(entityID, scriptSideProperties, properties);
     });
 
     // FIXME: We need to figure out a better way to handle this. Allowing these edits to go through potentially
@@ -408,64 +385,236 @@ QUuid EntityScriptingInterface::editEntity(QUuid id, const EntityItemProperties&
     // }
 
     _entityTree->withReadLock([&] {
-        EntityItemPointer entity = _entityTree->findEntityByEntityItemID(entityID);
-        if (entity) {
-            // make sure the properties has a type, so that the encode can know which properties to include
-            properties.setType(entity->getType());
-            bool hasTerseUpdateChanges = properties.hasTerseUpdateChanges();
-            bool hasPhysicsChanges = properties.hasMiscPhysicsChanges() || hasTerseUpdateChanges;
-            if (_bidOnSimulationOwnership && hasPhysicsChanges) {
-                auto nodeList = DependencyManager::get<NodeList>();
-                const QUuid myNodeID = nodeList->getSessionUUID();
+        prepareEditLocked(entityID, properties);
+    });
+    queueEntityMessage(PacketType::EntityEdit, entityID, properties);
+    return id;
+}
 
-                if (entity->getSimulatorID() == myNodeID) {
-                    // we think we already own the simulation, so make sure to send ALL TerseUpdate properties
-                    if (hasTerseUpdateChanges) {
-                        entity->getAllTerseUpdateProperties(properties);
-                    }
-                    // TODO: if we knew that ONLY TerseUpdate properties have changed in properties AND the object
-                    // is dynamic AND it is active in the physics simulation then we could chose to NOT queue an update
-                    // and instead let the physics simulation decide when to send a terse update.  This would remove
-                    // the "slide-no-rotate" glitch (and typical double-update) that we see during the "poke rolling
-                    // balls" test.  However, even if we solve this problem we still need to provide a "slerp the visible
-                    // proxy toward the true physical position" feature to hide the final glitches in the remote watcher's
-                    // simulation.
-
-                    if (entity->getSimulationPriority() < SCRIPT_POKE_SIMULATION_PRIORITY) {
-                        // we re-assert our simulation ownership at a higher priority
-                        properties.setSimulationOwner(myNodeID, SCRIPT_POKE_SIMULATION_PRIORITY);
-                    }
-                } else {
-                    // we make a bid for simulation ownership
-                    properties.setSimulationOwner(myNodeID, SCRIPT_POKE_SIMULATION_PRIORITY);
-                    entity->pokeSimulationOwnership();
-                    entity->rememberHasSimulationOwnershipBid();
+QVector<QUuid> EntityScriptingInterface::editEntities(const QVector<QUuid>& entityIDs,
+                                                      const QVector<EntityItemProperties>& scriptSideProperties) {
+    PROFILE_RANGE(script_entities, __FUNCTION__);
+
+    if (entityIDs.size() != scriptSideProperties.size()) {
+        qCDebug(entities) << "editEntities: got" << entityIDs.size() << "entities but" << scriptSideProperties.size()
+            << "properties";
+        return QVector<QUuid>();
+    }
+
+    if (!_entityTree) {
+        QVector<QUuid> results;
+        results.reserve(entityIDs.size());
+        for (int i = 0; i < entityIDs.size(); i++) {
+            results.push_back(editEntity(entityIDs[i], scriptSideProperties[i]));
+        }
+        return results;
+    }
+
+    _activityTracking.editedEntityCount += entityIDs.size();
+
+    // the whole batch is applied under a single lock, the edit messages are queued afterwards and packed together
+    // by the packet sender
+    QVector<EntityItemProperties> properties = scriptSideProperties;
+    _entityTree->withWriteLock([&] {
+        for (int i = 0; i < entityIDs.size(); i++) {
+            EntityItemID entityID(entityIDs[i]);
+            updateEntityLocked(entityID, scriptSideProperties[i], properties[i]);
+            prepareEditLocked(entityID, properties[i]);
+        }
+    });
+    for (int i = 0; i < entityIDs.size(); i++) {
+        queueEntityMessage(PacketType::EntityEdit, EntityItemID(entityIDs[i]), properties[i]);
+    }
+    return entityIDs;
+}
+
+QByteArray EntityScriptingInterface::getEntityPositions(const QVector<QUuid>& entityIDs) {
+    PROFILE_RANGE(script_entities, __FUNCTION__);
+
+    QVector<float> results(entityIDs.size() * 3, std::numeric_limits<float>::quiet_NaN());
+    if (_entityTree) {
+        _entityTree->withReadLock([&] {
+            for (int i = 0; i < entityIDs.size(); i++) {
+                EntityItemPointer entity = _entityTree->findEntityByEntityItemID(EntityItemID(entityIDs[i]));
+                if (entity) {
+                    glm::vec3 position = entity->getPosition();
+                    results[i * 3] = position.x;
+                    results[i * 3 + 1] = position.y;
+                    results[i * 3 + 2] = position.z;
                 }
             }
-            if (properties.parentRelatedPropertyChanged() && entity->computePuffedQueryAACube()) {
-                properties.setQueryAACube(entity->getQueryAACube());
+        });
+    }
+    return QByteArray((const char*)results.constData(), results.size() * (int)sizeof(float));
+}
+
+QByteArray EntityScriptingInterface::getEntityRotations(const QVector<QUuid>& entityIDs) {
+    PROFILE_RANGE(script_entities, __FUNCTION__);
+
+    QVector<float> results(entityIDs.size() * 4, std::numeric_limits<float>::quiet_NaN());
+    if (_entityTree) {
+        _entityTree->withReadLock([&] {
+            for (int i = 0; i < entityIDs.size(); i++) {
+                EntityItemPointer entity = _entityTree->findEntityByEntityItemID(EntityItemID(entityIDs[i]));
+                if (entity) {
+                    glm::quat rotation = entity->getOrientation();
+                    results[i * 4] = rotation.x;
+                    results[i * 4 + 1] = rotation.y;
+                    results[i * 4 + 2] = rotation.z;
+                    results[i * 4 + 3] = rotation.w;
+                }
             }
-            entity->setLastBroadcast(usecTimestampNow());
-            properties.setLastEdited(entity->getLastEdited());
-
-            // if we've moved an entity with children, check/update the queryAACube of all descendents and tell the server
-            // if they've changed.
-            entity->forEachDescendant([&](SpatiallyNestablePointer descendant) {
-                if (descendant->getNestableType() == NestableType::Entity) {
-                    if (descendant->computePuffedQueryAACube()) {
-                        EntityItemPointer entityDescendant = std::static_pointer_cast<EntityItem>(descendant);
-                        EntityItemProperties newQueryCubeProperties;
-                        newQueryCubeProperties.setQueryAACube(descendant->getQueryAACube());
-                        newQueryCubeProperties.setLastEdited(properties.getLastEdited());
-                        queueEntityMessage(PacketType::EntityEdit, descendant->getID(), newQueryCubeProperties);
-                        entityDescendant->setLastBroadcast(usecTimestampNow());
-                    }
+        });
+    }
+    return QByteArray((const char*)results.constData(), results.size() * (int)sizeof(float));
+}
+
+QVector<QUuid> EntityScriptingInterface::editEntityTransforms(const QVector<QUuid>& entityIDs,
+                                                              const QByteArray& positions, const QByteArray& rotations) {
+    PROFILE_RANGE(script_entities, __FUNCTION__);
+    const int count = entityIDs.size();
+    const int POSITION_SIZE = 3 * sizeof(float);
+    const int ROTATION_SIZE = 4 * sizeof(float);
+    bool hasPositions = !positions.isEmpty();
+    bool hasRotations = !rotations.isEmpty();
+    if (!hasPositions && !hasRotations) {
+        // nothing to edit, don't send an empty edit for every entity
+        return QVector<QUuid>();
+    }
+    if ((hasPositions && positions.size() != count * POSITION_SIZE) ||
+        (hasRotations && rotations.size() != count * ROTATION_SIZE)) {
+        qCDebug(entities) << "editEntityTransforms: buffer sizes don't match the" << count << "entities";
+        return QVector<QUuid>();
+    }
+
+    QVector<EntityItemProperties> properties(count);
+    for (int i = 0; i < count; i++) {
+        if (hasPositions) {
+            const float* position = (const float*)(positions.constData() + i * POSITION_SIZE);
+            properties[i].setPosition(glm::vec3(position[0], position[1], position[2]));
+        }
+        if (hasRotations) {
+            const float* rotation = (const float*)(rotations.constData() + i * ROTATION_SIZE);
+            properties[i].setRotation(glm::quat(rotation[3], rotation[0], rotation[1], rotation[2]));
+        }
+    }
+    return editEntities(entityIDs, properties);
+}
+
+bool EntityScriptingInterface::updateEntityLocked(const EntityItemID& entityID,
+                                                  const EntityItemProperties& scriptSideProperties,
+                                                  EntityItemProperties& properties) {
+    auto dimensions = scriptSideProperties.getDimensions();
+    float volume = dimensions.x * dimensions.y * dimensions.z;
+    auto density = scriptSideProperties.getDensity();
+    auto newVelocity = scriptSideProperties.getVelocity().length();
+    float oldVelocity = { 0.0f };
+
+    EntityItemPointer entity = _entityTree->findEntityByEntityItemID(entityID);
+    if (!entity) {
+        return false;
+    }
+
+    auto nodeList = DependencyManager::get<NodeList>();
+    if (entity->getClientOnly() && entity->getOwningAvatarID() != nodeList->getSessionUUID()) {
+        // don't edit other avatar's avatarEntities
+        return false;
+    }
+
+    if (scriptSideProperties.parentRelatedPropertyChanged()) {
+        // All of parentID, parentJointIndex, position, rotation are needed to make sense of any of them.
+        // If any of these changed, pull any missing properties from the entity.
+
+        //existing entity, retrieve old velocity for check down below
+        oldVelocity = entity->getVelocity().length();
+
+        if (!scriptSideProperties.parentIDChanged()) {
+            properties.setParentID(entity->getParentID());
+        }
+        if (!scriptSideProperties.parentJointIndexChanged()) {
+            properties.setParentJointIndex(entity->getParentJointIndex());
+        }
+        if (!scriptSideProperties.localPositionChanged() && !scriptSideProperties.positionChanged()) {
+            properties.setPosition(entity->getPosition());
+        }
+        if (!scriptSideProperties.localRotationChanged() && !scriptSideProperties.rotationChanged()) {
+            properties.setRotation(entity->getOrientation());
+        }
+    }
+    properties = convertLocationFromScriptSemantics(properties);
+    properties.setClientOnly(entity->getClientOnly());
+    properties.setOwningAvatarID(entity->getOwningAvatarID());
+
+    float cost = calculateCost(density * volume, oldVelocity, newVelocity);
+    cost *= costMultiplier;
+
+    if (cost > _currentAvatarEnergy) {
+        return false;
+    }
+    //debit the avatar energy and continue
+    bool updatedEntity = _entityTree->updateEntity(entityID, properties);
+    if (updatedEntity) {
+        emit debitEnergySource(cost);
+    }
+    return updatedEntity;
+}
+
+void EntityScriptingInterface::prepareEditLocked(const EntityItemID& entityID, EntityItemProperties& properties) {
+    EntityItemPointer entity = _entityTree->findEntityByEntityItemID(entityID);
+    if (entity) {
+        // make sure the properties has a type, so that the encode can know which properties to include
+        properties.setType(entity->getType());
+        bool hasTerseUpdateChanges = properties.hasTerseUpdateChanges();
+        bool hasPhysicsChanges = properties.hasMiscPhysicsChanges() || hasTerseUpdateChanges;
+        if (_bidOnSimulationOwnership && hasPhysicsChanges) {
+            auto nodeList = DependencyManager::get<NodeList>();
+            const QUuid myNodeID = nodeList->getSessionUUID();
+
+            if (entity->getSimulatorID() == myNodeID) {
+                // we think we already own the simulation, so make sure to send ALL TerseUpdate properties
+                if (hasTerseUpdateChanges) {
+                    entity->getAllTerseUpdateProperties(properties);
                 }
-            });
+                // TODO: if we knew that ONLY TerseUpdate properties have changed in properties AND the object
+                // is dynamic AND it is active in the physics simulation then we could chose to NOT queue an update
+                // and instead let the physics simulation decide when to send a terse update.  This would remove
+                // the "slide-no-rotate" glitch (and typical double-update) that we see during the "poke rolling
+                // balls" test.  However, even if we solve this problem we still need to provide a "slerp the visible
+                // proxy toward the true physical position" feature to hide the final glitches in the remote watcher's
+                // simulation.
+
+                if (entity->getSimulationPriority() < SCRIPT_POKE_SIMULATION_PRIORITY) {
+                    // we re-assert our simulation ownership at a higher priority
+                    properties.setSimulationOwner(myNodeID, SCRIPT_POKE_SIMULATION_PRIORITY);
+                }
+            } else {
+                // we make a bid for simulation ownership
+                properties.setSimulationOwner(myNodeID, SCRIPT_POKE_SIMULATION_PRIORITY);
+                entity->pokeSimulationOwnership();
+                entity->rememberHasSimulationOwnershipBid();
+            }
         }
-    });
-    queueEntityMessage(PacketType::EntityEdit, entityID, properties);
-    return id;
+        if (properties.parentRelatedPropertyChanged() && entity->computePuffedQueryAACube()) {
+            properties.setQueryAACube(entity->getQueryAACube());
+        }
+        entity->setLastBroadcast(usecTimestampNow());
+        properties.setLastEdited(entity->getLastEdited());
+
+        // if we've moved an entity with children, check/update the queryAACube of all descendents and tell the server
+        // if they've changed.
+        entity->forEachDescendant([&](SpatiallyNestablePointer descendant) {
+            if (descendant->getNestableType() == NestableType::Entity) {
+                if (descendant->computePuffedQueryAACube()) {
+                    EntityItemPointer entityDescendant = std::static_pointer_cast<EntityItem>(descendant);
+                    EntityItemProperties newQueryCubeProperties;
+                    newQueryCubeProperties.setQueryAACube(descendant->getQueryAACube());
+                    newQueryCubeProperties.setLastEdited(properties.getLastEdited());
+                    queueEntityMessage(PacketType::EntityEdit, descendant->getID(), newQueryCubeProperties);
+                    entityDescendant->setLastBroadcast(usecTimestampNow());
+                }
+            }
+        });
+    }
 }
 
 void EntityScriptingInterface::deleteEntity(QUuid id) {
@@ -160,6 +160,18 @@ public slots:
     Q_INVOKABLE EntityItemProperties getEntityProperties(QUuid entityID);
     Q_INVOKABLE EntityItemProperties getEntityProperties(QUuid identity, EntityPropertyFlags desiredProperties);
 
+    /**jsdoc
+     * Return the properties of several entities at once, cheaper than calling getEntityProperties for each.
+     *
+     * @function Entities.getMultipleEntityProperties
+     * @param {EntityID[]} entityIDs The IDs of the entities.
+     * @param {EntityPropertyFlags} [desiredProperties=[]] Array containing the names of the properties you
+     *     would like to get. If the array is empty, all properties will be returned.
+     * @return {EntityItemProperties[]} The properties of each entity, in the same order, empty for unknown entities.
+     */
+    Q_INVOKABLE QVector<EntityItemProperties> getMultipleEntityProperties(const QVector<QUuid>& entityIDs,
+        EntityPropertyFlags desiredProperties = EntityPropertyFlags());
+
     /**jsdoc
      * Updates an entity with the specified properties.
      *
@@ -168,6 +180,51 @@ public slots:
      */
     Q_INVOKABLE QUuid editEntity(QUuid entityID, const EntityItemProperties& properties);
 
+    /**jsdoc
+     * Updates several entities, each with its own properties, as one batch: the local tree is locked once and
+     * the edits are packed together in the packets sent to the entity server.
+     *
+     * @function Entities.editEntities
+     * @param {EntityID[]} entityIDs The IDs of the entities to edit.
+     * @param {EntityItemProperties[]} properties The properties for each entity, in the same order.
+     * @return {EntityID[]} What editEntity would return for each entity, empty if the arrays' lengths differ.
+     */
+    Q_INVOKABLE QVector<QUuid> editEntities(const QVector<QUuid>& entityIDs,
+                                            const QVector<EntityItemProperties>& properties);
+
+    /**jsdoc
+     * The world positions of several entities, packed for <code>new Float32Array(buffer)</code>.
+     *
+     * @function Entities.getEntityPositions
+     * @param {EntityID[]} entityIDs The IDs of the entities.
+     * @return {ArrayBuffer} x, y, z for each entity, NaN for unknown entities.
+     */
+    Q_INVOKABLE QByteArray getEntityPositions(const QVector<QUuid>& entityIDs);
+
+    /**jsdoc
+     * The world rotations of several entities, packed for <code>new Float32Array(buffer)</code>.
+     *
+     * @function Entities.getEntityRotations
+     * @param {EntityID[]} entityIDs The IDs of the entities.
+     * @return {ArrayBuffer} x, y, z, w for each entity, NaN for unknown entities.
+     */
+    Q_INVOKABLE QByteArray getEntityRotations(const QVector<QUuid>& entityIDs);
+
+    /**jsdoc
+     * Moves several entities as one batch, like editEntities with only position and rotation.
+     *
+     * @function Entities.editEntityTransforms
+     * @param {EntityID[]} entityIDs The IDs of the entities to edit.
+     * @param {ArrayBuffer} positions The buffer of a Float32Array with x, y, z for each entity, or an empty buffer
+     *     to leave the positions alone.
+     * @param {ArrayBuffer} rotations The buffer of a Float32Array with x, y, z, w for each entity, or an empty
+     *     buffer to leave the rotations alone.
+     * @return {EntityID[]} What editEntity would return for each entity, empty if the buffer sizes don't match or
+     *     both buffers are empty.
+     */
+    Q_INVOKABLE QVector<QUuid> editEntityTransforms(const QVector<QUuid>& entityIDs,
+                                                    const QByteArray& positions, const QByteArray& rotations);
+
     /**jsdoc
      * Deletes an entity.
      *
@@ -391,6 +448,12 @@ private:
     bool setPoints(QUuid entityID, std::function<bool(LineEntityItem&)> actor);
     void queueEntityMessage(PacketType packetType, EntityItemID entityID, const EntityItemProperties& properties);
 
+    // the pieces of getEntityProperties and editEntity shared with their batched versions, the tree must be locked
+    EntityItemProperties getEntityPropertiesLocked(const EntityItemPointer& entity, EntityPropertyFlags desiredProperties);
+    bool updateEntityLocked(const EntityItemID& entityID, const EntityItemProperties& scriptSideProperties,
+                            EntityItemProperties& properties);
+    void prepareEditLocked(const EntityItemID& entityID, EntityItemProperties& properties);
+
     EntityItemPointer checkForTreeEntityAndTypeMatch(const QUuid& entityID,
                                                      EntityTypes::EntityType entityType = EntityTypes::Unknown);
 
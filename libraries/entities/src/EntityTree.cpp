@@ -12,7 +12,7 @@
 #include <PerfStat.h>
 #include <QDateTime>
 #include <QtScript/QScriptEngine>
-
+#include <OctreeElementPool.h>
 #include "EntityTree.h"
 #include "EntitySimulation.h"
 #include "VariantMapToScriptValue.h"
@@ -74,7 +74,7 @@ void EntityTree::createRootElement() {
 }
 
 OctreeElementPointer EntityTree::createNewElement(unsigned char* octalCode) {
-    auto newElement = EntityTreeElementPointer(new EntityTreeElement(octalCode));
+    auto newElement = adoptPooledElement(new (allocatePooledElement<EntityTreeElement>()) EntityTreeElement(octalCode));
     newElement->setTree(std::static_pointer_cast<EntityTree>(shared_from_this()));
     return std::static_pointer_cast<OctreeElement>(newElement);
 }
@@ -13,6 +13,7 @@
 
 #include <FBXReader.h>
 #include <GeometryUtil.h>
+#include <OctreeElementPool.h>
 #include <OctreeUtils.h>
 
 #include "EntitiesLogging.h"
@@ -22,6 +23,8 @@
 #include "EntityTreeElement.h"
 #include "EntityTypes.h"
 
+std::atomic<uint32_t> EntityTreeElement::_queryFilterTraitsGeneration { 1 };
+
 EntityTreeElement::EntityTreeElement(unsigned char* octalCode) : OctreeElement() {
     init(octalCode);
 };
@@ -31,7 +34,7 @@ EntityTreeElement::~EntityTreeElement() {
 }
 
 OctreeElementPointer EntityTreeElement::createNewElement(unsigned char* octalCode) {
-    auto newChild = EntityTreeElementPointer(new EntityTreeElement(octalCode));
+    auto newChild = adoptPooledElement(new (allocatePooledElement<EntityTreeElement>()) EntityTreeElement(octalCode));
     newChild->setTree(_myTree);
     return newChild;
 }
@@ -129,9 +132,49 @@ bool EntityTreeElement::shouldRecurseChildTree(int childIndex, EncodeBitstreamPa
         return false;
     }
 
+    // nothing below can match the query filter, the only other entities this node could want are the flagged
+    // extra entities and we don't know where those live
+    auto entityNodeData = static_cast<EntityNodeData*>(params.nodeData);
+    const EntityQueryFilter& queryFilter = entityNodeData->getQueryFilter();
+    if (queryFilter.hasFilters() && !entityNodeData->hasFlaggedExtraEntities() &&
+        !queryFilter.canMatchTraits(childElement->getSubtreeQueryFilterTraits())) {
+
+        OctreeElementExtraEncodeData* extraEncodeData = &entityNodeData->extraEncodeData;
+        if (extraEncodeData->contains(childElement.get())) {
+            EntityTreeElementExtraEncodeDataPointer childExtraEncodeData
+                = std::static_pointer_cast<EntityTreeElementExtraEncodeData>((*extraEncodeData)[childElement.get()]);
+            childExtraEncodeData->subtreeCompleted = true;
+        }
+        return false;
+    }
+
     return true; // if we don't know otherwise than recurse!
 }
 
+uint32_t EntityTreeElement::getSubtreeQueryFilterTraits() const {
+    uint32_t generation = _queryFilterTraitsGeneration;
+    uint64_t cached = _subtreeQueryFilterTraits;
+    if ((uint32_t)(cached >> 32) == generation) {
+        return (uint32_t)cached;
+    }
+
+    // if the generation moves while we compute, we store the old one and the next call computes again
+    uint32_t traits = 0;
+    withReadLock([&] {
+        foreach(EntityItemPointer entity, _entityItems) {
+            traits |= entity->getQueryFilterTraits();
+        }
+    });
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        EntityTreeElementPointer child = getChildAtIndex(i);
+        if (child) {
+            traits |= child->getSubtreeQueryFilterTraits();
+        }
+    }
+    _subtreeQueryFilterTraits = ((uint64_t)generation << 32) | traits;
+    return traits;
+}
+
 bool EntityTreeElement::alreadyFullyEncoded(EncodeBitstreamParams& params) const {
     auto entityNodeData = static_cast<EntityNodeData*>(params.nodeData);
     assert(entityNodeData);
@@ -313,7 +356,7 @@ OctreeElement::AppendState EntityTreeElement::appendElementData(OctreePacketData
 
             // we have an EntityNodeData instance
             // so we should assume that means we might have JSON filters to check
-            auto jsonFilters = entityNodeData->getJSONParameters();
+            const EntityQueryFilter& queryFilter = entityNodeData->getQueryFilter();
 
 
             for (uint16_t i = 0; i < _entityItems.size(); i++) {
@@ -325,10 +368,10 @@ OctreeElement::AppendState EntityTreeElement::appendElementData(OctreePacketData
                 }
 
                 // if this entity has been updated since our last full send and there are json filters, check them
-                if (includeThisEntity && !jsonFilters.isEmpty()) {
+                if (includeThisEntity && queryFilter.hasFilters()) {
 
                     // if params include JSON filters, check if this entity matches
-                    bool entityMatchesFilters = entity->matchesJSONFilters(jsonFilters);
+                    bool entityMatchesFilters = queryFilter.matches(*entity);
 
                     if (entityMatchesFilters) {
                         // make sure this entity is in the set of entities sent last frame
@@ -1058,6 +1101,9 @@ void EntityTreeElement::addEntityItem(EntityItemPointer entity) {
         _entityItems.push_back(entity);
     });
     entity->_element = getThisPointer();
+    if (entity->getQueryFilterTraits()) {
+        queryFilterTraitsChanged();
+    }
 }
 
 // will average a "common reduced LOD view" from the the child elements...
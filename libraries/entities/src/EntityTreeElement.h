@@ -12,6 +12,7 @@
 #ifndef hifi_EntityTreeElement_h
 #define hifi_EntityTreeElement_h
 
+#include <atomic>
 #include <memory>
 
 #include <OctreeElement.h>
@@ -226,6 +227,11 @@ public:
 
     bool pruneChildren();
 
+    /// The EntityQueryFilter::Trait bits of every entity in this element and below, recomputed lazily after
+    /// queryFilterTraitsChanged().  May include traits that are gone, never misses one.
+    uint32_t getSubtreeQueryFilterTraits() const;
+    static void queryFilterTraitsChanged() { _queryFilterTraitsGeneration++; }
+
     void expandExtentsToContents(Extents& extents);
 
     EntityTreeElementPointer getThisPointer() {
@@ -242,6 +248,10 @@ protected:
     virtual void init(unsigned char * octalCode) override;
     EntityTreePointer _myTree;
     EntityItems _entityItems;
+
+    static std::atomic<uint32_t> _queryFilterTraitsGeneration;
+    // generation in the high 32 bits, traits in the low ones, so a reader never mixes two computations
+    mutable std::atomic<uint64_t> _subtreeQueryFilterTraits { 0 };
 };
 
 #endif // hifi_EntityTreeElement_h
@@ -0,0 +1,562 @@
+//
+//  BakedGeometry.cpp
+//  libraries/fbx/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "BakedGeometry.h"
+
+#include <memory>
+
+#include <QtCore/QDataStream>
+
+#include <Profile.h>
+
+namespace {
+
+const quint32 BAKED_GEOMETRY_MAGIC = 0x47424648; // "HFBG"
+
+class BakedWriter {
+public:
+    BakedWriter(QByteArray* data) : _out(data, QIODevice::WriteOnly) {
+        _out.setVersion(QDataStream::Qt_5_0);
+    }
+
+    // Plain old data (integers, floats, glm types) are written as raw bytes
+    template <typename T> void write(const T& value) {
+        _out.writeRawData(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void write(const QString& value) { _out << value; }
+    void write(const QByteArray& value) { _out << value; }
+
+    // Arrays of plain old data are written as one contiguous block
+    template <typename T> void writeArray(const QVector<T>& values) {
+        write((quint32)values.size());
+        _out.writeRawData(reinterpret_cast<const char*>(values.constData()), values.size() * (int)sizeof(T));
+    }
+
+    void write(const Extents& extents) {
+        write(extents.minimum);
+        write(extents.maximum);
+    }
+
+    void write(const Transform& transform) {
+        write(transform.getTranslation());
+        write(transform.getRotation());
+        write(transform.getScale());
+    }
+
+    void write(const FBXTexture& texture) {
+        write(texture.name);
+        write(texture.filename);
+        write(texture.content);
+        write(texture.transform);
+        write(texture.maxNumPixels);
+        write(texture.texcoordSet);
+        write(texture.texcoordSetName);
+        write(texture.isBumpmap);
+    }
+
+    void write(const FBXMaterial& material) {
+        write(material.diffuseColor);
+        write(material.diffuseFactor);
+        write(material.specularColor);
+        write(material.specularFactor);
+        write(material.emissiveColor);
+        write(material.emissiveFactor);
+        write(material.shininess);
+        write(material.opacity);
+        write(material.metallic);
+        write(material.roughness);
+        write(material.emissiveIntensity);
+        write(material.ambientFactor);
+        write(material.materialID);
+        write(material.name);
+        write(material.shadingModel);
+
+        // The readers only set the values of the model material, its texture maps are made by NetworkMaterial from
+        // the FBXTextures below, so the values and the key they lead to are all there is to keep.
+        write((bool)material._material);
+        if (material._material) {
+            const auto& modelMaterial = *material._material;
+            write((quint32)modelMaterial.getKey()._flags.to_ulong());
+            write(modelMaterial.getEmissive(false));
+            write(modelMaterial.getAlbedo(false));
+            write(modelMaterial.getFresnel(false));
+            write(modelMaterial.getRoughness());
+            write(modelMaterial.getMetallic());
+            write(modelMaterial.getScattering());
+            write(modelMaterial.getOpacity());
+            write(modelMaterial.isUnlit());
+        }
+
+        write(material.normalTexture);
+        write(material.albedoTexture);
+        write(material.opacityTexture);
+        write(material.glossTexture);
+        write(material.roughnessTexture);
+        write(material.specularTexture);
+        write(material.metallicTexture);
+        write(material.emissiveTexture);
+        write(material.occlusionTexture);
+        write(material.scatteringTexture);
+        write(material.lightmapTexture);
+        write(material.lightmapParams);
+
+        write(material.isPBSMaterial);
+        write(material.useNormalMap);
+        write(material.useAlbedoMap);
+        write(material.useOpacityMap);
+        write(material.useRoughnessMap);
+        write(material.useSpecularMap);
+        write(material.useMetallicMap);
+        write(material.useEmissiveMap);
+        write(material.useOcclusionMap);
+    }
+
+    void write(const FBXJoint& joint) {
+        writeArray(joint.shapeInfo.points);
+        writeArray(joint.freeLineage);
+        write(joint.isFree);
+        write(joint.parentIndex);
+        write(joint.distanceToParent);
+        write(joint.translation);
+        write(joint.preTransform);
+        write(joint.preRotation);
+        write(joint.rotation);
+        write(joint.postRotation);
+        write(joint.postTransform);
+        write(joint.transform);
+        write(joint.rotationMin);
+        write(joint.rotationMax);
+        write(joint.inverseDefaultRotation);
+        write(joint.inverseBindRotation);
+        write(joint.bindTransform);
+        write(joint.name);
+        write(joint.isSkeletonJoint);
+        write(joint.bindTransformFoundInCluster);
+        write(joint.hasGeometricOffset);
+        write(joint.geometricTranslation);
+        write(joint.geometricRotation);
+        write(joint.geometricScaling);
+    }
+
+    void write(const FBXMesh& mesh) {
+        write((quint32)mesh.parts.size());
+        for (const auto& part : mesh.parts) {
+            writeArray(part.quadIndices);
+            writeArray(part.quadTrianglesIndices);
+            writeArray(part.triangleIndices);
+            write(part.materialID);
+        }
+
+        writeArray(mesh.vertices);
+        writeArray(mesh.normals);
+        writeArray(mesh.tangents);
+        writeArray(mesh.colors);
+        writeArray(mesh.texCoords);
+        writeArray(mesh.texCoords1);
+        writeArray(mesh.clusterIndices);
+        writeArray(mesh.clusterWeights);
+        writeArray(mesh.clusters);
+
+        write(mesh.meshExtents);
+        write(mesh.modelTransform);
+
+        write((quint32)mesh.blendshapes.size());
+        for (const auto& blendshape : mesh.blendshapes) {
+            writeArray(blendshape.indices);
+            writeArray(blendshape.vertices);
+            writeArray(blendshape.normals);
+        }
+
+        write(mesh.meshIndex);
+    }
+
+    void write(const FBXGeometry& geometry) {
+        write(BAKED_GEOMETRY_MAGIC);
+        write(BAKED_GEOMETRY_VERSION);
+
+        write(geometry.originalURL);
+        write(geometry.author);
+        write(geometry.applicationName);
+
+        write((quint32)geometry.joints.size());
+        for (const auto& joint : geometry.joints) {
+            write(joint);
+        }
+        write((quint32)geometry.jointIndices.size());
+        for (auto it = geometry.jointIndices.cbegin(); it != geometry.jointIndices.cend(); ++it) {
+            write(it.key());
+            write(it.value());
+        }
+        write(geometry.hasSkeletonJoints);
+
+        write((quint32)geometry.meshes.size());
+        for (const auto& mesh : geometry.meshes) {
+            write(mesh);
+        }
+
+        write((quint32)geometry.materials.size());
+        for (auto it = geometry.materials.cbegin(); it != geometry.materials.cend(); ++it) {
+            write(it.key());
+            write(it.value());
+        }
+
+        write(geometry.offset);
+        write(geometry.leftEyeJointIndex);
+        write(geometry.rightEyeJointIndex);
+        write(geometry.neckJointIndex);
+        write(geometry.rootJointIndex);
+        write(geometry.leanJointIndex);
+        write(geometry.headJointIndex);
+        write(geometry.leftHandJointIndex);
+        write(geometry.rightHandJointIndex);
+        write(geometry.leftToeJointIndex);
+        write(geometry.rightToeJointIndex);
+        write(geometry.leftEyeSize);
+        write(geometry.rightEyeSize);
+        writeArray(geometry.humanIKJointIndices);
+        write(geometry.palmDirection);
+        write(geometry.neckPivot);
+        write(geometry.bindExtents);
+        write(geometry.meshExtents);
+
+        write((quint32)geometry.animationFrames.size());
+        for (const auto& frame : geometry.animationFrames) {
+            writeArray(frame.rotations);
+            writeArray(frame.translations);
+        }
+
+        write((quint32)geometry.meshIndicesToModelNames.size());
+        for (auto it = geometry.meshIndicesToModelNames.cbegin(); it != geometry.meshIndicesToModelNames.cend(); ++it) {
+            write(it.key());
+            write(it.value());
+        }
+
+        write((quint32)geometry.blendshapeChannelNames.size());
+        for (const auto& name : geometry.blendshapeChannelNames) {
+            write(name);
+        }
+    }
+
+private:
+    QDataStream _out;
+};
+
+class BakedReader {
+public:
+    BakedReader(const QByteArray& data) : _in(data) {
+        _in.setVersion(QDataStream::Qt_5_0);
+    }
+
+    template <typename T> void read(T& value) {
+        if (_in.readRawData(reinterpret_cast<char*>(&value), sizeof(T)) != (int)sizeof(T)) {
+            throw QString("truncated baked geometry");
+        }
+    }
+
+    void read(QString& value) { _in >> value; checkStatus(); }
+    void read(QByteArray& value) { _in >> value; checkStatus(); }
+
+    quint32 readSize() {
+        quint32 size;
+        read(size);
+        return size;
+    }
+
+    // Arrays are copied in a single block straight into their final storage
+    template <typename T> void readArray(QVector<T>& values) {
+        quint32 size = readSize();
+        const quint64 byteSize = (quint64)size * sizeof(T);
+        if (byteSize > (quint64)(_in.device()->bytesAvailable())) {
+            throw QString("truncated baked geometry");
+        }
+        values.resize(size);
+        if (byteSize > 0) {
+            _in.readRawData(reinterpret_cast<char*>(values.data()), (int)byteSize);
+        }
+    }
+
+    void read(Extents& extents) {
+        read(extents.minimum);
+        read(extents.maximum);
+    }
+
+    void read(Transform& transform) {
+        glm::vec3 translation;
+        glm::quat rotation;
+        glm::vec3 scale;
+        read(translation);
+        read(rotation);
+        read(scale);
+        transform.setTranslation(translation);
+        transform.setRotation(rotation);
+        transform.setScale(scale);
+    }
+
+    void read(FBXTexture& texture) {
+        read(texture.name);
+        read(texture.filename);
+        read(texture.content);
+        read(texture.transform);
+        read(texture.maxNumPixels);
+        read(texture.texcoordSet);
+        read(texture.texcoordSetName);
+        read(texture.isBumpmap);
+    }
+
+    void read(FBXMaterial& material) {
+        read(material.diffuseColor);
+        read(material.diffuseFactor);
+        read(material.specularColor);
+        read(material.specularFactor);
+        read(material.emissiveColor);
+        read(material.emissiveFactor);
+        read(material.shininess);
+        read(material.opacity);
+        read(material.metallic);
+        read(material.roughness);
+        read(material.emissiveIntensity);
+        read(material.ambientFactor);
+        read(material.materialID);
+        read(material.name);
+        read(material.shadingModel);
+
+        bool hasModelMaterial;
+        read(hasModelMaterial);
+        if (hasModelMaterial) {
+            quint32 keyFlags;
+            glm::vec3 emissive, albedo, fresnel;
+            float roughness, metallic, scattering, opacity;
+            bool unlit;
+            read(keyFlags);
+            read(emissive);
+            read(albedo);
+            read(fresnel);
+            read(roughness);
+            read(metallic);
+            read(scattering);
+            read(opacity);
+            read(unlit);
+
+            material._material = std::make_shared<model::Material>();
+            material._material->setEmissive(emissive, false);
+            material._material->setAlbedo(albedo, false);
+            material._material->setFresnel(fresnel, false);
+            material._material->setRoughness(roughness);
+            material._material->setMetallic(metallic);
+            // in the same order as the readers: setting the scattering also sets the metallic flag of the key, and
+            // the readers only set it when the mapping has one
+            const model::MaterialKey key(model::MaterialKey::Flags((unsigned long)keyFlags));
+            if (scattering > 0.0f || key.isMetallic() != (metallic > 0.0f)) {
+                material._material->setScattering(scattering);
+            }
+            material._material->setOpacity(opacity);
+            material._material->setUnlit(unlit);
+            if (material._material->getKey()._flags != key._flags) {
+                throw QString("material %1 can't be restored").arg(material.materialID);
+            }
+        }
+
+        read(material.normalTexture);
+        read(material.albedoTexture);
+        read(material.opacityTexture);
+        read(material.glossTexture);
+        read(material.roughnessTexture);
+        read(material.specularTexture);
+        read(material.metallicTexture);
+        read(material.emissiveTexture);
+        read(material.occlusionTexture);
+        read(material.scatteringTexture);
+        read(material.lightmapTexture);
+        read(material.lightmapParams);
+
+        read(material.isPBSMaterial);
+        read(material.useNormalMap);
+        read(material.useAlbedoMap);
+        read(material.useOpacityMap);
+        read(material.useRoughnessMap);
+        read(material.useSpecularMap);
+        read(material.useMetallicMap);
+        read(material.useEmissiveMap);
+        read(material.useOcclusionMap);
+    }
+
+    void read(FBXJoint& joint) {
+        readArray(joint.shapeInfo.points);
+        readArray(joint.freeLineage);
+        read(joint.isFree);
+        read(joint.parentIndex);
+        read(joint.distanceToParent);
+        read(joint.translation);
+        read(joint.preTransform);
+        read(joint.preRotation);
+        read(joint.rotation);
+        read(joint.postRotation);
+        read(joint.postTransform);
+        read(joint.transform);
+        read(joint.rotationMin);
+        read(joint.rotationMax);
+        read(joint.inverseDefaultRotation);
+        read(joint.inverseBindRotation);
+        read(joint.bindTransform);
+        read(joint.name);
+        read(joint.isSkeletonJoint);
+        read(joint.bindTransformFoundInCluster);
+        read(joint.hasGeometricOffset);
+        read(joint.geometricTranslation);
+        read(joint.geometricRotation);
+        read(joint.geometricScaling);
+    }
+
+    void read(FBXMesh& mesh) {
+        mesh.parts.resize(readSize());
+        for (auto& part : mesh.parts) {
+            readArray(part.quadIndices);
+            readArray(part.quadTrianglesIndices);
+            readArray(part.triangleIndices);
+            read(part.materialID);
+        }
+
+        readArray(mesh.vertices);
+        readArray(mesh.normals);
+        readArray(mesh.tangents);
+        readArray(mesh.colors);
+        readArray(mesh.texCoords);
+        readArray(mesh.texCoords1);
+        readArray(mesh.clusterIndices);
+        readArray(mesh.clusterWeights);
+        readArray(mesh.clusters);
+
+        read(mesh.meshExtents);
+        read(mesh.modelTransform);
+
+        mesh.blendshapes.resize(readSize());
+        for (auto& blendshape : mesh.blendshapes) {
+            readArray(blendshape.indices);
+            readArray(blendshape.vertices);
+            readArray(blendshape.normals);
+        }
+
+        read(mesh.meshIndex);
+    }
+
+    void read(FBXGeometry& geometry) {
+        quint32 magic, version;
+        read(magic);
+        read(version);
+        if (magic != BAKED_GEOMETRY_MAGIC || version != BAKED_GEOMETRY_VERSION) {
+            throw QString("not a baked geometry of version %1").arg(BAKED_GEOMETRY_VERSION);
+        }
+
+        read(geometry.originalURL);
+        read(geometry.author);
+        read(geometry.applicationName);
+
+        geometry.joints.resize(readSize());
+        for (auto& joint : geometry.joints) {
+            read(joint);
+        }
+        quint32 numJointIndices = readSize();
+        for (quint32 i = 0; i < numJointIndices; ++i) {
+            QString name;
+            int index;
+            read(name);
+            read(index);
+            geometry.jointIndices.insert(name, index);
+        }
+        read(geometry.hasSkeletonJoints);
+
+        geometry.meshes.resize(readSize());
+        for (auto& mesh : geometry.meshes) {
+            read(mesh);
+        }
+
+        quint32 numMaterials = readSize();
+        for (quint32 i = 0; i < numMaterials; ++i) {
+            QString materialID;
+            read(materialID);
+            read(geometry.materials[materialID]);
+        }
+
+        read(geometry.offset);
+        read(geometry.leftEyeJointIndex);
+        read(geometry.rightEyeJointIndex);
+        read(geometry.neckJointIndex);
+        read(geometry.rootJointIndex);
+        read(geometry.leanJointIndex);
+        read(geometry.headJointIndex);
+        read(geometry.leftHandJointIndex);
+        read(geometry.rightHandJointIndex);
+        read(geometry.leftToeJointIndex);
+        read(geometry.rightToeJointIndex);
+        read(geometry.leftEyeSize);
+        read(geometry.rightEyeSize);
+        readArray(geometry.humanIKJointIndices);
+        read(geometry.palmDirection);
+        read(geometry.neckPivot);
+        read(geometry.bindExtents);
+        read(geometry.meshExtents);
+
+        geometry.animationFrames.resize(readSize());
+        for (auto& frame : geometry.animationFrames) {
+            readArray(frame.rotations);
+            readArray(frame.translations);
+        }
+
+        quint32 numModelNames = readSize();
+        for (quint32 i = 0; i < numModelNames; ++i) {
+            int meshIndex;
+            QString modelName;
+            read(meshIndex);
+            read(modelName);
+            geometry.meshIndicesToModelNames.insert(meshIndex, modelName);
+        }
+
+        quint32 numChannelNames = readSize();
+        for (quint32 i = 0; i < numChannelNames; ++i) {
+            QString name;
+            read(name);
+            geometry.blendshapeChannelNames << name;
+        }
+    }
+
+private:
+    void checkStatus() {
+        if (_in.status() != QDataStream::Ok) {
+            throw QString("truncated baked geometry");
+        }
+    }
+
+    QDataStream _in;
+};
+
+}
+
+QByteArray writeBakedGeometry(const FBXGeometry& geometry) {
+    PROFILE_RANGE_EX(resource_parse, __FUNCTION__, 0xff0000ff, 0);
+    QByteArray data;
+    BakedWriter writer(&data);
+    writer.write(geometry);
+    return data;
+}
+
+FBXGeometry* readBakedGeometry(const char* data, size_t size, const QString& url) {
+    PROFILE_RANGE_EX(resource_parse, __FUNCTION__, 0xff0000ff, 0);
+    // Read in place, the data is usually a memory mapped cache file
+    const QByteArray rawData = QByteArray::fromRawData(data, (int)size);
+    std::unique_ptr<FBXGeometry> geometry { new FBXGeometry() };
+    BakedReader reader(rawData);
+    reader.read(*geometry);
+
+    for (auto& mesh : geometry->meshes) {
+        FBXReader::buildModelMesh(mesh, url);
+    }
+    return geometry.release();
+}
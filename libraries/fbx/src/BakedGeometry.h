@@ -0,0 +1,30 @@
+//
+//  BakedGeometry.h
+//  libraries/fbx/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BakedGeometry_h
+#define hifi_BakedGeometry_h
+
+#include "FBXReader.h"
+
+/// A baked geometry is a post-processed FBXGeometry (tangents, skinning clusters and materials already resolved)
+/// serialized in a binary layout where every vertex / index / skinning array is a single contiguous block.
+/// It is meant for the local model cache only: values are written in the native byte order.
+/// Materials keep their FBXTextures and the values of their model::Material; texture maps aren't part of it, as
+/// the readers leave them to NetworkMaterial.
+const quint32 BAKED_GEOMETRY_VERSION = 2;
+
+/// Serializes a fully extracted geometry.
+QByteArray writeBakedGeometry(const FBXGeometry& geometry);
+
+/// Reads a geometry written by writeBakedGeometry and rebuilds its model meshes.
+/// \exception QString if the data is not a valid baked geometry of the current version
+FBXGeometry* readBakedGeometry(const char* data, size_t size, const QString& url = "");
+
+#endif // hifi_BakedGeometry_h
@@ -0,0 +1,131 @@
+//
+//  BlendshapeKernel.cpp
+//  libraries/fbx/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "BlendshapeKernel.h"
+
+#include <algorithm>
+#include <limits>
+
+#include <FBXReader.h>
+#include <GLMHelpers.h>
+
+// normals only get a fraction of the blendshape so they stay close to unit length
+static const float NORMAL_COEFFICIENT_SCALE = 0.01f;
+
+BlendshapeKernel::Coefficients BlendshapeKernel::quantize(const QVector<float>& coefficients) {
+    const float MAX_QUANTIZED = (float)std::numeric_limits<quint16>::max();
+    Coefficients quantized(coefficients.size());
+    for (int i = 0; i < coefficients.size(); i++) {
+        quantized[i] = (quint16)glm::clamp(glm::round(coefficients[i] * (float)COEFFICIENT_STEPS), 0.0f, MAX_QUANTIZED);
+    }
+    return quantized;
+}
+
+BlendshapeKernel::BlendshapeKernel(const QVector<FBXMesh>& meshes) {
+    int numBlendshapes = 0;
+    for (const FBXMesh& mesh : meshes) {
+        numBlendshapes = std::max(numBlendshapes, mesh.blendshapes.size());
+    }
+    _blendshapes.resize(numBlendshapes);
+
+    std::vector<int> meshOffsets;
+    for (const FBXMesh& mesh : meshes) {
+        meshOffsets.push_back((int)_baseVertices.size());
+        if (mesh.blendshapes.isEmpty()) {
+            continue;
+        }
+        for (int i = 0; i < mesh.vertices.size(); i++) {
+            _baseVertices.push_back(glm::vec4(mesh.vertices[i], 0.0f));
+            _baseNormals.push_back(glm::vec4(i < mesh.normals.size() ? mesh.normals[i] : glm::vec3(), 0.0f));
+        }
+    }
+
+    for (int i = 0; i < numBlendshapes; i++) {
+        Range& range = _blendshapes[i];
+        range.first = (int)_indices.size();
+        for (int m = 0; m < meshes.size(); m++) {
+            const FBXMesh& mesh = meshes[m];
+            if (i >= mesh.blendshapes.size()) {
+                continue;
+            }
+            const FBXBlendshape& blendshape = mesh.blendshapes[i];
+            for (int j = 0; j < blendshape.indices.size(); j++) {
+                int index = blendshape.indices[j];
+                if (index < 0 || index >= mesh.vertices.size()) {
+                    continue;
+                }
+                _indices.push_back(meshOffsets[m] + index);
+                _deltas.push_back(glm::vec4(blendshape.vertices[j], 0.0f));
+                glm::vec3 normal = j < blendshape.normals.size() ? blendshape.normals[j] : glm::vec3();
+                _deltas.push_back(glm::vec4(normal * NORMAL_COEFFICIENT_SCALE, 0.0f));
+            }
+        }
+        range.count = (int)_indices.size() - range.first;
+    }
+}
+
+void BlendshapeKernel::accumulate(const int* indices, const glm::vec4* deltas, int count, float coefficient,
+                                  glm::vec4* vertices, glm::vec4* normals) {
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+    __m128 scale = _mm_set1_ps(coefficient);
+    for (int j = 0; j < count; j++) {
+        float* vertex = &vertices[indices[j]][0];
+        float* normal = &normals[indices[j]][0];
+        __m128 vertexDelta = _mm_loadu_ps(&deltas[2 * j][0]);
+        __m128 normalDelta = _mm_loadu_ps(&deltas[2 * j + 1][0]);
+        _mm_storeu_ps(vertex, _mm_add_ps(_mm_loadu_ps(vertex), _mm_mul_ps(vertexDelta, scale)));
+        _mm_storeu_ps(normal, _mm_add_ps(_mm_loadu_ps(normal), _mm_mul_ps(normalDelta, scale)));
+    }
+#else
+    accumulateScalar(indices, deltas, count, coefficient, vertices, normals);
+#endif
+}
+
+void BlendshapeKernel::accumulateScalar(const int* indices, const glm::vec4* deltas, int count, float coefficient,
+                                        glm::vec4* vertices, glm::vec4* normals) {
+    for (int j = 0; j < count; j++) {
+        vertices[indices[j]] += deltas[2 * j] * coefficient;
+        normals[indices[j]] += deltas[2 * j + 1] * coefficient;
+    }
+}
+
+void BlendshapeKernel::blend(const Coefficients& coefficients,
+                             QVector<glm::vec3>& vertices, QVector<glm::vec3>& normals) const {
+    blend(coefficients, vertices, normals, &BlendshapeKernel::accumulate);
+}
+
+void BlendshapeKernel::blend(const Coefficients& coefficients, QVector<glm::vec3>& vertices,
+                             QVector<glm::vec3>& normals, Accumulate accumulateBlendshape) const {
+    // reused by the blends of every model running on this thread
+    static thread_local std::vector<glm::vec4> blendedVertices;
+    static thread_local std::vector<glm::vec4> blendedNormals;
+    blendedVertices.assign(_baseVertices.begin(), _baseVertices.end());
+    blendedNormals.assign(_baseNormals.begin(), _baseNormals.end());
+
+    const float COEFFICIENT_SCALE = 1.0f / (float)COEFFICIENT_STEPS;
+    for (int i = 0, n = std::min(coefficients.size(), (int)_blendshapes.size()); i < n; i++) {
+        const Range& range = _blendshapes[i];
+        if (coefficients[i] == 0 || range.count == 0) {
+            continue;
+        }
+        accumulateBlendshape(&_indices[range.first], &_deltas[2 * range.first], range.count,
+                             (float)coefficients[i] * COEFFICIENT_SCALE, blendedVertices.data(), blendedNormals.data());
+    }
+
+    int numVertices = (int)blendedVertices.size();
+    vertices.resize(numVertices);
+    normals.resize(numVertices);
+    glm::vec3* vertexData = vertices.data();
+    glm::vec3* normalData = normals.data();
+    for (int i = 0; i < numVertices; i++) {
+        vertexData[i] = glm::vec3(blendedVertices[i]);
+        normalData[i] = glm::vec3(blendedNormals[i]);
+    }
+}
@@ -0,0 +1,70 @@
+//
+//  BlendshapeKernel.h
+//  libraries/fbx/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BlendshapeKernel_h
+#define hifi_BlendshapeKernel_h
+
+#include <memory>
+#include <vector>
+
+#include <QtCore/QVector>
+
+#include <glm/glm.hpp>
+
+class FBXMesh;
+
+// The blendshapes of a model file, rearranged once so blending is a tight loop over each blendshape's deltas.
+//
+// The vertices and normals of every mesh with blendshapes are concatenated, and each blendshape is merged across
+// meshes into one range of (index, vertex delta, normal delta).  Vertices are padded to 4 floats while blending,
+// so each delta is accumulated with one SIMD multiply-add; the accumulation scatters by vertex index, which a
+// structure of arrays layout wouldn't vectorize any better.
+class BlendshapeKernel {
+public:
+    using Pointer = std::shared_ptr<const BlendshapeKernel>;
+    using Coefficients = QVector<quint16>;
+
+    // Coefficients are quantized to steps of 1/COEFFICIENT_STEPS, changes smaller than that don't need a new blend
+    static const int COEFFICIENT_STEPS = 1024;
+    static Coefficients quantize(const QVector<float>& coefficients);
+
+    explicit BlendshapeKernel(const QVector<FBXMesh>& meshes);
+
+    // Vertices and normals of the meshes with blendshapes, concatenated in mesh order
+    void blend(const Coefficients& coefficients, QVector<glm::vec3>& vertices, QVector<glm::vec3>& normals) const;
+
+private:
+    friend class BlendshapeKernelTests;
+
+    // adds the deltas of one blendshape, scaled by its coefficient, to the vertices and normals they index
+    using Accumulate = void (*)(const int* indices, const glm::vec4* deltas, int count, float coefficient,
+                                glm::vec4* vertices, glm::vec4* normals);
+    static void accumulate(const int* indices, const glm::vec4* deltas, int count, float coefficient,
+                           glm::vec4* vertices, glm::vec4* normals);
+    static void accumulateScalar(const int* indices, const glm::vec4* deltas, int count, float coefficient,
+                                 glm::vec4* vertices, glm::vec4* normals);
+
+    void blend(const Coefficients& coefficients, QVector<glm::vec3>& vertices, QVector<glm::vec3>& normals,
+               Accumulate accumulateBlendshape) const;
+
+    class Range {
+    public:
+        int first { 0 };
+        int count { 0 };
+    };
+
+    std::vector<glm::vec4> _baseVertices;
+    std::vector<glm::vec4> _baseNormals;
+    std::vector<Range> _blendshapes; // per coefficient
+    std::vector<int> _indices;
+    std::vector<glm::vec4> _deltas; // vertex delta then normal delta, per index
+};
+
+#endif // hifi_BlendshapeKernel_h
@@ -401,6 +401,8 @@ public:
 
     FBXNode _fbxNode;
     static FBXNode parseFBX(QIODevice* device);
+    // Parse a binary FBX document held in memory (the whole file, starting with the binary prolog)
+    static FBXNode parseBinaryFBX(const char* data, quint64 size);
 
     FBXGeometry* extractFBXGeometry(const QVariantHash& mapping, const QString& url);
 
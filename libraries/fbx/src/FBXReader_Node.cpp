@@ -11,9 +11,12 @@
 
 #include "FBXReader.h"
 
+#include <algorithm>
 #include <iostream>
+#include <zlib.h>
+
 #include <QtCore/QBuffer>
-#include <QtCore/QDataStream>
+#include <QtCore/QFileDevice>
 #include <QtCore/QIODevice>
 #include <QtCore/QStringList>
 #include <QtCore/QTextStream>
@@ -24,195 +27,169 @@
 #include <shared/NsightHelpers.h>
 #include "ModelFormatLogging.h"
 
-template<class T> int streamSize() {
-    return sizeof(T);
-}
+// Binary FBX documents are parsed straight from a contiguous block of memory (the QBuffer data or a memory mapped
+// file) instead of going through a QDataStream: scalar properties are read in place and array properties are
+// inflated / copied directly into the storage of their final QVector.
+class FBXBinaryReader {
+public:
+    FBXBinaryReader(const char* data, quint64 size) : _data(data), _size(size) { }
 
-template<bool> int streamSize() {
-    return 1;
-}
+    quint64 getPosition() const { return _position; }
+    quint64 getSize() const { return _size; }
+    bool atEnd() const { return _position >= _size; }
+
+    void skip(quint64 length) {
+        checkAvailable(length);
+        _position += length;
+    }
 
-template<class T> QVariant readBinaryArray(QDataStream& in, int& position) {
-    quint32 arrayLength;
-    quint32 encoding;
-    quint32 compressedLength;
+    template<class T> T read() {
+        checkAvailable(sizeof(T));
+        T value;
+        memcpy(&value, _data + _position, sizeof(T));
+        _position += sizeof(T);
+        return fromLittleEndian(value);
+    }
 
-    in >> arrayLength;
-    in >> encoding;
-    in >> compressedLength;
-    position += sizeof(quint32) * 3;
+    QByteArray readBytes(quint64 length) {
+        checkAvailable(length);
+        QByteArray bytes(_data + _position, (int)length);
+        _position += length;
+        return bytes;
+    }
 
-    QVector<T> values;
-    if ((int)QSysInfo::ByteOrder == (int)in.byteOrder()) {
-        values.resize(arrayLength);
+    template<class T> QVariant readArray() {
+        quint32 arrayLength = read<quint32>();
+        quint32 encoding = read<quint32>();
+        quint32 compressedLength = read<quint32>();
+
+        QVector<T> values(arrayLength);
+        const quint64 arrayByteSize = (quint64)arrayLength * sizeof(T);
         const unsigned int DEFLATE_ENCODING = 1;
-        QByteArray arrayData;
         if (encoding == DEFLATE_ENCODING) {
-            // preface encoded data with uncompressed length
-            QByteArray compressed(sizeof(quint32) + compressedLength, 0);
-            *((quint32*)compressed.data()) = qToBigEndian<quint32>(arrayLength * sizeof(T));
-            in.readRawData(compressed.data() + sizeof(quint32), compressedLength);
-            position += compressedLength;
-            arrayData = qUncompress(compressed);
-            if (arrayData.isEmpty() ||
-                (unsigned int)arrayData.size() != (sizeof(T) * arrayLength)) { // answers empty byte array if corrupt
-                throw QString("corrupt fbx file");
+            checkAvailable(compressedLength);
+            uLongf inflatedSize = (uLongf)arrayByteSize;
+            if (arrayByteSize > 0) {
+                int status = uncompress(reinterpret_cast<Bytef*>(values.data()), &inflatedSize,
+                    reinterpret_cast<const Bytef*>(_data + _position), compressedLength);
+                if (status != Z_OK || inflatedSize != arrayByteSize) {
+                    throw QString("corrupt fbx file");
+                }
             }
+            _position += compressedLength;
         } else {
-            arrayData.resize(sizeof(T) * arrayLength);
-            position += sizeof(T) * arrayLength;
-            in.readRawData(arrayData.data(), arrayData.size());
+            checkAvailable(arrayByteSize);
+            if (arrayByteSize > 0) {
+                memcpy(values.data(), _data + _position, arrayByteSize);
+            }
+            _position += arrayByteSize;
         }
 
-        if (arrayData.size() > 0) {
-            memcpy(&values[0], arrayData.constData(), arrayData.size());
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+        for (auto& value : values) {
+            value = fromLittleEndian(value);
         }
-    } else {
-        values.reserve(arrayLength);
-        const unsigned int DEFLATE_ENCODING = 1;
-        if (encoding == DEFLATE_ENCODING) {
-            // preface encoded data with uncompressed length
-            QByteArray compressed(sizeof(quint32) + compressedLength, 0);
-            *((quint32*)compressed.data()) = qToBigEndian<quint32>(arrayLength * sizeof(T));
-            in.readRawData(compressed.data() + sizeof(quint32), compressedLength);
-            position += compressedLength;
-            QByteArray uncompressed = qUncompress(compressed);
-            if (uncompressed.isEmpty()) { // answers empty byte array if corrupt
-                throw QString("corrupt fbx file");
-            }
-            QDataStream uncompressedIn(uncompressed);
-            uncompressedIn.setByteOrder(QDataStream::LittleEndian);
-            uncompressedIn.setVersion(QDataStream::Qt_4_5); // for single/double precision switch
-            for (quint32 i = 0; i < arrayLength; i++) {
-                T value;
-                uncompressedIn >> value;
-                values.append(value);
-            }
-        } else {
-            for (quint32 i = 0; i < arrayLength; i++) {
-                T value;
-                in >> value;
-                position += streamSize<T>();
-                values.append(value);
-            }
+#endif
+        return QVariant::fromValue(values);
+    }
+
+private:
+    void checkAvailable(quint64 length) const {
+        if (length > _size - _position) {
+            throw QString("corrupt fbx file");
         }
     }
-    return QVariant::fromValue(values);
-}
 
-QVariant parseBinaryFBXProperty(QDataStream& in, int& position) {
-    char ch;
-    in.device()->getChar(&ch);
-    position++;
+    template<class T> static T fromLittleEndian(T value) {
+#if Q_BYTE_ORDER == Q_BIG_ENDIAN
+        char* bytes = reinterpret_cast<char*>(&value);
+        std::reverse(bytes, bytes + sizeof(T));
+#endif
+        return value;
+    }
+
+    const char* _data;
+    quint64 _size;
+    quint64 _position { 0 };
+};
+
+QVariant parseBinaryFBXProperty(FBXBinaryReader& in) {
+    char ch = in.read<char>();
     switch (ch) {
         case 'Y': {
-            qint16 value;
-            in >> value;
-            position += sizeof(qint16);
-            return QVariant::fromValue(value);
+            return QVariant::fromValue(in.read<qint16>());
         }
         case 'C': {
-            bool value;
-            in >> value;
-            position++;
-            return QVariant::fromValue(value);
+            return QVariant::fromValue(in.read<quint8>() != 0);
         }
         case 'I': {
-            qint32 value;
-            in >> value;
-            position += sizeof(qint32);
-            return QVariant::fromValue(value);
+            return QVariant::fromValue(in.read<qint32>());
         }
         case 'F': {
-            float value;
-            in >> value;
-            position += sizeof(float);
-            return QVariant::fromValue(value);
+            return QVariant::fromValue(in.read<float>());
         }
         case 'D': {
-            double value;
-            in >> value;
-            position += sizeof(double);
-            return QVariant::fromValue(value);
+            return QVariant::fromValue(in.read<double>());
         }
         case 'L': {
-            qint64 value;
-            in >> value;
-            position += sizeof(qint64);
-            return QVariant::fromValue(value);
+            return QVariant::fromValue(in.read<qint64>());
         }
         case 'f': {
-            return readBinaryArray<float>(in, position);
+            return in.readArray<float>();
         }
         case 'd': {
-            return readBinaryArray<double>(in, position);
+            return in.readArray<double>();
         }
         case 'l': {
-            return readBinaryArray<qint64>(in, position);
+            return in.readArray<qint64>();
         }
         case 'i': {
-            return readBinaryArray<qint32>(in, position);
+            return in.readArray<qint32>();
         }
         case 'b': {
-            return readBinaryArray<bool>(in, position);
+            return in.readArray<bool>();
         }
         case 'S':
         case 'R': {
-            quint32 length;
-            in >> length;
-            position += sizeof(quint32) + length;
-            return QVariant::fromValue(in.device()->read(length));
+            quint32 length = in.read<quint32>();
+            return QVariant::fromValue(in.readBytes(length));
         }
         default:
             throw QString("Unknown property type: ") + ch;
     }
 }
 
-FBXNode parseBinaryFBXNode(QDataStream& in, int& position, bool has64BitPositions = false) {
-    qint64 endOffset;
+FBXNode parseBinaryFBXNode(FBXBinaryReader& in, bool has64BitPositions = false) {
+    quint64 endOffset;
     quint64 propertyCount;
-    quint64 propertyListLength;
-    quint8 nameLength;
 
     // FBX 2016 and beyond uses 64bit positions in the node headers, pre-2016 used 32bit values
-    // our code generally doesn't care about the size that much, so we will use 64bit values
-    // from here on out, but if the file is an older format we read the stream into temp 32bit 
-    // values and then assign to our actual 64bit values.
     if (has64BitPositions) {
-        in >> endOffset;
-        in >> propertyCount;
-        in >> propertyListLength;
-        position += sizeof(quint64) * 3;
+        endOffset = in.read<quint64>();
+        propertyCount = in.read<quint64>();
+        in.read<quint64>(); // property list length
     } else {
-        qint32 tempEndOffset;
-        quint32 tempPropertyCount;
-        quint32 tempPropertyListLength;
-        in >> tempEndOffset;
-        in >> tempPropertyCount;
-        in >> tempPropertyListLength;
-        position += sizeof(quint32) * 3;
-        endOffset = tempEndOffset;
-        propertyCount = tempPropertyCount;
-        propertyListLength = tempPropertyListLength;
-    }
-    in >> nameLength;
-    position += sizeof(quint8);
+        endOffset = in.read<quint32>();
+        propertyCount = in.read<quint32>();
+        in.read<quint32>(); // property list length
+    }
+    quint8 nameLength = in.read<quint8>();
 
     FBXNode node;
-    const int MIN_VALID_OFFSET = 40;
+    const quint64 MIN_VALID_OFFSET = 40;
     if (endOffset < MIN_VALID_OFFSET || nameLength == 0) {
         // use a null name to indicate a null node
         return node;
     }
-    node.name = in.device()->read(nameLength);
-    position += nameLength;
+    node.name = in.readBytes(nameLength);
 
-    for (quint32 i = 0; i < propertyCount; i++) {
-        node.properties.append(parseBinaryFBXProperty(in, position));
+    node.properties.reserve((int)propertyCount);
+    for (quint64 i = 0; i < propertyCount; i++) {
+        node.properties.append(parseBinaryFBXProperty(in));
     }
 
-    while (endOffset > position) {
-        FBXNode child = parseBinaryFBXNode(in, position, has64BitPositions);
+    while (endOffset > in.getPosition()) {
+        FBXNode child = parseBinaryFBXNode(in, has64BitPositions);
         if (child.name.isNull()) {
             return node;
 
@@ -366,9 +343,45 @@ FBXNode FBXReader::parseFBX(QIODevice* device) {
         }
         return top;
     }
-    QDataStream in(device);
-    in.setByteOrder(QDataStream::LittleEndian);
-    in.setVersion(QDataStream::Qt_4_5); // for single/double precision switch
+    // Get at the whole binary document as one block of memory, without copying it when the device allows it
+    qint64 size = device->size() - device->pos();
+    QByteArray contents;
+    const char* data = nullptr;
+    uchar* mapped = nullptr;
+    auto buffer = qobject_cast<QBuffer*>(device);
+    auto file = qobject_cast<QFileDevice*>(device);
+    if (buffer) {
+        data = buffer->data().constData() + buffer->pos();
+    } else if (file && (mapped = file->map(file->pos(), size))) {
+        data = reinterpret_cast<const char*>(mapped);
+    } else {
+        contents = device->readAll();
+        data = contents.constData();
+        size = contents.size();
+    }
+
+    FBXNode top;
+    try {
+        top = parseBinaryFBX(data, (quint64)size);
+    } catch (...) {
+        if (mapped) {
+            file->unmap(mapped);
+        }
+        throw;
+    }
+
+    if (mapped) {
+        file->unmap(mapped);
+    }
+    if (contents.isNull()) {
+        // the document was read in place, consume it from the device like the sequential path does
+        device->seek(device->pos() + size);
+    }
+    return top;
+}
+
+FBXNode FBXReader::parseBinaryFBX(const char* data, quint64 size) {
+    FBXBinaryReader in(data, size);
 
     // see http://code.blender.org/index.php/2013/08/fbx-binary-file-format-specification/ for an explanation
     // of the FBX binary format
@@ -379,18 +392,15 @@ FBXNode FBXReader::parseFBX(QIODevice* device) {
     //   Bytes 23 - 26 : unsigned int, the version number. 7300 for version 7.3 for example.
     const int HEADER_BEFORE_VERSION = 23;
     const quint32 VERSION_FBX2016 = 7500;
-    in.skipRawData(HEADER_BEFORE_VERSION);
-    int position = HEADER_BEFORE_VERSION;
-    quint32 fileVersion;
-    in >> fileVersion;
-    position += sizeof(fileVersion);
+    in.skip(HEADER_BEFORE_VERSION);
+    quint32 fileVersion = in.read<quint32>();
     qCDebug(modelformat) << "fileVersion:" << fileVersion;
     bool has64BitPositions = (fileVersion >= VERSION_FBX2016);
 
     // parse the top-level node
     FBXNode top;
-    while (device->bytesAvailable()) {
-        FBXNode next = parseBinaryFBXNode(in, position, has64BitPositions);
+    while (!in.atEnd()) {
+        FBXNode next = parseBinaryFBXNode(in, has64BitPositions);
         if (next.name.isNull()) {
             return top;
 
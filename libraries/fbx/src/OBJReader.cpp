@@ -213,6 +213,40 @@ bool OBJReader::isValidTexture(const QByteArray &filename) {
     return isValid;
 }
 
+QByteArray OBJReader::fetchMaterialLibraries(const QByteArray& model, const QUrl& url) {
+    QByteArray libraries;
+    librariesFetched.clear();
+    int position = 0;
+    while ((position = model.indexOf("mtllib", position)) != -1) {
+        int lineStart = model.lastIndexOf('\n', position) + 1;
+        int lineEnd = model.indexOf('\n', position);
+        if (lineEnd == -1) {
+            lineEnd = model.size();
+        }
+        QList<QByteArray> tokens = model.mid(lineStart, lineEnd - lineStart).simplified().split(' ');
+        position = lineEnd;
+        if (tokens.size() < 2 || tokens[0] != "mtllib" || librariesFetched.contains(tokens[1])) {
+            continue;
+        }
+        const QByteArray& libraryName = tokens[1];
+        libraries += libraryName + '\n';
+
+        // resolved like readOBJ does
+        QUrl libraryUrl = url.resolved(QUrl(QString(libraryName)).fileName());
+        QNetworkReply* netReply = request(libraryUrl, false);
+        QByteArray library;
+        if (replyOK(netReply, libraryUrl)) {
+            library = netReply->readAll();
+            libraries += library;
+        }
+        librariesFetched[libraryName] = library;
+        if (netReply) {
+            netReply->deleteLater();
+        }
+    }
+    return libraries;
+}
+
 void OBJReader::parseMaterialLibrary(QIODevice* device) {
     OBJTokenizer tokenizer(device);
     QString matName = SMART_DEFAULT_MATERIAL_NAME;
@@ -624,6 +658,19 @@ FBXGeometry* OBJReader::readOBJ(QByteArray& model, const QVariantHash& mapping,
             // Throw away any path part of libraryName, and merge against original url.
             QUrl libraryUrl = _url.resolved(QUrl(libraryName).fileName());
             qCDebug(modelformat) << "OBJ Reader material library" << libraryName << "used in" << _url;
+            auto fetched = librariesFetched.find(libraryName.toUtf8());
+            if (fetched != librariesFetched.end()) {
+                // already fetched by fetchMaterialLibraries
+                if (!fetched.value().isNull()) {
+                    QBuffer libraryBuffer;
+                    libraryBuffer.setData(fetched.value());
+                    libraryBuffer.open(QIODevice::ReadOnly);
+                    parseMaterialLibrary(&libraryBuffer);
+                } else {
+                    qCDebug(modelformat) << "OBJ Reader WARNING:" << libraryName << "did not answer";
+                }
+                continue;
+            }
             QNetworkReply* netReply = request(libraryUrl, false);
             if (replyOK(netReply, libraryUrl)) {
                 parseMaterialLibrary(netReply);
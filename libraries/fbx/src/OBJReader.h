@@ -74,11 +74,16 @@ public:
 
     QNetworkReply* request(QUrl& url, bool isTest);
     FBXGeometry* readOBJ(QByteArray& model, const QVariantHash& mapping, bool combineParts, const QUrl& url = QUrl());
+    // The names and contents of the material libraries model refers to, for the caches of what readOBJ makes of it
+    // as it depends on them too.  A library that can't be fetched adds only its name.  The libraries are kept, a
+    // following readOBJ of the same model parses them instead of fetching them again.
+    QByteArray fetchMaterialLibraries(const QByteArray& model, const QUrl& url);
 
 private:
     QUrl _url;
 
     QHash<QByteArray, bool> librariesSeen;
+    QHash<QByteArray, QByteArray> librariesFetched; // null for the ones that could not be fetched
     bool parseOBJGroup(OBJTokenizer& tokenizer, const QVariantHash& mapping, FBXGeometry& geometry,
                        float& scaleGuess, bool combineParts);
     void parseMaterialLibrary(QIODevice* device);
@@ -0,0 +1,591 @@
+//
+//  FrameIO.cpp
+//  libraries/gpu/src/gpu
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "FrameIO.h"
+
+#include <string.h>
+#include <unordered_map>
+
+#include <QtCore/QDataStream>
+
+#include "Frame.h"
+#include "GPULogging.h"
+
+using namespace gpu;
+
+namespace {
+
+const quint32 FRAME_CAPTURE_MAGIC = 0x46474648; // "HFGF"
+
+// The objects referenced by the batches of a frame, each written once and referenced by index
+template <typename T>
+class ObjectTable {
+public:
+    using Pointer = std::shared_ptr<T>;
+
+    void add(const Pointer& object) {
+        if (object && _indices.find(object.get()) == _indices.end()) {
+            _indices[object.get()] = (qint32)_objects.size();
+            _objects.push_back(object);
+        }
+    }
+
+    qint32 indexOf(const Pointer& object) const {
+        auto it = object ? _indices.find(object.get()) : _indices.end();
+        return it != _indices.end() ? it->second : -1;
+    }
+
+    const std::vector<Pointer>& getObjects() const { return _objects; }
+
+private:
+    std::unordered_map<const T*, qint32> _indices;
+    std::vector<Pointer> _objects;
+};
+
+// What has to match for the raw blocks of a capture to be read back
+void writeLayout(QDataStream& out) {
+    out << (quint32)sizeof(void*) << (quint32)sizeof(Batch::Param) << (quint32)sizeof(Batch::Command)
+        << (quint32)sizeof(State::Data) << (quint32)sizeof(Sampler::Desc) << (quint32)sizeof(StereoState);
+}
+
+class FrameWriter {
+public:
+    FrameWriter(QByteArray* data) : _out(data, QIODevice::WriteOnly) {
+        _out.setVersion(QDataStream::Qt_5_0);
+    }
+
+    void writeFrame(const Frame& frame) {
+        collect(frame);
+
+        _out << FRAME_CAPTURE_MAGIC << FRAME_CAPTURE_VERSION;
+        writeLayout(_out);
+
+        writeTable(_buffers, [this](const BufferPointer& buffer) {
+            write((quint64)buffer->getSize());
+            _out.writeRawData(reinterpret_cast<const char*>(buffer->getData()), (int)buffer->getSize());
+        });
+        writeTable(_textures, [this](const TexturePointer& texture) {
+            write((quint8)texture->getType());
+            write((quint8)texture->getUsageType());
+            write(texture->getTexelFormat().getRaw());
+            write(texture->getWidth());
+            write(texture->getHeight());
+            write(texture->getDepth());
+            write(texture->getNumMips());
+            write(texture->getSampler().getDesc());
+            write(texture->source());
+        });
+        writeTable(_streamFormats, [this](const Stream::FormatPointer& format) {
+            write((quint32)format->getNumAttributes());
+            for (const auto& entry : format->getAttributes()) {
+                const Stream::Attribute& attribute = entry.second;
+                write(attribute._slot);
+                write(attribute._channel);
+                write(attribute._element.getRaw());
+                write((quint64)attribute._offset);
+                write(attribute._frequency);
+            }
+        });
+        writeTable(_programs, [this](const ShaderPointer& program) {
+            write((quint32)program->getShaders().size());
+            for (const auto& shader : program->getShaders()) {
+                write((quint8)shader->getType());
+                write(shader->getSource().getCode());
+            }
+        });
+        writeTable(_pipelines, [this](const PipelinePointer& pipeline) {
+            write(_programs.indexOf(pipeline->getProgram()));
+            write(pipeline->getState() ? pipeline->getState()->getValues() : State::DEFAULT);
+        });
+        writeTable(_framebuffers, [this](const FramebufferPointer& framebuffer) {
+            write(framebuffer->getName());
+            for (uint32 slot = 0; slot < Framebuffer::MAX_NUM_RENDER_BUFFERS; slot++) {
+                write(_textures.indexOf(framebuffer->getRenderBuffer(slot)));
+                write(framebuffer->getRenderBufferSubresource(slot));
+            }
+            write(_textures.indexOf(framebuffer->getDepthStencilBuffer()));
+            write(framebuffer->getDepthStencilBufferFormat().getRaw());
+            write(framebuffer->getDepthStencilBufferSubresource());
+        });
+        writeTable(_queries, [this](const QueryPointer& query) {
+            write(query->getName());
+        });
+
+        write(frame.frameIndex);
+        write(frame.pose);
+        write(frame.stereoState);
+        write(_framebuffers.indexOf(frame.framebuffer));
+        write(_textures.indexOf(frame.overlay));
+        write((quint32)frame.batches.size());
+        for (const Batch& batch : frame.batches) {
+            writeBatch(batch);
+        }
+    }
+
+private:
+    // Plain old data is written as raw bytes
+    template <typename T> void write(const T& value) {
+        _out.writeRawData(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void write(const std::string& value) { _out << QByteArray(value.data(), (int)value.size()); }
+
+    // Arrays of plain old data are written as one contiguous block
+    template <typename T> void writeArray(const std::vector<T>& values) {
+        write((quint32)values.size());
+        _out.writeRawData(reinterpret_cast<const char*>(values.data()), (int)(values.size() * sizeof(T)));
+    }
+
+    template <typename T, typename F> void writeTable(const ObjectTable<T>& table, F writeObject) {
+        write((quint32)table.getObjects().size());
+        for (const auto& object : table.getObjects()) {
+            writeObject(object);
+        }
+    }
+
+    template <typename T> void writeCache(const typename Batch::Cache<std::shared_ptr<T>>::Vector& cache,
+                                          const ObjectTable<T>& table) {
+        write((quint32)cache.size());
+        for (const auto& item : cache._items) {
+            write(table.indexOf(item._data));
+        }
+    }
+
+    void writeStrings(const Batch::StringCaches& cache) {
+        write((quint32)cache.size());
+        for (const auto& item : cache._items) {
+            write(item._data);
+        }
+    }
+
+    void collect(const Frame& frame) {
+        for (const Batch& batch : frame.batches) {
+            for (const auto& item : batch._buffers._items) {
+                _buffers.add(item._data);
+            }
+            for (const auto& entry : batch._namedData) {
+                for (const auto& buffer : entry.second.buffers) {
+                    _buffers.add(buffer);
+                }
+            }
+            for (const auto& item : batch._textures._items) {
+                _textures.add(item._data);
+            }
+            for (const auto& item : batch._streamFormats._items) {
+                _streamFormats.add(item._data);
+            }
+            for (const auto& item : batch._pipelines._items) {
+                if (item._data) {
+                    _programs.add(item._data->getProgram());
+                }
+                _pipelines.add(item._data);
+            }
+            for (const auto& item : batch._framebuffers._items) {
+                collect(item._data);
+            }
+            for (const auto& item : batch._queries._items) {
+                _queries.add(item._data);
+            }
+        }
+        collect(frame.framebuffer);
+        _textures.add(frame.overlay);
+    }
+
+    void collect(const FramebufferPointer& framebuffer) {
+        if (!framebuffer) {
+            return;
+        }
+        for (uint32 slot = 0; slot < Framebuffer::MAX_NUM_RENDER_BUFFERS; slot++) {
+            _textures.add(framebuffer->getRenderBuffer(slot));
+        }
+        _textures.add(framebuffer->getDepthStencilBuffer());
+        _framebuffers.add(framebuffer);
+    }
+
+    void writeBatch(const Batch& batch) {
+        write(batch.isStereoEnabled());
+        write(batch.isSkyboxEnabled());
+
+        writeArray(batch._commands);
+        writeArray(batch._commandOffsets);
+        writeArray(batch._params);
+        writeArray(batch._data);
+        writeArray(batch._drawCallInfos);
+        writeArray(batch._objects);
+
+        writeCache(batch._buffers, _buffers);
+        writeCache(batch._textures, _textures);
+        writeCache(batch._streamFormats, _streamFormats);
+        write((quint32)batch._transforms.size());
+        for (const auto& item : batch._transforms._items) {
+            write(item._data.getTranslation());
+            write(item._data.getRotation());
+            write(item._data.getScale());
+        }
+        writeCache(batch._pipelines, _pipelines);
+        writeCache(batch._framebuffers, _framebuffers);
+        writeCache(batch._queries, _queries);
+        write((quint32)batch._lambdas.size());
+        writeStrings(batch._profileRanges);
+        writeStrings(batch._names);
+
+        write((quint32)batch._namedData.size());
+        for (const auto& entry : batch._namedData) {
+            write(entry.first);
+            write((quint32)entry.second.buffers.size());
+            for (const auto& buffer : entry.second.buffers) {
+                write(_buffers.indexOf(buffer));
+            }
+            writeArray(entry.second.drawCallInfos);
+        }
+    }
+
+    QDataStream _out;
+    ObjectTable<Buffer> _buffers;
+    ObjectTable<Texture> _textures;
+    ObjectTable<Stream::Format> _streamFormats;
+    ObjectTable<Shader> _programs;
+    ObjectTable<Pipeline> _pipelines;
+    ObjectTable<Framebuffer> _framebuffers;
+    ObjectTable<Query> _queries;
+};
+
+class FrameReader {
+public:
+    FrameReader(const QByteArray& data) : _in(data) {
+        _in.setVersion(QDataStream::Qt_5_0);
+    }
+
+    FramePointer readFrame() {
+        quint32 magic, version;
+        _in >> magic >> version;
+        if (magic != FRAME_CAPTURE_MAGIC) {
+            return fail("not a frame capture");
+        }
+        if (version != FRAME_CAPTURE_VERSION) {
+            return fail(QString("unsupported frame capture version %1").arg(version));
+        }
+        QByteArray layout;
+        {
+            QDataStream layoutStream(&layout, QIODevice::WriteOnly);
+            writeLayout(layoutStream);
+        }
+        QByteArray captureLayout(layout.size(), 0);
+        if (_in.readRawData(captureLayout.data(), captureLayout.size()) != captureLayout.size() || captureLayout != layout) {
+            return fail("frame captured on a different platform");
+        }
+
+        readTable(_buffers, [this] {
+            quint64 size = readSize<quint64>(1);
+            std::vector<Byte> bytes(size);
+            readRaw(bytes.data(), size);
+            return std::make_shared<Buffer>(size, bytes.data());
+        });
+        readTable(_textures, [this] { return readTexture(); });
+        readTable(_streamFormats, [this] {
+            auto format = std::make_shared<Stream::Format>();
+            for (quint32 i = 0, count = readSize<quint32>(1); i < count; i++) {
+                Stream::Slot slot = read<Stream::Slot>();
+                Stream::Slot channel = read<Stream::Slot>();
+                Element element = readElement();
+                Offset offset = (Offset)read<quint64>();
+                Stream::Frequency frequency = (Stream::Frequency)read<uint32>();
+                format->setAttribute(slot, channel, element, offset, frequency);
+            }
+            return format;
+        });
+        readTable(_programs, [this] { return readProgram(); });
+        readTable(_pipelines, [this] {
+            ShaderPointer program = readIndex(_programs);
+            State::Data state = read<State::Data>();
+            return Pipeline::create(program, std::make_shared<State>(state));
+        });
+        readTable(_framebuffers, [this] {
+            FramebufferPointer framebuffer(Framebuffer::create(readString()));
+            for (uint32 slot = 0; slot < Framebuffer::MAX_NUM_RENDER_BUFFERS; slot++) {
+                TexturePointer texture = readIndex(_textures);
+                uint32 subresource = read<uint32>();
+                if (texture) {
+                    framebuffer->setRenderBuffer(slot, texture, subresource);
+                }
+            }
+            TexturePointer depthStencil = readIndex(_textures);
+            Element format = readElement();
+            uint32 subresource = read<uint32>();
+            if (depthStencil) {
+                framebuffer->setDepthStencilBuffer(depthStencil, format, subresource);
+            }
+            return framebuffer;
+        });
+        readTable(_queries, [this] {
+            return std::make_shared<Query>([](const Query&) {}, readString());
+        });
+
+        auto frame = std::make_shared<Frame>();
+        frame->frameIndex = read<uint32_t>();
+        frame->pose = read<Mat4>();
+        frame->stereoState = read<StereoState>();
+        frame->framebuffer = readIndex(_framebuffers);
+        frame->overlay = readIndex(_textures);
+        // Batches aren't movable, they are created in place
+        frame->batches.resize(readSize<quint32>(1));
+        for (Batch& batch : frame->batches) {
+            if (_failed) {
+                break;
+            }
+            readBatch(batch);
+        }
+        if (_failed) {
+            return FramePointer();
+        }
+        return frame;
+    }
+
+private:
+    // Reading stops at the first error: every later read returns zeros, sizes and objects included
+    FramePointer fail(const QString& error) {
+        if (!_failed) {
+            _failed = true;
+            qCWarning(gpulogging) << "Failed to read frame capture:" << error;
+        }
+        return FramePointer();
+    }
+
+    void readRaw(void* data, quint64 size) {
+        if (size == 0) {
+            return;
+        }
+        if (_failed || _in.readRawData(reinterpret_cast<char*>(data), (int)size) != (int)size) {
+            memset(data, 0, size);
+            fail("truncated frame capture");
+        }
+    }
+
+    template <typename T> T read() {
+        T value;
+        readRaw(&value, sizeof(T));
+        return value;
+    }
+
+    // A count of elements of elementSize bytes each, checked against what is left to read
+    template <typename T> T readSize(quint64 elementSize) {
+        T size = read<T>();
+        if ((quint64)size * elementSize > (quint64)_in.device()->bytesAvailable()) {
+            fail("truncated frame capture");
+            return 0;
+        }
+        return size;
+    }
+
+    std::string readString() {
+        if (_failed) {
+            return std::string();
+        }
+        QByteArray value;
+        _in >> value;
+        if (_in.status() != QDataStream::Ok) {
+            fail("truncated frame capture");
+            return std::string();
+        }
+        return std::string(value.constData(), value.size());
+    }
+
+    Element readElement() {
+        static_assert(sizeof(Element) == sizeof(uint16), "Element is expected to be its raw 16 bits");
+        uint16 raw = read<uint16>();
+        Element element;
+        memcpy(&element, &raw, sizeof(raw));
+        return element;
+    }
+
+    // Some batch types, like params, have no default constructor: they are copied from an aligned block
+    template <typename T> void readArray(std::vector<T>& values) {
+        quint32 size = readSize<quint32>(sizeof(T));
+        std::vector<quint64> block(((quint64)size * sizeof(T) + sizeof(quint64) - 1) / sizeof(quint64));
+        readRaw(block.data(), (quint64)size * sizeof(T));
+        const T* begin = reinterpret_cast<const T*>(block.data());
+        values.assign(begin, begin + size);
+    }
+
+    template <typename T, typename F> void readTable(std::vector<std::shared_ptr<T>>& table, F readObject) {
+        quint32 size = readSize<quint32>(1);
+        table.reserve(size);
+        for (quint32 i = 0; i < size && !_failed; i++) {
+            table.push_back(readObject());
+        }
+    }
+
+    template <typename T> std::shared_ptr<T> readIndex(const std::vector<std::shared_ptr<T>>& table) {
+        qint32 index = read<qint32>();
+        if (index < 0) {
+            return std::shared_ptr<T>();
+        }
+        if (index >= (qint32)table.size()) {
+            fail("invalid object index in frame capture");
+            return std::shared_ptr<T>();
+        }
+        return table[index];
+    }
+
+    template <typename T> void readCache(typename Batch::Cache<std::shared_ptr<T>>::Vector& cache,
+                                         const std::vector<std::shared_ptr<T>>& table) {
+        for (quint32 i = 0, size = readSize<quint32>(sizeof(qint32)); i < size; i++) {
+            cache.cache(readIndex(table));
+        }
+    }
+
+    void readStrings(Batch::StringCaches& cache) {
+        for (quint32 i = 0, size = readSize<quint32>(1); i < size; i++) {
+            cache.cache(readString());
+        }
+    }
+
+    // Textures are recreated with their format and size, their contents aren't captured
+    TexturePointer readTexture() {
+        Texture::Type type = (Texture::Type)read<quint8>();
+        TextureUsageType usageType = (TextureUsageType)read<quint8>();
+        Element format = readElement();
+        uint16 width = read<uint16>();
+        uint16 height = read<uint16>();
+        uint16 depth = read<uint16>();
+        uint16 numMips = read<uint16>();
+        Sampler sampler(read<Sampler::Desc>());
+        std::string source = readString();
+
+        Texture* texture;
+        switch (type) {
+            case Texture::TEX_1D:
+                texture = Texture::create1D(format, width, numMips, sampler);
+                break;
+            case Texture::TEX_3D:
+                texture = Texture::create3D(format, width, height, depth, numMips, sampler);
+                break;
+            case Texture::TEX_CUBE:
+                texture = Texture::createCube(format, width, numMips, sampler);
+                break;
+            case Texture::TEX_2D:
+            default:
+                if (usageType == TextureUsageType::RENDERBUFFER) {
+                    texture = Texture::createRenderBuffer(format, width, height, numMips, sampler);
+                } else if (usageType == TextureUsageType::STRICT_RESOURCE) {
+                    texture = Texture::createStrict(format, width, height, numMips, sampler);
+                } else {
+                    texture = Texture::create2D(format, width, height, numMips, sampler);
+                }
+                break;
+        }
+        texture->setSource(source);
+        return TexturePointer(texture);
+    }
+
+    ShaderPointer readProgram() {
+        ShaderPointer vertex, pixel, geometry;
+        for (quint32 i = 0, count = readSize<quint32>(1); i < count; i++) {
+            Shader::Type type = (Shader::Type)read<quint8>();
+            Shader::Source source(readString());
+            switch (type) {
+                case Shader::VERTEX:
+                    vertex = Shader::createVertex(source);
+                    break;
+                case Shader::PIXEL:
+                    pixel = Shader::createPixel(source);
+                    break;
+                case Shader::GEOMETRY:
+                    geometry = Shader::createGeometry(source);
+                    break;
+                default:
+                    fail("invalid shader type in frame capture");
+                    break;
+            }
+        }
+        if (_failed) {
+            return ShaderPointer();
+        }
+        return geometry ? Shader::createProgram(vertex, geometry, pixel) : Shader::createProgram(vertex, pixel);
+    }
+
+    void readBatch(Batch& batch) {
+        batch.enableStereo(read<bool>());
+        batch.enableSkybox(read<bool>());
+
+        readArray(batch._commands);
+        readArray(batch._commandOffsets);
+        readArray(batch._params);
+        readArray(batch._data);
+        readArray(batch._drawCallInfos);
+        readArray(batch._objects);
+
+        readCache(batch._buffers, _buffers);
+        readCache(batch._textures, _textures);
+        readCache(batch._streamFormats, _streamFormats);
+        for (quint32 i = 0, size = readSize<quint32>(sizeof(Transform::Vec3)); i < size; i++) {
+            Transform transform;
+            transform.setTranslation(read<Transform::Vec3>());
+            transform.setRotation(read<Transform::Quat>());
+            transform.setScale(read<Transform::Vec3>());
+            batch._transforms.cache(transform);
+        }
+        readCache(batch._pipelines, _pipelines);
+        readCache(batch._framebuffers, _framebuffers);
+        readCache(batch._queries, _queries);
+        quint32 numLambdas = read<quint32>();
+        if (numLambdas > batch._commands.size()) {
+            fail("corrupted batch in frame capture");
+            return;
+        }
+        for (quint32 i = 0; i < numLambdas; i++) {
+            batch._lambdas.cache([] {});
+        }
+        readStrings(batch._profileRanges);
+        readStrings(batch._names);
+
+        for (quint32 i = 0, size = readSize<quint32>(1); i < size; i++) {
+            Batch::NamedBatchData& namedData = batch._namedData[readString()];
+            for (quint32 j = 0, numBuffers = readSize<quint32>(sizeof(qint32)); j < numBuffers; j++) {
+                namedData.buffers.push_back(readIndex(_buffers));
+            }
+            readArray(namedData.drawCallInfos);
+        }
+
+        // the commands refer to params and data by offset, a capture that doesn't match them can't be replayed
+        if (batch._commands.size() != batch._commandOffsets.size()) {
+            fail("corrupted batch in frame capture");
+            return;
+        }
+        for (auto offset : batch._commandOffsets) {
+            if (offset > batch._params.size()) {
+                fail("corrupted batch in frame capture");
+                return;
+            }
+        }
+    }
+
+    QDataStream _in;
+    bool _failed { false };
+    std::vector<BufferPointer> _buffers;
+    std::vector<TexturePointer> _textures;
+    std::vector<Stream::FormatPointer> _streamFormats;
+    std::vector<ShaderPointer> _programs;
+    std::vector<PipelinePointer> _pipelines;
+    std::vector<FramebufferPointer> _framebuffers;
+    std::vector<QueryPointer> _queries;
+};
+
+}
+
+QByteArray gpu::writeFrame(const Frame& frame) {
+    QByteArray data;
+    FrameWriter(&data).writeFrame(frame);
+    return data;
+}
+
+FramePointer gpu::readFrame(const QByteArray& data) {
+    return FrameReader(data).readFrame();
+}
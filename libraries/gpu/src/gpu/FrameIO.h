@@ -0,0 +1,36 @@
+//
+//  FrameIO.h
+//  libraries/gpu/src/gpu
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_gpu_FrameIO_h
+#define hifi_gpu_FrameIO_h
+
+#include <QtCore/QByteArray>
+
+#include "Forward.h"
+
+namespace gpu {
+
+/// A captured frame holds everything the backends read from the batches of a finished frame: commands, params,
+/// data, transforms, the contents of the buffers and the description of the textures, stream formats, pipelines
+/// (shader sources and states), framebuffers and queries.  Texture contents aren't captured, nor are the batch
+/// lambdas, which replay as no-ops.  Named calls are captured already expanded, as they are once a frame is finished.
+/// Meant for replay on the same platform: values are written in the native byte order and pointer size.
+const quint32 FRAME_CAPTURE_VERSION = 1;
+
+/// Serializes a frame returned by Context::endFrame, must be called on the thread that recorded it
+QByteArray writeFrame(const Frame& frame);
+
+/// Rebuilds a frame written by writeFrame, with new gpu objects shared between its batches like the originals were
+/// \return null, after logging a warning, if the data is not a valid capture of the current version and platform
+FramePointer readFrame(const QByteArray& data);
+
+}
+
+#endif // hifi_gpu_FrameIO_h
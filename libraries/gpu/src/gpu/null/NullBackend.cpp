@@ -0,0 +1,100 @@
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+#include "NullBackend.h"
+
+#include <string.h>
+
+using namespace gpu;
+using namespace gpu::null;
+
+void Backend::countDraws(uint32 numDraws, uint32 numTriangles) {
+    int sides = isStereo() ? 2 : 1;
+    _stats._DSNumAPIDrawcalls++;
+    _stats._DSNumDrawcalls += sides * numDraws;
+    _stats._DSNumTriangles += sides * numTriangles;
+}
+
+void Backend::render(const Batch& batch) {
+    // Allow the batch to override the rendering stereo settings, as in the GL backend
+    bool savedStereo = _stereo._enable;
+    if (!batch.isStereoEnabled()) {
+        _stereo._enable = false;
+    }
+
+    const size_t numCommands = batch.getCommands().size();
+    const Batch::Commands::value_type* command = batch.getCommands().data();
+    const Batch::CommandOffsets::value_type* offset = batch.getCommandOffsets().data();
+    for (size_t commandIndex = 0; commandIndex < numCommands; ++commandIndex, ++command, ++offset) {
+        const Batch::Param* params = batch._params.data() + *offset;
+        switch (*command) {
+            case Batch::COMMAND_draw:
+            case Batch::COMMAND_drawIndexed:
+                countDraws(1, params[1]._uint / 3);
+                break;
+
+            case Batch::COMMAND_drawInstanced:
+            case Batch::COMMAND_drawIndexedInstanced:
+                countDraws(1, params[4]._uint * (params[2]._uint / 3));
+                break;
+
+            case Batch::COMMAND_multiDrawIndirect:
+            case Batch::COMMAND_multiDrawIndexedIndirect:
+                countDraws(params[0]._uint, 0);
+                break;
+
+            case Batch::COMMAND_setInputFormat:
+                if (batch._streamFormats.get(params[0]._uint)) {
+                    _stats._ISNumFormatChanges++;
+                }
+                break;
+
+            case Batch::COMMAND_setInputBuffer:
+                if (batch._buffers.get(params[2]._uint)) {
+                    _stats._ISNumInputBufferChanges++;
+                }
+                break;
+
+            case Batch::COMMAND_setIndexBuffer:
+                if (batch._buffers.get(params[1]._uint)) {
+                    _stats._ISNumIndexBufferChanges++;
+                }
+                break;
+
+            case Batch::COMMAND_setViewTransform:
+                batch._transforms.get(params[0]._uint).getMatrix(_view);
+                break;
+
+            case Batch::COMMAND_setProjectionTransform: {
+                const Batch::Byte* data = batch.readData(params[0]._uint);
+                if (data) {
+                    memcpy(&_projection, data, sizeof(Mat4));
+                }
+                break;
+            }
+
+            case Batch::COMMAND_setPipeline:
+                if (batch._pipelines.get(params[0]._uint)) {
+                    _stats._PSNumSetPipelines++;
+                }
+                break;
+
+            case Batch::COMMAND_setResourceTexture: {
+                TexturePointer texture = batch._textures.get(params[0]._uint);
+                if (texture) {
+                    _stats._RSNumTextureBounded++;
+                    _stats._RSAmountTextureMemoryBounded += (int)texture->getSize();
+                }
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    _stereo._enable = savedStereo;
+}
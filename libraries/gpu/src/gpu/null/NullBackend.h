@@ -27,7 +27,7 @@ class Backend : public gpu::Backend {
     // Context Backend static interface required
     friend class gpu::Context;
     static void init() {}
-    static gpu::Backend* createBackend() { return new Backend(); }
+    static BackendPointer createBackend() { return BackendPointer(new Backend()); }
     static bool makeProgram(Shader& shader, const Shader::BindingSet& slotBindings) { return true; }
 
 protected:
@@ -36,7 +36,9 @@ protected:
 public:
     ~Backend() { }
 
-    void render(const Batch& batch) final { }
+    // Walks the commands and resolves their cached objects like the GL backend does, without any GL calls, so
+    // the cost of the command translation can be measured on machines without a GPU
+    void render(const Batch& batch) final;
 
     // This call synchronize the Full Backend cache with the current GLState
     // THis is only intended to be used when mixing raw gl calls with the gpu api usage in order to sync
@@ -47,6 +49,15 @@ public:
     // This is the ugly "download the pixels to sysmem for taking a snapshot"
     // Just avoid using it, it's ugly and will break performances
     virtual void downloadFramebuffer(const FramebufferPointer& srcFramebuffer, const Vec4i& region, QImage& destImage) final { }
+
+    void recycle() const final { }
+    bool isTextureManagementSparseEnabled() const final { return false; }
+
+protected:
+    void countDraws(uint32 numDraws, uint32 numTriangles);
+
+    Mat4 _view;
+    Mat4 _projection;
 };
 
 } }
@@ -0,0 +1,775 @@
+//
+//  BlockCompression.cpp
+//  ktx/src/ktx
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+#include "BlockCompression.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+using namespace ktx;
+using namespace ktx::block;
+
+namespace {
+
+    const uint32_t NUM_CHANNELS { 4 };
+    const uint32_t BLOCK_TEXELS_BYTE_SIZE { BLOCK_TEXEL_COUNT * NUM_CHANNELS };
+
+    // Number of rows of blocks a worker thread takes at a time, below that threading is not worth it
+    const uint32_t MIN_BLOCK_ROWS_PER_THREAD { 8 };
+
+    inline uint8_t clampToByte(float value) {
+        return (uint8_t)std::min(255.0f, std::max(0.0f, value + 0.5f));
+    }
+
+    inline uint32_t evalSquaredDistance(const Byte* a, const Byte* b, uint32_t numChannels) {
+        uint32_t result = 0;
+        for (uint32_t c = 0; c < numChannels; ++c) {
+            int delta = (int)a[c] - (int)b[c];
+            result += (uint32_t)(delta * delta);
+        }
+        return result;
+    }
+
+    inline void writeUint16(Byte* dest, uint16_t value) {
+        dest[0] = (Byte)(value & 0xFF);
+        dest[1] = (Byte)(value >> 8);
+    }
+
+    inline uint16_t readUint16(const Byte* src) {
+        return (uint16_t)(src[0] | (src[1] << 8));
+    }
+
+    // Find the principal axis of a set of texels with a few power iterations over the covariance matrix.
+    // Texels are considered over the first numChannels channels only, mask allows to skip texels.
+    void evalPrincipalAxis(const Byte* texels, uint32_t numChannels, const bool* mask,
+                           float* mean, float* axis, float& minProj, float& maxProj) {
+        float covariance[NUM_CHANNELS][NUM_CHANNELS] = {};
+        uint32_t count = 0;
+        std::fill(mean, mean + NUM_CHANNELS, 0.0f);
+        for (uint32_t i = 0; i < BLOCK_TEXEL_COUNT; ++i) {
+            if (!mask || mask[i]) {
+                for (uint32_t c = 0; c < numChannels; ++c) {
+                    mean[c] += texels[i * NUM_CHANNELS + c];
+                }
+                ++count;
+            }
+        }
+        if (count == 0) {
+            std::fill(axis, axis + NUM_CHANNELS, 0.0f);
+            minProj = maxProj = 0.0f;
+            return;
+        }
+        for (uint32_t c = 0; c < numChannels; ++c) {
+            mean[c] /= (float)count;
+        }
+
+        for (uint32_t i = 0; i < BLOCK_TEXEL_COUNT; ++i) {
+            if (!mask || mask[i]) {
+                float delta[NUM_CHANNELS];
+                for (uint32_t c = 0; c < numChannels; ++c) {
+                    delta[c] = texels[i * NUM_CHANNELS + c] - mean[c];
+                }
+                for (uint32_t r = 0; r < numChannels; ++r) {
+                    for (uint32_t c = 0; c < numChannels; ++c) {
+                        covariance[r][c] += delta[r] * delta[c];
+                    }
+                }
+            }
+        }
+
+        // Start from the diagonal, it converges quickly for the usual color gradients
+        for (uint32_t c = 0; c < numChannels; ++c) {
+            axis[c] = 1.0f;
+        }
+        const int NUM_POWER_ITERATIONS = 8;
+        for (int iteration = 0; iteration < NUM_POWER_ITERATIONS; ++iteration) {
+            float next[NUM_CHANNELS] = {};
+            float length = 0.0f;
+            for (uint32_t r = 0; r < numChannels; ++r) {
+                for (uint32_t c = 0; c < numChannels; ++c) {
+                    next[r] += covariance[r][c] * axis[c];
+                }
+                length = std::max(length, std::abs(next[r]));
+            }
+            if (length < 1.0e-6f) {
+                break;
+            }
+            for (uint32_t c = 0; c < numChannels; ++c) {
+                axis[c] = next[c] / length;
+            }
+        }
+        float norm = 0.0f;
+        for (uint32_t c = 0; c < numChannels; ++c) {
+            norm += axis[c] * axis[c];
+        }
+        norm = std::sqrt(norm);
+        for (uint32_t c = 0; c < numChannels; ++c) {
+            axis[c] = (norm > 0.0f ? axis[c] / norm : 0.0f);
+        }
+
+        minProj = std::numeric_limits<float>::max();
+        maxProj = -std::numeric_limits<float>::max();
+        for (uint32_t i = 0; i < BLOCK_TEXEL_COUNT; ++i) {
+            if (!mask || mask[i]) {
+                float proj = 0.0f;
+                for (uint32_t c = 0; c < numChannels; ++c) {
+                    proj += (texels[i * NUM_CHANNELS + c] - mean[c]) * axis[c];
+                }
+                minProj = std::min(minProj, proj);
+                maxProj = std::max(maxProj, proj);
+            }
+        }
+    }
+
+    //
+    // BC1 color block, also the color part of BC3
+    //
+
+    inline uint16_t packRGB565(const Byte* rgb) {
+        uint16_t r = (uint16_t)((rgb[0] * 31 + 127) / 255);
+        uint16_t g = (uint16_t)((rgb[1] * 63 + 127) / 255);
+        uint16_t b = (uint16_t)((rgb[2] * 31 + 127) / 255);
+        return (uint16_t)((r << 11) | (g << 5) | b);
+    }
+
+    inline void unpackRGB565(uint16_t packed, Byte* rgba) {
+        uint8_t r = (packed >> 11) & 0x1F;
+        uint8_t g = (packed >> 5) & 0x3F;
+        uint8_t b = packed & 0x1F;
+        rgba[0] = (Byte)((r << 3) | (r >> 2));
+        rgba[1] = (Byte)((g << 2) | (g >> 4));
+        rgba[2] = (Byte)((b << 3) | (b >> 2));
+        rgba[3] = 255;
+    }
+
+    void evalColorPalette(uint16_t color0, uint16_t color1, bool alwaysFourColors, Byte palette[4][NUM_CHANNELS]) {
+        unpackRGB565(color0, palette[0]);
+        unpackRGB565(color1, palette[1]);
+        if (alwaysFourColors || color0 > color1) {
+            for (uint32_t c = 0; c < 3; ++c) {
+                palette[2][c] = (Byte)((2 * palette[0][c] + palette[1][c] + 1) / 3);
+                palette[3][c] = (Byte)((palette[0][c] + 2 * palette[1][c] + 1) / 3);
+            }
+            palette[2][3] = palette[3][3] = 255;
+        } else {
+            for (uint32_t c = 0; c < 3; ++c) {
+                palette[2][c] = (Byte)((palette[0][c] + palette[1][c]) / 2);
+                palette[3][c] = 0;
+            }
+            palette[2][3] = 255;
+            palette[3][3] = 0;
+        }
+    }
+
+    void compressColorBlock(const Byte* texels, Byte* dest, bool allowAlpha) {
+        bool opaque[BLOCK_TEXEL_COUNT];
+        bool hasTransparent = false;
+        for (uint32_t i = 0; i < BLOCK_TEXEL_COUNT; ++i) {
+            opaque[i] = !allowAlpha || (texels[i * NUM_CHANNELS + 3] >= 128);
+            hasTransparent = hasTransparent || !opaque[i];
+        }
+
+        float mean[NUM_CHANNELS];
+        float axis[NUM_CHANNELS];
+        float minProj, maxProj;
+        evalPrincipalAxis(texels, 3, opaque, mean, axis, minProj, maxProj);
+
+        Byte endpoint0[NUM_CHANNELS];
+        Byte endpoint1[NUM_CHANNELS];
+        for (uint32_t c = 0; c < 3; ++c) {
+            endpoint0[c] = clampToByte(mean[c] + axis[c] * maxProj);
+            endpoint1[c] = clampToByte(mean[c] + axis[c] * minProj);
+        }
+        uint16_t color0 = packRGB565(endpoint0);
+        uint16_t color1 = packRGB565(endpoint1);
+
+        // Four colors mode is selected with color0 > color1, three colors + transparent with color0 <= color1
+        if (hasTransparent ? (color0 > color1) : (color0 < color1)) {
+            std::swap(color0, color1);
+        }
+
+        Byte palette[4][NUM_CHANNELS];
+        evalColorPalette(color0, color1, !allowAlpha, palette);
+        const uint32_t numOpaqueEntries = (!allowAlpha || color0 > color1) ? 4 : 3;
+
+        uint32_t indices = 0;
+        for (uint32_t i = 0; i < BLOCK_TEXEL_COUNT; ++i) {
+            uint32_t bestIndex = 3;
+            if (opaque[i]) {
+                uint32_t bestError = std::numeric_limits<uint32_t>::max();
+                for (uint32_t p = 0; p < numOpaqueEntries; ++p) {
+                    uint32_t error = evalSquaredDistance(texels + i * NUM_CHANNELS, palette[p], 3);
+                    if (error < bestError) {
+                        bestError = error;
+                        bestIndex = p;
+                    }
+                }
+            }
+            indices |= bestIndex << (2 * i);
+        }
+
+        writeUint16(dest, color0);
+        writeUint16(dest + 2, color1);
+        for (uint32_t b = 0; b < 4; ++b) {
+            dest[4 + b] = (Byte)((indices >> (8 * b)) & 0xFF);
+        }
+    }
+
+    void decompressColorBlock(const Byte* src, Byte* texels, bool allowAlpha) {
+        uint16_t color0 = readUint16(src);
+        uint16_t color1 = readUint16(src + 2);
+        Byte palette[4][NUM_CHANNELS];
+        evalColorPalette(color0, color1, !allowAlpha, palette);
+        uint32_t indices = src[4] | (src[5] << 8) | (src[6] << 16) | ((uint32_t)src[7] << 24);
+        for (uint32_t i = 0; i < BLOCK_TEXEL_COUNT; ++i) {
+            const Byte* color = palette[(indices >> (2 * i)) & 0x3];
+            std::copy(color, color + NUM_CHANNELS, texels + i * NUM_CHANNELS);
+        }
+    }
+
+    //
+    // BC4 single channel block, used for BC3 alpha, BC4 and BC5
+    //
+
+    void evalChannelPalette(uint8_t value0, uint8_t value1, uint8_t palette[8]) {
+        palette[0] = value0;
+        palette[1] = value1;
+        if (value0 > value1) {
+            for (uint32_t i = 2; i < 8; ++i) {
+                palette[i] = (uint8_t)(((8 - i) * value0 + (i - 1) * value1 + 3) / 7);
+            }
+        } else {
+            for (uint32_t i = 2; i < 6; ++i) {
+                palette[i] = (uint8_t)(((6 - i) * value0 + (i - 1) * value1 + 2) / 5);
+            }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    void compressChannelBlock(const Byte* texels, uint32_t channel, Byte* dest) {
+        uint8_t minValue = 255;
+        uint8_t maxValue = 0;
+        for (uint32_t i = 0; i < BLOCK_TEXEL_COUNT; ++i) {
+            uint8_t value = texels[i * NUM_CHANNELS + channel];
+            minValue = std::min(minValue, value);
+            maxValue = std::max(maxValue, value);
+        }
+
+        // Eight values interpolation mode requires value0 > value1, a flat block ends up in the six values mode
+        uint8_t palette[8];
+        evalChannelPalette(maxValue, minValue, palette);
+
+        uint64_t indices = 0;
+        for (uint32_t i = 0; i < BLOCK_TEXEL_COUNT; ++i) {
+            int value = texels[i * NUM_CHANNELS + channel];
+            uint64_t bestIndex = 0;
+            int bestError = std::numeric_limits<int>::max();
+            for (uint32_t p = 0; p < 8; ++p) {
+                int error = std::abs(value - (int)palette[p]);
+                if (error < bestError) {
+                    bestError = error;
+                    bestIndex = p;
+                }
+            }
+            indices |= bestIndex << (3 * i);
+        }
+
+        dest[0] = maxValue;
+        dest[1] = minValue;
+        for (uint32_t b = 0; b < 6; ++b) {
+            dest[2 + b] = (Byte)((indices >> (8 * b)) & 0xFF);
+        }
+    }
+
+    void decompressChannelBlock(const Byte* src, uint32_t channel, Byte* texels) {
+        uint8_t palette[8];
+        evalChannelPalette(src[0], src[1], palette);
+        uint64_t indices = 0;
+        for (uint32_t b = 0; b < 6; ++b) {
+            indices |= ((uint64_t)src[2 + b]) << (8 * b);
+        }
+        for (uint32_t i = 0; i < BLOCK_TEXEL_COUNT; ++i) {
+            texels[i * NUM_CHANNELS + channel] = palette[(indices >> (3 * i)) & 0x7];
+        }
+    }
+
+    //
+    // BC7 mode 6 block: one subset, RGBA 7 bits endpoints + unique p-bit, 4 bits indices
+    //
+
+    const uint32_t BC7_MODE6 { 6 };
+    const uint32_t BC7_MODE6_ENDPOINT_BITS { 7 };
+    const uint32_t BC7_MODE6_INDEX_BITS { 4 };
+    const uint32_t BC7_MODE6_NUM_INDICES { 1 << BC7_MODE6_INDEX_BITS };
+    const uint32_t BC7_WEIGHTS4[BC7_MODE6_NUM_INDICES] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+
+    class BitWriter {
+    public:
+        BitWriter(Byte* dest) : _dest(dest) { std::fill(_dest, _dest + 16, 0); }
+        void write(uint32_t value, uint32_t numBits) {
+            for (uint32_t b = 0; b < numBits; ++b, ++_position) {
+                _dest[_position >> 3] |= (Byte)(((value >> b) & 1) << (_position & 7));
+            }
+        }
+    private:
+        Byte* _dest;
+        uint32_t _position { 0 };
+    };
+
+    class BitReader {
+    public:
+        BitReader(const Byte* src) : _src(src) {}
+        uint32_t read(uint32_t numBits) {
+            uint32_t value = 0;
+            for (uint32_t b = 0; b < numBits; ++b, ++_position) {
+                value |= ((_src[_position >> 3] >> (_position & 7)) & 1) << b;
+            }
+            return value;
+        }
+    private:
+        const Byte* _src;
+        uint32_t _position { 0 };
+    };
+
+    inline Byte interpolateBC7(Byte value0, Byte value1, uint32_t index) {
+        uint32_t weight = BC7_WEIGHTS4[index];
+        return (Byte)(((64 - weight) * value0 + weight * value1 + 32) >> 6);
+    }
+
+    // Quantize an endpoint to 7 bits per channel plus the p-bit shared by all the channels
+    void quantizeEndpointBC7(const float* endpoint, uint8_t* quantized, uint8_t& pBit) {
+        float bestError = std::numeric_limits<float>::max();
+        for (uint8_t p = 0; p < 2; ++p) {
+            uint8_t candidate[NUM_CHANNELS];
+            float error = 0.0f;
+            for (uint32_t c = 0; c < NUM_CHANNELS; ++c) {
+                float value = std::round((endpoint[c] - p) * 0.5f);
+                candidate[c] = (uint8_t)std::min(127.0f, std::max(0.0f, value));
+                float delta = (float)((candidate[c] << 1) | p) - endpoint[c];
+                error += delta * delta;
+            }
+            if (error < bestError) {
+                bestError = error;
+                pBit = p;
+                std::copy(candidate, candidate + NUM_CHANNELS, quantized);
+            }
+        }
+    }
+
+    void compressBlockBC7(const Byte* texels, Byte* dest) {
+        float mean[NUM_CHANNELS];
+        float axis[NUM_CHANNELS];
+        float minProj, maxProj;
+        evalPrincipalAxis(texels, NUM_CHANNELS, nullptr, mean, axis, minProj, maxProj);
+
+        float endpoints[2][NUM_CHANNELS];
+        for (uint32_t c = 0; c < NUM_CHANNELS; ++c) {
+            endpoints[0][c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * minProj));
+            endpoints[1][c] = std::min(255.0f, std::max(0.0f, mean[c] + axis[c] * maxProj));
+        }
+
+        uint8_t quantized[2][NUM_CHANNELS];
+        uint8_t pBits[2];
+        Byte unquantized[2][NUM_CHANNELS];
+        for (uint32_t e = 0; e < 2; ++e) {
+            quantizeEndpointBC7(endpoints[e], quantized[e], pBits[e]);
+            for (uint32_t c = 0; c < NUM_CHANNELS; ++c) {
+                unquantized[e][c] = (Byte)((quantized[e][c] << 1) | pBits[e]);
+            }
+        }
+
+        Byte palette[BC7_MODE6_NUM_INDICES][NUM_CHANNELS];
+        for (uint32_t i = 0; i < BC7_MODE6_NUM_INDICES; ++i) {
+            for (uint32_t c = 0; c < NUM_CHANNELS; ++c) {
+                palette[i][c] = interpolateBC7(unquantized[0][c], unquantized[1][c], i);
+            }
+        }
+
+        uint8_t indices[BLOCK_TEXEL_COUNT];
+        for (uint32_t i = 0; i < BLOCK_TEXEL_COUNT; ++i) {
+            uint32_t bestError = std::numeric_limits<uint32_t>::max();
+            for (uint32_t p = 0; p < BC7_MODE6_NUM_INDICES; ++p) {
+                uint32_t error = evalSquaredDistance(texels + i * NUM_CHANNELS, palette[p], NUM_CHANNELS);
+                if (error < bestError) {
+                    bestError = error;
+                    indices[i] = (uint8_t)p;
+                }
+            }
+        }
+
+        // The anchor index (texel 0) is stored with its most significant bit implied to 0
+        if (indices[0] & (BC7_MODE6_NUM_INDICES >> 1)) {
+            std::swap(quantized[0], quantized[1]);
+            std::swap(pBits[0], pBits[1]);
+            for (uint32_t i = 0; i < BLOCK_TEXEL_COUNT; ++i) {
+                indices[i] = (uint8_t)(BC7_MODE6_NUM_INDICES - 1 - indices[i]);
+            }
+        }
+
+        BitWriter writer(dest);
+        writer.write(1 << BC7_MODE6, BC7_MODE6 + 1);
+        for (uint32_t c = 0; c < NUM_CHANNELS; ++c) {
+            writer.write(quantized[0][c], BC7_MODE6_ENDPOINT_BITS);
+            writer.write(quantized[1][c], BC7_MODE6_ENDPOINT_BITS);
+        }
+        writer.write(pBits[0], 1);
+        writer.write(pBits[1], 1);
+        writer.write(indices[0], BC7_MODE6_INDEX_BITS - 1);
+        for (uint32_t i = 1; i < BLOCK_TEXEL_COUNT; ++i) {
+            writer.write(indices[i], BC7_MODE6_INDEX_BITS);
+        }
+    }
+
+    bool decompressBlockBC7(const Byte* src, Byte* texels) {
+        BitReader reader(src);
+        if (reader.read(BC7_MODE6 + 1) != (1u << BC7_MODE6)) {
+            return false;
+        }
+        Byte endpoints[2][NUM_CHANNELS];
+        for (uint32_t c = 0; c < NUM_CHANNELS; ++c) {
+            endpoints[0][c] = (Byte)(reader.read(BC7_MODE6_ENDPOINT_BITS) << 1);
+            endpoints[1][c] = (Byte)(reader.read(BC7_MODE6_ENDPOINT_BITS) << 1);
+        }
+        for (uint32_t e = 0; e < 2; ++e) {
+            uint32_t pBit = reader.read(1);
+            for (uint32_t c = 0; c < NUM_CHANNELS; ++c) {
+                endpoints[e][c] |= pBit;
+            }
+        }
+        for (uint32_t i = 0; i < BLOCK_TEXEL_COUNT; ++i) {
+            uint32_t index = reader.read(i == 0 ? BC7_MODE6_INDEX_BITS - 1 : BC7_MODE6_INDEX_BITS);
+            for (uint32_t c = 0; c < NUM_CHANNELS; ++c) {
+                texels[i * NUM_CHANNELS + c] = interpolateBC7(endpoints[0][c], endpoints[1][c], index);
+            }
+        }
+        return true;
+    }
+
+    // Gather a 4x4 block as RGBA, replicating the last row / column for the partial blocks on the edges
+    void loadBlock(uint32_t width, uint32_t height, const Byte* srcTexels, TexelOrder srcOrder,
+                   uint32_t blockX, uint32_t blockY, Byte* block) {
+        for (uint32_t y = 0; y < BLOCK_DIM; ++y) {
+            uint32_t srcY = std::min(blockY * BLOCK_DIM + y, height - 1);
+            for (uint32_t x = 0; x < BLOCK_DIM; ++x) {
+                uint32_t srcX = std::min(blockX * BLOCK_DIM + x, width - 1);
+                const Byte* texel = srcTexels + (srcY * width + srcX) * NUM_CHANNELS;
+                Byte* dest = block + (y * BLOCK_DIM + x) * NUM_CHANNELS;
+                if (srcOrder == TexelOrder::BGRA) {
+                    dest[0] = texel[2];
+                    dest[1] = texel[1];
+                    dest[2] = texel[0];
+                    dest[3] = texel[3];
+                } else {
+                    std::copy(texel, texel + NUM_CHANNELS, dest);
+                }
+            }
+        }
+    }
+
+    void compressBlockRows(BlockFormat format, uint32_t width, uint32_t height, const Byte* srcTexels, TexelOrder srcOrder,
+                           Byte* dest, uint32_t firstRow, uint32_t endRow) {
+        const uint32_t numBlocksX = evalBlockCount(width);
+        const uint32_t blockSize = evalBlockByteSize(format);
+        Byte block[BLOCK_TEXELS_BYTE_SIZE];
+        for (uint32_t blockY = firstRow; blockY < endRow; ++blockY) {
+            Byte* destRow = dest + (size_t)blockY * numBlocksX * blockSize;
+            for (uint32_t blockX = 0; blockX < numBlocksX; ++blockX) {
+                loadBlock(width, height, srcTexels, srcOrder, blockX, blockY, block);
+                compressBlock(format, block, destRow + blockX * blockSize);
+            }
+        }
+    }
+
+    // One 2D image to compress, a face of a mip for a KTX
+    struct ImageJob {
+        uint32_t width;
+        uint32_t height;
+        const Byte* srcTexels;
+        Byte* dest;
+    };
+
+    // Splits the images in slices of rows of blocks that one set of workers takes in turn, so a whole mip chain
+    // only starts threads once and the small mips don't leave workers idle
+    void compressImages(BlockFormat format, const std::vector<ImageJob>& jobs, TexelOrder srcOrder, uint32_t numThreads) {
+        struct Slice {
+            size_t job;
+            uint32_t firstRow;
+            uint32_t endRow;
+        };
+        std::vector<Slice> slices;
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            const uint32_t numBlockRows = evalBlockCount(jobs[i].height);
+            for (uint32_t row = 0; row < numBlockRows; row += MIN_BLOCK_ROWS_PER_THREAD) {
+                slices.push_back({ i, row, std::min(row + MIN_BLOCK_ROWS_PER_THREAD, numBlockRows) });
+            }
+        }
+
+        std::atomic<size_t> nextSlice { 0 };
+        auto work = [&] {
+            for (size_t i = nextSlice++; i < slices.size(); i = nextSlice++) {
+                const Slice& slice = slices[i];
+                const ImageJob& job = jobs[slice.job];
+                compressBlockRows(format, job.width, job.height, job.srcTexels, srcOrder, job.dest,
+                                  slice.firstRow, slice.endRow);
+            }
+        };
+
+        if (numThreads == 0) {
+            numThreads = std::max(std::thread::hardware_concurrency(), 1U);
+        }
+        numThreads = (uint32_t)std::min((size_t)numThreads, std::max(slices.size(), (size_t)1));
+        std::vector<std::thread> workers;
+        workers.reserve(numThreads - 1);
+        for (uint32_t t = 1; t < numThreads; ++t) {
+            workers.emplace_back(work);
+        }
+        // The calling thread takes slices too
+        work();
+        for (auto& worker : workers) {
+            worker.join();
+        }
+    }
+}
+
+uint32_t block::evalBlockByteSize(BlockFormat format) {
+    switch (format) {
+        case BlockFormat::BC1:
+        case BlockFormat::BC4:
+            return 8;
+        case BlockFormat::BC3:
+        case BlockFormat::BC5:
+        case BlockFormat::BC7:
+            return 16;
+        default:
+            return 0;
+    }
+}
+
+uint32_t block::evalBlockCount(uint32_t pixelSize) {
+    return (std::max(pixelSize, 1U) + BLOCK_DIM - 1) / BLOCK_DIM;
+}
+
+size_t block::evalCompressedSize(BlockFormat format, uint32_t width, uint32_t height) {
+    return (size_t)evalBlockCount(width) * evalBlockCount(height) * evalBlockByteSize(format);
+}
+
+void block::setHeaderFormat(Header& header, BlockFormat format, bool srgb) {
+    switch (format) {
+        case BlockFormat::BC1:
+            header.setCompressed(srgb ? GLInternalFormat_Compressed::COMPRESSED_SRGB_ALPHA_S3TC_DXT1 : GLInternalFormat_Compressed::COMPRESSED_RGBA_S3TC_DXT1,
+                                 GLBaseInternalFormat::RGBA);
+            break;
+        case BlockFormat::BC3:
+            header.setCompressed(srgb ? GLInternalFormat_Compressed::COMPRESSED_SRGB_ALPHA_S3TC_DXT5 : GLInternalFormat_Compressed::COMPRESSED_RGBA_S3TC_DXT5,
+                                 GLBaseInternalFormat::RGBA);
+            break;
+        case BlockFormat::BC4:
+            header.setCompressed(GLInternalFormat_Compressed::COMPRESSED_RED_RGTC1, GLBaseInternalFormat::RED);
+            break;
+        case BlockFormat::BC5:
+            header.setCompressed(GLInternalFormat_Compressed::COMPRESSED_RG_RGTC2, GLBaseInternalFormat::RG);
+            break;
+        case BlockFormat::BC7:
+            header.setCompressed(srgb ? GLInternalFormat_Compressed::COMPRESSED_SRGB_ALPHA_BPTC_UNORM : GLInternalFormat_Compressed::COMPRESSED_RGBA_BPTC_UNORM,
+                                 GLBaseInternalFormat::RGBA);
+            break;
+        default:
+            break;
+    }
+}
+
+bool block::evalBlockFormat(const Header& header, BlockFormat& format) {
+    if (header.getGLType() != GLType::COMPRESSED_TYPE) {
+        return false;
+    }
+    switch (header.getGLInternaFormat_Compressed()) {
+        case GLInternalFormat_Compressed::COMPRESSED_RGB_S3TC_DXT1:
+        case GLInternalFormat_Compressed::COMPRESSED_RGBA_S3TC_DXT1:
+        case GLInternalFormat_Compressed::COMPRESSED_SRGB_S3TC_DXT1:
+        case GLInternalFormat_Compressed::COMPRESSED_SRGB_ALPHA_S3TC_DXT1:
+            format = BlockFormat::BC1;
+            return true;
+        case GLInternalFormat_Compressed::COMPRESSED_RGBA_S3TC_DXT5:
+        case GLInternalFormat_Compressed::COMPRESSED_SRGB_ALPHA_S3TC_DXT5:
+            format = BlockFormat::BC3;
+            return true;
+        case GLInternalFormat_Compressed::COMPRESSED_RED_RGTC1:
+            format = BlockFormat::BC4;
+            return true;
+        case GLInternalFormat_Compressed::COMPRESSED_RG_RGTC2:
+            format = BlockFormat::BC5;
+            return true;
+        case GLInternalFormat_Compressed::COMPRESSED_RGBA_BPTC_UNORM:
+        case GLInternalFormat_Compressed::COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+            format = BlockFormat::BC7;
+            return true;
+        default:
+            return false;
+    }
+}
+
+void block::compressBlock(BlockFormat format, const Byte* rgbaBlock, Byte* dest) {
+    switch (format) {
+        case BlockFormat::BC1:
+            compressColorBlock(rgbaBlock, dest, true);
+            break;
+        case BlockFormat::BC3:
+            compressChannelBlock(rgbaBlock, 3, dest);
+            compressColorBlock(rgbaBlock, dest + 8, false);
+            break;
+        case BlockFormat::BC4:
+            compressChannelBlock(rgbaBlock, 0, dest);
+            break;
+        case BlockFormat::BC5:
+            compressChannelBlock(rgbaBlock, 0, dest);
+            compressChannelBlock(rgbaBlock, 1, dest + 8);
+            break;
+        case BlockFormat::BC7:
+            compressBlockBC7(rgbaBlock, dest);
+            break;
+        default:
+            break;
+    }
+}
+
+bool block::decompressBlock(BlockFormat format, const Byte* src, Byte* rgbaBlock) {
+    switch (format) {
+        case BlockFormat::BC1:
+            decompressColorBlock(src, rgbaBlock, true);
+            return true;
+        case BlockFormat::BC3:
+            decompressColorBlock(src + 8, rgbaBlock, false);
+            decompressChannelBlock(src, 3, rgbaBlock);
+            return true;
+        case BlockFormat::BC4:
+        case BlockFormat::BC5:
+            for (uint32_t i = 0; i < BLOCK_TEXEL_COUNT; ++i) {
+                rgbaBlock[i * NUM_CHANNELS + 1] = 0;
+                rgbaBlock[i * NUM_CHANNELS + 2] = 0;
+                rgbaBlock[i * NUM_CHANNELS + 3] = 255;
+            }
+            decompressChannelBlock(src, 0, rgbaBlock);
+            if (format == BlockFormat::BC5) {
+                decompressChannelBlock(src + 8, 1, rgbaBlock);
+            }
+            return true;
+        case BlockFormat::BC7:
+            return decompressBlockBC7(src, rgbaBlock);
+        default:
+            return false;
+    }
+}
+
+void block::compressImage(BlockFormat format, uint32_t width, uint32_t height, const Byte* srcTexels, TexelOrder srcOrder,
+                          Byte* dest, uint32_t numThreads) {
+    if (!srcTexels || !dest || width == 0 || height == 0) {
+        return;
+    }
+    compressImages(format, { { width, height, srcTexels, dest } }, srcOrder, numThreads);
+}
+
+bool block::decompressImage(BlockFormat format, uint32_t width, uint32_t height, const Byte* src, Byte* destRGBA) {
+    const uint32_t numBlocksX = evalBlockCount(width);
+    const uint32_t numBlocksY = evalBlockCount(height);
+    const uint32_t blockSize = evalBlockByteSize(format);
+    Byte block[BLOCK_TEXELS_BYTE_SIZE];
+    for (uint32_t blockY = 0; blockY < numBlocksY; ++blockY) {
+        for (uint32_t blockX = 0; blockX < numBlocksX; ++blockX) {
+            if (!decompressBlock(format, src + ((size_t)blockY * numBlocksX + blockX) * blockSize, block)) {
+                return false;
+            }
+            for (uint32_t y = 0; y < BLOCK_DIM && (blockY * BLOCK_DIM + y) < height; ++y) {
+                for (uint32_t x = 0; x < BLOCK_DIM && (blockX * BLOCK_DIM + x) < width; ++x) {
+                    const Byte* texel = block + (y * BLOCK_DIM + x) * NUM_CHANNELS;
+                    Byte* dest = destRGBA + ((size_t)(blockY * BLOCK_DIM + y) * width + blockX * BLOCK_DIM + x) * NUM_CHANNELS;
+                    std::copy(texel, texel + NUM_CHANNELS, dest);
+                }
+            }
+        }
+    }
+    return true;
+}
+
+std::unique_ptr<KTX> ktx::compressKTX(const KTX& src, BlockFormat format, bool srgb, const KeyValues& keyValues,
+                                      uint32_t numThreads) {
+    const auto& srcHeader = src.getHeader();
+    if (srcHeader.getGLType() != GLType::UNSIGNED_BYTE || srcHeader.getTypeSize() != 1) {
+        return nullptr;
+    }
+    TexelOrder srcOrder;
+    if (srcHeader.getGLFormat() == GLFormat::RGBA) {
+        srcOrder = TexelOrder::RGBA;
+    } else if (srcHeader.getGLFormat() == GLFormat::BGRA) {
+        srcOrder = TexelOrder::BGRA;
+    } else {
+        return nullptr;
+    }
+    // Only plain 2D textures and cube maps
+    if (srcHeader.pixelDepth > 1 || srcHeader.numberOfArrayElements > 0 || src._images.empty()) {
+        return nullptr;
+    }
+
+    Header header = srcHeader;
+    block::setHeaderFormat(header, format, srgb);
+    header.numberOfMipmapLevels = (uint32_t)src._images.size();
+
+    // Evaluate the layout of the compressed KTX, cube faces of a mip are contiguous and the image size covers all of them
+    // (same as KTX::writeImages)
+    const uint32_t numFaces = src._images[0]._numFaces;
+    std::vector<size_t> faceSizes;
+    size_t storageSize = sizeof(Header) + KeyValue::serializedKeyValuesByteSize(keyValues);
+    for (uint32_t level = 0; level < header.numberOfMipmapLevels; ++level) {
+        const auto& srcImage = src._images[level];
+        auto width = header.evalPixelWidth(level);
+        auto height = header.evalPixelHeight(level);
+        if (srcImage._numFaces != numFaces || srcImage._faceSize < (size_t)width * height * NUM_CHANNELS) {
+            return nullptr;
+        }
+        faceSizes.push_back(block::evalCompressedSize(format, width, height));
+        size_t imageSize = faceSizes.back() * numFaces;
+        storageSize += sizeof(uint32_t) + imageSize + Header::evalPadding(imageSize);
+    }
+
+    // Compress straight into the final storage
+    auto memoryStorage = new storage::MemoryStorage(storageSize);
+    StoragePointer storagePointer { memoryStorage };
+    Byte* currentPtr = memoryStorage->data();
+
+    auto destHeader = reinterpret_cast<Header*>(currentPtr);
+    memcpy(currentPtr, &header, sizeof(Header));
+    currentPtr += sizeof(Header);
+
+    destHeader->bytesOfKeyValueData = (uint32_t)KTX::writeKeyValues(currentPtr, storageSize - sizeof(Header), keyValues);
+    currentPtr += destHeader->bytesOfKeyValueData;
+
+    // Lay out the images, then compress every face of every mip with one set of workers
+    std::vector<ImageJob> jobs;
+    for (uint32_t level = 0; level < header.numberOfMipmapLevels; ++level) {
+        const auto& srcImage = src._images[level];
+        auto width = header.evalPixelWidth(level);
+        auto height = header.evalPixelHeight(level);
+        uint32_t imageSize = (uint32_t)(faceSizes[level] * numFaces);
+        memcpy(currentPtr, &imageSize, sizeof(uint32_t));
+        currentPtr += sizeof(uint32_t);
+        for (uint32_t face = 0; face < numFaces; ++face) {
+            jobs.push_back({ width, height, srcImage._faceBytes[face], currentPtr });
+            currentPtr += faceSizes[level];
+        }
+        auto padding = Header::evalPadding(imageSize);
+        memset(currentPtr, 0, padding);
+        currentPtr += padding;
+    }
+    compressImages(format, jobs, srcOrder, numThreads);
+
+    return KTX::create(storagePointer);
+}
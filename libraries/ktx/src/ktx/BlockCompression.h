@@ -0,0 +1,75 @@
+//
+//  BlockCompression.h
+//  ktx/src/ktx
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+#pragma once
+#ifndef hifi_ktx_BlockCompression_h
+#define hifi_ktx_BlockCompression_h
+
+#include "KTX.h"
+
+namespace ktx {
+
+    // The block compressed formats the CPU encoder knows how to produce.
+    // All of them work on 4x4 texel blocks.
+    enum class BlockFormat : uint8_t {
+        BC1 = 0,    // RGB + 1 bit alpha, 8 bytes per block (DXT1)
+        BC3,        // RGBA, 16 bytes per block (DXT5)
+        BC4,        // R, 8 bytes per block (RGTC1)
+        BC5,        // RG, 16 bytes per block (RGTC2)
+        BC7,        // RGBA, 16 bytes per block (BPTC), mode 6 only
+
+        NUM_BLOCK_FORMATS,
+    };
+
+    namespace block {
+        const uint32_t BLOCK_DIM { 4 };
+        const uint32_t BLOCK_TEXEL_COUNT { BLOCK_DIM * BLOCK_DIM };
+
+        // Byte order of the 32 bits source texels fed to the encoder
+        enum class TexelOrder : uint8_t {
+            RGBA = 0,
+            BGRA,
+        };
+
+        uint32_t evalBlockByteSize(BlockFormat format);
+        uint32_t evalBlockCount(uint32_t pixelSize);
+        size_t evalCompressedSize(BlockFormat format, uint32_t width, uint32_t height);
+
+        // Configure the header to describe the compressed format, dimensions are left untouched
+        void setHeaderFormat(Header& header, BlockFormat format, bool srgb);
+
+        // Deduce the BlockFormat described by a header, return false if it is not one of ours
+        bool evalBlockFormat(const Header& header, BlockFormat& format);
+
+        // Compress a single 4x4 block of RGBA texels (row major, 64 bytes) into dest
+        void compressBlock(BlockFormat format, const Byte* rgbaBlock, Byte* dest);
+        // Decompress a single block into 4x4 RGBA texels (row major, 64 bytes)
+        // For BC7 only the mode emitted by compressBlock is supported, return false otherwise
+        bool decompressBlock(BlockFormat format, const Byte* src, Byte* rgbaBlock);
+
+        // Compress a full 2D image made of tightly packed 32 bits texels.
+        // dest must be at least evalCompressedSize(format, width, height) bytes.
+        // The rows of blocks are shared between numThreads workers (0 means use all the cores).
+        void compressImage(BlockFormat format, uint32_t width, uint32_t height, const Byte* srcTexels, TexelOrder srcOrder,
+                           Byte* dest, uint32_t numThreads = 0);
+
+        // Decompress a full 2D image into tightly packed RGBA texels (width * height * 4 bytes)
+        bool decompressImage(BlockFormat format, uint32_t width, uint32_t height, const Byte* src, Byte* destRGBA);
+    }
+
+    // Create a KTX holding a block compressed copy of an uncompressed 32 bits RGBA or BGRA KTX.
+    // The source mip chain (and cube faces) is compressed on the CPU, by one set of numThreads workers, and written
+    // directly in the new KTX storage with the given key values.  The key values of the source aren't carried over:
+    // some describe its uncompressed texels, like the gpu payload, the caller writes what holds for the compressed
+    // copy.  Returns nullptr if the source layout is not supported.
+    std::unique_ptr<KTX> compressKTX(const KTX& src, BlockFormat format, bool srgb, const KeyValues& keyValues = KeyValues(),
+                                     uint32_t numThreads = 0);
+}
+
+#endif // hifi_ktx_BlockCompression_h
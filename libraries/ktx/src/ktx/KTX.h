@@ -268,7 +268,15 @@ namespace ktx {
         COMPRESSED_RG11_EAC = 0x9272,
         COMPRESSED_SIGNED_RG11_EAC = 0x9273,
 
-         NUM_COMPRESSED_GLINTERNALFORMATS = 24,
+        // EXT_texture_compression_s3tc / EXT_texture_sRGB
+        COMPRESSED_RGB_S3TC_DXT1 = 0x83F0,
+        COMPRESSED_RGBA_S3TC_DXT1 = 0x83F1,
+        COMPRESSED_RGBA_S3TC_DXT5 = 0x83F3,
+        COMPRESSED_SRGB_S3TC_DXT1 = 0x8C4C,
+        COMPRESSED_SRGB_ALPHA_S3TC_DXT1 = 0x8C4D,
+        COMPRESSED_SRGB_ALPHA_S3TC_DXT5 = 0x8C4F,
+
+         NUM_COMPRESSED_GLINTERNALFORMATS = 30,
     };
  
     enum class GLBaseInternalFormat : uint32_t {
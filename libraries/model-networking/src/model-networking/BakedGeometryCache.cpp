@@ -0,0 +1,36 @@
+//
+//  BakedGeometryCache.cpp
+//  libraries/model-networking/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "BakedGeometryCache.h"
+
+using File = cache::File;
+using FilePointer = cache::FilePointer;
+
+BakedGeometryCache::BakedGeometryCache(const std::string& dir, const std::string& ext) :
+    FileCache(dir, ext) {
+    initialize();
+}
+
+BakedGeometryFilePointer BakedGeometryCache::writeFile(const char* data, Metadata&& metadata) {
+    FilePointer file = FileCache::writeFile(data, std::move(metadata));
+    return std::static_pointer_cast<BakedGeometryFile>(file);
+}
+
+BakedGeometryFilePointer BakedGeometryCache::getFile(const Key& key) {
+    return std::static_pointer_cast<BakedGeometryFile>(FileCache::getFile(key));
+}
+
+std::unique_ptr<File> BakedGeometryCache::createFile(Metadata&& metadata, const std::string& filepath) {
+    qCInfo(file_cache) << "Wrote baked geometry" << metadata.key.c_str();
+    return std::unique_ptr<File>(new BakedGeometryFile(std::move(metadata), filepath));
+}
+
+BakedGeometryFile::BakedGeometryFile(Metadata&& metadata, const std::string& filepath) :
+    cache::File(std::move(metadata), filepath) {}
@@ -0,0 +1,44 @@
+//
+//  BakedGeometryCache.h
+//  libraries/model-networking/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BakedGeometryCache_h
+#define hifi_BakedGeometryCache_h
+
+#include <QUrl>
+
+#include <FileCache.h>
+
+class BakedGeometryFile;
+using BakedGeometryFilePointer = std::shared_ptr<BakedGeometryFile>;
+
+// On disk cache of post-processed geometries (see BakedGeometry.h), keyed by a hash of the source model content
+class BakedGeometryCache : public cache::FileCache {
+    Q_OBJECT
+
+public:
+    BakedGeometryCache(const std::string& dir, const std::string& ext);
+
+    BakedGeometryFilePointer writeFile(const char* data, Metadata&& metadata);
+    BakedGeometryFilePointer getFile(const Key& key);
+
+protected:
+    std::unique_ptr<cache::File> createFile(Metadata&& metadata, const std::string& filepath) override final;
+};
+
+class BakedGeometryFile : public cache::File {
+    Q_OBJECT
+
+protected:
+    friend class BakedGeometryCache;
+
+    BakedGeometryFile(Metadata&& metadata, const std::string& filepath);
+};
+
+#endif // hifi_BakedGeometryCache_h
@@ -14,10 +14,15 @@
 #include <FSTReader.h>
 #include "FBXReader.h"
 #include "OBJReader.h"
+#include "BakedGeometry.h"
 
 #include <gpu/Batch.h>
 #include <gpu/Stream.h>
 
+#include <QCryptographicHash>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QThreadPool>
 
 #include "ModelNetworkingLogging.h"
@@ -139,6 +144,11 @@ public:
     virtual void run() override;
 
 private:
+    std::string evalBakedGeometryKey(OBJReader& objReader) const;
+    bool useBakedGeometryCache() const;
+    FBXGeometry::Pointer readFromBakedGeometryCache(const std::string& key) const;
+    void writeToBakedGeometryCache(const std::string& key, const FBXGeometry& geometry) const;
+
     QWeakPointer<Resource> _resource;
     QUrl _url;
     QVariantHash _mapping;
@@ -172,19 +182,31 @@ void GeometryReader::run() {
         QString urlname = _url.path().toLower();
         if (!urlname.isEmpty() && !_url.path().isEmpty() &&
             (_url.path().toLower().endsWith(".fbx") || _url.path().toLower().endsWith(".obj"))) {
-            FBXGeometry::Pointer fbxGeometry;
-
-            if (_url.path().toLower().endsWith(".fbx")) {
+            // A model that was already parsed and post-processed once is read back from the disk cache.
+            // The OBJ reader keeps the material libraries fetched for the key, so they are only fetched once.
+            OBJReader objReader;
+            bool useBakedCache = useBakedGeometryCache();
+            std::string bakedKey = useBakedCache ? evalBakedGeometryKey(objReader) : std::string();
+            FBXGeometry::Pointer fbxGeometry = useBakedCache ? readFromBakedGeometryCache(bakedKey) : FBXGeometry::Pointer();
+            bool wasBaked = (bool)fbxGeometry;
+
+            if (wasBaked) {
+                qCDebug(modelnetworking) << "Read" << _url << "from the baked geometry cache";
+            } else if (_url.path().toLower().endsWith(".fbx")) {
                 fbxGeometry.reset(readFBX(_data, _mapping, _url.path()));
                 if (fbxGeometry->meshes.size() == 0 && fbxGeometry->joints.size() == 0) {
                     throw QString("empty geometry, possibly due to an unsupported FBX version");
                 }
             } else if (_url.path().toLower().endsWith(".obj")) {
-                fbxGeometry.reset(OBJReader().readOBJ(_data, _mapping, _combineParts, _url));
+                fbxGeometry.reset(objReader.readOBJ(_data, _mapping, _combineParts, _url));
             } else {
                 throw QString("unsupported format");
             }
 
+            if (useBakedCache && !wasBaked) {
+                writeToBakedGeometryCache(bakedKey, *fbxGeometry);
+            }
+
             // Ensure the resource has not been deleted
             auto resource = _resource.toStrongRef();
             if (!resource) {
@@ -208,6 +230,68 @@ void GeometryReader::run() {
     }
 }
 
+bool GeometryReader::useBakedGeometryCache() const {
+    auto modelCache = DependencyManager::get<ModelCache>();
+    return modelCache && modelCache->_bakedGeometryCache;
+}
+
+std::string GeometryReader::evalBakedGeometryKey(OBJReader& objReader) const {
+    // The baked geometry depends on the model content as well as on everything fed to the readers
+    QCryptographicHash hasher(QCryptographicHash::Md5);
+    hasher.addData(_data);
+    hasher.addData(QJsonDocument(QJsonObject::fromVariantHash(_mapping)).toJson(QJsonDocument::Compact));
+    hasher.addData(_url.path().toUtf8());
+    hasher.addData(_combineParts ? "1" : "0");
+    hasher.addData(QByteArray::number(BAKED_GEOMETRY_VERSION));
+    if (_url.path().toLower().endsWith(".obj")) {
+        // the materials of an OBJ come from the .mtl files it refers to
+        hasher.addData(objReader.fetchMaterialLibraries(_data, _url));
+    }
+    return hasher.result().toHex().toStdString();
+}
+
+FBXGeometry::Pointer GeometryReader::readFromBakedGeometryCache(const std::string& key) const {
+    auto modelCache = DependencyManager::get<ModelCache>();
+    if (!modelCache || !modelCache->_bakedGeometryCache) {
+        return FBXGeometry::Pointer();
+    }
+    BakedGeometryFilePointer bakedFile = modelCache->_bakedGeometryCache->getFile(key);
+    if (!bakedFile) {
+        return FBXGeometry::Pointer();
+    }
+
+    QFile file(QString::fromStdString(bakedFile->getFilepath()));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return FBXGeometry::Pointer();
+    }
+    const char* data = reinterpret_cast<const char*>(file.map(0, file.size()));
+    QByteArray contents;
+    if (!data) {
+        contents = file.readAll();
+        data = contents.constData();
+    }
+
+    try {
+        return FBXGeometry::Pointer(readBakedGeometry(data, (size_t)file.size(), _url.path()));
+    } catch (const QString& error) {
+        // A stale or damaged entry, fall back to parsing the source
+        qCWarning(modelnetworking) << "Ignoring baked geometry for" << _url << ":" << error;
+        return FBXGeometry::Pointer();
+    }
+}
+
+void GeometryReader::writeToBakedGeometryCache(const std::string& key, const FBXGeometry& geometry) const {
+    auto modelCache = DependencyManager::get<ModelCache>();
+    if (!modelCache || !modelCache->_bakedGeometryCache) {
+        return;
+    }
+    QByteArray baked = writeBakedGeometry(geometry);
+    if (!modelCache->_bakedGeometryCache->writeFile(baked.constData(),
+                                                   BakedGeometryCache::Metadata(key, baked.size()))) {
+        qCWarning(modelnetworking) << "Failed to write baked geometry for" << _url;
+    }
+}
+
 class GeometryDefinitionResource : public GeometryResource {
     Q_OBJECT
 public:
@@ -261,7 +345,13 @@ void GeometryDefinitionResource::setGeometryDefinition(FBXGeometry::Pointer fbxG
     finishedLoading(true);
 }
 
-ModelCache::ModelCache() {
+const std::string ModelCache::BAKED_GEOMETRY_DIRNAME { "baked_geometry_cache" };
+const std::string ModelCache::BAKED_GEOMETRY_EXT { "bgeo" };
+
+ModelCache::ModelCache(bool useBakedGeometryCache) {
+    if (useBakedGeometryCache) {
+        _bakedGeometryCache.reset(new BakedGeometryCache(BAKED_GEOMETRY_DIRNAME, BAKED_GEOMETRY_EXT));
+    }
     const qint64 GEOMETRY_DEFAULT_UNUSED_MAX_SIZE = DEFAULT_UNUSED_MAX_SIZE;
     setUnusedResourceCacheSize(GEOMETRY_DEFAULT_UNUSED_MAX_SIZE);
     setObjectName("ModelCache");
@@ -20,6 +20,7 @@
 
 #include "FBXReader.h"
 #include "TextureCache.h"
+#include "BakedGeometryCache.h"
 
 // Alias instead of derive to avoid copying
 
@@ -47,6 +48,8 @@ public:
     bool isGeometryLoaded() const { return (bool)_fbxGeometry; }
 
     const FBXGeometry& getFBXGeometry() const { return *_fbxGeometry; }
+    // shared by every geometry of the same model file, for caches keyed by it
+    const std::shared_ptr<const FBXGeometry>& getFBXGeometryPointer() const { return _fbxGeometry; }
     const GeometryMeshes& getMeshes() const { return *_meshes; }
     const std::shared_ptr<const NetworkMaterial> getShapeMaterial(int shapeID) const;
 
@@ -81,6 +84,8 @@ public:
     GeometryResource(const QUrl& url, const QUrl& textureBaseUrl = QUrl()) :
         Resource(url), _textureBaseUrl(textureBaseUrl) {}
 
+    ResourceRequestCategory getRequestCategory() const override { return ResourceRequestCategory::Model; }
+
     virtual bool areTexturesLoaded() const override { return isLoaded() && Geometry::areTexturesLoaded(); }
 
     virtual void deleter() override;
@@ -145,13 +150,20 @@ public:
 
 protected:
     friend class GeometryMappingResource;
+    friend class GeometryReader;
 
     virtual QSharedPointer<Resource> createResource(const QUrl& url, const QSharedPointer<Resource>& fallback,
                                                     const void* extra) override;
 
 private:
-    ModelCache();
+    // The baked geometries are only kept on disk when useBakedGeometryCache is set, the directory is shared
+    // by all the processes creating the cache with it
+    ModelCache(bool useBakedGeometryCache = false);
     virtual ~ModelCache() = default;
+
+    static const std::string BAKED_GEOMETRY_DIRNAME;
+    static const std::string BAKED_GEOMETRY_EXT;
+    std::unique_ptr<BakedGeometryCache> _bakedGeometryCache;
 };
 
 class NetworkMaterial : public model::Material {
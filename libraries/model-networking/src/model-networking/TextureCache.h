@@ -68,6 +68,7 @@ public:
     NetworkTexture(const QUrl& url, Type type, const QByteArray& content, int maxNumPixels);
 
     QString getType() const override { return "NetworkTexture"; }
+    ResourceRequestCategory getRequestCategory() const override { return ResourceRequestCategory::Texture; }
 
     int getOriginalWidth() const { return _originalWidth; }
     int getOriginalHeight() const { return _originalHeight; }
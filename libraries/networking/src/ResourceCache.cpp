@@ -9,6 +9,8 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <algorithm>
+#include <atomic>
 #include <cfloat>
 #include <cmath>
 
@@ -30,23 +32,59 @@
                            (((x) > (max)) ? (max) :\
                                             (x)))
 
+ResourceCacheSharedItems::ResourceCacheSharedItems() {
+    _loadingRequestsCounts.fill(0);
+    _requestBudgets.fill(UNLIMITED_REQUEST_BUDGET);
+    _requestShares.fill(0.0f);
+}
+
 void ResourceCacheSharedItems::appendActiveRequest(QWeakPointer<Resource> resource) {
+    auto strongRef = resource.lock();
+    if (!strongRef) {
+        return;
+    }
+    auto category = strongRef->getRequestCategory();
+
     Lock lock(_mutex);
-    _loadingRequests.append(resource);
+    _loadingRequests.append({ resource, category });
+    _loadingRequestsCounts[(int)category]++;
 }
 
 void ResourceCacheSharedItems::appendPendingRequest(QWeakPointer<Resource> resource) {
+    auto strongRef = resource.lock();
+    if (!strongRef) {
+        return;
+    }
+    auto category = strongRef->getRequestCategory();
+
+    Lock lock(_mutex);
+    _pendingRequests[(int)category].push(strongRef, strongRef->getLoadPriority());
+}
+
+void ResourceCacheSharedItems::updatePendingRequest(int requestID, ResourceRequestCategory category, float priority) {
     Lock lock(_mutex);
-    _pendingRequests.append(resource);
+    _pendingRequests[(int)category].update(requestID, priority);
+}
+
+void ResourceCacheSharedItems::removePendingRequest(int requestID) {
+    Lock lock(_mutex);
+    // the category of a resource can't be asked while it is destroyed, it is only queued in one of them
+    for (auto& queue : _pendingRequests) {
+        if (queue.remove(requestID)) {
+            break;
+        }
+    }
 }
 
 QList<QSharedPointer<Resource>> ResourceCacheSharedItems::getPendingRequests() {
     QList<QSharedPointer<Resource>> result;
     Lock lock(_mutex);
 
-    foreach(QSharedPointer<Resource> resource, _pendingRequests) {
-        if (resource) {
-            result.append(resource);
+    for (const auto& queue : _pendingRequests) {
+        for (const auto& entry : queue.getEntries()) {
+            if (auto resource = entry.resource.lock()) {
+                result.append(resource);
+            }
         }
     }
 
@@ -55,15 +93,19 @@ QList<QSharedPointer<Resource>> ResourceCacheSharedItems::getPendingRequests() {
 
 uint32_t ResourceCacheSharedItems::getPendingRequestsCount() const {
     Lock lock(_mutex);
-    return _pendingRequests.size();
+    uint32_t count = 0;
+    for (const auto& queue : _pendingRequests) {
+        count += (uint32_t)queue.size();
+    }
+    return count;
 }
 
 QList<QSharedPointer<Resource>> ResourceCacheSharedItems::getLoadingRequests() {
     QList<QSharedPointer<Resource>> result;
     Lock lock(_mutex);
 
-    foreach(QSharedPointer<Resource> resource, _loadingRequests) {
-        if (resource) {
+    for (const auto& request : _loadingRequests) {
+        if (auto resource = request.resource.lock()) {
             result.append(resource);
         }
     }
@@ -83,9 +125,10 @@ void ResourceCacheSharedItems::removeRequest(QWeakPointer<Resource> resource) {
     // QWeakPointer has no operator== implementation for two weak ptrs, so
     // manually loop in case resource has been freed.
     for (int i = 0; i < _loadingRequests.size();) {
-        auto request = _loadingRequests.at(i);
+        const auto& request = _loadingRequests.at(i);
         // Clear our resource and any freed resources
-        if (!request || request.data() == resource.data()) {
+        if (!request.resource || request.resource.data() == resource.data()) {
+            _loadingRequestsCounts[(int)request.category]--;
             _loadingRequests.removeAt(i);
             continue;
         }
@@ -94,35 +137,84 @@ void ResourceCacheSharedItems::removeRequest(QWeakPointer<Resource> resource) {
 }
 
 QSharedPointer<Resource> ResourceCacheSharedItems::getHighestPendingRequest() {
-    // look for the highest priority pending request
-    int highestIndex = -1;
-    float highestPriority = -FLT_MAX;
     QSharedPointer<Resource> highestResource;
-    Lock lock(_mutex);
+    {
+        Lock lock(_mutex);
+
+        ResourceRequestQueue* highestQueue = nullptr;
+        uint64_t highestSequence = 0;
+        float highestPriority = -FLT_MAX;
+        for (int i = 0; i < NUM_RESOURCE_REQUEST_CATEGORIES; ++i) {
+            if (_loadingRequestsCounts[i] >= _requestBudgets[i]) {
+                continue;
+            }
 
-    for (int i = 0; i < _pendingRequests.size();) {
-        // Clear any freed resources
-        auto resource = _pendingRequests.at(i).lock();
-        if (!resource) {
-            _pendingRequests.removeAt(i);
-            continue;
+            // Owners can disappear without notice, so the priority at the top of the queue is
+            // refreshed until it settles on an entry that is still valid.  A request whose owners
+            // are all gone stays queued at the lowest priority.
+            auto& queue = _pendingRequests[i];
+            while (!queue.isEmpty()) {
+                const auto& top = queue.top();
+                auto resource = top.resource.lock();
+                if (!resource) {
+                    // Clear any freed resources
+                    queue.pop();
+                    continue;
+                }
+                float priority = resource->getLoadPriority();
+                if (priority != top.priority) {
+                    queue.update(top.key, priority);
+                    continue;
+                }
+
+                if (!highestQueue || priority > highestPriority ||
+                    (priority == highestPriority && top.sequence > highestSequence)) {
+                    highestQueue = &queue;
+                    highestPriority = priority;
+                    highestSequence = top.sequence;
+                    highestResource = resource;
+                }
+                break;
+            }
         }
 
-        // Check load priority
-        float priority = resource->getLoadPriority();
-        if (priority >= highestPriority) {
-            highestPriority = priority;
-            highestIndex = i;
-            highestResource = resource;
+        if (highestQueue) {
+            highestQueue->pop();
         }
-        i++;
     }
 
-    if (highestIndex >= 0) {
-        _pendingRequests.takeAt(highestIndex);
+    return highestResource;
+}
+
+void ResourceCacheSharedItems::setRequestBudget(ResourceRequestCategory category, int budget) {
+    Lock lock(_mutex);
+    _requestBudgets[(int)category] = budget;
+    _requestShares[(int)category] = 0.0f;
+}
+
+void ResourceCacheSharedItems::setRequestShare(ResourceRequestCategory category, float share, int requestLimit) {
+    Lock lock(_mutex);
+    _requestShares[(int)category] = share;
+    _requestBudgets[(int)category] = std::max(1, (int)(requestLimit * share));
+}
+
+void ResourceCacheSharedItems::updateRequestShares(int requestLimit) {
+    Lock lock(_mutex);
+    for (int i = 0; i < NUM_RESOURCE_REQUEST_CATEGORIES; i++) {
+        if (_requestShares[i] > 0.0f) {
+            _requestBudgets[i] = std::max(1, (int)(requestLimit * _requestShares[i]));
+        }
     }
+}
 
-    return highestResource;
+int ResourceCacheSharedItems::getRequestBudget(ResourceRequestCategory category) const {
+    Lock lock(_mutex);
+    return _requestBudgets[(int)category];
+}
+
+bool ResourceCacheSharedItems::isWithinRequestBudget(ResourceRequestCategory category) const {
+    Lock lock(_mutex);
+    return _loadingRequestsCounts[(int)category] < _requestBudgets[(int)category];
 }
 
 ScriptableResource::ScriptableResource(const QUrl& url) :
@@ -240,14 +332,21 @@ void ResourceCache::clearATPAssets() {
             }
         }
     }
+    UnusedResources atpResources;
     {
-        QWriteLocker locker(&_unusedResourcesLock);
-        for (auto& resource : _unusedResources.values()) {
-            if (resource->getURL().scheme() == URL_SCHEME_ATP) {
-                _unusedResources.remove(resource->getLRUKey());
+        Lock lock(_unusedResourcesMutex);
+        for (auto it = _unusedResources.begin(); it != _unusedResources.end();) {
+            auto next = std::next(it);
+            if ((*it)->getURL().scheme() == URL_SCHEME_ATP) {
+                _unusedResourcesIndex.erase(it->data());
+                _unusedResourcesSize -= (*it)->getBytes();
+                atpResources.splice(atpResources.end(), _unusedResources, it);
             }
+            it = next;
         }
     }
+    // Release the ATP resources outside of the lock
+    atpResources.clear();
     {
         QWriteLocker locker(&_resourcesToBeGottenLock);
         auto it = _resourcesToBeGotten.begin();
@@ -316,6 +415,7 @@ QVariantList ResourceCache::getResourceList() {
  
 void ResourceCache::setRequestLimit(int limit) {
     _requestLimit = limit;
+    DependencyManager::get<ResourceCacheSharedItems>()->updateRequestShares(limit);
 
     // Now go fill any new request spots
     while (attemptHighestPriorityRequest()) {
@@ -378,55 +478,73 @@ void ResourceCache::addUnusedResource(const QSharedPointer<Resource>& resource)
         return;
     }
     reserveUnusedResource(resource->getBytes());
-    
-    resource->setLRUKey(++_lastLRUKey);
-    _unusedResourcesSize += resource->getBytes();
 
-    resetResourceCounters();
+    {
+        Lock lock(_unusedResourcesMutex);
+        if (_unusedResourcesIndex.find(resource.data()) == _unusedResourcesIndex.end()) {
+            // most recently used at the back
+            _unusedResourcesIndex[resource.data()] = _unusedResources.insert(_unusedResources.end(), resource);
+            _unusedResourcesSize += resource->getBytes();
+        }
+    }
 
-    QWriteLocker locker(&_unusedResourcesLock);
-    _unusedResources.insert(resource->getLRUKey(), resource);
+    resetResourceCounters();
 }
 
 void ResourceCache::removeUnusedResource(const QSharedPointer<Resource>& resource) {
-    QWriteLocker locker(&_unusedResourcesLock);
-    if (_unusedResources.contains(resource->getLRUKey())) {
-        _unusedResources.remove(resource->getLRUKey());
+    // keep the reference alive until the lock is released
+    QSharedPointer<Resource> removed;
+    {
+        Lock lock(_unusedResourcesMutex);
+        auto it = _unusedResourcesIndex.find(resource.data());
+        if (it == _unusedResourcesIndex.end()) {
+            return;
+        }
+        removed = *it->second;
+        _unusedResources.erase(it->second);
+        _unusedResourcesIndex.erase(it);
         _unusedResourcesSize -= resource->getBytes();
-
-        locker.unlock();
-        resetResourceCounters();
     }
+    resetResourceCounters();
 }
 
 void ResourceCache::reserveUnusedResource(qint64 resourceSize) {
-    QWriteLocker locker(&_unusedResourcesLock);
+    Lock lock(_unusedResourcesMutex);
     while (!_unusedResources.empty() &&
            _unusedResourcesSize + resourceSize > _unusedResourcesMaxSize) {
         // unload the oldest resource
-        QMap<int, QSharedPointer<Resource> >::iterator it = _unusedResources.begin();
-        
-        it.value()->setCache(nullptr);
-        auto size = it.value()->getBytes();
-
-        locker.unlock();
-        removeResource(it.value()->getURL(), size);
-        locker.relock();
+        QSharedPointer<Resource> oldest = _unusedResources.front();
+        _unusedResources.pop_front();
+        _unusedResourcesIndex.erase(oldest.data());
 
+        oldest->setCache(nullptr);
+        auto size = oldest->getBytes();
         _unusedResourcesSize -= size;
-        _unusedResources.erase(it);
+
+        lock.unlock();
+        removeResource(oldest->getURL(), size);
+        // drop the last reference outside of the lock
+        oldest.reset();
+        lock.lock();
     }
 }
 
 void ResourceCache::clearUnusedResources() {
     // the unused resources may themselves reference resources that will be added to the unused
     // list on destruction, so keep clearing until there are no references left
-    QWriteLocker locker(&_unusedResourcesLock);
-    while (!_unusedResources.isEmpty()) {
-        foreach (const QSharedPointer<Resource>& resource, _unusedResources) {
+    Lock lock(_unusedResourcesMutex);
+    while (!_unusedResources.empty()) {
+        UnusedResources resources;
+        resources.swap(_unusedResources);
+        _unusedResourcesIndex.clear();
+        _unusedResourcesSize = 0;
+
+        lock.unlock();
+        for (const auto& resource : resources) {
             resource->setCache(nullptr);
         }
-        _unusedResources.clear();
+        resources.clear();
+        lock.lock();
     }
 }
 
@@ -437,7 +555,7 @@ void ResourceCache::resetResourceCounters() {
     }
 
     {
-        QReadLocker locker(&_unusedResourcesLock);
+        Lock lock(_unusedResourcesMutex);
         _numUnusedResources = _unusedResources.size();
     }
 
@@ -476,7 +594,7 @@ bool ResourceCache::attemptRequest(QSharedPointer<Resource> resource) {
     Q_ASSERT(!resource.isNull());
     auto sharedItems = DependencyManager::get<ResourceCacheSharedItems>();
 
-    if (_requestsActive >= _requestLimit) {
+    if (_requestsActive >= _requestLimit || !sharedItems->isWithinRequestBudget(resource->getRequestCategory())) {
         // wait until a slot becomes available
         sharedItems->appendPendingRequest(resource);
         return false;
@@ -493,7 +611,10 @@ void ResourceCache::requestCompleted(QWeakPointer<Resource> resource) {
     sharedItems->removeRequest(resource);
     --_requestsActive;
 
-    attemptHighestPriorityRequest();
+    // The freed slot may let through requests of several categories that were held back by their budget
+    while (attemptHighestPriorityRequest()) {
+        // just keep looping until we reach the limit or no more pending requests fit in their budget
+    }
 }
 
 bool ResourceCache::attemptHighestPriorityRequest() {
@@ -502,11 +623,33 @@ bool ResourceCache::attemptHighestPriorityRequest() {
     return (resource && attemptRequest(resource));
 }
 
+void ResourceCache::setRequestBudget(ResourceRequestCategory category, int budget) {
+    DependencyManager::get<ResourceCacheSharedItems>()->setRequestBudget(category, budget);
+
+    // Now go fill any new request spots
+    while (attemptHighestPriorityRequest()) {
+        // just keep looping until we reach the new budget or no more pending requests
+    }
+}
+
+void ResourceCache::setRequestShare(ResourceRequestCategory category, float share) {
+    DependencyManager::get<ResourceCacheSharedItems>()->setRequestShare(category, share, _requestLimit);
+
+    // Now go fill any new request spots
+    while (attemptHighestPriorityRequest()) {
+        // just keep looping until we reach the new budget or no more pending requests
+    }
+}
+
+int ResourceCache::getRequestBudget(ResourceRequestCategory category) {
+    return DependencyManager::get<ResourceCacheSharedItems>()->getRequestBudget(category);
+}
+
 const int DEFAULT_REQUEST_LIMIT = 10;
 int ResourceCache::_requestLimit = DEFAULT_REQUEST_LIMIT;
 int ResourceCache::_requestsActive = 0;
 
-static int requestID = 0;
+static std::atomic<int> requestID { 0 };
 
 Resource::Resource(const QUrl& url) :
     _url(url),
@@ -521,6 +664,9 @@ Resource::~Resource() {
         _request->deleteLater();
         _request = nullptr;
         ResourceCache::requestCompleted(_self);
+    } else if (_startedLoading && !(_loaded || _failedToLoad) && DependencyManager::isSet<ResourceCacheSharedItems>()) {
+        // a queued request must not outlive its resource
+        DependencyManager::get<ResourceCacheSharedItems>()->removePendingRequest(_requestID);
     }
 }
 
@@ -533,6 +679,7 @@ void Resource::ensureLoading() {
 void Resource::setLoadPriority(const QPointer<QObject>& owner, float priority) {
     if (!(_failedToLoad || _loaded)) {
         _loadPriorities.insert(owner, priority);
+        updatePendingRequest();
     }
 }
 
@@ -544,11 +691,21 @@ void Resource::setLoadPriorities(const QHash<QPointer<QObject>, float>& prioriti
             it != priorities.constEnd(); it++) {
         _loadPriorities.insert(it.key(), it.value());
     }
+    updatePendingRequest();
 }
 
 void Resource::clearLoadPriority(const QPointer<QObject>& owner) {
     if (!(_failedToLoad || _loaded)) {
         _loadPriorities.remove(owner);
+        updatePendingRequest();
+    }
+}
+
+void Resource::updatePendingRequest() {
+    // only a queued request has a rank to update
+    if (_startedLoading && !_request && !(_loaded || _failedToLoad)) {
+        DependencyManager::get<ResourceCacheSharedItems>()->updatePendingRequest(_requestID, getRequestCategory(),
+                                                                                 getLoadPriority());
     }
 }
 
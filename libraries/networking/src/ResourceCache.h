@@ -12,8 +12,12 @@
 #ifndef hifi_ResourceCache_h
 #define hifi_ResourceCache_h
 
+#include <array>
 #include <atomic>
+#include <climits>
+#include <list>
 #include <mutex>
+#include <unordered_map>
 
 #include <QtCore/QHash>
 #include <QtCore/QList>
@@ -33,6 +37,7 @@
 #include <DependencyManager.h>
 
 #include "ResourceManager.h"
+#include "ResourceRequestQueue.h"
 
 Q_DECLARE_METATYPE(size_t)
 
@@ -55,6 +60,19 @@ static const qint64 DEFAULT_UNUSED_MAX_SIZE = 1024 * BYTES_PER_MEGABYTES;
 static const qint64 MIN_UNUSED_MAX_SIZE = 0;
 static const qint64 MAX_UNUSED_MAX_SIZE = MAXIMUM_CACHE_SIZE;
 
+// The kind of asset a resource request is for, each kind can be given its own budget of concurrent requests
+enum class ResourceRequestCategory : uint8_t {
+    Other = 0,
+    Texture,
+    Model,
+    Sound,
+    Animation,
+
+    NUM_CATEGORIES,
+};
+static const int NUM_RESOURCE_REQUEST_CATEGORIES = (int)ResourceRequestCategory::NUM_CATEGORIES;
+static const int UNLIMITED_REQUEST_BUDGET = INT_MAX;
+
 // We need to make sure that these items are available for all instances of
 // ResourceCache derived classes. Since we can't count on the ordering of
 // static members destruction, we need to use this Dependency manager implemented
@@ -67,20 +85,41 @@ class ResourceCacheSharedItems : public Dependency  {
 
 public:
     void appendPendingRequest(QWeakPointer<Resource> newRequest);
+    void updatePendingRequest(int requestID, ResourceRequestCategory category, float priority);
+    void removePendingRequest(int requestID);
     void appendActiveRequest(QWeakPointer<Resource> newRequest);
     void removeRequest(QWeakPointer<Resource> doneRequest);
     QList<QSharedPointer<Resource>> getPendingRequests();
     uint32_t getPendingRequestsCount() const;
     QList<QSharedPointer<Resource>> getLoadingRequests();
+    /// Takes the highest priority pending request among the categories still within their budget.
+    /// Requests whose owners are all gone sink to the lowest priority, they still load once nothing else waits.
     QSharedPointer<Resource> getHighestPendingRequest();
     uint32_t getLoadingRequestsCount() const;
 
+    void setRequestBudget(ResourceRequestCategory category, int budget);
+    int getRequestBudget(ResourceRequestCategory category) const;
+    bool isWithinRequestBudget(ResourceRequestCategory category) const;
+
+    /// Sets the budget of a category to a share of the request limit, recomputed by updateRequestShares
+    void setRequestShare(ResourceRequestCategory category, float share, int requestLimit);
+    void updateRequestShares(int requestLimit);
+
 private:
-    ResourceCacheSharedItems() = default;
+    ResourceCacheSharedItems();
+
+    class LoadingRequest {
+    public:
+        QWeakPointer<Resource> resource;
+        ResourceRequestCategory category;
+    };
 
     mutable Mutex _mutex;
-    QList<QWeakPointer<Resource>> _pendingRequests;
-    QList<QWeakPointer<Resource>> _loadingRequests;
+    std::array<ResourceRequestQueue, NUM_RESOURCE_REQUEST_CATEGORIES> _pendingRequests;
+    QList<LoadingRequest> _loadingRequests;
+    std::array<int, NUM_RESOURCE_REQUEST_CATEGORIES> _loadingRequestsCounts;
+    std::array<int, NUM_RESOURCE_REQUEST_CATEGORIES> _requestBudgets;
+    std::array<float, NUM_RESOURCE_REQUEST_CATEGORIES> _requestShares; // 0 for a budget that isn't a share
 };
 
 /// Wrapper to expose resources to JS/QML
@@ -234,6 +273,14 @@ public:
     static int getRequestLimit() { return _requestLimit; }
 
     static int getRequestsActive() { return _requestsActive; }
+
+    /// Caps the number of concurrent requests for one category of resources, within the global request limit
+    static void setRequestBudget(ResourceRequestCategory category, int budget);
+    static int getRequestBudget(ResourceRequestCategory category);
+
+    /// Caps the number of concurrent requests for one category of resources to a share of the request limit,
+    /// at least one, recomputed when the limit changes
+    static void setRequestShare(ResourceRequestCategory category, float share);
     
     void setUnusedResourceCacheSize(qint64 unusedResourcesMaxSize);
     qint64 getUnusedResourceCacheSize() const { return _unusedResourcesMaxSize; }
@@ -309,6 +356,9 @@ protected:
 private:
     friend class Resource;
 
+    using Mutex = std::mutex;
+    using Lock = std::unique_lock<Mutex>;
+
     void reserveUnusedResource(qint64 resourceSize);
     void resetResourceCounters();
     void removeResource(const QUrl& url, qint64 size = 0);
@@ -319,14 +369,15 @@ private:
     // Resources
     QHash<QUrl, QWeakPointer<Resource>> _resources;
     QReadWriteLock _resourcesLock { QReadWriteLock::Recursive };
-    int _lastLRUKey = 0;
 
     std::atomic<size_t> _numTotalResources { 0 };
     std::atomic<qint64> _totalResourcesSize { 0 };
 
-    // Cached resources
-    QMap<int, QSharedPointer<Resource>> _unusedResources;
-    QReadWriteLock _unusedResourcesLock { QReadWriteLock::Recursive };
+    // Cached resources, from the least to the most recently used
+    using UnusedResources = std::list<QSharedPointer<Resource>>;
+    UnusedResources _unusedResources;
+    std::unordered_map<const Resource*, UnusedResources::iterator> _unusedResourcesIndex;
+    Mutex _unusedResourcesMutex;
     qint64 _unusedResourcesMaxSize = DEFAULT_UNUSED_MAX_SIZE;
 
     std::atomic<size_t> _numUnusedResources { 0 };
@@ -347,9 +398,9 @@ public:
     ~Resource();
 
     virtual QString getType() const { return "Resource"; }
-    
-    /// Returns the key last used to identify this resource in the unused map.
-    int getLRUKey() const { return _lruKey; }
+
+    /// Returns the category whose request budget this resource counts against.
+    virtual ResourceRequestCategory getRequestCategory() const { return ResourceRequestCategory::Other; }
 
     /// Makes sure that the resource has started loading.
     void ensureLoading();
@@ -395,6 +446,9 @@ public:
     
     const QUrl& getURL() const { return _url; }
 
+    /// Unique among all the resources of the process, even after they are destroyed
+    int getRequestID() const { return _requestID; }
+
 signals:
     /// Fired when the resource begins downloading.
     void loading();
@@ -455,10 +509,11 @@ private slots:
 
 private:
     friend class ResourceCache;
+    friend class ResourceCacheSharedItems;
     friend class ScriptableResource;
-    
-    void setLRUKey(int lruKey) { _lruKey = lruKey; }
-    
+
+    void updatePendingRequest();
+
     void makeRequest();
     void retry();
     void reinsert();
@@ -468,7 +523,6 @@ private:
     
     int _requestID;
     ResourceRequest* _request{ nullptr };
-    int _lruKey{ 0 };
     QTimer* _replyTimer{ nullptr };
     qint64 _bytesReceived{ 0 };
     qint64 _bytesTotal{ 0 };
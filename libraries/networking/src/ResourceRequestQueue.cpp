@@ -0,0 +1,132 @@
+//
+//  ResourceRequestQueue.cpp
+//  libraries/networking/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ResourceRequestQueue.h"
+
+#include <assert.h>
+
+#include "ResourceCache.h"
+
+bool ResourceRequestQueue::push(const QSharedPointer<Resource>& resource, float priority) {
+    if (!resource) {
+        return false;
+    }
+    int key = resource->getRequestID();
+    if (contains(key)) {
+        return false;
+    }
+
+    Entry entry;
+    entry.resource = resource;
+    entry.key = key;
+    entry.priority = priority;
+    entry.sequence = _nextSequence++;
+
+    _heap.push_back(entry);
+    _indices[key] = _heap.size() - 1;
+    siftUp(_heap.size() - 1);
+    return true;
+}
+
+bool ResourceRequestQueue::update(int key, float priority) {
+    auto it = _indices.find(key);
+    if (it == _indices.end()) {
+        return false;
+    }
+
+    size_t index = it->second;
+    float previous = _heap[index].priority;
+    _heap[index].priority = priority;
+    if (priority > previous) {
+        siftUp(index);
+    } else if (priority < previous) {
+        siftDown(index);
+    }
+    return true;
+}
+
+bool ResourceRequestQueue::remove(int key) {
+    auto it = _indices.find(key);
+    if (it == _indices.end()) {
+        return false;
+    }
+    removeAt(it->second);
+    return true;
+}
+
+void ResourceRequestQueue::pop() {
+    assert(!_heap.empty());
+    removeAt(0);
+}
+
+void ResourceRequestQueue::clear() {
+    _heap.clear();
+    _indices.clear();
+}
+
+bool ResourceRequestQueue::isHigher(const Entry& left, const Entry& right) {
+    if (left.priority != right.priority) {
+        return left.priority > right.priority;
+    }
+    // Same as the previous linear scan: among equals, the last request queued goes first
+    return left.sequence > right.sequence;
+}
+
+void ResourceRequestQueue::siftUp(size_t index) {
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (!isHigher(_heap[index], _heap[parent])) {
+            break;
+        }
+        swapEntries(index, parent);
+        index = parent;
+    }
+}
+
+void ResourceRequestQueue::siftDown(size_t index) {
+    const size_t size = _heap.size();
+    while (true) {
+        size_t highest = index;
+        size_t left = 2 * index + 1;
+        size_t right = left + 1;
+        if (left < size && isHigher(_heap[left], _heap[highest])) {
+            highest = left;
+        }
+        if (right < size && isHigher(_heap[right], _heap[highest])) {
+            highest = right;
+        }
+        if (highest == index) {
+            break;
+        }
+        swapEntries(index, highest);
+        index = highest;
+    }
+}
+
+void ResourceRequestQueue::swapEntries(size_t left, size_t right) {
+    std::swap(_heap[left], _heap[right]);
+    _indices[_heap[left].key] = left;
+    _indices[_heap[right].key] = right;
+}
+
+void ResourceRequestQueue::removeAt(size_t index) {
+    const size_t last = _heap.size() - 1;
+    _indices.erase(_heap[index].key);
+    if (index != last) {
+        _heap[index] = _heap[last];
+        _indices[_heap[index].key] = index;
+        _heap.pop_back();
+        // The moved entry can go either way, if it moves up siftDown is a no-op
+        siftUp(index);
+        siftDown(index);
+    } else {
+        _heap.pop_back();
+    }
+}
@@ -0,0 +1,73 @@
+//
+//  ResourceRequestQueue.h
+//  libraries/networking/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ResourceRequestQueue_h
+#define hifi_ResourceRequestQueue_h
+
+#include <unordered_map>
+#include <vector>
+
+#include <QtCore/QSharedPointer>
+#include <QtCore/QWeakPointer>
+
+class Resource;
+
+/// Indexed binary max-heap of pending resource requests.
+/// Every queued resource knows its slot in the heap, so the priority of a request can be updated
+/// and a request can be removed in O(log n) without scanning the queue.
+/// Requests are keyed by the request ID of their resource, which unlike its address is never reused.
+/// Not thread safe, the owner is expected to guard it.
+class ResourceRequestQueue {
+public:
+    class Entry {
+    public:
+        QWeakPointer<Resource> resource;
+        int key { 0 };
+        float priority { 0.0f };
+        uint64_t sequence { 0 };
+    };
+
+    /// Queues the resource, returns false if it is already queued
+    bool push(const QSharedPointer<Resource>& resource, float priority);
+
+    /// Moves an already queued resource to its new rank, returns false if it is not queued
+    bool update(int key, float priority);
+
+    /// Removes a queued resource, returns false if it is not queued
+    bool remove(int key);
+
+    bool contains(int key) const { return _indices.find(key) != _indices.end(); }
+
+    /// The highest priority entry, the most recently queued one wins a tie
+    const Entry& top() const { return _heap.front(); }
+    void pop();
+
+    bool isEmpty() const { return _heap.empty(); }
+    size_t size() const { return _heap.size(); }
+
+    void clear();
+
+    /// All the entries, in heap order
+    const std::vector<Entry>& getEntries() const { return _heap; }
+
+private:
+    static bool isHigher(const Entry& left, const Entry& right);
+
+    void siftUp(size_t index);
+    void siftDown(size_t index);
+    void swapEntries(size_t left, size_t right);
+    void removeAt(size_t index);
+
+    std::vector<Entry> _heap;
+    std::unordered_map<int, size_t> _indices;
+    uint64_t _nextSequence { 0 };
+};
+
+#endif // hifi_ResourceRequestQueue_h
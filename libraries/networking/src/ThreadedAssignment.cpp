@@ -15,6 +15,7 @@
 #include <QtCore/QTimer>
 
 #include <LogHandler.h>
+#include <MetricsRegistry.h>
 
 #include "ThreadedAssignment.h"
 
@@ -104,6 +105,10 @@ void ThreadedAssignment::addPacketStatsAndSendStatsPacket(QJsonObject statsObjec
 
     statsObject["io_stats"] = ioStats;
 
+    if (auto metrics = DependencyManager::get<MetricsRegistry>()) {
+        metrics->publishStats(getTypeName(), statsObject);
+    }
+
     nodeList->sendStatsToDomainServer(statsObject);
 }
 
@@ -86,12 +86,9 @@ void OctreeElement::init(unsigned char * octalCode) {
 
 #ifdef SIMPLE_EXTERNAL_CHILDREN
     _childrenSingle.reset();
+    _externalChildren = nullptr;
 #endif
 
-    for (int i = 0; i < NUMBER_OF_CHILDREN; i ++) {
-        _externalChildren[i].reset();
-    }
-
     _isDirty = true;
     _shouldRender = false;
     _sourceUUIDKey = 0;
@@ -258,28 +255,14 @@ OctreeElementPointer OctreeElement::getChildAtIndex(int childIndex) const {
 #endif // SIMPLE_CHILD_ARRAY
 
 #ifdef SIMPLE_EXTERNAL_CHILDREN
-    int childCount = getChildCount();
-
-    switch (childCount) {
-        case 0: {
-            return NULL;
-        } break;
-
-        case 1: {
-            // if our single child is the one being requested, return it, otherwise
-            // return null
-            int firstIndex = getNthBit(_childBitmask, 1);
-            if (firstIndex == childIndex) {
-                return _childrenSingle;
-            } else {
-                return NULL;
-            }
-        } break;
-
-        default : {
-            return _externalChildren[childIndex];
-        } break;
+    if (!oneAtBit(_childBitmask, childIndex)) {
+        return NULL;
     }
+    if (!_childrenExternal) {
+        // our single child is the one being requested
+        return _childrenSingle;
+    }
+    return _externalChildren[getChildRank(childIndex)];
 #endif // def SIMPLE_EXTERNAL_CHILDREN
 }
 
@@ -292,12 +275,16 @@ void OctreeElement::deleteAllChildren() {
         }
     }
 
+#ifdef SIMPLE_EXTERNAL_CHILDREN
+    _childrenSingle.reset();
     if (_childrenExternal) {
-        // if the children_t union represents _children.external we need to delete it here
-        for (int i = 0; i < NUMBER_OF_CHILDREN; i ++) {
-            _externalChildren[i].reset();
-        }
+        // if the children are external we need to delete their array here
+        _externalChildrenMemoryUsage -= getChildCount() * sizeof(OctreeElementPointer);
+        delete[] _externalChildren;
+        _externalChildren = nullptr;
+        _childrenExternal = false;
     }
+#endif
 }
 
 void OctreeElement::setChildAtIndex(int childIndex, OctreeElementPointer child) {
@@ -321,9 +308,26 @@ void OctreeElement::setChildAtIndex(int childIndex, OctreeElementPointer child)
 #endif
 
 #ifdef SIMPLE_EXTERNAL_CHILDREN
+    bool hadChild = oneAtBit(_childBitmask, childIndex);
+    if (hadChild && child) {
+        // replacing a child doesn't change the layout
+        if (_childrenExternal) {
+            _externalChildren[getChildRank(childIndex)] = child;
+        } else {
+            _childrenSingle = child;
+        }
+        return;
+    }
+    if (!hadChild && !child) {
+        return;
+    }
 
-    int firstIndex = getNthBit(_childBitmask, 1);
-    int secondIndex = getNthBit(_childBitmask, 2);
+    // gather the children by index, then store them again in the layout of the new count
+    OctreeElementPointer children[NUMBER_OF_CHILDREN];
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        children[i] = getChildAtIndex(i);
+    }
+    children[childIndex] = child;
 
     int previousChildCount = getChildCount();
     if (child) {
@@ -334,47 +338,31 @@ void OctreeElement::setChildAtIndex(int childIndex, OctreeElementPointer child)
     int newChildCount = getChildCount();
 
     // track our population data
-    if (previousChildCount != newChildCount) {
-        _childrenCount[previousChildCount]--;
-        _childrenCount[newChildCount]++;
-    }
-
-    if ((previousChildCount == 0 || previousChildCount == 1) && newChildCount == 0) {
-        _childrenSingle.reset();
-    } else if (previousChildCount == 0 && newChildCount == 1) {
-        _childrenSingle = child;
-    } else if (previousChildCount == 1 && newChildCount == 2) {
-        OctreeElementPointer previousChild = _childrenSingle;
-        for (int i = 0; i < NUMBER_OF_CHILDREN; i ++) {
-            _externalChildren[i].reset();
-        }
-        _externalChildren[firstIndex] = previousChild;
-        _externalChildren[childIndex] = child;
-
-        _childrenExternal = true;
-
-        _externalChildrenMemoryUsage += NUMBER_OF_CHILDREN * sizeof(OctreeElementPointer);
-
-    } else if (previousChildCount == 2 && newChildCount == 1) {
-        assert(!child); // we are removing a child, so this must be true!
-        OctreeElementPointer previousFirstChild = _externalChildren[firstIndex];
-        OctreeElementPointer previousSecondChild = _externalChildren[secondIndex];
+    _childrenCount[previousChildCount]--;
+    _childrenCount[newChildCount]++;
 
-        for (int i = 0; i < NUMBER_OF_CHILDREN; i ++) {
-            _externalChildren[i].reset();
-        }
+    if (_childrenExternal) {
+        _externalChildrenMemoryUsage -= previousChildCount * sizeof(OctreeElementPointer);
+        delete[] _externalChildren;
+        _externalChildren = nullptr;
         _childrenExternal = false;
+    }
+    _childrenSingle.reset();
 
-        _externalChildrenMemoryUsage -= NUMBER_OF_CHILDREN * sizeof(OctreeElementPointer);
-        if (childIndex == firstIndex) {
-            _childrenSingle = previousSecondChild;
-        } else {
-            _childrenSingle = previousFirstChild;
+    if (newChildCount == 1) {
+        _childrenSingle = children[getNthBit(_childBitmask, 1)];
+    } else if (newChildCount > 1) {
+        // external children are packed: only the existing children are stored, in index order
+        _externalChildren = new OctreeElementPointer[newChildCount];
+        _childrenExternal = true;
+        _externalChildrenMemoryUsage += newChildCount * sizeof(OctreeElementPointer);
+        int rank = 0;
+        for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+            if (children[i]) {
+                _externalChildren[rank++] = std::move(children[i]);
+            }
         }
-    } else {
-        _externalChildren[childIndex] = child;
     }
-
 #endif // def SIMPLE_EXTERNAL_CHILDREN
 }
 
@@ -224,6 +224,9 @@ protected:
     void deleteAllChildren();
     void setChildAtIndex(int childIndex, OctreeElementPointer child);
 
+    // the number of existing children before childIndex, that is its place among the external children
+    int getChildRank(int childIndex) const { return numberOfOnes(_childBitmask & (unsigned char)(0xff00 >> childIndex)); }
+
     void calculateAACube();
 
     AACube _cube; /// Client and server, axis aligned box for bounds of this voxel, 48 bytes
@@ -242,10 +245,9 @@ protected:
 #endif
 
 #ifdef SIMPLE_EXTERNAL_CHILDREN
-    // union children_t {
+    // a single child is stored inline, more are in an array of exactly as many pointers, ordered by child index
     OctreeElementPointer _childrenSingle;
-    OctreeElementPointer _externalChildren[NUMBER_OF_CHILDREN];
-    // } _children;
+    OctreeElementPointer* _externalChildren;
 #endif
 
     uint16_t _sourceUUIDKey; /// Client only, stores node id of voxel server that sent his voxel, 2 bytes
@@ -0,0 +1,184 @@
+//
+//  OctreeElementPool.h
+//  libraries/octree/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_OctreeElementPool_h
+#define hifi_OctreeElementPool_h
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+
+// Blocks of one size carved out of large chunks.  Octree elements come and go by the thousands as trees are
+// loaded and edited: pooling them packs neighbouring elements (and their shared_ptr control blocks) together,
+// without a heap header per allocation.  Blocks are taken from the chunk with the lowest address that has room, so
+// the live elements gather in the oldest chunks and the others empty out when a tree is pruned or erased.  An empty
+// chunk is given back to the heap, except for one that is kept for the next allocations.
+template <size_t BlockSize>
+class OctreeElementPool {
+public:
+    static OctreeElementPool& getInstance() {
+        // never destroyed: elements of static trees may be freed during static destruction
+        static OctreeElementPool* instance = new OctreeElementPool();
+        return *instance;
+    }
+
+    void* allocate() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_chunksWithFreeBlocks.empty()) {
+            addChunk();
+        }
+        Chunk& chunk = *_chunksWithFreeBlocks.begin()->second;
+        FreeBlock* block = chunk.freeBlocks;
+        chunk.freeBlocks = block->next;
+        if (!chunk.freeBlocks) {
+            _chunksWithFreeBlocks.erase(chunk.memory);
+        }
+        if (chunk.usedBlocks++ == 0) {
+            _emptyChunkCount--;
+        }
+        return block;
+    }
+
+    void free(void* memory) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        // the chunk with the highest address at or below the block
+        auto chunkItr = --_chunks.upper_bound(static_cast<char*>(memory));
+        Chunk& chunk = chunkItr->second;
+
+        FreeBlock* block = static_cast<FreeBlock*>(memory);
+        block->next = chunk.freeBlocks;
+        if (!chunk.freeBlocks) {
+            _chunksWithFreeBlocks[chunk.memory] = &chunk;
+        }
+        chunk.freeBlocks = block;
+
+        if (--chunk.usedBlocks == 0) {
+            if (_emptyChunkCount < MAX_EMPTY_CHUNKS) {
+                _emptyChunkCount++;
+            } else {
+                releaseChunk(chunkItr);
+            }
+        }
+    }
+
+    size_t getChunkCount() const {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _chunks.size();
+    }
+
+    /// the bytes held from the heap, used or not
+    size_t getReservedBytes() const { return getChunkCount() * BLOCKS_PER_CHUNK * ALIGNED_BLOCK_SIZE; }
+
+private:
+    class FreeBlock {
+    public:
+        FreeBlock* next;
+    };
+
+    class Chunk {
+    public:
+        char* memory;
+        FreeBlock* freeBlocks;
+        size_t usedBlocks;
+    };
+
+    static const size_t ALIGNMENT = 16;
+    static const size_t ALIGNED_BLOCK_SIZE = ((BlockSize < sizeof(FreeBlock) ? sizeof(FreeBlock) : BlockSize) +
+        ALIGNMENT - 1) & ~(ALIGNMENT - 1);
+    static const size_t CHUNK_SIZE = 64 * 1024;
+    static const size_t BLOCKS_PER_CHUNK = CHUNK_SIZE / ALIGNED_BLOCK_SIZE > 0 ? CHUNK_SIZE / ALIGNED_BLOCK_SIZE : 1;
+    static const size_t MAX_EMPTY_CHUNKS = 1;
+
+    OctreeElementPool() {}
+
+    // the blocks of a chunk are linked in address order, so consecutive allocations are adjacent
+    void addChunk() {
+        char* memory = static_cast<char*>(::operator new(BLOCKS_PER_CHUNK * ALIGNED_BLOCK_SIZE));
+        FreeBlock* freeBlocks = nullptr;
+        for (size_t i = BLOCKS_PER_CHUNK; i > 0; i--) {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(memory + (i - 1) * ALIGNED_BLOCK_SIZE);
+            block->next = freeBlocks;
+            freeBlocks = block;
+        }
+        Chunk& chunk = _chunks[memory];
+        chunk.memory = memory;
+        chunk.freeBlocks = freeBlocks;
+        chunk.usedBlocks = 0;
+        _chunksWithFreeBlocks[memory] = &chunk;
+        _emptyChunkCount++;
+    }
+
+    void releaseChunk(typename std::map<char*, Chunk>::iterator chunkItr) {
+        char* memory = chunkItr->first;
+        _chunksWithFreeBlocks.erase(memory);
+        _chunks.erase(chunkItr);
+        ::operator delete(memory);
+    }
+
+    mutable std::mutex _mutex;
+    std::map<char*, Chunk> _chunks; // by address, to find the chunk of a freed block
+    std::map<char*, Chunk*> _chunksWithFreeBlocks; // by address, allocations come from the first one
+    size_t _emptyChunkCount { 0 };
+};
+
+// Allocates the control blocks of pooled elements from the pool of their own size
+template <typename T>
+class OctreeElementAllocator {
+public:
+    using value_type = T;
+
+    OctreeElementAllocator() {}
+    template <typename U> OctreeElementAllocator(const OctreeElementAllocator<U>&) {}
+
+    T* allocate(size_t n) {
+        if (n != 1) {
+            return static_cast<T*>(::operator new(n * sizeof(T)));
+        }
+        return static_cast<T*>(OctreeElementPool<sizeof(T)>::getInstance().allocate());
+    }
+
+    void deallocate(T* memory, size_t n) {
+        if (n != 1) {
+            ::operator delete(memory);
+            return;
+        }
+        OctreeElementPool<sizeof(T)>::getInstance().free(memory);
+    }
+
+    template <typename U> bool operator==(const OctreeElementAllocator<U>&) const { return true; }
+    template <typename U> bool operator!=(const OctreeElementAllocator<U>&) const { return false; }
+};
+
+/// Memory for an element of type T, to construct with placement new where the constructor of T is accessible,
+/// then hand to adoptPooledElement
+template <typename T>
+void* allocatePooledElement() {
+    static_assert(alignof(T) <= 16, "pooled elements are 16 byte aligned");
+    return OctreeElementPool<sizeof(T)>::getInstance().allocate();
+}
+
+template <typename T>
+class PooledElementDeleter {
+public:
+    void operator()(T* element) const {
+        element->~T();
+        OctreeElementPool<sizeof(T)>::getInstance().free(element);
+    }
+};
+
+/// \return a pointer owning an element constructed in memory from allocatePooledElement<T>()
+template <typename T>
+std::shared_ptr<T> adoptPooledElement(T* element) {
+    return std::shared_ptr<T>(element, PooledElementDeleter<T>(), OctreeElementAllocator<T>());
+}
+
+#endif // hifi_OctreeElementPool_h
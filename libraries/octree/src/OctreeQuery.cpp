@@ -134,13 +134,21 @@ int OctreeQuery::parseData(ReceivedMessage& message) {
         // grab the parameter object from the packed binary representation of JSON
         auto newJsonDocument = QJsonDocument::fromBinaryData(binaryJSONParameters);
         
-        QWriteLocker jsonParameterLocker { &_jsonParametersLock };
-        _jsonParameters = newJsonDocument.object();
+        setJSONParameters(newJsonDocument.object());
     }
     
     return sourceBuffer - startPosition;
 }
 
+void OctreeQuery::setJSONParameters(const QJsonObject& jsonParameters) {
+    QWriteLocker locker { &_jsonParametersLock };
+    // the parameters are sent with every query, only count actual changes
+    if (jsonParameters != _jsonParameters) {
+        _jsonParameters = jsonParameters;
+        _jsonParametersVersion++;
+    }
+}
+
 glm::vec3 OctreeQuery::calculateCameraDirection() const {
     glm::vec3 direction = glm::vec3(_cameraOrientation * glm::vec4(IDENTITY_FORWARD, 0.0f));
     return direction;
@@ -27,6 +27,7 @@ typedef unsigned long long quint64;
 #include <inttypes.h>
 #endif
 
+#include <atomic>
 
 #include <glm/glm.hpp>
 #include <glm/gtc/quaternion.hpp>
@@ -71,8 +72,9 @@ public:
     
     // getters/setters for JSON filter
     QJsonObject getJSONParameters() { QReadLocker locker { &_jsonParametersLock }; return _jsonParameters; }
-    void setJSONParameters(const QJsonObject& jsonParameters)
-        { QWriteLocker locker { &_jsonParametersLock }; _jsonParameters = jsonParameters; }
+    void setJSONParameters(const QJsonObject& jsonParameters);
+    // bumped every time the JSON parameters actually change, so what is derived from them can be cached
+    uint32_t getJSONParametersVersion() const { return _jsonParametersVersion; }
     
     // related to Octree Sending strategies
     int getMaxQueryPacketsPerSecond() const { return _maxQueryPPS; }
@@ -107,6 +109,7 @@ protected:
     
     QJsonObject _jsonParameters;
     QReadWriteLock _jsonParametersLock;
+    std::atomic<uint32_t> _jsonParametersVersion { 0 };
     
 private:
     // privatize the copy constructor and assignment operator so they cannot be called
@@ -61,6 +61,7 @@ void PhysicalEntitySimulation::removeEntityInternal(EntityItemPointer entity) {
         EntitySimulation::removeEntityInternal(entity);
         QMutexLocker lock(&_mutex);
         _entitiesToAddToPhysics.remove(entity);
+        _shapeInfosBeingBuilt.remove(entity);
 
         EntityMotionState* motionState = static_cast<EntityMotionState*>(entity->getPhysicsInfo());
         if (motionState) {
@@ -110,6 +111,7 @@ void PhysicalEntitySimulation::changeEntityInternal(EntityItemPointer entity) {
         // The intent is for this object to be in the PhysicsEngine, but it has no MotionState yet.
         // Perhaps it's shape has changed and it can now be added?
         _entitiesToAddToPhysics.insert(entity);
+        _shapeInfosBeingBuilt.remove(entity);
         _simpleKinematicEntities.remove(entity); // just in case it's non-physical-kinematic
     } else if (entity->isMovingRelativeToParent()) {
         _simpleKinematicEntities.insert(entity);
@@ -148,6 +150,7 @@ void PhysicalEntitySimulation::clearEntitiesInternal() {
     _entitiesToRemoveFromPhysics.clear();
     _entitiesToRelease.clear();
     _entitiesToAddToPhysics.clear();
+    _shapeInfosBeingBuilt.clear();
     _pendingChanges.clear();
     _outgoingChanges.clear();
 }
@@ -167,6 +170,7 @@ void PhysicalEntitySimulation::getObjectsToRemoveFromPhysics(VectorOfMotionState
     for (auto entity: _entitiesToRemoveFromPhysics) {
         // make sure it isn't on any side lists
         _entitiesToAddToPhysics.remove(entity);
+        _shapeInfosBeingBuilt.remove(entity);
 
         EntityMotionState* motionState = static_cast<EntityMotionState*>(entity->getPhysicsInfo());
         if (motionState) {
@@ -208,30 +212,39 @@ void PhysicalEntitySimulation::getObjectsToAddToPhysics(VectorOfMotionStates& re
         assert(!entity->getPhysicsInfo());
         if (entity->isDead()) {
             prepareEntityForDelete(entity);
+            _shapeInfosBeingBuilt.remove(entity);
             entityItr = _entitiesToAddToPhysics.erase(entityItr);
         } else if (!entity->shouldBePhysical()) {
             // this entity should no longer be on the internal _entitiesToAddToPhysics
+            _shapeInfosBeingBuilt.remove(entity);
             entityItr = _entitiesToAddToPhysics.erase(entityItr);
             if (entity->isMovingRelativeToParent()) {
                 _simpleKinematicEntities.insert(entity);
             }
         } else if (entity->isReadyToComputeShape()) {
-            ShapeInfo shapeInfo;
-            entity->computeShapeInfo(shapeInfo);
-            int numPoints = shapeInfo.getLargestSubshapePointCount();
-            if (shapeInfo.getType() == SHAPE_TYPE_COMPOUND) {
-                if (numPoints > MAX_HULL_POINTS) {
-                    qWarning() << "convex hull with" << numPoints
-                        << "points for entity" << entity->getName()
-                        << "at" << entity->getPosition() << " will be reduced";
+            // meshes and hulls are built in the background, the entity is added once its shape is ready
+            // and its shape info is kept meanwhile rather than computed again every frame
+            auto shapeInfoItr = _shapeInfosBeingBuilt.find(entity);
+            if (shapeInfoItr == _shapeInfosBeingBuilt.end()) {
+                ShapeInfo shapeInfo;
+                entity->computeShapeInfo(shapeInfo);
+                int numPoints = shapeInfo.getLargestSubshapePointCount();
+                if (shapeInfo.getType() == SHAPE_TYPE_COMPOUND) {
+                    if (numPoints > MAX_HULL_POINTS) {
+                        qWarning() << "convex hull with" << numPoints
+                            << "points for entity" << entity->getName()
+                            << "at" << entity->getPosition() << " will be reduced";
+                    }
                 }
+                shapeInfoItr = _shapeInfosBeingBuilt.insert(entity, shapeInfo);
             }
-            btCollisionShape* shape = const_cast<btCollisionShape*>(ObjectMotionState::getShapeManager()->getShape(shapeInfo));
+            btCollisionShape* shape = const_cast<btCollisionShape*>(ObjectMotionState::getShapeManager()->requestShape(shapeInfoItr.value()));
             if (shape) {
                 EntityMotionState* motionState = new EntityMotionState(shape, entity);
                 entity->setPhysicsInfo(static_cast<void*>(motionState));
                 _physicalObjects.insert(motionState);
                 result.push_back(motionState);
+                _shapeInfosBeingBuilt.erase(shapeInfoItr);
                 entityItr = _entitiesToAddToPhysics.erase(entityItr);
             } else {
                 //qWarning() << "Failed to generate new shape for entity." << entity->getName();
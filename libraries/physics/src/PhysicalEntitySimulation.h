@@ -19,6 +19,7 @@
 
 #include <EntityItem.h>
 #include <EntitySimulation.h>
+#include <ShapeInfo.h>
 
 #include "PhysicsEngine.h"
 #include "EntityMotionState.h"
@@ -66,6 +67,7 @@ private:
     SetOfEntities _entitiesToRemoveFromPhysics;
     SetOfEntities _entitiesToRelease;
     SetOfEntities _entitiesToAddToPhysics;
+    QHash<EntityItemPointer, ShapeInfo> _shapeInfosBeingBuilt; // of _entitiesToAddToPhysics waiting for their shape
 
     SetOfEntityMotionStates _pendingChanges; // EntityMotionStates already in PhysicsEngine that need their physics changed
     SetOfEntityMotionStates _outgoingChanges; // EntityMotionStates for which we may need to send updates to entity-server
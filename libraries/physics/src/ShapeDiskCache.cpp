@@ -0,0 +1,281 @@
+//
+//  ShapeDiskCache.cpp
+//  libraries/physcis/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ShapeDiskCache.h"
+
+#include <QtCore/QCryptographicHash>
+#include <QtCore/QDataStream>
+#include <QtCore/QDir>
+#include <QtCore/QFile>
+#include <QtCore/QSaveFile>
+
+#include "PhysicsLogging.h"
+#include "ShapeFactory.h"
+
+static const quint32 SHAPE_FILE_MAGIC = 0x48465343; // "HFSC"
+static const char* SHAPE_FILE_EXTENSION = ".shape";
+
+// the header fields that must match for the bvh blobs to be readable in place
+static const quint8 POINTER_SIZE = (quint8)sizeof(void*);
+static const quint8 SCALAR_SIZE = (quint8)sizeof(btScalar);
+
+enum ShapeTag : quint8 {
+    CONVEX_HULL_TAG = 1,
+    COMPOUND_TAG,
+    STATIC_MESH_TAG
+};
+
+// the largest compound stored, deeper ones are not expected from ShapeFactory
+static const int MAX_SHAPE_DEPTH = 4;
+
+static QDataStream& operator<<(QDataStream& stream, const btVector3& vector) {
+    return stream << (float)vector.getX() << (float)vector.getY() << (float)vector.getZ();
+}
+
+static QDataStream& operator>>(QDataStream& stream, btVector3& vector) {
+    float x, y, z;
+    stream >> x >> y >> z;
+    vector.setValue(x, y, z);
+    return stream;
+}
+
+static bool writeShape(QDataStream& stream, const btCollisionShape* shape, int depth) {
+    switch (shape->getShapeType()) {
+        case CONVEX_HULL_SHAPE_PROXYTYPE: {
+            const btConvexHullShape* hull = static_cast<const btConvexHullShape*>(shape);
+            int numPoints = hull->getNumPoints();
+            const btVector3* points = hull->getUnscaledPoints();
+            stream << (quint8)CONVEX_HULL_TAG << (float)hull->getMargin() << (quint32)numPoints;
+            for (int i = 0; i < numPoints; ++i) {
+                stream << points[i];
+            }
+            return true;
+        }
+        case COMPOUND_SHAPE_PROXYTYPE: {
+            if (depth >= MAX_SHAPE_DEPTH) {
+                return false;
+            }
+            const btCompoundShape* compound = static_cast<const btCompoundShape*>(shape);
+            int numChildren = compound->getNumChildShapes();
+            stream << (quint8)COMPOUND_TAG << (quint32)numChildren;
+            for (int i = 0; i < numChildren; ++i) {
+                const btTransform& transform = compound->getChildTransform(i);
+                const btMatrix3x3& basis = transform.getBasis();
+                stream << basis[0] << basis[1] << basis[2] << transform.getOrigin();
+                if (!writeShape(stream, compound->getChildShape(i), depth + 1)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case TRIANGLE_MESH_SHAPE_PROXYTYPE: {
+            // Bullet only hands out the bvh of a non-const shape, serializing it doesn't modify it
+            btBvhTriangleMeshShape* mesh = const_cast<btBvhTriangleMeshShape*>(static_cast<const btBvhTriangleMeshShape*>(shape));
+            const btOptimizedBvh* bvh = mesh->getOptimizedBvh();
+            if (!bvh) {
+                return false;
+            }
+            unsigned size = bvh->calculateSerializeBufferSize();
+            const int BVH_ALIGNMENT = 16;
+            void* buffer = btAlignedAlloc(size, BVH_ALIGNMENT);
+            bool serialized = bvh->serializeInPlace(buffer, size, false);
+            if (serialized) {
+                stream << (quint8)STATIC_MESH_TAG << (quint32)size;
+                stream.writeRawData(static_cast<const char*>(buffer), (int)size);
+            }
+            btAlignedFree(buffer);
+            return serialized;
+        }
+        default:
+            return false;
+    }
+}
+
+static btCollisionShape* readShape(QDataStream& stream, const ShapeInfo& info, int depth) {
+    quint8 tag;
+    stream >> tag;
+    if (stream.status() != QDataStream::Ok) {
+        throw QString("truncated shape");
+    }
+    switch (tag) {
+        case CONVEX_HULL_TAG: {
+            float margin;
+            quint32 numPoints;
+            stream >> margin >> numPoints;
+            const quint32 MAX_STORED_HULL_POINTS = 65536;
+            if (stream.status() != QDataStream::Ok || numPoints == 0 || numPoints > MAX_STORED_HULL_POINTS) {
+                throw QString("invalid hull");
+            }
+            btConvexHullShape* hull = new btConvexHullShape();
+            hull->setMargin(margin);
+            for (quint32 i = 0; i < numPoints; ++i) {
+                btVector3 point;
+                stream >> point;
+                hull->addPoint(point, false);
+            }
+            hull->recalcLocalAabb();
+            if (stream.status() != QDataStream::Ok) {
+                delete hull;
+                throw QString("truncated hull");
+            }
+            return hull;
+        }
+        case COMPOUND_TAG: {
+            quint32 numChildren;
+            stream >> numChildren;
+            const quint32 MAX_STORED_CHILDREN = 65536;
+            if (stream.status() != QDataStream::Ok || depth >= MAX_SHAPE_DEPTH || numChildren > MAX_STORED_CHILDREN) {
+                throw QString("invalid compound");
+            }
+            btCompoundShape* compound = new btCompoundShape();
+            try {
+                for (quint32 i = 0; i < numChildren; ++i) {
+                    btVector3 rows[3];
+                    btVector3 origin;
+                    stream >> rows[0] >> rows[1] >> rows[2] >> origin;
+                    btTransform transform(btMatrix3x3(rows[0].getX(), rows[0].getY(), rows[0].getZ(),
+                                                      rows[1].getX(), rows[1].getY(), rows[1].getZ(),
+                                                      rows[2].getX(), rows[2].getY(), rows[2].getZ()), origin);
+                    compound->addChildShape(transform, readShape(stream, info, depth + 1));
+                }
+            } catch (const QString&) {
+                ShapeFactory::deleteShape(compound);
+                throw;
+            }
+            return compound;
+        }
+        case STATIC_MESH_TAG: {
+            quint32 size;
+            stream >> size;
+            if (stream.status() != QDataStream::Ok || size > (quint32)(stream.device()->bytesAvailable())) {
+                throw QString("invalid mesh");
+            }
+            const int BVH_ALIGNMENT = 16;
+            void* buffer = btAlignedAlloc(size, BVH_ALIGNMENT);
+            btOptimizedBvh* bvh = nullptr;
+            if (stream.readRawData(static_cast<char*>(buffer), (int)size) == (int)size) {
+                bvh = btOptimizedBvh::deSerializeInPlace(buffer, size, false);
+            }
+            if (!bvh) {
+                btAlignedFree(buffer);
+                throw QString("invalid bvh");
+            }
+            btCollisionShape* mesh = ShapeFactory::createStaticMeshShape(info, bvh);
+            if (!mesh) {
+                bvh->~btOptimizedBvh();
+                btAlignedFree(buffer);
+                throw QString("invalid mesh");
+            }
+            return mesh;
+        }
+        default:
+            throw QString("unknown shape tag %1").arg(tag);
+    }
+}
+
+// the hash of a ShapeInfo doesn't cover its points, and the model at a url may change between sessions
+static QByteArray hashContents(const ShapeInfo& info) {
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    const glm::vec3& halfExtents = info.getHalfExtents();
+    const glm::vec3& offset = info.getOffset();
+    hash.addData(reinterpret_cast<const char*>(&halfExtents), sizeof(glm::vec3));
+    hash.addData(reinterpret_cast<const char*>(&offset), sizeof(glm::vec3));
+    for (const ShapeInfo::PointList& points : info.getPointCollection()) {
+        int numPoints = points.size();
+        hash.addData(reinterpret_cast<const char*>(&numPoints), sizeof(int));
+        hash.addData(reinterpret_cast<const char*>(points.constData()), numPoints * (int)sizeof(glm::vec3));
+    }
+    const ShapeInfo::TriangleIndices& indices = info.getTriangleIndices();
+    hash.addData(reinterpret_cast<const char*>(indices.constData()), indices.size() * (int)sizeof(int32_t));
+    return hash.result();
+}
+
+ShapeDiskCache::ShapeDiskCache(const QString& directory) : _directory(directory) {
+    QDir().mkpath(_directory);
+}
+
+QString ShapeDiskCache::getFilePath(const ShapeInfo& info) const {
+    const DoubleHashKey& key = info.getHash();
+    return QDir(_directory).filePath(QString("%1%2%3").arg(key.getHash(), 8, 16, QChar('0'))
+        .arg(key.getHash2(), 8, 16, QChar('0')).arg(SHAPE_FILE_EXTENSION));
+}
+
+const btCollisionShape* ShapeDiskCache::loadShape(const ShapeInfo& info) const {
+    QFile file(getFilePath(info));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return nullptr;
+    }
+
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    quint32 magic, version, hash, hash2;
+    quint8 pointerSize, scalarSize;
+    qint32 bulletVersion, type;
+    QByteArray contents, checksum, payload;
+    stream >> magic >> version >> pointerSize >> scalarSize >> bulletVersion >> hash >> hash2 >> type >> contents;
+    if (stream.status() != QDataStream::Ok || magic != SHAPE_FILE_MAGIC || version != VERSION ||
+            pointerSize != POINTER_SIZE || scalarSize != SCALAR_SIZE || bulletVersion != BT_BULLET_VERSION ||
+            hash != info.getHash().getHash() || hash2 != info.getHash().getHash2() || type != (qint32)info.getType() ||
+            contents != hashContents(info)) {
+        // written by another version, or for another shape with the same file name
+        return nullptr;
+    }
+    stream >> checksum >> payload;
+    if (stream.status() != QDataStream::Ok || checksum != QCryptographicHash::hash(payload, QCryptographicHash::Md5)) {
+        qCWarning(physics) << "ShapeDiskCache::loadShape -- ignoring corrupt file" << file.fileName();
+        return nullptr;
+    }
+
+    QDataStream payloadStream(payload);
+    payloadStream.setVersion(QDataStream::Qt_5_0);
+    payloadStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+    try {
+        return readShape(payloadStream, info, 0);
+    } catch (const QString& error) {
+        qCWarning(physics) << "ShapeDiskCache::loadShape -- ignoring" << file.fileName() << ":" << error;
+        return nullptr;
+    }
+}
+
+bool ShapeDiskCache::saveShape(const ShapeInfo& info, const btCollisionShape* shape) const {
+    QByteArray payload;
+    {
+        QDataStream payloadStream(&payload, QIODevice::WriteOnly);
+        payloadStream.setVersion(QDataStream::Qt_5_0);
+        payloadStream.setFloatingPointPrecision(QDataStream::SinglePrecision);
+        if (!writeShape(payloadStream, shape, 0)) {
+            return false;
+        }
+    }
+
+    // written to a temporary file and renamed, so concurrent loads never see a partial file
+    QSaveFile file(getFilePath(info));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_5_0);
+    stream << SHAPE_FILE_MAGIC << VERSION << POINTER_SIZE << SCALAR_SIZE << (qint32)BT_BULLET_VERSION
+        << info.getHash().getHash() << info.getHash().getHash2() << (qint32)info.getType() << hashContents(info)
+        << QCryptographicHash::hash(payload, QCryptographicHash::Md5) << payload;
+    return stream.status() == QDataStream::Ok && file.commit();
+}
+
+void ShapeDiskCache::prune(qint64 maxSize) const {
+    QFileInfoList files = QDir(_directory).entryInfoList(QStringList() << QString("*") + SHAPE_FILE_EXTENSION,
+                                                         QDir::Files, QDir::Time);
+    qint64 size = 0;
+    for (const QFileInfo& fileInfo : files) {
+        size += fileInfo.size();
+        if (size > maxSize) {
+            QFile::remove(fileInfo.filePath());
+        }
+    }
+}
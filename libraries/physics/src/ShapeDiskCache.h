@@ -0,0 +1,50 @@
+//
+//  ShapeDiskCache.h
+//  libraries/physcis/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_ShapeDiskCache_h
+#define hifi_ShapeDiskCache_h
+
+#include <btBulletDynamicsCommon.h>
+
+#include <QtCore/QString>
+
+#include <ShapeInfo.h>
+
+// Stores built shapes in files named after the hash of their ShapeInfo, so the expensive parts of building them
+// (the bvh of a static mesh, the reduction of hull points) are done once per shape rather than once per session.
+// Convex hulls, compounds of them and static meshes are stored, other shapes are cheap to build and aren't.
+// Files are written in the native byte order and layout of the bvh: they aren't meant to be shared between
+// platforms or Bullet versions, and a file that doesn't match is ignored.
+// All methods may be called from any thread.
+class ShapeDiskCache {
+public:
+    static const quint32 VERSION = 1;
+    static const qint64 DEFAULT_MAX_SIZE = 256 * 1024 * 1024; // bytes
+
+    explicit ShapeDiskCache(const QString& directory);
+
+    const QString& getDirectory() const { return _directory; }
+
+    /// \return a new shape for info, or nullptr if none was stored or the file is invalid
+    const btCollisionShape* loadShape(const ShapeInfo& info) const;
+
+    /// \return true if the shape was stored, false if it is not a kind of shape that is stored or the write failed
+    bool saveShape(const ShapeInfo& info, const btCollisionShape* shape) const;
+
+    /// deletes the least recently written files until the cache is smaller than maxSize
+    void prune(qint64 maxSize = DEFAULT_MAX_SIZE) const;
+
+private:
+    QString getFilePath(const ShapeInfo& info) const;
+
+    QString _directory;
+};
+
+#endif // hifi_ShapeDiskCache_h
@@ -392,6 +392,15 @@ const btCollisionShape* ShapeFactory::createShapeFromInfo(const ShapeInfo& info)
     return shape;
 }
 
+btCollisionShape* ShapeFactory::createStaticMeshShape(const ShapeInfo& info, btOptimizedBvh* serializedBvh) {
+    assert(serializedBvh);
+    btTriangleIndexVertexArray* dataArray = createStaticMeshArray(info);
+    if (!dataArray) {
+        return nullptr;
+    }
+    return new StaticMeshShape(dataArray, serializedBvh);
+}
+
 void ShapeFactory::deleteShape(const btCollisionShape* shape) {
     assert(shape);
     // ShapeFactory is responsible for deleting all shapes, even the const ones that are stored
@@ -420,7 +429,21 @@ ShapeFactory::StaticMeshShape::StaticMeshShape(btTriangleIndexVertexArray* dataA
     assert(dataArray);
 }
 
+// the serializedBvh must have been quantized for the same mesh, it is used as is
+ShapeFactory::StaticMeshShape::StaticMeshShape(btTriangleIndexVertexArray* dataArray, btOptimizedBvh* serializedBvh)
+:   btBvhTriangleMeshShape(dataArray, true, false), _dataArray(dataArray), _serializedBvh(serializedBvh) {
+    assert(dataArray);
+    assert(serializedBvh);
+    setOptimizedBvh(serializedBvh);
+}
+
 ShapeFactory::StaticMeshShape::~StaticMeshShape() {
+    if (_serializedBvh) {
+        // deserialized in place: the bvh and its arrays live in one aligned buffer
+        _serializedBvh->~btOptimizedBvh();
+        btAlignedFree(_serializedBvh);
+        _serializedBvh = nullptr;
+    }
     deleteStaticMeshArray(_dataArray);
     _dataArray = nullptr;
 }
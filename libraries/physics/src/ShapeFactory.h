@@ -23,6 +23,10 @@ namespace ShapeFactory {
     const btCollisionShape* createShapeFromInfo(const ShapeInfo& info);
     void deleteShape(const btCollisionShape* shape);
 
+    // a SHAPE_TYPE_STATIC_MESH shape around a bvh that was serialized in place (see ShapeDiskCache) instead of built,
+    // the shape takes ownership of the bvh and its btAlignedAlloc'ed buffer
+    btCollisionShape* createStaticMeshShape(const ShapeInfo& info, btOptimizedBvh* serializedBvh);
+
     //btTriangleIndexVertexArray* createStaticMeshArray(const ShapeInfo& info);
     //void deleteStaticMeshArray(btTriangleIndexVertexArray* dataArray);
 
@@ -30,11 +34,14 @@ namespace ShapeFactory {
     public:
         StaticMeshShape() = delete;
         StaticMeshShape(btTriangleIndexVertexArray* dataArray);
+        StaticMeshShape(btTriangleIndexVertexArray* dataArray, btOptimizedBvh* serializedBvh);
         ~StaticMeshShape();
 
     private:
         // the StaticMeshShape owns its vertex/index data
         btTriangleIndexVertexArray* _dataArray;
+        // and the bvh it was given, if any (Bullet only frees the bvh it builds)
+        btOptimizedBvh* _serializedBvh { nullptr };
     };
 };
 
@@ -9,17 +9,110 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <mutex>
+
 #include <QDebug>
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
 
 #include <glm/gtx/norm.hpp>
 
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
+
+#include "ShapeDiskCache.h"
 #include "ShapeFactory.h"
 #include "ShapeManager.h"
 
-ShapeManager::ShapeManager() {
+// how long a built shape is kept for the object that requested it to ask again
+const quint64 UNCLAIMED_SHAPE_LIFETIME = 10 * USECS_PER_SECOND;
+
+class ShapeManager::BuiltShapes {
+public:
+    class BuiltShape {
+    public:
+        DoubleHashKey key;
+        const btCollisionShape* shape; // nullptr if the build failed
+    };
+
+    void push(const DoubleHashKey& key, const btCollisionShape* shape) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_abandoned) {
+            if (shape) {
+                ShapeFactory::deleteShape(shape);
+            }
+            return;
+        }
+        _shapes.push_back({ key, shape });
+    }
+
+    std::vector<BuiltShape> take() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::vector<BuiltShape> shapes;
+        shapes.swap(_shapes);
+        return shapes;
+    }
+
+    // the manager is gone, builds still running delete their shape
+    void abandon() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _abandoned = true;
+        for (auto& builtShape : _shapes) {
+            if (builtShape.shape) {
+                ShapeFactory::deleteShape(builtShape.shape);
+            }
+        }
+        _shapes.clear();
+    }
+
+private:
+    std::mutex _mutex;
+    std::vector<BuiltShape> _shapes;
+    bool _abandoned { false };
+};
+
+class ShapeManager::BuildTask : public QRunnable {
+public:
+    BuildTask(const ShapeInfo& info, const std::shared_ptr<const ShapeDiskCache>& diskCache,
+              const std::shared_ptr<BuiltShapes>& builtShapes) :
+        _info(info), _key(info.getHash()), _diskCache(diskCache), _builtShapes(builtShapes) {}
+
+    void run() override {
+        const btCollisionShape* shape = _diskCache ? _diskCache->loadShape(_info) : nullptr;
+        if (!shape) {
+            shape = ShapeFactory::createShapeFromInfo(_info);
+            if (shape && _diskCache) {
+                _diskCache->saveShape(_info, shape);
+            }
+        }
+        _builtShapes->push(_key, shape);
+    }
+
+private:
+    ShapeInfo _info;
+    DoubleHashKey _key;
+    std::shared_ptr<const ShapeDiskCache> _diskCache;
+    std::shared_ptr<BuiltShapes> _builtShapes;
+};
+
+namespace {
+
+class CachePruneTask : public QRunnable {
+public:
+    CachePruneTask(const std::shared_ptr<const ShapeDiskCache>& diskCache) : _diskCache(diskCache) {}
+    void run() override { _diskCache->prune(); }
+
+private:
+    std::shared_ptr<const ShapeDiskCache> _diskCache;
+};
+
+}
+
+ShapeManager::ShapeManager() : _builtShapes(std::make_shared<BuiltShapes>()) {
 }
 
 ShapeManager::~ShapeManager() {
+    _builtShapes->abandon();
     int numShapes = _shapeMap.size();
     for (int i = 0; i < numShapes; ++i) {
         ShapeReference* shapeRef = _shapeMap.getAtIndex(i);
@@ -28,16 +121,34 @@ ShapeManager::~ShapeManager() {
     _shapeMap.clear();
 }
 
-const btCollisionShape* ShapeManager::getShape(const ShapeInfo& info) {
+void ShapeManager::setCacheDirectory(const QString& directory) {
+    if (directory.isEmpty()) {
+        _diskCache.reset();
+    } else if (!_diskCache || _diskCache->getDirectory() != directory) {
+        _diskCache = std::make_shared<ShapeDiskCache>(directory);
+        QThreadPool::globalInstance()->start(new CachePruneTask(_diskCache));
+    }
+}
+
+// private helper method
+bool ShapeManager::canMakeShape(const ShapeInfo& info) const {
     if (info.getType() == SHAPE_TYPE_NONE) {
-        return nullptr;
+        return false;
     }
     const float MIN_SHAPE_DIAGONAL_SQUARED = 3.0e-4f; // 1 cm cube
     if (4.0f * glm::length2(info.getHalfExtents()) < MIN_SHAPE_DIAGONAL_SQUARED) {
         // tiny shapes are not supported
         // qCDebug(physics) << "ShapeManager::getShape -- not making shape due to size" << diagonal;
+        return false;
+    }
+    return true;
+}
+
+const btCollisionShape* ShapeManager::getShape(const ShapeInfo& info) {
+    if (!canMakeShape(info)) {
         return nullptr;
     }
+    takeBuiltShapes();
 
     DoubleHashKey key = info.getHash();
     ShapeReference* shapeRef = _shapeMap.find(key);
@@ -56,6 +167,71 @@ const btCollisionShape* ShapeManager::getShape(const ShapeInfo& info) {
     return shape;
 }
 
+const btCollisionShape* ShapeManager::requestShape(const ShapeInfo& info) {
+    if (!canMakeShape(info)) {
+        return nullptr;
+    }
+    takeBuiltShapes();
+
+    DoubleHashKey key = info.getHash();
+    ShapeReference* shapeRef = _shapeMap.find(key);
+    if (shapeRef) {
+        shapeRef->refCount++;
+        return shapeRef->shape;
+    }
+
+    switch (info.getType()) {
+        case SHAPE_TYPE_COMPOUND:
+        case SHAPE_TYPE_SIMPLE_HULL:
+        case SHAPE_TYPE_SIMPLE_COMPOUND:
+        case SHAPE_TYPE_STATIC_MESH:
+            break;
+        default:
+            // cheap enough to build right away
+            return getShape(info);
+    }
+
+    if (!_shapesBeingBuilt.find(key)) {
+        _shapesBeingBuilt.insert(key, key);
+        QThreadPool::globalInstance()->start(new BuildTask(info, _diskCache, _builtShapes));
+    }
+    return nullptr;
+}
+
+// private helper method
+void ShapeManager::takeBuiltShapes() {
+    quint64 now = usecTimestampNow();
+    for (auto& builtShape : _builtShapes->take()) {
+        _shapesBeingBuilt.remove(builtShape.key);
+        if (!builtShape.shape) {
+            continue;
+        }
+        if (_shapeMap.find(builtShape.key)) {
+            // getShape() built it meanwhile
+            ShapeFactory::deleteShape(builtShape.shape);
+            continue;
+        }
+        ShapeReference newRef;
+        newRef.refCount = 0;
+        newRef.shape = builtShape.shape;
+        newRef.key = builtShape.key;
+        _shapeMap.insert(builtShape.key, newRef);
+        _unclaimedShapes.push_back({ builtShape.key, now + UNCLAIMED_SHAPE_LIFETIME });
+    }
+
+    // the oldest are first
+    size_t numExpired = 0;
+    while (numExpired < _unclaimedShapes.size() && _unclaimedShapes[numExpired].expiry < now) {
+        const DoubleHashKey& key = _unclaimedShapes[numExpired].key;
+        ShapeReference* shapeRef = _shapeMap.find(key);
+        if (shapeRef && shapeRef->refCount == 0) {
+            _pendingGarbage.push_back(key);
+        }
+        ++numExpired;
+    }
+    _unclaimedShapes.erase(_unclaimedShapes.begin(), _unclaimedShapes.begin() + numExpired);
+}
+
 // private helper method
 bool ShapeManager::releaseShapeByKey(const DoubleHashKey& key) {
     ShapeReference* shapeRef = _shapeMap.find(key);
@@ -12,13 +12,20 @@
 #ifndef hifi_ShapeManager_h
 #define hifi_ShapeManager_h
 
+#include <memory>
+#include <vector>
+
 #include <btBulletDynamicsCommon.h>
 #include <LinearMath/btHashMap.h>
 
+#include <QtCore/QString>
+
 #include <ShapeInfo.h>
 
 #include "DoubleHashKey.h"
 
+class ShapeDiskCache;
+
 class ShapeManager {
 public:
 
@@ -28,6 +35,14 @@ public:
     /// \return pointer to shape
     const btCollisionShape* getShape(const ShapeInfo& info);
 
+    /// Like getShape(), but meshes and hulls are built on the global thread pool rather than on the calling thread.
+    /// \return pointer to shape, or nullptr while it is being built: the caller is expected to ask again later
+    const btCollisionShape* requestShape(const ShapeInfo& info);
+
+    /// Shapes built by requestShape() are stored in directory, later requests for them load them from there.
+    /// An empty directory (the default) disables the disk cache.
+    void setCacheDirectory(const QString& directory);
+
     /// \return true if shape was found and released
     bool releaseShape(const btCollisionShape* shape);
 
@@ -41,7 +56,12 @@ public:
     bool hasShape(const btCollisionShape* shape) const;
 
 private:
+    class BuiltShapes;
+    class BuildTask;
+
+    bool canMakeShape(const ShapeInfo& info) const;
     bool releaseShapeByKey(const DoubleHashKey& key);
+    void takeBuiltShapes();
 
     class ShapeReference {
     public:
@@ -53,6 +73,19 @@ private:
 
     btHashMap<DoubleHashKey, ShapeReference> _shapeMap;
     btAlignedObjectArray<DoubleHashKey> _pendingGarbage;
+
+    // built shapes are handed back through a queue shared with the builds, which may outlive the manager
+    std::shared_ptr<BuiltShapes> _builtShapes;
+    btHashMap<DoubleHashKey, DoubleHashKey> _shapesBeingBuilt;
+    std::shared_ptr<const ShapeDiskCache> _diskCache;
+
+    // built shapes nobody asked for again (their object was removed meanwhile) become garbage when they expire
+    class UnclaimedShape {
+    public:
+        DoubleHashKey key;
+        quint64 expiry;
+    };
+    std::vector<UnclaimedShape> _unclaimedShapes;
 };
 
 #endif // hifi_ShapeManager_h
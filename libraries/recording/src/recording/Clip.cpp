@@ -13,6 +13,7 @@
 
 #include "impl/FileClip.h"
 #include "impl/BufferClip.h"
+#include "impl/IndexedClip.h"
 
 #include <QtCore/QJsonDocument>
 #include <QtCore/QJsonObject>
@@ -22,6 +23,10 @@
 using namespace recording;
 
 Clip::Pointer Clip::fromFile(const QString& filePath) {
+    if (auto indexedClipData = IndexedClipData::fromFile(filePath)) {
+        return std::make_shared<IndexedClip>(indexedClipData);
+    }
+
     auto result = std::make_shared<FileClip>(filePath);
     if (result->frameCount() == 0) {
         return Clip::Pointer();
@@ -33,6 +38,18 @@ void Clip::toFile(const QString& filePath, const Clip::ConstPointer& clip) {
     FileClip::write(filePath, clip->duplicate());
 }
 
+bool Clip::toIndexedFile(const QString& filePath, const Clip::ConstPointer& clip) {
+    if (0 == clip->frameCount()) {
+        return false;
+    }
+
+    QFile outputFile(filePath);
+    if (!outputFile.open(QFile::Truncate | QFile::WriteOnly)) {
+        return false;
+    }
+    return IndexedClipData::write(outputFile, clip);
+}
+
 QByteArray Clip::toBuffer(const Clip::ConstPointer& clip) {
     QBuffer buffer;
     if (buffer.open(QFile::Truncate | QFile::WriteOnly)) {
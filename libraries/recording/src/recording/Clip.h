@@ -49,8 +49,11 @@ public:
 
     bool write(QIODevice& output);
 
+    // Reads both the legacy and the indexed formats
     static Pointer fromFile(const QString& filePath);
     static void toFile(const QString& filePath, const ConstPointer& clip);
+    // Delta compressed, with random access, see IndexedClipData
+    static bool toIndexedFile(const QString& filePath, const ConstPointer& clip);
     static QByteArray toBuffer(const ConstPointer& clip);
     static Pointer newClip();
     
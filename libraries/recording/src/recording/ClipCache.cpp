@@ -10,8 +10,7 @@
 
 using namespace recording;
 NetworkClipLoader::NetworkClipLoader(const QUrl& url) :
-    Resource(url),
-    _clip(std::make_shared<NetworkClip>(url)) {}
+    Resource(url) {}
 
 void NetworkClip::init(const QByteArray& clipData) {
     _clipData = clipData;
@@ -19,8 +18,24 @@ void NetworkClip::init(const QByteArray& clipData) {
 }
 
 void NetworkClipLoader::downloadFinished(const QByteArray& data) {
-    _clip->init(data);
-    finishedLoading(true);
+    if (IndexedClipData::isIndexedClip(reinterpret_cast<const uchar*>(data.constData()), data.size())) {
+        _clipData = IndexedClipData::fromBuffer(data, _url.toString());
+    } else {
+        // legacy clips are converted once so they can be shared the same way
+        auto clip = std::make_shared<NetworkClip>(_url);
+        clip->init(data);
+        if (clip->frameCount() > 0) {
+            _clipData = IndexedClipData::fromClip(clip, _url.toString());
+        }
+    }
+    finishedLoading((bool)_clipData);
+}
+
+ClipPointer NetworkClipLoader::getClip() {
+    if (!_clipData) {
+        return ClipPointer();
+    }
+    return std::make_shared<IndexedClip>(_clipData);
 }
 
 ClipCache& ClipCache::instance() {
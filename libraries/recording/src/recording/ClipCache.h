@@ -12,6 +12,7 @@
 #include <ResourceCache.h>
 
 #include "Forward.h"
+#include "impl/IndexedClip.h"
 #include "impl/PointerClip.h"
 
 namespace recording {
@@ -33,11 +34,12 @@ class NetworkClipLoader : public Resource {
 public:
     NetworkClipLoader(const QUrl& url);
     virtual void downloadFinished(const QByteArray& data) override;
-    ClipPointer getClip() { return _clip; }
+    // A new read cursor on the downloaded clip for every call, so any number of decks can play it at once
+    ClipPointer getClip();
     bool completed() { return _failedToLoad || isLoaded(); }
 
 private:
-    const NetworkClip::Pointer _clip;
+    IndexedClipData::Pointer _clipData;
 };
 
 using NetworkClipLoaderPointer = QSharedPointer<NetworkClipLoader>;
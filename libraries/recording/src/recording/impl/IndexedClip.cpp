@@ -0,0 +1,410 @@
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "IndexedClip.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include <QtCore/QBuffer>
+#include <QtCore/QDebug>
+#include <QtCore/QFile>
+#include <QtCore/QJsonObject>
+#include <QtCore/QMap>
+
+#include "../Frame.h"
+#include "../Logging.h"
+
+using namespace recording;
+
+// defined in PointerClip.cpp
+QMap<FrameType, FrameType> parseTranslationMap(const QJsonDocument& doc);
+
+const uint32_t IndexedClipData::MAGIC = 0x49524648; // "HFRI" in a little endian file
+const uint32_t IndexedClipData::VERSION = 1;
+const uint32_t IndexedClipData::FRAMES_PER_BLOCK = 64;
+
+static const QString FRAMES_PER_BLOCK_KEY = QStringLiteral("framesPerBlock");
+
+static const uint8_t ENCODING_WHOLE = 0;
+static const uint8_t ENCODING_DELTA = 1;
+
+static const size_t FILE_HEADER_SIZE = 3 * sizeof(uint32_t);
+static const size_t FOOTER_SIZE = sizeof(uint64_t) + 3 * sizeof(uint32_t);
+static const size_t FRAME_ENTRY_SIZE = 2 * sizeof(uint16_t) + 2 * sizeof(uint32_t);
+static const size_t BLOCK_ENTRY_SIZE = sizeof(uint64_t) + 2 * sizeof(uint32_t);
+static const size_t BLOCK_FRAME_HEADER_SIZE = sizeof(FrameType) + sizeof(uint8_t) + sizeof(uint32_t);
+
+template <typename T>
+static bool writeValue(QIODevice& output, const T& value) {
+    return output.write(reinterpret_cast<const char*>(&value), sizeof(T)) == sizeof(T);
+}
+
+template <typename T>
+static void appendValue(QByteArray& buffer, const T& value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// callers check the bounds
+template <typename T>
+static T readValue(const uchar*& current) {
+    T value;
+    memcpy(&value, current, sizeof(T));
+    current += sizeof(T);
+    return value;
+}
+
+static void xorInto(QByteArray& target, const QByteArray& reference) {
+    char* data = target.data();
+    const char* referenceData = reference.constData();
+    for (int i = 0; i < target.size(); i++) {
+        data[i] ^= referenceData[i];
+    }
+}
+
+IndexedClipData::~IndexedClipData() {
+    if (_file && _data) {
+        _file->unmap(const_cast<uchar*>(_data));
+    }
+}
+
+bool IndexedClipData::isIndexedClip(const uchar* data, size_t size) {
+    if (size < FILE_HEADER_SIZE + FOOTER_SIZE) {
+        return false;
+    }
+    uint32_t magic;
+    memcpy(&magic, data, sizeof(uint32_t));
+    return magic == MAGIC;
+}
+
+IndexedClipData::Pointer IndexedClipData::fromFile(const QString& filePath) {
+    std::unique_ptr<QFile> file(new QFile(filePath));
+    if (!file->open(QIODevice::ReadOnly)) {
+        return Pointer();
+    }
+
+    auto size = file->size();
+    uchar* mappedFile = file->map(0, size);
+    if (!mappedFile || !isIndexedClip(mappedFile, size)) {
+        if (mappedFile) {
+            file->unmap(mappedFile);
+        }
+        return Pointer();
+    }
+
+    std::shared_ptr<IndexedClipData> result(new IndexedClipData());
+    result->_name = filePath;
+    result->_file = std::move(file);
+    if (!result->init(mappedFile, size)) {
+        qCWarning(recordingLog) << "Invalid indexed clip" << filePath;
+        return Pointer();
+    }
+    return result;
+}
+
+IndexedClipData::Pointer IndexedClipData::fromBuffer(const QByteArray& buffer, const QString& name) {
+    std::shared_ptr<IndexedClipData> result(new IndexedClipData());
+    result->_name = name;
+    result->_buffer = buffer;
+    if (!result->init(reinterpret_cast<const uchar*>(result->_buffer.constData()), result->_buffer.size())) {
+        qCWarning(recordingLog) << "Invalid indexed clip" << name;
+        return Pointer();
+    }
+    return result;
+}
+
+IndexedClipData::Pointer IndexedClipData::fromClip(const ClipConstPointer& clip, const QString& name) {
+    QBuffer buffer;
+    buffer.open(QIODevice::WriteOnly);
+    if (!write(buffer, clip)) {
+        return Pointer();
+    }
+    buffer.close();
+    return fromBuffer(buffer.data(), name);
+}
+
+bool IndexedClipData::init(const uchar* data, size_t size) {
+    _data = data;
+    _size = size;
+    if (!isIndexedClip(data, size)) {
+        return false;
+    }
+
+    const uchar* current = data + sizeof(uint32_t);
+    uint32_t version = readValue<uint32_t>(current);
+    if (version != VERSION) {
+        qCWarning(recordingLog) << "Unsupported indexed clip version" << version;
+        return false;
+    }
+    uint32_t headerSize = readValue<uint32_t>(current);
+    if (headerSize > size - FILE_HEADER_SIZE - FOOTER_SIZE) {
+        return false;
+    }
+    _header = QJsonDocument::fromBinaryData(QByteArray::fromRawData(reinterpret_cast<const char*>(current), headerSize));
+
+    const uchar* footer = data + size - FOOTER_SIZE;
+    current = footer;
+    uint64_t frameTableOffset = readValue<uint64_t>(current);
+    uint32_t frameCount = readValue<uint32_t>(current);
+    uint32_t blockCount = readValue<uint32_t>(current);
+    uint32_t magic = readValue<uint32_t>(current);
+    uint64_t tablesSize = (uint64_t)frameCount * FRAME_ENTRY_SIZE + (uint64_t)blockCount * BLOCK_ENTRY_SIZE;
+    if (magic != MAGIC || frameTableOffset < FILE_HEADER_SIZE + headerSize ||
+            frameTableOffset + tablesSize != size - FOOTER_SIZE) {
+        return false;
+    }
+
+    auto translationMap = parseTranslationMap(_header);
+    if (translationMap.empty()) {
+        qCWarning(recordingLog) << "Header missing frame type map, invalid file";
+        return false;
+    }
+
+    // the frame table is small and translated to this process' frame types, so it's kept in memory
+    current = data + frameTableOffset;
+    _frames.reserve(frameCount);
+    for (uint32_t i = 0; i < frameCount; i++) {
+        FrameEntry entry;
+        entry.type = readValue<FrameType>(current);
+        entry.indexInBlock = readValue<uint16_t>(current);
+        entry.timeOffset = readValue<Frame::Time>(current);
+        entry.block = readValue<uint32_t>(current);
+        if (entry.block >= blockCount) {
+            return false;
+        }
+        if (!translationMap.contains(entry.type)) {
+            continue;
+        }
+        entry.type = translationMap[entry.type];
+        _frames.push_back(entry);
+    }
+
+    _blocks.reserve(blockCount);
+    for (uint32_t i = 0; i < blockCount; i++) {
+        BlockEntry entry;
+        entry.offset = readValue<uint64_t>(current);
+        entry.size = readValue<uint32_t>(current);
+        entry.reserved = readValue<uint32_t>(current);
+        if (entry.offset < FILE_HEADER_SIZE + headerSize || entry.offset + entry.size > frameTableOffset) {
+            return false;
+        }
+        _blocks.push_back(entry);
+    }
+    return true;
+}
+
+std::vector<QByteArray> IndexedClipData::decodeBlock(uint32_t block) const {
+    std::vector<QByteArray> payloads;
+    if (block >= _blocks.size()) {
+        return payloads;
+    }
+
+    const auto& entry = _blocks[block];
+    QByteArray blockData = qUncompress(_data + entry.offset, entry.size);
+    const uchar* current = reinterpret_cast<const uchar*>(blockData.constData());
+    const uchar* end = current + blockData.size();
+
+    // the last payload of each type, the reference of the next delta of that type
+    QMap<FrameType, int> previousOfType;
+    payloads.reserve(FRAMES_PER_BLOCK);
+    while (end - current >= (ptrdiff_t)BLOCK_FRAME_HEADER_SIZE) {
+        FrameType type = readValue<FrameType>(current);
+        uint8_t encoding = readValue<uint8_t>(current);
+        uint32_t size = readValue<uint32_t>(current);
+        if ((size_t)(end - current) < size) {
+            break;
+        }
+
+        QByteArray payload(reinterpret_cast<const char*>(current), size);
+        current += size;
+        if (encoding == ENCODING_DELTA) {
+            auto previous = previousOfType.find(type);
+            if (previous == previousOfType.end() || payloads[previous.value()].size() != payload.size()) {
+                break;
+            }
+            xorInto(payload, payloads[previous.value()]);
+        }
+        previousOfType[type] = (int)payloads.size();
+        payloads.push_back(payload);
+    }
+
+    if (current != end) {
+        qCWarning(recordingLog) << "Corrupted block" << block << "in" << _name;
+        payloads.clear();
+    }
+    return payloads;
+}
+
+bool IndexedClipData::write(QIODevice& output, const ClipConstPointer& clip) {
+    auto source = clip->duplicate();
+    source->seek(0);
+
+    auto frameTypes = Frame::getFrameTypes();
+    QJsonObject frameTypeObj;
+    for (const auto& frameTypeName : frameTypes.keys()) {
+        frameTypeObj[frameTypeName] = frameTypes[frameTypeName];
+    }
+    QJsonObject rootObject;
+    rootObject.insert(Clip::FRAME_TYPE_MAP, frameTypeObj);
+    rootObject.insert(FRAMES_PER_BLOCK_KEY, (int)FRAMES_PER_BLOCK);
+    QByteArray header = QJsonDocument(rootObject).toBinaryData();
+
+    if (!writeValue(output, MAGIC) || !writeValue(output, VERSION) || !writeValue(output, (uint32_t)header.size()) ||
+            output.write(header) != header.size()) {
+        return false;
+    }
+    uint64_t offset = FILE_HEADER_SIZE + header.size();
+
+    std::vector<FrameEntry> frames;
+    std::vector<BlockEntry> blocks;
+    QByteArray blockData;
+    QMap<FrameType, QByteArray> previousOfType;
+    uint16_t indexInBlock = 0;
+
+    auto flushBlock = [&]() -> bool {
+        if (indexInBlock == 0) {
+            return true;
+        }
+        QByteArray compressed = qCompress(blockData);
+        if (output.write(compressed) != compressed.size()) {
+            return false;
+        }
+        blocks.push_back({ offset, (uint32_t)compressed.size(), 0 });
+        offset += compressed.size();
+        blockData.clear();
+        previousOfType.clear();
+        indexInBlock = 0;
+        return true;
+    };
+
+    for (auto frame = source->nextFrame(); frame; frame = source->nextFrame()) {
+        if (frame->type == Frame::TYPE_INVALID) {
+            continue;
+        }
+
+        frames.push_back({ frame->type, indexInBlock, frame->timeOffset, (uint32_t)blocks.size() });
+
+        QByteArray payload = frame->data;
+        uint8_t encoding = ENCODING_WHOLE;
+        auto previous = previousOfType.find(frame->type);
+        if (previous != previousOfType.end() && previous.value().size() == payload.size()) {
+            encoding = ENCODING_DELTA;
+            xorInto(payload, previous.value());
+        }
+        previousOfType[frame->type] = frame->data;
+
+        appendValue(blockData, frame->type);
+        appendValue(blockData, encoding);
+        appendValue(blockData, (uint32_t)payload.size());
+        blockData.append(payload);
+
+        if (++indexInBlock == FRAMES_PER_BLOCK && !flushBlock()) {
+            return false;
+        }
+    }
+    if (!flushBlock()) {
+        return false;
+    }
+
+    uint64_t frameTableOffset = offset;
+    for (const auto& entry : frames) {
+        if (!writeValue(output, entry.type) || !writeValue(output, entry.indexInBlock) ||
+                !writeValue(output, entry.timeOffset) || !writeValue(output, entry.block)) {
+            return false;
+        }
+    }
+    for (const auto& entry : blocks) {
+        if (!writeValue(output, entry.offset) || !writeValue(output, entry.size) || !writeValue(output, entry.reserved)) {
+            return false;
+        }
+    }
+    return writeValue(output, frameTableOffset) && writeValue(output, (uint32_t)frames.size()) &&
+        writeValue(output, (uint32_t)blocks.size()) && writeValue(output, MAGIC);
+}
+
+Clip::Pointer IndexedClip::duplicate() const {
+    auto result = newClip();
+    Locker lock(_mutex);
+    for (size_t i = 0; i < frameCount(); ++i) {
+        result->addFrame(readFrame(i));
+    }
+    return result;
+}
+
+float IndexedClip::duration() const {
+    const auto& frames = _data->getFrames();
+    if (frames.empty()) {
+        return 0;
+    }
+    return Frame::frameTimeToSeconds(frames.back().timeOffset);
+}
+
+void IndexedClip::seekFrameTime(Frame::Time offset) {
+    Locker lock(_mutex);
+    const auto& frames = _data->getFrames();
+    auto itr = std::lower_bound(frames.begin(), frames.end(), offset,
+        [](const IndexedClipData::FrameEntry& a, Frame::Time b)->bool {
+            return a.timeOffset < b;
+        }
+    );
+    _frameIndex = itr - frames.begin();
+}
+
+Frame::Time IndexedClip::positionFrameTime() const {
+    Locker lock(_mutex);
+    Frame::Time result = Frame::INVALID_TIME;
+    if (_frameIndex < frameCount()) {
+        result = _data->getFrames()[_frameIndex].timeOffset;
+    }
+    return result;
+}
+
+FrameConstPointer IndexedClip::peekFrame() const {
+    Locker lock(_mutex);
+    FrameConstPointer result;
+    if (_frameIndex < frameCount()) {
+        result = readFrame(_frameIndex);
+    }
+    return result;
+}
+
+FrameConstPointer IndexedClip::nextFrame() {
+    Locker lock(_mutex);
+    FrameConstPointer result;
+    if (_frameIndex < frameCount()) {
+        result = readFrame(_frameIndex++);
+    }
+    return result;
+}
+
+void IndexedClip::skipFrame() {
+    Locker lock(_mutex);
+    if (_frameIndex < frameCount()) {
+        ++_frameIndex;
+    }
+}
+
+void IndexedClip::addFrame(FrameConstPointer) {
+    throw std::runtime_error("Indexed clips are read only, use duplicate to create a read/write clip");
+}
+
+// Internal only function, needs no locking
+FrameConstPointer IndexedClip::readFrame(size_t index) const {
+    const auto& entry = _data->getFrames()[index];
+    if (entry.block != _cachedBlock) {
+        _cachedPayloads = _data->decodeBlock(entry.block);
+        _cachedBlock = entry.block;
+    }
+
+    auto result = std::make_shared<Frame>();
+    result->type = entry.type;
+    result->timeOffset = entry.timeOffset;
+    if (entry.indexInBlock < _cachedPayloads.size()) {
+        result->data = _cachedPayloads[entry.indexInBlock];
+    }
+    return result;
+}
@@ -0,0 +1,131 @@
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#pragma once
+#ifndef hifi_Recording_Impl_IndexedClip_h
+#define hifi_Recording_Impl_IndexedClip_h
+
+#include "../Clip.h"
+
+#include <memory>
+#include <vector>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QJsonDocument>
+
+class QFile;
+
+namespace recording {
+
+// Immutable contents of an indexed clip, shared read-only by every IndexedClip playing it.
+//
+// Frames are stored in blocks of FRAMES_PER_BLOCK, each compressed on its own.  Inside a block the first frame
+// of every type is stored whole, the following ones as a byte delta against the previous frame of the same type,
+// which compresses to almost nothing for the mostly unchanged avatar frames.  A frame table and a block index at
+// the end of the file allow seeking to any time by decoding a single block.
+//
+//  magic | version | header size | header (binary JSON, frame type map)
+//  block 0 ... block N
+//  frame table: { type, time offset, block, index in block } per frame
+//  block index: { file offset, size } per block
+//  footer: frame table offset | frame count | block count | magic
+class IndexedClipData {
+public:
+    using Pointer = std::shared_ptr<const IndexedClipData>;
+
+    static const uint32_t MAGIC;
+    static const uint32_t VERSION;
+    static const uint32_t FRAMES_PER_BLOCK;
+
+    struct FrameEntry {
+        FrameType type;
+        uint16_t indexInBlock;
+        Frame::Time timeOffset;
+        uint32_t block;
+    };
+
+    struct BlockEntry {
+        uint64_t offset;
+        uint32_t size;
+        uint32_t reserved;
+    };
+
+    ~IndexedClipData();
+
+    // true if the data starts like an indexed clip, legacy clips start with their header frame
+    static bool isIndexedClip(const uchar* data, size_t size);
+
+    // The file is memory mapped, nullptr if it can't be opened or isn't a valid indexed clip
+    static Pointer fromFile(const QString& filePath);
+    static Pointer fromBuffer(const QByteArray& buffer, const QString& name);
+    // Encodes any clip in memory, so clips in the legacy format can be shared as well
+    static Pointer fromClip(const ClipConstPointer& clip, const QString& name);
+
+    static bool write(QIODevice& output, const ClipConstPointer& clip);
+
+    const QString& getName() const { return _name; }
+    const std::vector<FrameEntry>& getFrames() const { return _frames; }
+    size_t getBlockCount() const { return _blocks.size(); }
+
+    // Payloads of every frame in the block, in file order, empty on corrupted data
+    std::vector<QByteArray> decodeBlock(uint32_t block) const;
+
+private:
+    IndexedClipData() {}
+    bool init(const uchar* data, size_t size);
+
+    QString _name;
+    QJsonDocument _header;
+    std::vector<FrameEntry> _frames; // only the frames of types known to this process
+    std::vector<BlockEntry> _blocks;
+    const uchar* _data { nullptr };
+    size_t _size { 0 };
+
+    // whichever holds the bytes _data points to
+    std::unique_ptr<QFile> _file;
+    QByteArray _buffer;
+};
+
+// A read cursor on shared indexed clip data, each playing Deck needs its own.
+class IndexedClip : public Clip {
+public:
+    using Pointer = std::shared_ptr<IndexedClip>;
+
+    IndexedClip(const IndexedClipData::Pointer& data) : _data(data) {}
+
+    virtual Clip::Pointer duplicate() const override;
+    virtual QString getName() const override { return _data->getName(); }
+
+    virtual float duration() const override;
+    virtual size_t frameCount() const override { return _data->getFrames().size(); }
+
+    virtual void seekFrameTime(Frame::Time offset) override;
+    virtual Frame::Time positionFrameTime() const override;
+
+    virtual FrameConstPointer peekFrame() const override;
+    virtual FrameConstPointer nextFrame() override;
+    virtual void skipFrame() override;
+    virtual void addFrame(FrameConstPointer) override;
+
+    const IndexedClipData::Pointer& getData() const { return _data; }
+
+protected:
+    virtual void reset() override { _frameIndex = 0; }
+
+    FrameConstPointer readFrame(size_t index) const;
+
+    const IndexedClipData::Pointer _data;
+    size_t _frameIndex { 0 };
+
+    // the last block decoded, playback reads all the frames of a block in a row
+    mutable uint32_t _cachedBlock { (uint32_t)-1 };
+    mutable std::vector<QByteArray> _cachedPayloads;
+};
+
+}
+
+#endif
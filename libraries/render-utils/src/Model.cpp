@@ -9,6 +9,9 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <map>
+#include <mutex>
+
 #include <QMetaType>
 #include <QRunnable>
 #include <QThreadPool>
@@ -19,6 +22,7 @@
 #include <GeometryUtil.h>
 #include <PathUtils.h>
 #include <PerfStat.h>
+#include <SkinningBatch.h>
 #include <ViewFrustum.h>
 #include <GLMHelpers.h>
 
@@ -212,7 +216,7 @@ void Model::updateRenderItems() {
         // _collisionGeometry is already scaled
         scale = glm::vec3(1.0f);
     }
-    _needsUpdateClusterMatrices = true;
+    queueClusterMatricesUpdate();
     _renderItemsNeedUpdate = false;
 
     // queue up this work for later processing, at the end of update and just before rendering.
@@ -229,6 +233,7 @@ void Model::updateRenderItems() {
 
         // lazy update of cluster matrices used for rendering.
         // We need to update them here so we can correctly update the bounding box.
+        Model::updatePendingClusterMatrices();
         self->updateClusterMatrices();
 
         render::ScenePointer scene = AbstractViewStateInterface::instance()->getMain3DScene();
@@ -378,7 +383,7 @@ bool Model::findRayIntersectionAgainstSubMeshes(const glm::vec3& origin, const g
         glm::vec3 meshFrameOrigin = glm::vec3(worldToMeshMatrix * glm::vec4(origin, 1.0f));
         glm::vec3 meshFrameDirection = glm::vec3(worldToMeshMatrix * glm::vec4(direction, 0.0f));
 
-        for (const auto& triangleSet : _modelSpaceMeshTriangleSets) {
+        for (const auto& triangleSet : *_modelSpaceMeshTriangleSets) {
             float triangleSetDistance = 0.0f;
             BoxFace triangleSetFace;
             glm::vec3 triangleSetNormal;
@@ -445,7 +450,7 @@ bool Model::convexHullContains(glm::vec3 point) {
         glm::mat4 worldToMeshMatrix = glm::inverse(meshToWorldMatrix);
         glm::vec3 meshFramePoint = glm::vec3(worldToMeshMatrix * glm::vec4(point, 1.0f));
 
-        for (const auto& triangleSet : _modelSpaceMeshTriangleSets) {
+        for (const auto& triangleSet : *_modelSpaceMeshTriangleSets) {
             const AABox& box = triangleSet.getBounds();
             if (box.contains(meshFramePoint)) {
                 if (triangleSet.convexHullContains(meshFramePoint)) {
@@ -461,15 +466,9 @@ bool Model::convexHullContains(glm::vec3 point) {
     return false;
 }
 
-void Model::calculateTriangleSets() {
-    PROFILE_RANGE(render, __FUNCTION__);
-
-    const FBXGeometry& geometry = getFBXGeometry();
+static std::shared_ptr<const QVector<TriangleSet>> calculateMeshTriangleSets(const FBXGeometry& geometry) {
     int numberOfMeshes = geometry.meshes.size();
-
-    _triangleSetsValid = true;
-    _modelSpaceMeshTriangleSets.clear();
-    _modelSpaceMeshTriangleSets.resize(numberOfMeshes);
+    auto triangleSets = std::make_shared<QVector<TriangleSet>>(numberOfMeshes);
 
     for (int i = 0; i < numberOfMeshes; i++) {
         const FBXMesh& mesh = geometry.meshes.at(i);
@@ -485,9 +484,9 @@ void Model::calculateTriangleSets() {
             int numberOfQuads = part.quadIndices.size() / INDICES_PER_QUAD;
             int numberOfTris = part.triangleIndices.size() / INDICES_PER_TRIANGLE;
             int totalTriangles = (numberOfQuads * TRIANGLES_PER_QUAD) + numberOfTris;
-            _modelSpaceMeshTriangleSets[i].reserve(totalTriangles);
+            (*triangleSets)[i].reserve(totalTriangles);
 
-            auto meshTransform = getFBXGeometry().offset * mesh.modelTransform;
+            auto meshTransform = geometry.offset * mesh.modelTransform;
 
             if (part.quadIndices.size() > 0) {
                 int vIndex = 0;
@@ -507,8 +506,8 @@ void Model::calculateTriangleSets() {
 
                     Triangle tri1 = { v0, v1, v3 };
                     Triangle tri2 = { v1, v2, v3 };
-                    _modelSpaceMeshTriangleSets[i].insert(tri1);
-                    _modelSpaceMeshTriangleSets[i].insert(tri2);
+                    (*triangleSets)[i].insert(tri1);
+                    (*triangleSets)[i].insert(tri2);
                 }
             }
 
@@ -527,11 +526,45 @@ void Model::calculateTriangleSets() {
                     glm::vec3 v2 = glm::vec3(meshTransform * glm::vec4(mesh.vertices[i2], 1.0f));
 
                     Triangle tri = { v0, v1, v2 };
-                    _modelSpaceMeshTriangleSets[i].insert(tri);
+                    (*triangleSets)[i].insert(tri);
                 }
             }
         }
     }
+    return triangleSets;
+}
+
+// The model space triangles only depend on the FBXGeometry, so the models of the same file share them and the
+// hierarchy each set builds for precise picks.  Keyed by the owner of the FBXGeometry, which every copy of a geometry
+// shares, and forgotten with the last model using them.
+static std::mutex meshTriangleSetsMutex;
+static std::map<std::weak_ptr<const FBXGeometry>, std::weak_ptr<const QVector<TriangleSet>>,
+                std::owner_less<std::weak_ptr<const FBXGeometry>>> meshTriangleSets;
+
+void Model::calculateTriangleSets() {
+    PROFILE_RANGE(render, __FUNCTION__);
+
+    _triangleSetsValid = true;
+    const auto& fbxGeometry = _renderGeometry->getFBXGeometryPointer();
+    {
+        std::lock_guard<std::mutex> lock(meshTriangleSetsMutex);
+        auto it = meshTriangleSets.find(fbxGeometry);
+        if (it != meshTriangleSets.end()) {
+            _modelSpaceMeshTriangleSets = it->second.lock();
+            if (_modelSpaceMeshTriangleSets) {
+                return;
+            }
+        }
+    }
+
+    // models of the same geometry calculating them at the same time each make their own, the last one is shared
+    auto triangleSets = calculateMeshTriangleSets(*fbxGeometry);
+    std::lock_guard<std::mutex> lock(meshTriangleSetsMutex);
+    for (auto it = meshTriangleSets.begin(); it != meshTriangleSets.end();) {
+        it = it->second.expired() ? meshTriangleSets.erase(it) : std::next(it);
+    }
+    meshTriangleSets[fbxGeometry] = triangleSets;
+    _modelSpaceMeshTriangleSets = triangleSets;
 }
 
 void Model::setVisibleInScene(bool newValue, std::shared_ptr<render::Scene> scene) {
@@ -654,7 +687,11 @@ void Model::renderDebugMeshBoxes(gpu::Batch& batch) {
 
     DependencyManager::get<GeometryCache>()->bindSimpleProgram(batch, false, false, false, true, true);
 
-    for(const auto& triangleSet : _modelSpaceMeshTriangleSets) {
+    if (!_modelSpaceMeshTriangleSets) {
+        _mutex.unlock();
+        return;
+    }
+    for(const auto& triangleSet : *_modelSpaceMeshTriangleSets) {
         auto box = triangleSet.getBounds();
 
         if (_debugMeshBoxesID == GeometryCache::UNKNOWN_ID) {
@@ -878,7 +915,7 @@ class Blender : public QRunnable {
 public:
 
     Blender(ModelPointer model, int blendNumber, const Geometry::WeakPointer& geometry,
-        const QVector<FBXMesh>& meshes, const QVector<float>& blendshapeCoefficients);
+        const std::shared_ptr<const FBXGeometry>& fbxGeometry, const BlendshapeKernel::Coefficients& blendshapeCoefficients);
 
     virtual void run() override;
 
@@ -887,16 +924,16 @@ private:
     ModelPointer _model;
     int _blendNumber;
     Geometry::WeakPointer _geometry;
-    QVector<FBXMesh> _meshes;
-    QVector<float> _blendshapeCoefficients;
+    std::shared_ptr<const FBXGeometry> _fbxGeometry;
+    BlendshapeKernel::Coefficients _blendshapeCoefficients;
 };
 
 Blender::Blender(ModelPointer model, int blendNumber, const Geometry::WeakPointer& geometry,
-        const QVector<FBXMesh>& meshes, const QVector<float>& blendshapeCoefficients) :
+        const std::shared_ptr<const FBXGeometry>& fbxGeometry, const BlendshapeKernel::Coefficients& blendshapeCoefficients) :
     _model(model),
     _blendNumber(blendNumber),
     _geometry(geometry),
-    _meshes(meshes),
+    _fbxGeometry(fbxGeometry),
     _blendshapeCoefficients(blendshapeCoefficients) {
 }
 
@@ -904,31 +941,10 @@ void Blender::run() {
     PROFILE_RANGE_EX(simulation_animation, __FUNCTION__, 0xFFFF0000, 0, { { "url", _model->getURL().toString() } });
     QVector<glm::vec3> vertices, normals;
     if (_model) {
-        int offset = 0;
-        foreach (const FBXMesh& mesh, _meshes) {
-            if (mesh.blendshapes.isEmpty()) {
-                continue;
-            }
-            vertices += mesh.vertices;
-            normals += mesh.normals;
-            glm::vec3* meshVertices = vertices.data() + offset;
-            glm::vec3* meshNormals = normals.data() + offset;
-            offset += mesh.vertices.size();
-            const float NORMAL_COEFFICIENT_SCALE = 0.01f;
-            for (int i = 0, n = qMin(_blendshapeCoefficients.size(), mesh.blendshapes.size()); i < n; i++) {
-                float vertexCoefficient = _blendshapeCoefficients.at(i);
-                const float EPSILON = 0.0001f;
-                if (vertexCoefficient < EPSILON) {
-                    continue;
-                }
-                float normalCoefficient = vertexCoefficient * NORMAL_COEFFICIENT_SCALE;
-                const FBXBlendshape& blendshape = mesh.blendshapes.at(i);
-                for (int j = 0; j < blendshape.indices.size(); j++) {
-                    int index = blendshape.indices.at(j);
-                    meshVertices[index] += blendshape.vertices.at(j) * vertexCoefficient;
-                    meshNormals[index] += blendshape.normals.at(j) * normalCoefficient;
-                }
-            }
+        auto modelBlender = DependencyManager::get<ModelBlender>();
+        if (!modelBlender->findBlend(_fbxGeometry, _blendshapeCoefficients, vertices, normals)) {
+            modelBlender->getBlendshapeKernel(_fbxGeometry)->blend(_blendshapeCoefficients, vertices, normals);
+            modelBlender->addBlend(_fbxGeometry, _blendshapeCoefficients, vertices, normals);
         }
     }
     // post the result to the geometry cache, which will dispatch to the model if still alive
@@ -1059,7 +1075,50 @@ void Model::computeMeshPartLocalBounds() {
     }
 }
 
-// virtual
+// models queued by updateRenderItems since the last updatePendingClusterMatrices
+static std::mutex pendingClusterMatricesMutex;
+static std::vector<ModelWeakPointer> pendingClusterMatrices;
+
+void Model::queueClusterMatricesUpdate() {
+    _needsUpdateClusterMatrices = true;
+    std::lock_guard<std::mutex> lock(pendingClusterMatricesMutex);
+    pendingClusterMatrices.push_back(shared_from_this());
+}
+
+void Model::updatePendingClusterMatrices() {
+    PerformanceTimer perfTimer("Model::updatePendingClusterMatrices");
+
+    std::vector<ModelWeakPointer> pending;
+    {
+        std::lock_guard<std::mutex> lock(pendingClusterMatricesMutex);
+        pending.swap(pendingClusterMatrices);
+    }
+    if (pending.empty()) {
+        return;
+    }
+
+    // the arrays are kept from frame to frame, the post update lambdas all run on the main thread
+    static SkinningBatch batch;
+    batch.clear();
+    std::vector<ModelPointer> models;
+    models.reserve(pending.size());
+    for (const auto& weakModel : pending) {
+        auto model = weakModel.lock();
+        // models queued more than once are only added the first time
+        if (model && model->_needsUpdateClusterMatrices && model->isLoaded()) {
+            model->_needsUpdateClusterMatrices = false;
+            model->addClusterMatrices(batch);
+            models.push_back(model);
+        }
+    }
+
+    batch.compute();
+
+    for (const auto& model : models) {
+        model->uploadClusterMatrices();
+    }
+}
+
 void Model::updateClusterMatrices() {
     PerformanceTimer perfTimer("Model::updateClusterMatrices");
 
@@ -1067,15 +1126,33 @@ void Model::updateClusterMatrices() {
         return;
     }
     _needsUpdateClusterMatrices = false;
+
+    SkinningBatch batch;
+    addClusterMatrices(batch);
+    batch.compute();
+    uploadClusterMatrices();
+}
+
+// virtual
+void Model::addClusterMatrices(SkinningBatch& batch) {
     const FBXGeometry& geometry = getFBXGeometry();
     for (int i = 0; i < _meshStates.size(); i++) {
-        MeshState& state = _meshStates[i];
         const FBXMesh& mesh = geometry.meshes.at(i);
+        // data() detaches here, the batch may be computed on other threads
+        glm::mat4* clusterMatrices = _meshStates[i].clusterMatrices.data();
         for (int j = 0; j < mesh.clusters.size(); j++) {
             const FBXCluster& cluster = mesh.clusters.at(j);
-            auto jointMatrix = _rig->getJointTransform(cluster.jointIndex);
-            glm_mat4u_mul(jointMatrix, cluster.inverseBindMatrix, state.clusterMatrices[j]);
+            batch.add(_rig->getJointTransform(cluster.jointIndex), cluster.inverseBindMatrix, clusterMatrices + j);
         }
+    }
+}
+
+// virtual
+void Model::uploadClusterMatrices() {
+    const FBXGeometry& geometry = getFBXGeometry();
+    for (int i = 0; i < _meshStates.size(); i++) {
+        MeshState& state = _meshStates[i];
+        const FBXMesh& mesh = geometry.meshes.at(i);
 
         // Once computed the cluster matrices, update the buffer(s)
         if (mesh.clusters.size() > 1) {
@@ -1090,10 +1167,7 @@ void Model::updateClusterMatrices() {
     }
 
     // post the blender if we're not currently waiting for one to finish
-    if (geometry.hasBlendedMeshes() && _blendshapeCoefficients != _blendedBlendshapeCoefficients) {
-        _blendedBlendshapeCoefficients = _blendshapeCoefficients;
-        DependencyManager::get<ModelBlender>()->noteRequiresBlend(getThisPointer());
-    }
+    maybeRequestBlend();
 }
 
 void Model::inverseKinematics(int endIndex, glm::vec3 targetPosition, const glm::quat& targetRotation, float priority) {
@@ -1115,12 +1189,23 @@ float Model::getLimbLength(int jointIndex) const {
     return _rig->getLimbLength(jointIndex, freeLineage, _scale, geometry.joints);
 }
 
+void Model::maybeRequestBlend() {
+    // coefficient changes smaller than a quantization step don't need a new blend
+    if (getFBXGeometry().hasBlendedMeshes()) {
+        auto blendshapeCoefficients = BlendshapeKernel::quantize(_blendshapeCoefficients);
+        if (blendshapeCoefficients != _blendedBlendshapeCoefficients) {
+            _blendedBlendshapeCoefficients = blendshapeCoefficients;
+            DependencyManager::get<ModelBlender>()->noteRequiresBlend(getThisPointer());
+        }
+    }
+}
+
 bool Model::maybeStartBlender() {
     if (isLoaded()) {
         const FBXGeometry& fbxGeometry = getFBXGeometry();
         if (fbxGeometry.hasBlendedMeshes()) {
             QThreadPool::globalInstance()->start(new Blender(getThisPointer(), ++_blendNumber, _renderGeometry,
-                fbxGeometry.meshes, _blendshapeCoefficients));
+                _renderGeometry->getFBXGeometryPointer(), BlendshapeKernel::quantize(_blendshapeCoefficients)));
             return true;
         }
     }
@@ -1361,6 +1446,91 @@ void ModelBlender::noteRequiresBlend(ModelPointer model) {
     }
 }
 
+ModelBlender::GeometryBlends* ModelBlender::findGeometryBlends(const std::shared_ptr<const FBXGeometry>& geometry) {
+    auto it = _geometryBlends.find(geometry.get());
+    if (it == _geometryBlends.end() || it->second.geometry.lock() != geometry) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+ModelBlender::GeometryBlends& ModelBlender::getGeometryBlends(const std::shared_ptr<const FBXGeometry>& geometry) {
+    if (auto blends = findGeometryBlends(geometry)) {
+        return *blends;
+    }
+    // a new model file, forget the ones that were unloaded
+    for (auto it = _geometryBlends.begin(); it != _geometryBlends.end();) {
+        if (it->second.geometry.expired()) {
+            it = _geometryBlends.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    GeometryBlends& blends = _geometryBlends[geometry.get()];
+    blends = GeometryBlends();
+    blends.geometry = geometry;
+    return blends;
+}
+
+BlendshapeKernel::Pointer ModelBlender::getBlendshapeKernel(const std::shared_ptr<const FBXGeometry>& geometry) {
+    {
+        Lock lock(_blendsMutex);
+        auto blends = findGeometryBlends(geometry);
+        if (blends && blends->kernel) {
+            return blends->kernel;
+        }
+    }
+    // built outside of the lock, if two blenders race the first one wins
+    BlendshapeKernel::Pointer kernel = std::make_shared<BlendshapeKernel>(geometry->meshes);
+    Lock lock(_blendsMutex);
+    GeometryBlends& blends = getGeometryBlends(geometry);
+    if (!blends.kernel) {
+        blends.kernel = kernel;
+    }
+    return blends.kernel;
+}
+
+bool ModelBlender::findBlend(const std::shared_ptr<const FBXGeometry>& geometry,
+        const BlendshapeKernel::Coefficients& coefficients, QVector<glm::vec3>& vertices, QVector<glm::vec3>& normals) {
+    Lock lock(_blendsMutex);
+    auto blends = findGeometryBlends(geometry);
+    if (!blends) {
+        return false;
+    }
+    auto it = blends->blends.find(coefficients);
+    if (it == blends->blends.end()) {
+        return false;
+    }
+    it->lastUsed = ++_blendUseCount;
+    // implicitly shared, the models upload them without copying
+    vertices = it->vertices;
+    normals = it->normals;
+    return true;
+}
+
+void ModelBlender::addBlend(const std::shared_ptr<const FBXGeometry>& geometry,
+        const BlendshapeKernel::Coefficients& coefficients,
+        const QVector<glm::vec3>& vertices, const QVector<glm::vec3>& normals) {
+    // enough for the few expressions avatars of the same model hold for a while, faces in motion rarely repeat
+    const int MAX_CACHED_BLENDS_PER_GEOMETRY = 8;
+
+    Lock lock(_blendsMutex);
+    GeometryBlends& blends = getGeometryBlends(geometry);
+    if (blends.blends.size() >= MAX_CACHED_BLENDS_PER_GEOMETRY && !blends.blends.contains(coefficients)) {
+        auto leastRecentlyUsed = blends.blends.begin();
+        for (auto it = blends.blends.begin(); it != blends.blends.end(); ++it) {
+            if (it->lastUsed < leastRecentlyUsed->lastUsed) {
+                leastRecentlyUsed = it;
+            }
+        }
+        blends.blends.erase(leastRecentlyUsed);
+    }
+    CachedBlend& blend = blends.blends[coefficients];
+    blend.vertices = vertices;
+    blend.normals = normals;
+    blend.lastUsed = ++_blendUseCount;
+}
+
 void ModelBlender::setBlendedVertices(ModelPointer model, int blendNumber,
         const Geometry::WeakPointer& geometry, const QVector<glm::vec3>& vertices, const QVector<glm::vec3>& normals) {
     if (model) {
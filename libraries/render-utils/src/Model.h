@@ -13,6 +13,7 @@
 #define hifi_Model_h
 
 #include <QBitArray>
+#include <QHash>
 #include <QObject>
 #include <QUrl>
 #include <QMutex>
@@ -29,12 +30,14 @@
 #include <Transform.h>
 #include <SpatiallyNestable.h>
 #include <TriangleSet.h>
+#include <BlendshapeKernel.h>
 
 #include "GeometryCache.h"
 #include "TextureCache.h"
 #include "Rig.h"
 
 class AbstractViewStateInterface;
+class SkinningBatch;
 class QScriptEngine;
 
 #include "RenderArgs.h"
@@ -128,7 +131,11 @@ public:
     bool getSnapModelToRegistrationPoint() { return _snapModelToRegistrationPoint; }
 
     virtual void simulate(float deltaTime, bool fullUpdate = true);
-    virtual void updateClusterMatrices();
+    void updateClusterMatrices();
+
+    /// Computes the cluster matrices of every model whose render items were updated this frame in one batch, so
+    /// the skinning of a crowd is spread over the thread pool instead of done one model at a time.
+    static void updatePendingClusterMatrices();
 
     /// Returns a reference to the shared geometry.
     const Geometry::Pointer& getGeometry() const { return _renderGeometry; }
@@ -341,6 +348,15 @@ protected:
     virtual void deleteGeometry();
     void initJointTransforms();
 
+    // notes this model requires a blend if its blendshape coefficients changed since the last one
+    void maybeRequestBlend();
+
+    // queues the cluster matrices to compute, then uploads them once the batch is computed
+    virtual void addClusterMatrices(SkinningBatch& batch);
+    virtual void uploadClusterMatrices();
+    // marks the cluster matrices dirty and queues the model for updatePendingClusterMatrices
+    void queueClusterMatricesUpdate();
+
     QVector<float> _blendshapeCoefficients;
 
     QUrl _url;
@@ -350,7 +366,7 @@ protected:
 
     QVector<QVector<QSharedPointer<Texture> > > _dilatedTextures;
 
-    QVector<float> _blendedBlendshapeCoefficients;
+    BlendshapeKernel::Coefficients _blendedBlendshapeCoefficients;
     int _blendNumber;
     int _appliedBlendNumber;
 
@@ -358,7 +374,8 @@ protected:
 
     bool _triangleSetsValid { false };
     void calculateTriangleSets();
-    QVector<TriangleSet> _modelSpaceMeshTriangleSets; // model space triangles for all sub meshes
+    // model space triangles for all sub meshes, shared by the models of the same geometry
+    std::shared_ptr<const QVector<TriangleSet>> _modelSpaceMeshTriangleSets;
 
 
     void createRenderItemSet();
@@ -425,6 +442,15 @@ public:
     /// Adds the specified model to the list requiring vertex blends.
     void noteRequiresBlend(ModelPointer model);
 
+    /// The blendshapes of a model file prepared for blending, built on first use.
+    BlendshapeKernel::Pointer getBlendshapeKernel(const std::shared_ptr<const FBXGeometry>& geometry);
+
+    /// Recent blends are shared by the models of the same file with the same coefficients, like idle faces.
+    bool findBlend(const std::shared_ptr<const FBXGeometry>& geometry, const BlendshapeKernel::Coefficients& coefficients,
+        QVector<glm::vec3>& vertices, QVector<glm::vec3>& normals);
+    void addBlend(const std::shared_ptr<const FBXGeometry>& geometry, const BlendshapeKernel::Coefficients& coefficients,
+        const QVector<glm::vec3>& vertices, const QVector<glm::vec3>& normals);
+
 public slots:
     void setBlendedVertices(ModelPointer model, int blendNumber, const Geometry::WeakPointer& geometry,
         const QVector<glm::vec3>& vertices, const QVector<glm::vec3>& normals);
@@ -436,9 +462,31 @@ private:
     ModelBlender();
     virtual ~ModelBlender();
 
+    class CachedBlend {
+    public:
+        QVector<glm::vec3> vertices;
+        QVector<glm::vec3> normals;
+        quint64 lastUsed { 0 };
+    };
+
+    class GeometryBlends {
+    public:
+        std::weak_ptr<const FBXGeometry> geometry;
+        BlendshapeKernel::Pointer kernel;
+        QHash<BlendshapeKernel::Coefficients, CachedBlend> blends;
+    };
+
+    // nullptr if the entry is for a geometry that was freed, and possibly reallocated at the same address
+    GeometryBlends* findGeometryBlends(const std::shared_ptr<const FBXGeometry>& geometry);
+    GeometryBlends& getGeometryBlends(const std::shared_ptr<const FBXGeometry>& geometry);
+
     std::set<ModelWeakPointer, std::owner_less<ModelWeakPointer>> _modelsRequiringBlends;
     int _pendingBlenders;
     Mutex _mutex;
+
+    Mutex _blendsMutex;
+    std::unordered_map<const FBXGeometry*, GeometryBlends> _geometryBlends;
+    quint64 _blendUseCount { 0 };
 };
 
 
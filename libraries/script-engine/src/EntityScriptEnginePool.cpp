@@ -0,0 +1,124 @@
+//
+//  EntityScriptEnginePool.cpp
+//  libraries/script-engine/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityScriptEnginePool.h"
+
+#include <NumericalConstants.h>
+
+using Lock = std::lock_guard<std::mutex>;
+
+void EntityScriptEnginePool::setEngines(const std::vector<EnginePointer>& engines) {
+    std::vector<std::shared_ptr<EngineLoad>> loads;
+    for (const auto& engine : engines) {
+        auto load = std::make_shared<EngineLoad>();
+        // direct, so the frames are counted on the engine's own thread even when the server's is busy
+        QObject::connect(engine.data(), &ScriptEngine::frameFinished, engine.data(), [load](quint64 busyUsecs) {
+            load->frames++;
+            load->busyUsecs += busyUsecs;
+        }, Qt::DirectConnection);
+        loads.push_back(load);
+    }
+
+    Lock lock(_mutex);
+    _engines = engines;
+    _loads.swap(loads);
+    _entityEngines.clear();
+}
+
+std::vector<EntityScriptEnginePool::EnginePointer> EntityScriptEnginePool::getEngines() const {
+    Lock lock(_mutex);
+    return _engines;
+}
+
+bool EntityScriptEnginePool::isEmpty() const {
+    Lock lock(_mutex);
+    return _engines.empty();
+}
+
+EntityScriptEnginePool::EnginePointer EntityScriptEnginePool::assign(const EntityItemID& entityID,
+                                                                     const QString& scriptGroup) {
+    Lock lock(_mutex);
+    if (_engines.empty()) {
+        return EnginePointer();
+    }
+
+    auto it = _entityEngines.constFind(entityID);
+    if (it != _entityEngines.constEnd()) {
+        return _engines[it.value()];
+    }
+
+    uint hash = scriptGroup.isEmpty() ? qHash(QUuid(entityID)) : qHash(scriptGroup);
+    int engineIndex = (int)(hash % (uint)_engines.size());
+    _entityEngines.insert(entityID, engineIndex);
+    return _engines[engineIndex];
+}
+
+EntityScriptEnginePool::EnginePointer EntityScriptEnginePool::find(const EntityItemID& entityID) const {
+    Lock lock(_mutex);
+    auto it = _entityEngines.constFind(entityID);
+    return it != _entityEngines.constEnd() ? _engines[it.value()] : EnginePointer();
+}
+
+EntityScriptEnginePool::EnginePointer EntityScriptEnginePool::findOrFirst(const EntityItemID& entityID) const {
+    Lock lock(_mutex);
+    if (_engines.empty()) {
+        return EnginePointer();
+    }
+    auto it = _entityEngines.constFind(entityID);
+    return _engines[it != _entityEngines.constEnd() ? it.value() : 0];
+}
+
+void EntityScriptEnginePool::release(const EntityItemID& entityID) {
+    Lock lock(_mutex);
+    _entityEngines.remove(entityID);
+}
+
+QList<QUuid> EntityScriptEnginePool::getAssignedEntities() const {
+    Lock lock(_mutex);
+    return _entityEngines.keys();
+}
+
+int EntityScriptEnginePool::getNumRunningEntityScripts() const {
+    int numRunningScripts = 0;
+    for (const auto& engine : getEngines()) {
+        numRunningScripts += engine->getNumRunningEntityScripts();
+    }
+    return numRunningScripts;
+}
+
+std::vector<EntityScriptEnginePool::EngineStats> EntityScriptEnginePool::takeStats() {
+    Lock lock(_mutex);
+    std::vector<EngineStats> stats(_engines.size());
+    for (auto it = _entityEngines.constBegin(); it != _entityEngines.constEnd(); ++it) {
+        stats[it.value()].assignedEntities++;
+    }
+    for (size_t i = 0; i < _engines.size(); i++) {
+        stats[i].runningScripts = _engines[i]->getNumRunningEntityScripts();
+        stats[i].timers = _engines[i]->getNumTimers();
+        quint64 frames = _loads[i]->frames.exchange(0);
+        quint64 busyUsecs = _loads[i]->busyUsecs.exchange(0);
+        if (frames > 0) {
+            stats[i].averageFrameMsecs = (float)busyUsecs / (float)frames / (float)USECS_PER_MSEC;
+        }
+    }
+    return stats;
+}
+
+void EntityScriptEnginePool::callEntityScriptMethod(const EntityItemID& entityID, const QString& methodName,
+                                                    const QStringList& params) {
+    if (auto engine = find(entityID)) {
+        engine->callEntityScriptMethod(entityID, methodName, params);
+    }
+}
+
+QFuture<QVariant> EntityScriptEnginePool::getLocalEntityScriptDetails(const EntityItemID& entityID) {
+    auto engine = findOrFirst(entityID);
+    return engine ? engine->getLocalEntityScriptDetails(entityID) : QFuture<QVariant>();
+}
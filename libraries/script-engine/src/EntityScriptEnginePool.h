@@ -0,0 +1,81 @@
+//
+//  EntityScriptEnginePool.h
+//  libraries/script-engine/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityScriptEnginePool_h
+#define hifi_EntityScriptEnginePool_h
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QtCore/QHash>
+#include <QtCore/QSharedPointer>
+
+#include <EntitiesScriptEngineProvider.h>
+
+#include "ScriptEngine.h"
+
+// The script engines of the entity script server.  Every entity's server script runs on one engine, picked by hashing
+// its script group when the entity has one, or its ID otherwise, so a slow script only stalls the entities sharing
+// its engine.  Calls made through the Entities API are routed to the engine owning the entity.
+// The pool is used from the script engine threads, all methods are thread safe.
+class EntityScriptEnginePool : public EntitiesScriptEngineProvider {
+public:
+    using EnginePointer = QSharedPointer<ScriptEngine>;
+
+    // Frames seen by an engine since the last call to takeLoad, updated from the engine's thread
+    class EngineLoad {
+    public:
+        std::atomic<quint64> frames { 0 };
+        std::atomic<quint64> busyUsecs { 0 };
+    };
+
+    class EngineStats {
+    public:
+        int assignedEntities { 0 };
+        int runningScripts { 0 };
+        int timers { 0 };
+        float averageFrameMsecs { 0.0f }; // time spent working per frame, sleep excluded, 0 without frames
+    };
+
+    // Replaces the engines and forgets every assignment, the caller stops the previous engines
+    void setEngines(const std::vector<EnginePointer>& engines);
+    std::vector<EnginePointer> getEngines() const;
+    bool isEmpty() const;
+
+    // The engine running the entity's script, assigned on the first call
+    EnginePointer assign(const EntityItemID& entityID, const QString& scriptGroup);
+    // nullptr if the entity has no engine
+    EnginePointer find(const EntityItemID& entityID) const;
+    void release(const EntityItemID& entityID);
+    QList<QUuid> getAssignedEntities() const;
+
+    int getNumRunningEntityScripts() const;
+
+    // Per engine, in engine order, resets the frame counters
+    std::vector<EngineStats> takeStats();
+
+    // EntitiesScriptEngineProvider
+    void callEntityScriptMethod(const EntityItemID& entityID, const QString& methodName,
+                                const QStringList& params = QStringList()) override;
+    QFuture<QVariant> getLocalEntityScriptDetails(const EntityItemID& entityID) override;
+
+private:
+    // entities without an engine are answered by the first one, which reports them as not running
+    EnginePointer findOrFirst(const EntityItemID& entityID) const;
+
+    mutable std::mutex _mutex;
+    std::vector<EnginePointer> _engines;
+    std::vector<std::shared_ptr<EngineLoad>> _loads;
+    QHash<QUuid, int> _entityEngines;
+};
+
+#endif // hifi_EntityScriptEnginePool_h
@@ -0,0 +1,78 @@
+//
+//  EntityScriptProgramCache.cpp
+//  libraries/script-engine/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityScriptProgramCache.h"
+
+#include <QtCore/QCryptographicHash>
+
+#include <NumericalConstants.h>
+
+using Lock = std::lock_guard<std::mutex>;
+
+EntityScriptProgramCache& EntityScriptProgramCache::instance() {
+    static EntityScriptProgramCache _instance;
+    return _instance;
+}
+
+QByteArray EntityScriptProgramCache::makeKey(const QString& contents, const QString& fileName) {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(fileName.toUtf8());
+    hash.addData(contents.toUtf8());
+    return hash.result();
+}
+
+bool EntityScriptProgramCache::isChecked(const QByteArray& key) const {
+    Lock lock(_mutex);
+    return _programs.contains(key);
+}
+
+void EntityScriptProgramCache::setChecked(const QByteArray& key, const QString& fileName, int sourceSize,
+                                          quint64 checkUsecs) {
+    Lock lock(_mutex);
+    auto& program = _programs[key];
+    program.fileName = fileName;
+    program.sourceSize = sourceSize;
+    program.checkUsecs = checkUsecs;
+}
+
+void EntityScriptProgramCache::addInstance(const QByteArray& key, quint64 usecs) {
+    Lock lock(_mutex);
+    auto it = _programs.find(key);
+    if (it != _programs.end()) {
+        it->instances++;
+        it->totalInstances++;
+        it->totalInstantiationUsecs += usecs;
+    }
+}
+
+void EntityScriptProgramCache::removeInstance(const QByteArray& key) {
+    Lock lock(_mutex);
+    auto it = _programs.find(key);
+    if (it != _programs.end() && --it->instances <= 0) {
+        _programs.erase(it);
+    }
+}
+
+QJsonObject EntityScriptProgramCache::getStats() const {
+    Lock lock(_mutex);
+    QJsonObject stats;
+    for (const auto& program : _programs) {
+        QJsonObject programStats;
+        programStats["instances"] = program.instances;
+        programStats["source_bytes"] = program.sourceSize;
+        programStats["check_ms"] = (double)program.checkUsecs / USECS_PER_MSEC;
+        if (program.totalInstances > 0) {
+            programStats["avg_instantiation_ms"] =
+                (double)program.totalInstantiationUsecs / program.totalInstances / USECS_PER_MSEC;
+        }
+        stats[program.fileName] = programStats;
+    }
+    return stats;
+}
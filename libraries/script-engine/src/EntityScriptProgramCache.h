@@ -0,0 +1,60 @@
+//
+//  EntityScriptProgramCache.h
+//  libraries/script-engine/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityScriptProgramCache_h
+#define hifi_EntityScriptProgramCache_h
+
+#include <mutex>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QHash>
+#include <QtCore/QJsonObject>
+#include <QtCore/QString>
+
+// The entity scripts that passed the syntax and constructor checks, keyed by a hash of their contents and file name,
+// shared by every script engine of the process so each distinct script is only checked once however many entities
+// run it.  Also keeps the load costs of each script, for the stats.
+//
+// Compiled programs and constructors are not shared: a QScriptProgram caches its compilation for a single engine and
+// isn't thread safe, and each entity evaluates the script for its own constructor since the instances of a script
+// often keep their state in the function enclosing the constructor.
+class EntityScriptProgramCache {
+public:
+    static EntityScriptProgramCache& instance();
+
+    static QByteArray makeKey(const QString& contents, const QString& fileName);
+
+    bool isChecked(const QByteArray& key) const;
+    void setChecked(const QByteArray& key, const QString& fileName, int sourceSize, quint64 checkUsecs);
+
+    // An entity started running the script, after usecs spent evaluating and constructing it
+    void addInstance(const QByteArray& key, quint64 usecs);
+    // the script is forgotten with its last instance, the next load checks it again
+    void removeInstance(const QByteArray& key);
+
+    // keyed by file name: instances, check and average instantiation times, source size
+    QJsonObject getStats() const;
+
+private:
+    class Program {
+    public:
+        QString fileName;
+        int sourceSize { 0 };
+        quint64 checkUsecs { 0 };
+        int instances { 0 };
+        quint64 totalInstances { 0 };
+        quint64 totalInstantiationUsecs { 0 };
+    };
+
+    mutable std::mutex _mutex;
+    QHash<QByteArray, Program> _programs;
+};
+
+#endif // hifi_EntityScriptProgramCache_h
@@ -56,6 +56,7 @@
 #include "BatchLoader.h"
 #include "BaseScriptEngine.h"
 #include "DataViewClass.h"
+#include "EntityScriptProgramCache.h"
 #include "EventTypes.h"
 #include "FileScriptingInterface.h" // unzip project
 #include "MenuItemProperties.h"
@@ -151,14 +152,25 @@ QString ScriptEngine::logException(const QScriptValue& exception) {
 }
 
 int ScriptEngine::processLevelMaxRetries { ScriptRequest::MAX_RETRIES };
+
+static quint64 timerWheelNow() {
+    using namespace std::chrono;
+    return (quint64)duration_cast<milliseconds>(steady_clock::now().time_since_epoch()).count();
+}
+
 ScriptEngine::ScriptEngine(Context context, const QString& scriptContents, const QString& fileNameString) :
     BaseScriptEngine(),
     _context(context),
     _scriptContents(scriptContents),
-    _timerFunctionMap(),
+    _timerWheel(timerWheelNow()),
     _fileNameString(fileNameString),
     _arrayBufferClass(new ArrayBufferClass(this))
 {
+    // only the assignment client exports metrics, the interface has no registry
+    if (DependencyManager::isSet<MetricsRegistry>()) {
+        _timerLateness = MetricsRegistry::findHistogram("script_timer_late_msecs",
+            "How late script timers fire after their due time, in milliseconds");
+    }
     DependencyManager::get<ScriptEngines>()->addScriptEngine(this);
 
     connect(this, &QScriptEngine::signalHandlerException, this, [this](const QScriptValue& exception) {
@@ -301,6 +313,8 @@ void ScriptEngine::runDebuggable() {
             return;
         }
 
+        fireTimers();
+
         qint64 now = usecTimestampNow();
         // we check for 'now' in the past in case people set their clock back
         if (_lastUpdate < now) {
@@ -607,6 +621,7 @@ void ScriptEngine::init() {
     qScriptRegisterMetaType(this, AvatarEntityMapToScriptValue, AvatarEntityMapFromScriptValue);
     qScriptRegisterSequenceMetaType<QVector<QUuid>>(this);
     qScriptRegisterSequenceMetaType<QVector<EntityItemID>>(this);
+    qScriptRegisterSequenceMetaType<QVector<EntityItemProperties>>(this);
 
     qScriptRegisterSequenceMetaType<QVector<glm::vec2> >(this);
     qScriptRegisterSequenceMetaType<QVector<glm::quat> >(this);
@@ -1012,6 +1027,7 @@ void ScriptEngine::run() {
     // TODO: Integrate this with signals/slots instead of reimplementing throttling for ScriptEngine
     while (!_isFinished) {
         auto beforeSleep = clock::now();
+        std::chrono::microseconds frameBusy(0); // the frame's time spent on events, timers and updates
 
         // Throttle to SCRIPT_FPS
         // We'd like to try to keep the script at a solid SCRIPT_FPS update rate. And so we will 
@@ -1037,12 +1053,14 @@ void ScriptEngine::run() {
         // purgatory, constantly checking to see if our script was asked to end
         bool processedEvents = false;
         while (!_isFinished && clock::now() < sleepUntil) {
-
+            auto beforeEvents = clock::now();
             {
                 PROFILE_RANGE(script, "processEvents-sleep");
                 QCoreApplication::processEvents(); // before we sleep again, give events a chance to process
             }
             processedEvents = true;
+            fireTimers();
+            frameBusy += std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - beforeEvents);
 
             // If after processing events, we're past due, exit asap
             if (clock::now() >= sleepUntil) {
@@ -1057,6 +1075,7 @@ void ScriptEngine::run() {
         }
 
         PROFILE_RANGE(script, "ScriptMainLoop");
+        auto afterSleep = clock::now();
 
 #ifdef SCRIPT_DELAY_DEBUG
         {
@@ -1083,6 +1102,7 @@ void ScriptEngine::run() {
         if (!processedEvents) {
             PROFILE_RANGE(script, "processEvents");
             QCoreApplication::processEvents();
+            fireTimers();
         }
 
         if (_isFinished) {
@@ -1124,6 +1144,9 @@ void ScriptEngine::run() {
             emit unhandledException(cloneUncaughtException(__FUNCTION__));
             clearExceptions();
         }
+
+        frameBusy += std::chrono::duration_cast<std::chrono::microseconds>(clock::now() - afterSleep);
+        emit frameFinished((quint64)frameBusy.count());
     }
     scriptInfoMessage("Script Engine stopping:" + getFilename());
 
@@ -1156,32 +1179,21 @@ void ScriptEngine::run() {
 // NOTE: This is private because it must be called on the same thread that created the timers, which is why
 // we want to only call it in our own run "shutdown" processing.
 void ScriptEngine::stopAllTimers() {
-    QMutableHashIterator<QTimer*, CallbackData> i(_timerFunctionMap);
-    int j {0};
-    while (i.hasNext()) {
-        i.next();
-        QTimer* timer = i.key();
-        qCDebug(scriptengine) << getFilename() << "stopAllTimers[" << j++ << "]";
-        stopTimer(timer);
+    qCDebug(scriptengine) << getFilename() << "stopAllTimers" << _timerFunctionMap.size();
+    for (auto it = _timerFunctionMap.constBegin(); it != _timerFunctionMap.constEnd(); ++it) {
+        _timerWheel.cancel(it.key());
     }
+    _timerFunctionMap.clear();
+    _entityTimers.clear();
+    _numTimers = 0;
 }
 
 void ScriptEngine::stopAllTimersForEntityScript(const EntityItemID& entityID) {
-     // We could maintain a separate map of entityID => QTimer, but someone will have to prove to me that it's worth the complexity. -HRS
-    QVector<QTimer*> toDelete;
-    QMutableHashIterator<QTimer*, CallbackData> i(_timerFunctionMap);
-    while (i.hasNext()) {
-        i.next();
-        if (i.value().definingEntityIdentifier != entityID) {
-            continue;
-        }
-        QTimer* timer = i.key();
-        toDelete << timer; // don't delete while we're iterating. save it.
-    }
-    for (auto timer:toDelete) { // now reap 'em
-        stopTimer(timer);
+    for (auto timer : _entityTimers.take(entityID)) {
+        _timerWheel.cancel(timer);
+        _timerFunctionMap.remove(timer);
     }
-
+    _numTimers = _timerFunctionMap.size();
 }
 
 void ScriptEngine::stop(bool marshal) {
@@ -1231,7 +1243,23 @@ void ScriptEngine::updateMemoryCost(const qint64& deltaSize) {
     }
 }
 
-void ScriptEngine::timerFired() {
+void ScriptEngine::fireTimers() {
+    if (_timerFunctionMap.isEmpty()) {
+        return;
+    }
+    PROFILE_RANGE(script, "ScriptTimers");
+    _timerWheel.advance(timerWheelNow(), [this](TimerWheel::TimerID timer, quint64 lateMsecs) {
+        timerFired(timer, lateMsecs);
+    });
+}
+
+void ScriptEngine::timerFired(TimerWheel::TimerID timer, quint64 lateMsecs) {
+    CallbackData timerData = _timerFunctionMap.value(timer);
+    if (!_timerWheel.contains(timer)) {
+        // this timer is done, we can forget it
+        removeTimer(timer);
+    }
+
     {
         auto engine = DependencyManager::get<ScriptEngines>();
         if (!engine || engine->isStopped()) {
@@ -1240,13 +1268,8 @@ void ScriptEngine::timerFired() {
         }
     }
 
-    QTimer* callingTimer = reinterpret_cast<QTimer*>(sender());
-    CallbackData timerData = _timerFunctionMap.value(callingTimer);
-
-    if (!callingTimer->isActive()) {
-        // this timer is done, we can kill it
-        _timerFunctionMap.remove(callingTimer);
-        delete callingTimer;
+    if (_timerLateness) {
+        _timerLateness->record(lateMsecs);
     }
 
     // call the associated JS function, if it exists
@@ -1261,55 +1284,63 @@ void ScriptEngine::timerFired() {
     }
 }
 
-QObject* ScriptEngine::setupTimerWithInterval(const QScriptValue& function, int intervalMS, bool isSingleShot) {
-    // create the timer, add it to the map, and start it
-    QTimer* newTimer = new QTimer(this);
-    newTimer->setSingleShot(isSingleShot);
-
-    // The default timer type is not very accurate below about 200ms http://doc.qt.io/qt-5/qt.html#TimerType-enum
-    static const int MIN_TIMEOUT_FOR_COARSE_TIMER = 200;
-    if (intervalMS < MIN_TIMEOUT_FOR_COARSE_TIMER) {
-        newTimer->setTimerType(Qt::PreciseTimer);
-    }
-
-    connect(newTimer, &QTimer::timeout, this, &ScriptEngine::timerFired);
-
-    // make sure the timer stops when the script does
-    connect(this, &ScriptEngine::scriptEnding, newTimer, &QTimer::stop);
+QScriptValue ScriptEngine::setupTimerWithInterval(const QScriptValue& function, int intervalMS, bool isSingleShot) {
+    quint64 delay = (quint64)std::max(intervalMS, 0);
+    // a repeating timer fires at most once per pass of the loop, so a 0 interval repeats on every pass
+    auto timer = _timerWheel.add(timerWheelNow(), delay, isSingleShot ? 0 : std::max(delay, (quint64)1));
 
     CallbackData timerData = { function, currentEntityIdentifier, currentSandboxURL };
-    _timerFunctionMap.insert(newTimer, timerData);
+    _timerFunctionMap.insert(timer, timerData);
+    if (!currentEntityIdentifier.isInvalidID()) {
+        _entityTimers[currentEntityIdentifier].insert(timer);
+    }
+    _numTimers = _timerFunctionMap.size();
 
-    newTimer->start(intervalMS);
-    return newTimer;
+    return QScriptValue((uint)timer);
 }
 
-QObject* ScriptEngine::setInterval(const QScriptValue& function, int intervalMS) {
+QScriptValue ScriptEngine::setInterval(const QScriptValue& function, int intervalMS) {
     if (DependencyManager::get<ScriptEngines>()->isStopped()) {
         scriptWarningMessage("Script.setInterval() while shutting down is ignored... parent script:" + getFilename());
-        return NULL; // bail early
+        return QScriptValue(0); // bail early
     }
 
     return setupTimerWithInterval(function, intervalMS, false);
 }
 
-QObject* ScriptEngine::setTimeout(const QScriptValue& function, int timeoutMS) {
+QScriptValue ScriptEngine::setTimeout(const QScriptValue& function, int timeoutMS) {
     if (DependencyManager::get<ScriptEngines>()->isStopped()) {
         scriptWarningMessage("Script.setTimeout() while shutting down is ignored... parent script:" + getFilename());
-        return NULL; // bail early
+        return QScriptValue(0); // bail early
     }
 
     return setupTimerWithInterval(function, timeoutMS, true);
 }
 
-void ScriptEngine::stopTimer(QTimer *timer) {
-    if (_timerFunctionMap.contains(timer)) {
-        timer->stop();
-        _timerFunctionMap.remove(timer);
-        delete timer;
+void ScriptEngine::stopTimer(const QScriptValue& timer) {
+    if (!timer.isNumber()) {
+        qCDebug(scriptengine) << "stopTimer -- not a timer" << timer.toString();
+        return;
+    }
+    auto id = (TimerWheel::TimerID)timer.toUInt32();
+    if (_timerFunctionMap.contains(id)) {
+        _timerWheel.cancel(id);
+        removeTimer(id);
     } else {
-        qCDebug(scriptengine) << "stopTimer -- not in _timerFunctionMap" << timer;
+        qCDebug(scriptengine) << "stopTimer -- not in _timerFunctionMap" << id;
+    }
+}
+
+void ScriptEngine::removeTimer(TimerWheel::TimerID timer) {
+    CallbackData timerData = _timerFunctionMap.take(timer);
+    auto entityTimers = _entityTimers.find(timerData.definingEntityIdentifier);
+    if (entityTimers != _entityTimers.end()) {
+        entityTimers->remove(timer);
+        if (entityTimers->isEmpty()) {
+            _entityTimers.erase(entityTimers);
+        }
     }
+    _numTimers = _timerFunctionMap.size();
 }
 
 QUrl ScriptEngine::resolvePath(const QString& include) const {
@@ -1885,7 +1916,11 @@ int ScriptEngine::getNumRunningEntityScripts() const {
 }
 
 void ScriptEngine::setEntityScriptDetails(const EntityItemID& entityID, const EntityScriptDetails& details) {
-    _entityScripts[entityID] = details;
+    auto& entityDetails = _entityScripts[entityID];
+    if (!entityDetails.programKey.isEmpty()) {
+        EntityScriptProgramCache::instance().removeInstance(entityDetails.programKey);
+    }
+    entityDetails = details;
     emit entityScriptDetailsUpdated();
 }
 
@@ -2169,85 +2204,94 @@ void ScriptEngine::entityScriptContentAvailable(const EntityItemID& entityID, co
         return;
     }
 
-    // SYNTAX ERRORS
-    auto syntaxError = lintScript(contents, fileName);
-    if (syntaxError.isError()) {
-        auto message = syntaxError.property("formatted").toString();
-        if (message.isEmpty()) {
-            message = syntaxError.toString();
+    // The checks only depend on the script, so they are done once for all the entities running it
+    auto& programCache = EntityScriptProgramCache::instance();
+    QByteArray programKey = EntityScriptProgramCache::makeKey(contents, fileName);
+    if (!programCache.isChecked(programKey)) {
+        auto checkStart = usecTimestampNow();
+
+        // SYNTAX ERRORS
+        auto syntaxError = lintScript(contents, fileName);
+        if (syntaxError.isError()) {
+            auto message = syntaxError.property("formatted").toString();
+            if (message.isEmpty()) {
+                message = syntaxError.toString();
+            }
+            setError(QString("Bad syntax (%1)").arg(message), EntityScriptStatus::ERROR_RUNNING_SCRIPT);
+            syntaxError.setProperty("detail", entityID.toString());
+            emit unhandledException(syntaxError);
+            return;
+        }
+        QScriptProgram program { contents, fileName };
+        if (program.isNull()) {
+            setError("Bad program (isNull)", EntityScriptStatus::ERROR_RUNNING_SCRIPT);
+            emit unhandledException(makeError("program.isNull"));
+            return; // done processing script
         }
-        setError(QString("Bad syntax (%1)").arg(message), EntityScriptStatus::ERROR_RUNNING_SCRIPT);
-        syntaxError.setProperty("detail", entityID.toString());
-        emit unhandledException(syntaxError);
-        return;
-    }
-    QScriptProgram program { contents, fileName };
-    if (program.isNull()) {
-        setError("Bad program (isNull)", EntityScriptStatus::ERROR_RUNNING_SCRIPT);
-        emit unhandledException(makeError("program.isNull"));
-        return; // done processing script
-    }
 
-    if (isURL) {
-        setParentURL(scriptOrURL);
-    }
+        // SANITY/PERFORMANCE CHECK USING SANDBOX
+        const int SANDBOX_TIMEOUT = 0.25 * MSECS_PER_SECOND;
+        BaseScriptEngine sandbox;
+        sandbox.setProcessEventsInterval(SANDBOX_TIMEOUT);
+        QScriptValue testConstructor, exception;
+        {
+            QTimer timeout;
+            timeout.setSingleShot(true);
+            timeout.start(SANDBOX_TIMEOUT);
+            connect(&timeout, &QTimer::timeout, [&sandbox, SANDBOX_TIMEOUT, scriptOrURL]{
+                    qCDebug(scriptengine) << "ScriptEngine::entityScriptContentAvailable timeout(" << scriptOrURL << ")";
+
+                    // Guard against infinite loops and non-performant code
+                    sandbox.raiseException(
+                        sandbox.makeError(QString("Timed out (entity constructors are limited to %1ms)").arg(SANDBOX_TIMEOUT))
+                    );
+            });
 
-    // SANITY/PERFORMANCE CHECK USING SANDBOX
-    const int SANDBOX_TIMEOUT = 0.25 * MSECS_PER_SECOND;
-    BaseScriptEngine sandbox;
-    sandbox.setProcessEventsInterval(SANDBOX_TIMEOUT);
-    QScriptValue testConstructor, exception;
-    {
-        QTimer timeout;
-        timeout.setSingleShot(true);
-        timeout.start(SANDBOX_TIMEOUT);
-        connect(&timeout, &QTimer::timeout, [&sandbox, SANDBOX_TIMEOUT, scriptOrURL]{
-                qCDebug(scriptengine) << "ScriptEngine::entityScriptContentAvailable timeout(" << scriptOrURL << ")";
-
-                // Guard against infinite loops and non-performant code
-                sandbox.raiseException(
-                    sandbox.makeError(QString("Timed out (entity constructors are limited to %1ms)").arg(SANDBOX_TIMEOUT))
-                );
-        });
+            testConstructor = sandbox.evaluate(program);
 
-        testConstructor = sandbox.evaluate(program);
+            if (sandbox.hasUncaughtException()) {
+                exception = sandbox.cloneUncaughtException(QString("(preflight %1)").arg(entityID.toString()));
+                sandbox.clearExceptions();
+            } else if (testConstructor.isError()) {
+                exception = testConstructor;
+            }
+        }
 
-        if (sandbox.hasUncaughtException()) {
-            exception = sandbox.cloneUncaughtException(QString("(preflight %1)").arg(entityID.toString()));
-            sandbox.clearExceptions();
-        } else if (testConstructor.isError()) {
-            exception = testConstructor;
+        if (exception.isError()) {
+            // create a local copy using makeError to decouple from the sandbox engine
+            exception = makeError(exception);
+            setError(formatException(exception, _enableExtendedJSExceptions.get()), EntityScriptStatus::ERROR_RUNNING_SCRIPT);
+            emit unhandledException(exception);
+            return;
         }
-    }
 
-    if (exception.isError()) {
-        // create a local copy using makeError to decouple from the sandbox engine
-        exception = makeError(exception);
-        setError(formatException(exception, _enableExtendedJSExceptions.get()), EntityScriptStatus::ERROR_RUNNING_SCRIPT);
-        emit unhandledException(exception);
-        return;
-    }
+        // CONSTRUCTOR VIABILITY
+        if (!testConstructor.isFunction()) {
+            QString testConstructorType = QString(testConstructor.toVariant().typeName());
+            if (testConstructorType == "") {
+                testConstructorType = "empty";
+            }
+            QString testConstructorValue = testConstructor.toString();
+            if (testConstructorValue.size() > MAX_DEBUG_VALUE_LENGTH) {
+                testConstructorValue = testConstructorValue.mid(0, MAX_DEBUG_VALUE_LENGTH) + "...";
+            }
+            auto message = QString("failed to load entity script -- expected a function, got %1, %2")
+                .arg(testConstructorType).arg(testConstructorValue);
 
-    // CONSTRUCTOR VIABILITY
-    if (!testConstructor.isFunction()) {
-        QString testConstructorType = QString(testConstructor.toVariant().typeName());
-        if (testConstructorType == "") {
-            testConstructorType = "empty";
-        }
-        QString testConstructorValue = testConstructor.toString();
-        if (testConstructorValue.size() > MAX_DEBUG_VALUE_LENGTH) {
-            testConstructorValue = testConstructorValue.mid(0, MAX_DEBUG_VALUE_LENGTH) + "...";
+            auto err = makeError(message);
+            err.setProperty("fileName", scriptOrURL);
+            err.setProperty("detail", "(constructor " + entityID.toString() + ")");
+
+            setError("Could not find constructor (" + testConstructorType + ")", EntityScriptStatus::ERROR_RUNNING_SCRIPT);
+            emit unhandledException(err);
+            return; // done processing script
         }
-        auto message = QString("failed to load entity script -- expected a function, got %1, %2")
-            .arg(testConstructorType).arg(testConstructorValue);
 
-        auto err = makeError(message);
-        err.setProperty("fileName", scriptOrURL);
-        err.setProperty("detail", "(constructor " + entityID.toString() + ")");
+        programCache.setChecked(programKey, fileName, contents.size(), usecTimestampNow() - checkStart);
+    }
 
-        setError("Could not find constructor (" + testConstructorType + ")", EntityScriptStatus::ERROR_RUNNING_SCRIPT);
-        emit unhandledException(err);
-        return; // done processing script
+    if (isURL) {
+        setParentURL(scriptOrURL);
     }
 
     // (this feeds into refreshFileScript)
@@ -2260,6 +2304,9 @@ void ScriptEngine::entityScriptContentAvailable(const EntityItemID& entityID, co
     // THE ACTUAL EVALUATION AND CONSTRUCTION
     QScriptValue entityScriptConstructor, entityScriptObject;
     QUrl sandboxURL = currentSandboxURL.isEmpty() ? scriptOrURL : currentSandboxURL;
+    // Each entity evaluates the script itself: scripts commonly keep their instance in a variable of the enclosing
+    // function, like `var _this;`, that a constructor shared between entities would share too
+    auto instantiationStart = usecTimestampNow();
     auto initialization = [&]{
         entityScriptConstructor = evaluate(contents, fileName);
         entityScriptObject = entityScriptConstructor.construct();
@@ -2279,8 +2326,11 @@ void ScriptEngine::entityScriptContentAvailable(const EntityItemID& entityID, co
         return;
     }
 
+    programCache.addInstance(programKey, usecTimestampNow() - instantiationStart);
+
     // ... AND WE HAVE LIFTOFF
     newDetails.status = EntityScriptStatus::RUNNING;
+    newDetails.programKey = programKey;
     newDetails.scriptObject = entityScriptObject;
     newDetails.lastModified = lastModified;
     newDetails.definingSandboxURL = sandboxURL;
@@ -2326,6 +2376,9 @@ void ScriptEngine::unloadEntityScript(const EntityItemID& entityID, bool shouldR
 #endif
         if (shouldRemoveFromMap) {
             // this was a deleted entity, we've been asked to remove it from the map
+            if (!oldDetails.programKey.isEmpty()) {
+                EntityScriptProgramCache::instance().removeInstance(oldDetails.programKey);
+            }
             _entityScripts.remove(entityID);
             emit entityScriptDetailsUpdated();
         } else if (oldDetails.status != EntityScriptStatus::UNLOADED) {
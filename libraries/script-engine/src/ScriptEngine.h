@@ -27,9 +27,11 @@
 #include <AvatarData.h>
 #include <AvatarHashMap.h>
 #include <LimitedNodeList.h>
+#include <MetricsRegistry.h>
 #include <EntityItemID.h>
 #include <EntitiesScriptEngineProvider.h>
 #include <EntityScriptUtils.h>
+#include <TimerWheel.h>
 
 #include "PointerEvent.h"
 #include "ArrayBufferClass.h"
@@ -77,6 +79,9 @@ public:
     QScriptValue scriptObject { QScriptValue() };
     int64_t lastModified { 0 };
     QUrl definingSandboxURL { QUrl("about:EntityScript") };
+
+    // The EntityScriptProgramCache key of the script this instance runs, empty if it isn't running
+    QByteArray programKey;
 };
 
 class ScriptEngine : public BaseScriptEngine, public EntitiesScriptEngineProvider {
@@ -170,10 +175,11 @@ public:
     QVariantMap fetchModuleSource(const QString& modulePath, const bool forceDownload = false);
     QScriptValue instantiateModule(const QScriptValue& module, const QString& sourceCode);
 
-    Q_INVOKABLE QObject* setInterval(const QScriptValue& function, int intervalMS);
-    Q_INVOKABLE QObject* setTimeout(const QScriptValue& function, int timeoutMS);
-    Q_INVOKABLE void clearInterval(QObject* timer) { stopTimer(reinterpret_cast<QTimer*>(timer)); }
-    Q_INVOKABLE void clearTimeout(QObject* timer) { stopTimer(reinterpret_cast<QTimer*>(timer)); }
+    // Timers are identified by a number, like in browsers, 0 when the timer couldn't be created
+    Q_INVOKABLE QScriptValue setInterval(const QScriptValue& function, int intervalMS);
+    Q_INVOKABLE QScriptValue setTimeout(const QScriptValue& function, int timeoutMS);
+    Q_INVOKABLE void clearInterval(const QScriptValue& timer) { stopTimer(timer); }
+    Q_INVOKABLE void clearTimeout(const QScriptValue& timer) { stopTimer(timer); }
 
     Q_INVOKABLE void print(const QString& message);
     Q_INVOKABLE QUrl resolvePath(const QString& path) const;
@@ -223,6 +229,7 @@ public:
     void scriptInfoMessage(const QString& message);
 
     int getNumRunningEntityScripts() const;
+    int getNumTimers() const { return _numTimers; }
     bool getEntityScriptDetails(const EntityItemID& entityID, EntityScriptDetails &details) const;
 
 public slots:
@@ -233,6 +240,8 @@ signals:
     void scriptLoaded(const QString& scriptFilename);
     void errorLoadingScript(const QString& scriptFilename);
     void update(float deltaTime);
+    // Emitted at the end of each frame of the run loop with the time it spent working, sleep excluded
+    void frameFinished(quint64 busyUsecs);
     void scriptEnding();
     void finished(const QString& fileNameString, ScriptEngine* engine);
     void cleanupMenuItem(const QString& menuItemString);
@@ -257,7 +266,8 @@ protected:
     Q_INVOKABLE QString _requireResolve(const QString& moduleId, const QString& relativeTo = QString());
 
     QString logException(const QScriptValue& exception);
-    void timerFired();
+    void fireTimers();
+    void timerFired(TimerWheel::TimerID timer, quint64 lateMsecs);
     void stopAllTimers();
     void stopAllTimersForEntityScript(const EntityItemID& entityID);
     void refreshFileScript(const EntityItemID& entityID);
@@ -266,8 +276,9 @@ protected:
     void setParentURL(const QString& parentURL) { _parentURL = parentURL; }
     void processDeferredEntityLoads(const QString& entityScript, const EntityItemID& leaderID);
 
-    QObject* setupTimerWithInterval(const QScriptValue& function, int intervalMS, bool isSingleShot);
-    void stopTimer(QTimer* timer);
+    QScriptValue setupTimerWithInterval(const QScriptValue& function, int intervalMS, bool isSingleShot);
+    void stopTimer(const QScriptValue& timer);
+    void removeTimer(TimerWheel::TimerID timer);
 
     QHash<EntityItemID, RegisteredEventHandlers> _registeredHandlers;
     void forwardHandlerCall(const EntityItemID& entityID, const QString& eventName, QScriptValueList eventHanderArgs);
@@ -285,9 +296,15 @@ protected:
     std::atomic<bool> _isRunning { false };
     std::atomic<bool> _isStopping { false };
     bool _isInitialized { false };
-    QHash<QTimer*, CallbackData> _timerFunctionMap;
+    // Script timers are polled from the script thread's loop, rather than each being a QTimer
+    TimerWheel _timerWheel;
+    QHash<TimerWheel::TimerID, CallbackData> _timerFunctionMap;
+    QHash<EntityItemID, QSet<TimerWheel::TimerID>> _entityTimers;
+    std::atomic<int> _numTimers { 0 };
+    MetricsRegistry::Histogram* _timerLateness { nullptr };
     QSet<QUrl> _includedURLs;
     QHash<EntityItemID, EntityScriptDetails> _entityScripts;
+
     QHash<QString, EntityItemID> _occupiedScriptURLs;
     QList<DeferredLoadEntity> _deferredEntityLoads;
 
@@ -0,0 +1,222 @@
+//
+//  MetricsRegistry.cpp
+//  libraries/shared/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "MetricsRegistry.h"
+
+#include <assert.h>
+#include <functional>
+#include <thread>
+
+#include <QtCore/QJsonValue>
+#include <QtCore/QTextStream>
+#include <QtCore/QUuid>
+
+static const int MAX_PUBLISHED_STATS_DEPTH = 3;
+static const std::array<double, 4> PUBLISHED_QUANTILES { { 0.5, 0.9, 0.99, 0.999 } };
+
+int MetricsRegistry::getShard() {
+    static thread_local int shard = (int)(std::hash<std::thread::id>()(std::this_thread::get_id()) % SHARD_COUNT);
+    return shard;
+}
+
+uint64_t MetricsRegistry::Counter::get() const {
+    uint64_t total = 0;
+    for (const auto& shard : _shards) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void MetricsRegistry::Gauge::add(double value) {
+    double current = _value.load(std::memory_order_relaxed);
+    while (!_value.compare_exchange_weak(current, current + value, std::memory_order_relaxed)) {
+    }
+}
+
+int MetricsRegistry::Histogram::getBucket(uint64_t value) {
+    if (value < (uint64_t)SUB_BUCKETS) {
+        return (int)value;
+    }
+    int exponent = 0;
+    for (uint64_t remaining = value; remaining > 1; remaining >>= 1) {
+        exponent++;
+    }
+    if (exponent > MAX_EXPONENT) {
+        return NUM_BUCKETS - 1;
+    }
+    int subBucket = (int)((value >> (exponent - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+    return (exponent - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + subBucket;
+}
+
+uint64_t MetricsRegistry::Histogram::getBucketUpperBound(int bucket) {
+    if (bucket < SUB_BUCKETS) {
+        return (uint64_t)bucket;
+    }
+    int exponent = bucket / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+    uint64_t subBucket = (uint64_t)(bucket % SUB_BUCKETS);
+    int shift = exponent - SUB_BUCKET_BITS;
+    return ((SUB_BUCKETS + subBucket + 1) << shift) - 1;
+}
+
+void MetricsRegistry::Histogram::record(uint64_t value) {
+    auto& shard = _shards[getShard()];
+    shard.buckets[getBucket(value)].fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+    shard.count.fetch_add(1, std::memory_order_relaxed);
+}
+
+MetricsRegistry::Histogram::Snapshot MetricsRegistry::Histogram::getSnapshot() const {
+    Snapshot snapshot;
+    snapshot.buckets.resize(NUM_BUCKETS, 0);
+    for (const auto& shard : _shards) {
+        snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+        for (int i = 0; i < NUM_BUCKETS; i++) {
+            uint64_t bucketCount = shard.buckets[i].load(std::memory_order_relaxed);
+            snapshot.buckets[i] += bucketCount;
+            // counted from the buckets so the percentiles are consistent with the count
+            snapshot.count += bucketCount;
+        }
+    }
+    return snapshot;
+}
+
+uint64_t MetricsRegistry::Histogram::Snapshot::getPercentile(double fraction) const {
+    if (count == 0) {
+        return 0;
+    }
+    uint64_t target = (uint64_t)(fraction * (double)count);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); i++) {
+        seen += buckets[i];
+        if (seen > target) {
+            return getBucketUpperBound((int)i);
+        }
+    }
+    return getBucketUpperBound((int)buckets.size() - 1);
+}
+
+QString MetricsRegistry::sanitizeName(const QString& name) {
+    QString sanitized;
+    sanitized.reserve(name.size());
+    for (const QChar& c : name) {
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_' || c == ':') {
+            sanitized.append(c.toLower());
+        } else if (c == '%') {
+            sanitized.append("percent");
+        } else if (!sanitized.endsWith('_')) {
+            sanitized.append('_');
+        }
+    }
+    if (sanitized.isEmpty() || sanitized[0].isDigit()) {
+        sanitized.prepend('_');
+    }
+    return sanitized;
+}
+
+MetricsRegistry::Metric& MetricsRegistry::getMetric(const QString& name, const QString& help, Type type) {
+    std::lock_guard<std::mutex> guard(_metricsMutex);
+    QString sanitized = sanitizeName(name);
+    auto it = _metrics.find(sanitized);
+    if (it != _metrics.end()) {
+        assert(it->second.type == type);
+        return it->second;
+    }
+
+    Metric& metric = _metrics[sanitized];
+    metric.type = type;
+    metric.help = help;
+    switch (type) {
+        case Type::Counter:
+            metric.counter.reset(new Counter());
+            break;
+        case Type::Gauge:
+            metric.gauge.reset(new Gauge());
+            break;
+        case Type::Histogram:
+            metric.histogram.reset(new Histogram());
+            break;
+    }
+    return metric;
+}
+
+MetricsRegistry::Counter& MetricsRegistry::getCounter(const QString& name, const QString& help) {
+    return *getMetric(name, help, Type::Counter).counter;
+}
+
+MetricsRegistry::Gauge& MetricsRegistry::getGauge(const QString& name, const QString& help) {
+    return *getMetric(name, help, Type::Gauge).gauge;
+}
+
+MetricsRegistry::Histogram& MetricsRegistry::getHistogram(const QString& name, const QString& help) {
+    return *getMetric(name, help, Type::Histogram).histogram;
+}
+
+MetricsRegistry::Histogram* MetricsRegistry::findHistogram(const QString& name, const QString& help) {
+    // get() warns about a dependency that isn't set, most processes don't have a registry
+    if (!DependencyManager::isSet<MetricsRegistry>()) {
+        return nullptr;
+    }
+    return &DependencyManager::get<MetricsRegistry>()->getHistogram(name, help);
+}
+
+void MetricsRegistry::publishStats(const QString& prefix, const QJsonObject& stats) {
+    publishStats(sanitizeName(prefix), stats, 0);
+}
+
+void MetricsRegistry::publishStats(const QString& prefix, const QJsonObject& stats, int depth) {
+    for (auto it = stats.constBegin(); it != stats.constEnd(); ++it) {
+        QString name = prefix + "_" + sanitizeName(it.key());
+        const QJsonValue& value = it.value();
+        if (value.isDouble()) {
+            getGauge(name, "from the stats sent to the domain server").set(value.toDouble());
+        } else if (value.isBool()) {
+            getGauge(name, "from the stats sent to the domain server").set(value.toBool() ? 1.0 : 0.0);
+        } else if (value.isObject() && depth < MAX_PUBLISHED_STATS_DEPTH && QUuid(it.key()).isNull()) {
+            publishStats(name, value.toObject(), depth + 1);
+        }
+    }
+}
+
+QByteArray MetricsRegistry::toPrometheusText() const {
+    QByteArray text;
+    QTextStream out(&text);
+    out.setRealNumberPrecision(17);
+
+    std::lock_guard<std::mutex> guard(_metricsMutex);
+    for (const auto& entry : _metrics) {
+        const QString& name = entry.first;
+        const Metric& metric = entry.second;
+        if (!metric.help.isEmpty()) {
+            out << "# HELP " << name << " " << QString(metric.help).replace('\n', ' ') << "\n";
+        }
+        switch (metric.type) {
+            case Type::Counter:
+                out << "# TYPE " << name << " counter\n";
+                out << name << " " << (quint64)metric.counter->get() << "\n";
+                break;
+            case Type::Gauge:
+                out << "# TYPE " << name << " gauge\n";
+                out << name << " " << metric.gauge->get() << "\n";
+                break;
+            case Type::Histogram: {
+                auto snapshot = metric.histogram->getSnapshot();
+                out << "# TYPE " << name << " summary\n";
+                for (double quantile : PUBLISHED_QUANTILES) {
+                    out << name << "{quantile=\"" << quantile << "\"} " << (quint64)snapshot.getPercentile(quantile) << "\n";
+                }
+                out << name << "_sum " << (quint64)snapshot.sum << "\n";
+                out << name << "_count " << (quint64)snapshot.count << "\n";
+                break;
+            }
+        }
+    }
+    out.flush();
+    return text;
+}
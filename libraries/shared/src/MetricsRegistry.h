@@ -0,0 +1,152 @@
+//
+//  MetricsRegistry.h
+//  libraries/shared/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#pragma once
+
+#ifndef hifi_MetricsRegistry_h
+#define hifi_MetricsRegistry_h
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QJsonObject>
+#include <QtCore/QString>
+
+#include "DependencyManager.h"
+
+// Process wide counters, gauges and latency histograms, scraped in the Prometheus text format.
+// Metrics are registered once, by name, and the returned references stay valid for the life of the registry.
+// Updates are lock-free: counters and histograms are sharded per thread so hot loops don't share cache lines.
+class MetricsRegistry : public Dependency {
+public:
+    static const int SHARD_COUNT = 8;
+
+    class Counter {
+    public:
+        void add(uint64_t value = 1) { _shards[getShard()].value.fetch_add(value, std::memory_order_relaxed); }
+        uint64_t get() const;
+
+    private:
+        struct alignas(64) Shard {
+            std::atomic<uint64_t> value { 0 };
+        };
+        std::array<Shard, SHARD_COUNT> _shards;
+    };
+
+    class Gauge {
+    public:
+        void set(double value) { _value.store(value, std::memory_order_relaxed); }
+        void add(double value);
+        double get() const { return _value.load(std::memory_order_relaxed); }
+
+    private:
+        std::atomic<double> _value { 0.0 };
+    };
+
+    // Log-linear buckets: exact below 16, then 16 buckets per power of two, so a percentile is within 1/16th
+    // of the recorded value, up to 2^41.
+    class Histogram {
+    public:
+        static const int SUB_BUCKET_BITS = 4;
+        static const int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+        static const int MAX_EXPONENT = 40;
+        static const int NUM_BUCKETS = (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS + SUB_BUCKETS;
+
+        class Snapshot {
+        public:
+            uint64_t count { 0 };
+            uint64_t sum { 0 };
+            std::vector<uint64_t> buckets;
+
+            // upper bound of the bucket holding the given fraction of the values, 0 if there are none
+            uint64_t getPercentile(double fraction) const;
+        };
+
+        void record(uint64_t value);
+        Snapshot getSnapshot() const;
+
+        static int getBucket(uint64_t value);
+        static uint64_t getBucketUpperBound(int bucket);
+
+    private:
+        struct alignas(64) Shard {
+            std::atomic<uint64_t> count { 0 };
+            std::atomic<uint64_t> sum { 0 };
+            std::array<std::atomic<uint64_t>, NUM_BUCKETS> buckets {};
+        };
+        std::array<Shard, SHARD_COUNT> _shards;
+    };
+
+    // Records the microseconds it lived in a histogram, does nothing without one
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(Histogram* histogram) : _histogram(histogram) {
+            if (_histogram) {
+                _start = std::chrono::steady_clock::now();
+            }
+        }
+        ~ScopedTimer() {
+            if (_histogram) {
+                auto elapsed = std::chrono::steady_clock::now() - _start;
+                _histogram->record((uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count());
+            }
+        }
+
+    private:
+        Histogram* _histogram;
+        std::chrono::steady_clock::time_point _start;
+    };
+
+    // Names are sanitized to the Prometheus character set, the help of the first registration is kept.
+    // Registering an existing name as another kind of metric is a programming error and asserts.
+    Counter& getCounter(const QString& name, const QString& help);
+    Gauge& getGauge(const QString& name, const QString& help);
+    Histogram& getHistogram(const QString& name, const QString& help);
+
+    // The histogram of the process' registry, nullptr if the process doesn't have one
+    static Histogram* findHistogram(const QString& name, const QString& help);
+
+    // Mirrors the numeric values of a stats object, as sent to the domain server, into gauges named
+    // prefix_key_subkey. Per node sections keyed by a UUID are skipped to keep the number of metrics bounded.
+    void publishStats(const QString& prefix, const QJsonObject& stats);
+
+    QByteArray toPrometheusText() const;
+
+    static QString sanitizeName(const QString& name);
+
+    // thread local shard index, stable for the life of the thread
+    static int getShard();
+
+private:
+    enum class Type { Counter, Gauge, Histogram };
+
+    class Metric {
+    public:
+        Type type;
+        QString help;
+        std::unique_ptr<Counter> counter;
+        std::unique_ptr<Gauge> gauge;
+        std::unique_ptr<Histogram> histogram;
+    };
+
+    Metric& getMetric(const QString& name, const QString& help, Type type);
+    void publishStats(const QString& prefix, const QJsonObject& stats, int depth);
+
+    mutable std::mutex _metricsMutex;
+    std::map<QString, Metric> _metrics;
+};
+
+#endif // hifi_MetricsRegistry_h
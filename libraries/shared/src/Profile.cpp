@@ -39,9 +39,13 @@ static bool tracingEnabled() {
 
 Duration::Duration(const QLoggingCategory& category, const QString& name, uint32_t argbColor, uint64_t payload, const QVariantMap& baseArgs) : _name(name), _category(category) {
     if (tracingEnabled() && category.isDebugEnabled()) {
-        QVariantMap args = baseArgs;
-        args["nv_payload"] = QVariant::fromValue(payload);
-        tracing::traceEvent(_category, _name, tracing::DurationBegin, "", args);
+        if (baseArgs.isEmpty()) {
+            DependencyManager::get<tracing::Tracer>()->traceDuration(_category, _name, tracing::DurationBegin, payload);
+        } else {
+            QVariantMap args = baseArgs;
+            args["nv_payload"] = QVariant::fromValue(payload);
+            tracing::traceEvent(_category, _name, tracing::DurationBegin, "", args);
+        }
 
 #if defined(NSIGHT_TRACING)
         nvtxEventAttributes_t eventAttrib { 0 };
@@ -47,6 +47,7 @@ extern "C" FILE * __cdecl __iob_func(void) {
 #include <QtCore/QDebug>
 #include <QDateTime>
 #include <QElapsedTimer>
+#include <QFile>
 #include <QProcess>
 #include <QSysInfo>
 #include <QThread>
@@ -880,6 +881,44 @@ bool getMemoryInfo(MemoryInfo& info) {
     info.processUsedMemoryBytes = pmc.PrivateUsage;
     info.processPeakUsedMemoryBytes = pmc.PeakPagefileUsage;
 
+    return true;
+#elif defined(Q_OS_LINUX)
+    // the "kB" of /proc are 1024 bytes
+    const uint64_t BYTES_PER_PROC_KB = 1024;
+    auto readKilobytes = [](const QString& path, const QList<QByteArray>& keys, QList<uint64_t>& values) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            return false;
+        }
+        values = QList<uint64_t>();
+        for (int i = 0; i < keys.size(); i++) {
+            values.append(0);
+        }
+        int found = 0;
+        for (QByteArray line = file.readLine(); !line.isEmpty(); line = file.readLine()) {
+            int index = keys.indexOf(line.left(line.indexOf(':')));
+            if (index >= 0) {
+                values[index] = line.mid(line.indexOf(':') + 1).simplified().split(' ').first().toULongLong();
+                found++;
+            }
+        }
+        return found == keys.size();
+    };
+
+    QList<uint64_t> values;
+    if (!readKilobytes("/proc/meminfo", { "MemTotal", "MemAvailable" }, values)) {
+        return false;
+    }
+    info.totalMemoryBytes = values[0] * BYTES_PER_PROC_KB;
+    info.availMemoryBytes = values[1] * BYTES_PER_PROC_KB;
+    info.usedMemoryBytes = info.totalMemoryBytes - info.availMemoryBytes;
+
+    if (!readKilobytes("/proc/self/status", { "VmRSS", "VmHWM" }, values)) {
+        return false;
+    }
+    info.processUsedMemoryBytes = values[0] * BYTES_PER_PROC_KB;
+    info.processPeakUsedMemoryBytes = values[1] * BYTES_PER_PROC_KB;
+
     return true;
 #endif
 
@@ -0,0 +1,112 @@
+//
+//  SkinningBatch.cpp
+//  libraries/shared/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "SkinningBatch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include <QtCore/QRunnable>
+#include <QtCore/QThreadPool>
+
+#include "GLMHelpers.h"
+
+namespace {
+
+// Shared by the caller and the pool tasks of one compute(), outlives it if a task starts after the work is done
+class ChunkQueue {
+public:
+    using Pointer = std::shared_ptr<ChunkQueue>;
+    using ComputeFunction = std::function<void(size_t begin, size_t end)>;
+
+    ChunkQueue(size_t size, ComputeFunction compute) :
+        _size(size), _numChunks((size + SkinningBatch::MATRICES_PER_CHUNK - 1) / SkinningBatch::MATRICES_PER_CHUNK),
+        _compute(compute) {}
+
+    size_t getNumChunks() const { return _numChunks; }
+
+    // takes chunks until there are none left, _compute isn't touched once all chunks are taken
+    void work() {
+        size_t chunk;
+        while ((chunk = _nextChunk.fetch_add(1)) < _numChunks) {
+            size_t begin = chunk * SkinningBatch::MATRICES_PER_CHUNK;
+            _compute(begin, std::min(begin + SkinningBatch::MATRICES_PER_CHUNK, _size));
+            if (_doneChunks.fetch_add(1) + 1 == _numChunks) {
+                std::lock_guard<std::mutex> lock(_mutex);
+                _done.notify_all();
+            }
+        }
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done.wait(lock, [this] { return _doneChunks.load() == _numChunks; });
+    }
+
+private:
+    const size_t _size;
+    const size_t _numChunks;
+    const ComputeFunction _compute;
+    std::atomic<size_t> _nextChunk { 0 };
+    std::atomic<size_t> _doneChunks { 0 };
+    std::mutex _mutex;
+    std::condition_variable _done;
+};
+
+class ChunkTask : public QRunnable {
+public:
+    ChunkTask(const ChunkQueue::Pointer& queue) : _queue(queue) {}
+    void run() override { _queue->work(); }
+
+private:
+    ChunkQueue::Pointer _queue;
+};
+
+}
+
+void SkinningBatch::reserve(size_t size) {
+    _jointMatrices.reserve(size);
+    _inverseBindMatrices.reserve(size);
+    _outputs.reserve(size);
+}
+
+void SkinningBatch::clear() {
+    _jointMatrices.clear();
+    _inverseBindMatrices.clear();
+    _outputs.clear();
+}
+
+void SkinningBatch::computeRange(size_t begin, size_t end) const {
+    for (size_t i = begin; i < end; i++) {
+        glm_mat4u_mul(_jointMatrices[i], _inverseBindMatrices[i], *_outputs[i]);
+    }
+}
+
+void SkinningBatch::compute() {
+    if (size() < 2 * MATRICES_PER_CHUNK) {
+        computeSerially();
+        return;
+    }
+
+    auto queue = std::make_shared<ChunkQueue>(size(), [this](size_t begin, size_t end) {
+        computeRange(begin, end);
+    });
+    QThreadPool* pool = QThreadPool::globalInstance();
+    int numTasks = std::min(pool->maxThreadCount(), (int)queue->getNumChunks() - 1);
+    for (int i = 0; i < numTasks; i++) {
+        pool->start(new ChunkTask(queue));
+    }
+    queue->work();
+    queue->wait();
+}
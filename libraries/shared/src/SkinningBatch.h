@@ -0,0 +1,51 @@
+//
+//  SkinningBatch.h
+//  libraries/shared/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#pragma once
+
+#ifndef hifi_SkinningBatch_h
+#define hifi_SkinningBatch_h
+
+#include <vector>
+
+#include <glm/glm.hpp>
+
+// The skinning matrices (joint transform * inverse bind matrix) of many models, gathered in contiguous arrays
+// and computed in one pass.  Large batches are split in chunks shared between the calling thread and the global
+// thread pool; the calling thread takes chunks too, so a busy pool only costs parallelism, never a wait on
+// work that hasn't started.
+// Outputs must stay valid and must not be written by anyone else until compute() returns.
+class SkinningBatch {
+public:
+    // matrices per chunk of work; batches of fewer than two chunks are computed on the calling thread
+    static const size_t MATRICES_PER_CHUNK = 256;
+
+    void reserve(size_t size);
+    void clear();
+    size_t size() const { return _outputs.size(); }
+
+    void add(const glm::mat4& jointMatrix, const glm::mat4& inverseBindMatrix, glm::mat4* output) {
+        _jointMatrices.push_back(jointMatrix);
+        _inverseBindMatrices.push_back(inverseBindMatrix);
+        _outputs.push_back(output);
+    }
+
+    void compute();
+    void computeSerially() { computeRange(0, size()); }
+
+private:
+    void computeRange(size_t begin, size_t end) const;
+
+    std::vector<glm::mat4> _jointMatrices;
+    std::vector<glm::mat4> _inverseBindMatrices;
+    std::vector<glm::mat4*> _outputs;
+};
+
+#endif // hifi_SkinningBatch_h
@@ -64,12 +64,17 @@ const QUuid SpatiallyNestable::getParentID() const {
 }
 
 void SpatiallyNestable::setParentID(const QUuid& parentID) {
+    bool changed = false;
     _idLock.withWriteLock([&] {
         if (_parentID != parentID) {
             _parentID = parentID;
             _parentKnowsMe = false;
+            changed = true;
         }
     });
+    if (changed) {
+        invalidateWorldTransform();
+    }
 
     bool success = false;
     getParentPointer(success);
@@ -149,7 +154,10 @@ void SpatiallyNestable::forgetChild(SpatiallyNestablePointer newChild) const {
 }
 
 void SpatiallyNestable::setParentJointIndex(quint16 parentJointIndex) {
-    _parentJointIndex = parentJointIndex;
+    if (_parentJointIndex != parentJointIndex) {
+        _parentJointIndex = parentJointIndex;
+        invalidateWorldTransform();
+    }
 }
 
 glm::vec3 SpatiallyNestable::worldToLocal(const glm::vec3& position,
@@ -408,6 +416,9 @@ void SpatiallyNestable::setPosition(const glm::vec3& position, bool& success, bo
             _translationChanged = usecTimestampNow();
         }
     });
+    if (changed) {
+        invalidateWorldTransform();
+    }
     if (success && changed) {
         locationChanged(tellPhysics);
     }
@@ -461,6 +472,9 @@ void SpatiallyNestable::setOrientation(const glm::quat& orientation, bool& succe
             _rotationChanged = usecTimestampNow();
         }
     });
+    if (changed) {
+        invalidateWorldTransform();
+    }
     if (success && changed) {
         locationChanged(tellPhysics);
     }
@@ -596,12 +610,70 @@ glm::vec3 SpatiallyNestable::getParentAngularVelocity(bool& success) const {
 
 const Transform SpatiallyNestable::getTransform(bool& success, int depth) const {
     Transform result;
+    uint32_t generation = _worldTransformGeneration;
+    bool cached = false;
+    _transformLock.withReadLock([&] {
+        // a parent that went away does not bump our generation, so check for it here
+        if (_cachedWorldTransformGeneration == generation && (!_cachedWorldTransformHasParent || !_parent.expired())) {
+            result = _cachedWorldTransform;
+            cached = true;
+        }
+    });
+    if (cached) {
+        success = true;
+        return result;
+    }
+
     // return a world-space transform for this object's location
     Transform parentTransform = getParentTransform(success, depth);
+
+    // Joints move without telling their children, so only transforms that do not hang off a joint anywhere
+    // up the chain can be cached.  The parent was just evaluated, so its cache is up to date if it can be.
+    SpatiallyNestablePointer parent = _parent.lock();
+    bool cacheable = success && _parentJointIndex == INVALID_JOINT_INDEX &&
+        (!parent || parent->isWorldTransformCached());
+
+    if (cacheable) {
+        _transformLock.withWriteLock([&] {
+            Transform::mult(result, parentTransform, _transform);
+            // the generation moved if anything up the chain changed while we were evaluating it
+            if (generation == _worldTransformGeneration) {
+                _cachedWorldTransform = result;
+                _cachedWorldTransformGeneration = generation;
+                _cachedWorldTransformHasParent = (bool)parent;
+            }
+        });
+    } else {
+        _transformLock.withReadLock([&] {
+            Transform::mult(result, parentTransform, _transform);
+        });
+    }
+    return result;
+}
+
+bool SpatiallyNestable::isWorldTransformCached() const {
+    bool cached = false;
     _transformLock.withReadLock([&] {
-        Transform::mult(result, parentTransform, _transform);
+        cached = _cachedWorldTransformGeneration == _worldTransformGeneration;
+    });
+    return cached;
+}
+
+void SpatiallyNestable::invalidateWorldTransform(int depth) {
+    ++_worldTransformGeneration;
+    if (depth > maxParentingChain) {
+        // parenting loop, getTransform will break it
+        return;
+    }
+    // children register with their parent before they can cache anything, so this reaches every cached descendant
+    _childrenLock.withReadLock([&] {
+        foreach(const SpatiallyNestableWeakPointer& childWP, _children) {
+            SpatiallyNestablePointer child = childWP.lock();
+            if (child) {
+                child->invalidateWorldTransform(depth + 1);
+            }
+        }
     });
-    return result;
 }
 
 const Transform SpatiallyNestable::getTransform() const {
@@ -661,6 +733,9 @@ void SpatiallyNestable::setTransform(const Transform& transform, bool& success)
             _rotationChanged = usecTimestampNow();
         }
     });
+    if (changed) {
+        invalidateWorldTransform();
+    }
     if (success && changed) {
         locationChanged();
     }
@@ -703,6 +778,7 @@ void SpatiallyNestable::setScale(const glm::vec3& scale) {
         }
     });
     if (changed) {
+        invalidateWorldTransform();
         dimensionsChanged();
     }
 }
@@ -726,6 +802,7 @@ void SpatiallyNestable::setScale(float value) {
     });
 
     if (changed) {
+        invalidateWorldTransform();
         dimensionsChanged();
     }
 }
@@ -757,6 +834,7 @@ void SpatiallyNestable::setLocalTransform(const Transform& transform) {
     });
 
     if (changed) {
+        invalidateWorldTransform();
         locationChanged();
     }
 }
@@ -784,6 +862,7 @@ void SpatiallyNestable::setLocalPosition(const glm::vec3& position, bool tellPhy
         }
     });
     if (changed) {
+        invalidateWorldTransform();
         locationChanged(tellPhysics);
     }
 }
@@ -811,6 +890,7 @@ void SpatiallyNestable::setLocalOrientation(const glm::quat& orientation) {
         }
     });
     if (changed) {
+        invalidateWorldTransform();
         locationChanged();
     }
 }
@@ -869,6 +949,7 @@ void SpatiallyNestable::setLocalScale(const glm::vec3& scale) {
         }
     });
     if (changed) {
+        invalidateWorldTransform();
         dimensionsChanged();
     }
 }
@@ -1113,6 +1194,9 @@ void SpatiallyNestable::setLocalTransformAndVelocities(
             _rotationChanged = usecTimestampNow();
         }
     });
+    if (changed) {
+        invalidateWorldTransform();
+    }
     // linear velocity
     _velocityLock.withWriteLock([&] {
         _velocity = localVelocity;
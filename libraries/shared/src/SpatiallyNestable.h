@@ -12,6 +12,8 @@
 #ifndef hifi_SpatiallyNestable_h
 #define hifi_SpatiallyNestable_h
 
+#include <atomic>
+
 #include <QUuid>
 
 #include "Transform.h"
@@ -194,6 +196,11 @@ protected:
     mutable ReadWriteLockable _childrenLock;
     mutable QHash<QUuid, SpatiallyNestableWeakPointer> _children;
 
+    // called when this object's local transform or parent changes, drops the cached world transforms of this
+    // object and of all its descendants
+    void invalidateWorldTransform(int depth = 0);
+    bool isWorldTransformCached() const;
+
     virtual void locationChanged(bool tellPhysics = true); // called when a this object's location has changed
     virtual void dimensionsChanged() { } // called when a this object's dimensions have changed
     virtual void parentDeleted() { } // called on children of a deleted parent
@@ -216,6 +223,12 @@ private:
     mutable ReadWriteLockable _velocityLock;
     mutable ReadWriteLockable _angularVelocityLock;
     Transform _transform; // this is to be combined with parent's world-transform to produce this' world-transform.
+
+    // world transform cache, valid while its generation matches _worldTransformGeneration
+    std::atomic<uint32_t> _worldTransformGeneration { 1 };
+    mutable uint32_t _cachedWorldTransformGeneration { 0 };
+    mutable Transform _cachedWorldTransform;
+    mutable bool _cachedWorldTransformHasParent { false };
     glm::vec3 _velocity;
     glm::vec3 _angularVelocity;
     mutable bool _parentKnowsMe { false };
@@ -0,0 +1,110 @@
+//
+//  TimerWheel.cpp
+//  libraries/shared/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "TimerWheel.h"
+
+#include <algorithm>
+
+static const quint64 MAX_DELAY = (1ULL << (TimerWheel::SLOT_BITS * TimerWheel::LEVELS)) - 1;
+
+TimerWheel::TimerID TimerWheel::add(quint64 nowMsecs, quint64 delayMsecs, quint64 intervalMsecs) {
+    TimerID id = _nextID++;
+    while (id == 0 || _timers.find(id) != _timers.end()) {
+        id = _nextID++;
+    }
+
+    Timer& timer = _timers[id];
+    timer.expiry = std::max(nowMsecs, _current) + std::min(delayMsecs, MAX_DELAY);
+    timer.interval = std::min(intervalMsecs, MAX_DELAY);
+    schedule(id, timer);
+    return id;
+}
+
+bool TimerWheel::cancel(TimerID id) {
+    auto it = _timers.find(id);
+    if (it == _timers.end()) {
+        return false;
+    }
+    Timer& timer = it->second;
+    if (timer.level != FIRING) {
+        _slots[timer.level][(timer.expiry >> (timer.level * SLOT_BITS)) & (SLOTS - 1)].erase(timer.position);
+    }
+    _timers.erase(it);
+    return true;
+}
+
+void TimerWheel::schedule(TimerID id, Timer& timer, bool cascading) {
+    // anything already due goes in the next tick's slot, except while cascading: that runs after _current moved to
+    // the new tick and before its slot fires, so a timer due on it still fires on time
+    quint64 expiry = std::max(timer.expiry, cascading ? _current : _current + 1);
+    quint64 delta = expiry - _current;
+    int level = 0;
+    while (level < LEVELS - 1 && delta >= (1ULL << ((level + 1) * SLOT_BITS))) {
+        level++;
+    }
+    auto& slot = _slots[level][(expiry >> (level * SLOT_BITS)) & (SLOTS - 1)];
+    timer.expiry = expiry;
+    timer.level = level;
+    timer.position = slot.insert(slot.end(), id);
+}
+
+void TimerWheel::cascade(int level) {
+    auto& slot = _slots[level][(_current >> (level * SLOT_BITS)) & (SLOTS - 1)];
+    std::list<TimerID> timers;
+    timers.swap(slot);
+    for (TimerID id : timers) {
+        schedule(id, _timers[id], true);
+    }
+}
+
+void TimerWheel::advance(quint64 nowMsecs, const FireFunction& fire) {
+    while (_current < nowMsecs) {
+        if (_timers.empty()) {
+            _current = nowMsecs;
+            return;
+        }
+
+        _current++;
+        for (int level = 1; level < LEVELS && ((_current >> ((level - 1) * SLOT_BITS)) & (SLOTS - 1)) == 0; level++) {
+            cascade(level);
+        }
+
+        auto& slot = _slots[0][_current & (SLOTS - 1)];
+        if (slot.empty()) {
+            continue;
+        }
+
+        std::list<TimerID> due;
+        due.swap(slot);
+        // cancel() must not touch the list we're iterating
+        for (TimerID id : due) {
+            _timers[id].level = FIRING;
+        }
+        for (TimerID id : due) {
+            auto it = _timers.find(id);
+            if (it == _timers.end()) {
+                continue; // cancelled by an earlier callback of this tick
+            }
+            Timer& timer = it->second;
+            quint64 late = nowMsecs - timer.expiry;
+            if (timer.interval > 0) {
+                // like QTimer, a repeating timer that fell behind skips the periods it missed
+                timer.expiry += timer.interval;
+                if (timer.expiry <= nowMsecs) {
+                    timer.expiry = nowMsecs + timer.interval;
+                }
+                schedule(id, timer);
+            } else {
+                _timers.erase(it);
+            }
+            fire(id, late);
+        }
+    }
+}
@@ -0,0 +1,71 @@
+//
+//  TimerWheel.h
+//  libraries/shared/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#pragma once
+
+#ifndef hifi_TimerWheel_h
+#define hifi_TimerWheel_h
+
+#include <array>
+#include <functional>
+#include <list>
+#include <unordered_map>
+
+#include <QtCore/QtGlobal>
+
+// Hierarchical timer wheel with a millisecond tick, for owners that poll it from their own loop rather than
+// registering one timer per callback with the event loop.  Adding and cancelling a timer are O(1); a timer due in
+// more than 256 ticks is moved to a finer level at most once per level on its way to expiry.
+// Not thread safe, a wheel belongs to the thread polling it.
+class TimerWheel {
+public:
+    using TimerID = quint32; // never 0
+    // lateMsecs: how long after its due time the timer fired
+    using FireFunction = std::function<void(TimerID timer, quint64 lateMsecs)>;
+
+    static const int SLOT_BITS = 8;
+    static const int SLOTS = 1 << SLOT_BITS;
+    static const int LEVELS = 4; // up to 2^32 ms, about 49 days, longer delays are clamped
+
+    explicit TimerWheel(quint64 nowMsecs = 0) : _current(nowMsecs) {}
+
+    // Fires delayMsecs after nowMsecs, then every intervalMsecs if it isn't 0; a 0 delay fires on the next advance.
+    // nowMsecs is on the clock passed to advance, times before the last advance count as the last advance.
+    TimerID add(quint64 nowMsecs, quint64 delayMsecs, quint64 intervalMsecs = 0);
+    // false if the timer already fired for the last time or was cancelled
+    bool cancel(TimerID timer);
+    bool contains(TimerID timer) const { return _timers.find(timer) != _timers.end(); }
+    size_t size() const { return _timers.size(); }
+
+    // Fires every timer due at or before nowMsecs, in due time order.  The callback can add and cancel timers,
+    // including the one firing: when it runs a single shot timer is already gone, a repeating one rescheduled.
+    void advance(quint64 nowMsecs, const FireFunction& fire);
+
+private:
+    static const int FIRING = -1; // level of the timers taken out of their slot to fire
+
+    class Timer {
+    public:
+        quint64 expiry;
+        quint64 interval;
+        int level;
+        std::list<TimerID>::iterator position;
+    };
+
+    void schedule(TimerID id, Timer& timer, bool cascading = false);
+    void cascade(int level);
+
+    quint64 _current; // last tick processed
+    TimerID _nextID { 1 };
+    std::unordered_map<TimerID, Timer> _timers;
+    std::array<std::array<std::list<TimerID>, SLOTS>, LEVELS> _slots;
+};
+
+#endif // hifi_TimerWheel_h
@@ -8,7 +8,10 @@
 
 #include "Trace.h"
 
+#include <algorithm>
 #include <chrono>
+#include <cstring>
+#include <unordered_map>
 
 #include <QtCore/QDebug>
 #include <QtCore/QCoreApplication>
@@ -39,24 +42,579 @@ bool tracing::enabled() {
     return DependencyManager::get<Tracer>()->isEnabled();
 }
 
+const QString Tracer::BINARY_EXTENSION = ".hftrace";
+const size_t Tracer::MAX_RECORDED_BYTES = 256 * 1024 * 1024;
+
+static const QByteArray BINARY_MAGIC = "HFTRACE";
+static const quint32 BINARY_VERSION = 2;
+static const QDataStream::Version BINARY_STREAM_VERSION = QDataStream::Qt_5_0;
+static const int FLUSH_INTERVAL_MSECS = 100;
+
+static std::atomic<uint64_t> nextTracerInstanceID { 1 };
+// payloads are matched by sequence alone: the ID of a thread that is gone can be given to a new one
+static std::atomic<uint64_t> nextPayloadSequence { 0 };
+
+namespace tracing {
+
+enum RecordKind : uint8_t {
+    NoArgs = 0,
+    DurationPayload, // value is the nv_payload argument
+    CounterValue, // argName is the only argument, value holds its double
+    Serialized // value is the sequence number of the serialized id, args and extra of the event
+};
+
+struct TraceRecord {
+    uint64_t timestamp;
+    uint64_t value;
+    uint32_t name;
+    uint32_t category;
+    uint32_t argName;
+    char type;
+    uint8_t kind;
+    uint16_t padding;
+};
+static_assert(sizeof(TraceRecord) == 32, "TraceRecord is written as is in the binary format");
+
+// Single producer, single consumer ring: only the owning thread pushes, only the Tracer's drain pops.
+class TraceThreadBuffer {
+public:
+    static const uint64_t CAPACITY = 8192; // 256 KB per tracing thread
+    static const uint64_t MASK = CAPACITY - 1;
+
+    explicit TraceThreadBuffer(qint64 threadID) : threadID(threadID), _records(new TraceRecord[CAPACITY]) {}
+
+    bool push(const TraceRecord& record) {
+        uint64_t head = _head.load(std::memory_order_relaxed);
+        if (head - _tail.load(std::memory_order_acquire) >= CAPACITY) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        _records[head & MASK] = record;
+        _head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool pushSerialized(TraceRecord& record, QByteArray payload) {
+        if (_head.load(std::memory_order_relaxed) - _tail.load(std::memory_order_acquire) >= CAPACITY) {
+            _dropped.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        record.value = nextPayloadSequence++;
+        {
+            std::lock_guard<std::mutex> guard(_serializedMutex);
+            _serialized.emplace_back(record.value, std::move(payload));
+        }
+        return push(record);
+    }
+
+    void take(std::vector<TraceRecord>& records, std::vector<std::pair<uint64_t, QByteArray>>& serialized) {
+        uint64_t tail = _tail.load(std::memory_order_relaxed);
+        uint64_t head = _head.load(std::memory_order_acquire);
+        records.clear();
+        records.reserve(head - tail);
+        for (uint64_t i = tail; i < head; i++) {
+            records.push_back(_records[i & MASK]);
+        }
+        _tail.store(head, std::memory_order_release);
+
+        // may hold the payload of a record published after head was read, the converter matches them up
+        std::lock_guard<std::mutex> guard(_serializedMutex);
+        serialized.assign(_serialized.begin(), _serialized.end());
+        _serialized.clear();
+    }
+
+    bool isEmpty() const { return _head.load(std::memory_order_acquire) == _tail.load(std::memory_order_relaxed); }
+    quint64 getDroppedCount() const { return _dropped.load(std::memory_order_relaxed); }
+
+    const qint64 threadID;
+
+    // interning caches, only touched by the owning thread, valid for the capture of stringsGeneration
+    uint32_t stringsGeneration { 0 };
+    QHash<QString, uint32_t> strings;
+    std::unordered_map<const QLoggingCategory*, uint32_t> categories;
+
+private:
+    std::unique_ptr<TraceRecord[]> _records;
+    std::atomic<uint64_t> _head { 0 };
+    std::atomic<uint64_t> _tail { 0 };
+    std::atomic<quint64> _dropped { 0 };
+
+    std::deque<std::pair<uint64_t, QByteArray>> _serialized;
+    std::mutex _serializedMutex;
+};
+
+}
+
+struct LocalTraceBuffer {
+    uint64_t tracerID { 0 };
+    std::shared_ptr<TraceThreadBuffer> buffer;
+};
+static thread_local LocalTraceBuffer localTraceBuffer;
+
+static TraceTimestamp timestampNow() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(p_high_resolution_clock::now().time_since_epoch()).count();
+}
+
+static bool isNumeric(const QVariant& value) {
+    switch ((QMetaType::Type)value.type()) {
+        case QMetaType::Int:
+        case QMetaType::UInt:
+        case QMetaType::LongLong:
+        case QMetaType::ULongLong:
+        case QMetaType::Float:
+        case QMetaType::Double:
+            return true;
+        default:
+            return false;
+    }
+}
+
+static void writeEvent(QDataStream& out, const TraceEvent& event) {
+    out << event.id << event.name << (qint8)event.type << event.timestamp << event.processID << event.threadID
+        << event.category << event.args << event.extra;
+}
+
+static void readEvent(QDataStream& in, TraceEvent& event) {
+    qint8 type;
+    in >> event.id >> event.name >> type >> event.timestamp >> event.processID >> event.threadID
+        >> event.category >> event.args >> event.extra;
+    event.type = (EventType)type;
+}
+
+Tracer::Tracer() :
+    _instanceID(nextTracerInstanceID++),
+    _processID(QCoreApplication::applicationPid())
+{
+}
+
+Tracer::~Tracer() {
+    stopFlushThread();
+}
+
 void Tracer::startTracing() {
-    std::lock_guard<std::mutex> guard(_eventsMutex);
+    std::lock_guard<std::mutex> guard(_stateMutex);
     if (_enabled) {
         qWarning() << "Tried to enable tracer, but already enabled";
         return;
     }
 
-    _events.clear();
+    // throw away what a previous session left behind
+    drain();
+    {
+        std::lock_guard<std::mutex> drainGuard(_drainMutex);
+        _chunks.clear();
+        _chunkBytes = 0;
+    }
+    {
+        // each capture interns its own strings, the threads drop their cached ids on their next event
+        std::lock_guard<std::mutex> stringsGuard(_stringsMutex);
+        _strings.clear();
+        _stringIDs.clear();
+        _stringsGeneration++;
+    }
     _enabled = true;
+    startFlushThread();
 }
 
 void Tracer::stopTracing() {
-    std::lock_guard<std::mutex> guard(_eventsMutex);
+    std::lock_guard<std::mutex> guard(_stateMutex);
     if (!_enabled) {
         qWarning() << "Cannot stop tracing, already disabled";
         return;
     }
     _enabled = false;
+    stopFlushThread();
+    drain();
+}
+
+quint64 Tracer::getDroppedEventCount() const {
+    quint64 dropped = _droppedFromFinishedThreads.load();
+    std::lock_guard<std::mutex> guard(_buffersMutex);
+    for (const auto& buffer : _buffers) {
+        dropped += buffer->getDroppedCount();
+    }
+    return dropped;
+}
+
+void Tracer::startFlushThread() {
+    std::lock_guard<std::mutex> guard(_flushMutex);
+    if (_flushThreadRunning) {
+        return;
+    }
+    _flushThreadRunning = true;
+    _flushThread = std::thread([this] {
+        std::unique_lock<std::mutex> lock(_flushMutex);
+        while (_flushThreadRunning) {
+            _flushCondition.wait_for(lock, std::chrono::milliseconds(FLUSH_INTERVAL_MSECS));
+            lock.unlock();
+            drain();
+            lock.lock();
+        }
+    });
+}
+
+void Tracer::stopFlushThread() {
+    {
+        std::lock_guard<std::mutex> guard(_flushMutex);
+        if (!_flushThreadRunning) {
+            return;
+        }
+        _flushThreadRunning = false;
+    }
+    _flushCondition.notify_one();
+    _flushThread.join();
+}
+
+TraceThreadBuffer& Tracer::getThreadBuffer() {
+    if (localTraceBuffer.tracerID != _instanceID || !localTraceBuffer.buffer) {
+        auto buffer = std::make_shared<TraceThreadBuffer>(int64_t(QThread::currentThreadId()));
+        {
+            std::lock_guard<std::mutex> guard(_buffersMutex);
+            _buffers.push_back(buffer);
+        }
+        localTraceBuffer.tracerID = _instanceID;
+        localTraceBuffer.buffer = buffer;
+    }
+    TraceThreadBuffer& buffer = *localTraceBuffer.buffer;
+    uint32_t stringsGeneration = _stringsGeneration.load(std::memory_order_acquire);
+    if (buffer.stringsGeneration != stringsGeneration) {
+        buffer.strings.clear();
+        buffer.categories.clear();
+        buffer.stringsGeneration = stringsGeneration;
+    }
+    return buffer;
+}
+
+uint32_t Tracer::intern(TraceThreadBuffer& buffer, const QString& string) {
+    auto cached = buffer.strings.constFind(string);
+    if (cached != buffer.strings.constEnd()) {
+        return cached.value();
+    }
+
+    uint32_t id;
+    {
+        std::lock_guard<std::mutex> guard(_stringsMutex);
+        auto it = _stringIDs.constFind(string);
+        if (it != _stringIDs.constEnd()) {
+            id = it.value();
+        } else {
+            id = (uint32_t)_strings.size();
+            _strings.push_back(string);
+            _stringIDs.insert(string, id);
+        }
+    }
+    buffer.strings.insert(string, id);
+    return id;
+}
+
+uint32_t Tracer::intern(TraceThreadBuffer& buffer, const QLoggingCategory& category) {
+    auto cached = buffer.categories.find(&category);
+    if (cached != buffer.categories.end()) {
+        return cached->second;
+    }
+    uint32_t id = intern(buffer, QString(category.categoryName()));
+    buffer.categories[&category] = id;
+    return id;
+}
+
+void Tracer::addMetadataEvent(const QLoggingCategory& category, const QString& name, const QString& id,
+                              const QVariantMap& args, const QVariantMap& extra) {
+    // We always want to store metadata events even if tracing is not enabled so that when
+    // tracing is enabled we will be able to associate that metadata with that trace.
+    // Metadata events should be used sparingly - as of 12/30/16 the Chrome Tracing
+    // spec only supports thread+process metadata, so we should only expect to see metadata
+    // events created when a new thread or process is created.
+    std::lock_guard<std::mutex> guard(_metadataMutex);
+    _metadataEvents.push_back({
+        id,
+        name,
+        Metadata,
+        (qint64)timestampNow(),
+        _processID,
+        int64_t(QThread::currentThreadId()),
+        category.categoryName(),
+        args,
+        extra
+    });
+}
+
+void Tracer::traceEvent(const QLoggingCategory& category, 
+    const QString& name, EventType type, const QString& id, 
+    const QVariantMap& args, const QVariantMap& extra) {
+    if (type == Metadata) {
+        addMetadataEvent(category, name, id, args, extra);
+        return;
+    }
+    if (!isEnabled()) {
+        return;
+    }
+
+    auto& buffer = getThreadBuffer();
+    TraceRecord record {};
+    record.timestamp = timestampNow();
+    record.name = intern(buffer, name);
+    record.category = intern(buffer, category);
+    record.type = type;
+
+    if (id.isEmpty() && extra.isEmpty()) {
+        if (args.isEmpty()) {
+            record.kind = NoArgs;
+            buffer.push(record);
+            return;
+        }
+        if (args.size() == 1) {
+            auto arg = args.constBegin();
+            if ((type == DurationBegin || type == DurationEnd) && arg.key() == "nv_payload") {
+                record.kind = DurationPayload;
+                record.value = arg.value().toULongLong();
+                buffer.push(record);
+                return;
+            }
+            if (type == Counter && isNumeric(arg.value())) {
+                record.kind = CounterValue;
+                record.argName = intern(buffer, arg.key());
+                double value = arg.value().toDouble();
+                memcpy(&record.value, &value, sizeof(value));
+                buffer.push(record);
+                return;
+            }
+        }
+    }
+
+    QByteArray payload;
+    {
+        QDataStream out(&payload, QIODevice::WriteOnly);
+        out.setVersion(BINARY_STREAM_VERSION);
+        out << id << args << extra;
+    }
+    record.kind = Serialized;
+    buffer.pushSerialized(record, payload);
+}
+
+void Tracer::traceDuration(const QLoggingCategory& category, const QString& name, EventType type, uint64_t payload) {
+    if (!isEnabled()) {
+        return;
+    }
+
+    auto& buffer = getThreadBuffer();
+    TraceRecord record {};
+    record.timestamp = timestampNow();
+    record.name = intern(buffer, name);
+    record.category = intern(buffer, category);
+    record.type = type;
+    record.kind = DurationPayload;
+    record.value = payload;
+    buffer.push(record);
+}
+
+void Tracer::drain() {
+    std::vector<std::shared_ptr<TraceThreadBuffer>> buffers;
+    {
+        std::lock_guard<std::mutex> guard(_buffersMutex);
+        buffers = _buffers;
+    }
+
+    std::lock_guard<std::mutex> guard(_drainMutex);
+    std::vector<TraceRecord> records;
+    std::vector<std::pair<uint64_t, QByteArray>> serialized;
+    for (auto& buffer : buffers) {
+        buffer->take(records, serialized);
+        if (records.empty() && serialized.empty()) {
+            continue;
+        }
+
+        QByteArray chunk;
+        {
+            QDataStream out(&chunk, QIODevice::WriteOnly);
+            out.setVersion(BINARY_STREAM_VERSION);
+            out << buffer->threadID << (quint32)records.size();
+            out.writeRawData(reinterpret_cast<const char*>(records.data()), (int)(records.size() * sizeof(TraceRecord)));
+            out << (quint32)serialized.size();
+            for (const auto& entry : serialized) {
+                out << (quint64)entry.first << entry.second;
+            }
+        }
+        _chunkBytes += chunk.size();
+        _chunks.push_back(chunk);
+    }
+
+    // keep the most recent part of the trace
+    while (_chunkBytes > MAX_RECORDED_BYTES && _chunks.size() > 1) {
+        _chunkBytes -= _chunks.front().size();
+        _chunks.pop_front();
+    }
+
+    // forget the threads that are gone once everything they traced is drained
+    std::lock_guard<std::mutex> buffersGuard(_buffersMutex);
+    buffers.clear();
+    _buffers.erase(std::remove_if(_buffers.begin(), _buffers.end(), [this](const std::shared_ptr<TraceThreadBuffer>& buffer) {
+        if (buffer.use_count() == 1 && buffer->isEmpty()) {
+            _droppedFromFinishedThreads += buffer->getDroppedCount();
+            return true;
+        }
+        return false;
+    }), _buffers.end());
+}
+
+// Binary format, a QDataStream (Qt 5.0 version, big endian) of:
+//   magic, version, process ID
+//   string table: count, then the strings in id order
+//   metadata events: count, then each event
+//   chunks: count, then each chunk as a byte array of:
+//     thread ID, record count, the TraceRecords in host byte order,
+//     serialized payload count, then (sequence number, unique in the trace, id + args + extra) for each
+// The chunks are taken, the next trace only has what was recorded after this one.
+QByteArray Tracer::toBinary() {
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(BINARY_STREAM_VERSION);
+    out.writeRawData(BINARY_MAGIC.constData(), BINARY_MAGIC.size());
+    out << BINARY_VERSION << _processID;
+
+    {
+        std::lock_guard<std::mutex> guard(_stringsMutex);
+        out << (quint32)_strings.size();
+        for (const auto& string : _strings) {
+            out << string;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> guard(_metadataMutex);
+        out << (quint32)_metadataEvents.size();
+        for (const auto& event : _metadataEvents) {
+            writeEvent(out, event);
+        }
+    }
+    std::deque<QByteArray> chunks;
+    {
+        std::lock_guard<std::mutex> guard(_drainMutex);
+        chunks.swap(_chunks);
+        _chunkBytes = 0;
+    }
+    out << (quint32)chunks.size();
+    for (const auto& chunk : chunks) {
+        out << chunk;
+    }
+    return data;
+}
+
+bool tracing::convertToJson(const QByteArray& binaryTrace, QByteArray& json) {
+    QDataStream in(binaryTrace);
+    in.setVersion(BINARY_STREAM_VERSION);
+
+    QByteArray magic(BINARY_MAGIC.size(), 0);
+    in.readRawData(magic.data(), magic.size());
+    quint32 version;
+    qint64 processID;
+    in >> version >> processID;
+    if (magic != BINARY_MAGIC || version != BINARY_VERSION || in.status() != QDataStream::Ok) {
+        qWarning() << "Not a binary trace, or a version this build can't read";
+        return false;
+    }
+
+    quint32 count;
+    in >> count;
+    std::vector<QString> strings(count);
+    for (auto& string : strings) {
+        in >> string;
+    }
+    auto lookup = [&](uint32_t id) {
+        return id < strings.size() ? strings[id] : QString();
+    };
+
+    QTextStream out(&json);
+    out << "[\n";
+    bool first = true;
+    auto write = [&](const TraceEvent& event) {
+        if (first) {
+            first = false;
+        } else {
+            out << ",\n";
+        }
+        event.writeJson(out);
+    };
+
+    in >> count;
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+        TraceEvent event;
+        readEvent(in, event);
+        write(event);
+    }
+
+    // payloads can land in an earlier chunk than their record, so gather them all first
+    in >> count;
+    std::vector<QByteArray> chunks(count);
+    for (auto& chunk : chunks) {
+        in >> chunk;
+    }
+    if (in.status() != QDataStream::Ok) {
+        qWarning() << "Binary trace is truncated";
+        return false;
+    }
+
+    std::unordered_map<quint64, QByteArray> payloads;
+    for (const auto& chunk : chunks) {
+        QDataStream chunkIn(chunk);
+        chunkIn.setVersion(BINARY_STREAM_VERSION);
+        qint64 threadID;
+        quint32 recordCount;
+        chunkIn >> threadID >> recordCount;
+        chunkIn.skipRawData(recordCount * sizeof(TraceRecord));
+        quint32 payloadCount;
+        chunkIn >> payloadCount;
+        for (quint32 i = 0; i < payloadCount && chunkIn.status() == QDataStream::Ok; i++) {
+            quint64 sequence;
+            QByteArray payload;
+            chunkIn >> sequence >> payload;
+            payloads[sequence] = payload;
+        }
+    }
+
+    for (const auto& chunk : chunks) {
+        QDataStream chunkIn(chunk);
+        chunkIn.setVersion(BINARY_STREAM_VERSION);
+        qint64 threadID;
+        quint32 recordCount;
+        chunkIn >> threadID >> recordCount;
+        std::vector<TraceRecord> records(recordCount);
+        chunkIn.readRawData(reinterpret_cast<char*>(records.data()), (int)(recordCount * sizeof(TraceRecord)));
+
+        for (const auto& record : records) {
+            TraceEvent event;
+            event.name = lookup(record.name);
+            event.category = lookup(record.category);
+            event.type = (EventType)record.type;
+            event.timestamp = (qint64)record.timestamp;
+            event.processID = processID;
+            event.threadID = threadID;
+            switch (record.kind) {
+                case DurationPayload:
+                    event.args["nv_payload"] = QVariant::fromValue((quint64)record.value);
+                    break;
+                case CounterValue: {
+                    double value;
+                    memcpy(&value, &record.value, sizeof(value));
+                    event.args[lookup(record.argName)] = value;
+                    break;
+                }
+                case Serialized: {
+                    auto payload = payloads.find(record.value);
+                    if (payload != payloads.end()) {
+                        QDataStream payloadIn(payload->second);
+                        payloadIn.setVersion(BINARY_STREAM_VERSION);
+                        payloadIn >> event.id >> event.args >> event.extra;
+                    }
+                    break;
+                }
+                default:
+                    break;
+            }
+            write(event);
+        }
+    }
+    out << "\n]";
+    out.flush();
+    return true;
 }
 
 void TraceEvent::writeJson(QTextStream& out) const {
@@ -64,7 +622,7 @@ void TraceEvent::writeJson(QTextStream& out) const {
     // FIXME QJsonObject serialization is very slow, so we should be using manual JSON serialization
     out << "{";
     out << "\"name\":\"" << name << "\",";
-    out << "\"cat\":\"" << category.categoryName() << "\",";
+    out << "\"cat\":\"" << category << "\",";
     out << "\"ph\":\"" << QString(type) << "\",";
     out << "\"ts\":\"" << timestamp << "\",";
     out << "\"pid\":\"" << processID << "\",";
@@ -82,7 +640,7 @@ void TraceEvent::writeJson(QTextStream& out) const {
 #else
     QJsonObject ev {
         { "name", QJsonValue(name) },
-        { "cat", category.categoryName() },
+        { "cat", category },
         { "ph", QString(type) },
         { "ts", timestamp },
         { "pid", processID },
@@ -128,13 +686,10 @@ void Tracer::serialize(const QString& originalPath) {
 
 
 
-    std::list<TraceEvent> currentEvents;
-    {
-        std::lock_guard<std::mutex> guard(_eventsMutex);
-        currentEvents.swap(_events);
-        for (auto& event : _metadataEvents) {
-            currentEvents.push_back(event);
-        }
+    drain();
+    quint64 dropped = getDroppedEventCount();
+    if (dropped > 0) {
+        qWarning() << "Trace is missing" << dropped << "events that didn't fit their thread's buffer";
     }
 
     // If the file exists and we can't remove it, fail early
@@ -142,21 +697,14 @@ void Tracer::serialize(const QString& originalPath) {
         return;
     }
 
-    // If we can't open a temp file for writing, fail early
-    QByteArray data;
-    {
-        QTextStream out(&data);
-        out << "[\n";
-        bool first = true;
-        for (const auto& event : currentEvents) {
-            if (first) {
-                first = false;
-            } else {
-                out << ",\n";
-            }
-            event.writeJson(out);
+    QByteArray data = toBinary();
+    QString format = path.endsWith(".gz") ? path.left(path.length() - 3) : path;
+    if (!format.endsWith(BINARY_EXTENSION)) {
+        QByteArray json;
+        if (!convertToJson(data, json)) {
+            return;
         }
-        out << "\n]";
+        data = json;
     }
 
     if (path.endsWith(".gz")) {
@@ -196,60 +744,3 @@ void Tracer::serialize(const QString& originalPath) {
     }
 #endif
 }
-
-void Tracer::traceEvent(const QLoggingCategory& category,
-    const QString& name, EventType type,
-    qint64 timestamp, qint64 processID, qint64 threadID,
-    const QString& id,
-    const QVariantMap& args, const QVariantMap& extra) {
-    std::lock_guard<std::mutex> guard(_eventsMutex);
-
-    // We always want to store metadata events even if tracing is not enabled so that when
-    // tracing is enabled we will be able to associate that metadata with that trace.
-    // Metadata events should be used sparingly - as of 12/30/16 the Chrome Tracing
-    // spec only supports thread+process metadata, so we should only expect to see metadata
-    // events created when a new thread or process is created.
-    if (!_enabled && type != Metadata) {
-        return;
-    }
-
-    if (type == Metadata) {
-        _metadataEvents.push_back({
-            id,
-            name,
-            type,
-            timestamp,
-            processID,
-            threadID,
-            category,
-            args,
-            extra
-        });
-    } else {
-        _events.push_back({
-            id,
-            name,
-            type,
-            timestamp,
-            processID,
-            threadID,
-            category,
-            args,
-            extra
-        });
-    }
-}
-
-void Tracer::traceEvent(const QLoggingCategory& category, 
-    const QString& name, EventType type, const QString& id, 
-    const QVariantMap& args, const QVariantMap& extra) {
-    if (!_enabled && type != Metadata) {
-        return;
-    }
-
-    auto timestamp = std::chrono::duration_cast<std::chrono::microseconds>(p_high_resolution_clock::now().time_since_epoch()).count();
-    auto processID = QCoreApplication::applicationPid();
-    auto threadID = int64_t(QThread::currentThreadId());
-
-    traceEvent(category, name, type, timestamp, processID, threadID, id, args, extra);
-}
@@ -10,8 +10,15 @@
 #ifndef hifi_Trace_h
 #define hifi_Trace_h
 
+#include <atomic>
+#include <condition_variable>
 #include <cstdint>
+#include <deque>
+#include <list>
+#include <memory>
 #include <mutex>
+#include <thread>
+#include <vector>
 
 #include <QtCore/QString>
 #include <QtCore/QVariantMap>
@@ -69,36 +76,87 @@ struct TraceEvent {
     qint64 timestamp;
     qint64 processID;
     qint64 threadID;
-    const QLoggingCategory& category;
+    QString category;
     QVariantMap args;
     QVariantMap extra;
 
     void writeJson(QTextStream& out) const;
 };
 
+// Converts a trace written by Tracer::serialize in the binary format to the chrome://tracing JSON array
+bool convertToJson(const QByteArray& binaryTrace, QByteArray& json);
+
+class TraceThreadBuffer;
+
+// Events are recorded as fixed size binary records into a lock-free ring owned by the thread that traces them,
+// names and categories are interned once per thread.  A background thread drains the rings into chunks kept in
+// memory, the oldest chunks are let go past MAX_RECORDED_BYTES so tracing can be left on.
+// Events with an id, extra fields or arguments other than a duration payload or a single counter value take a
+// slower path that serializes them, but still doesn't contend with other threads.
 class Tracer : public Dependency {
 public:
+    // serialize writes the binary format when the file has this extension, optionally followed by .gz
+    static const QString BINARY_EXTENSION;
+    static const size_t MAX_RECORDED_BYTES;
+
+    Tracer();
+    ~Tracer();
+
     void traceEvent(const QLoggingCategory& category, 
         const QString& name, EventType type,
         const QString& id = "", 
         const QVariantMap& args = QVariantMap(), const QVariantMap& extra = QVariantMap());
 
+    // Same as a DurationBegin or DurationEnd event with only an nv_payload argument, without building the map
+    void traceDuration(const QLoggingCategory& category, const QString& name, EventType type, uint64_t payload = 0);
+
     void startTracing();
     void stopTracing();
+    // writes what was recorded since the last call and lets it go
     void serialize(const QString& file);
-    bool isEnabled() const { return _enabled; }
+    bool isEnabled() const { return _enabled.load(std::memory_order_relaxed); }
+
+    // events lost because the ring of their thread was full
+    quint64 getDroppedEventCount() const;
 
 private:
-    void traceEvent(const QLoggingCategory& category, 
-        const QString& name, EventType type,
-        qint64 timestamp, qint64 processID, qint64 threadID,
-        const QString& id = "",
-        const QVariantMap& args = QVariantMap(), const QVariantMap& extra = QVariantMap());
+    TraceThreadBuffer& getThreadBuffer();
+    uint32_t intern(TraceThreadBuffer& buffer, const QString& string);
+    uint32_t intern(TraceThreadBuffer& buffer, const QLoggingCategory& category);
+    void addMetadataEvent(const QLoggingCategory& category, const QString& name, const QString& id,
+        const QVariantMap& args, const QVariantMap& extra);
+
+    void startFlushThread();
+    void stopFlushThread();
+    void drain();
+    QByteArray toBinary();
+
+    const uint64_t _instanceID;
+    const qint64 _processID;
+    std::atomic<bool> _enabled { false };
+    std::mutex _stateMutex;
+
+    std::vector<std::shared_ptr<TraceThreadBuffer>> _buffers;
+    mutable std::mutex _buffersMutex;
+    std::atomic<quint64> _droppedFromFinishedThreads { 0 };
+
+    QHash<QString, uint32_t> _stringIDs;
+    std::vector<QString> _strings;
+    std::atomic<uint32_t> _stringsGeneration { 0 };
+    std::mutex _stringsMutex;
 
-    bool _enabled { false };
-    std::list<TraceEvent> _events;
     std::list<TraceEvent> _metadataEvents;
-    std::mutex _eventsMutex;
+    std::mutex _metadataMutex;
+
+    // drained records, guarded by _drainMutex
+    std::deque<QByteArray> _chunks;
+    size_t _chunkBytes { 0 };
+    std::mutex _drainMutex;
+
+    std::thread _flushThread;
+    bool _flushThreadRunning { false };
+    std::mutex _flushMutex;
+    std::condition_variable _flushCondition;
 };
 
 inline void traceEvent(const QLoggingCategory& category, const QString& name, EventType type, const QString& id = "", const QVariantMap& args = {}, const QVariantMap& extra = {}) {
@@ -12,7 +12,287 @@
 #include "GLMHelpers.h"
 #include "TriangleSet.h"
 
+#include <algorithm>
+
+// A bounding volume hierarchy of the triangles, split with a binned surface area heuristic.  Nodes are flattened
+// depth first in 32 bytes: the first child of an interior node follows it, the node keeps the index of the second.
+// The triangles stay in the set, the hierarchy keeps their indices in leaf order so each leaf is a contiguous range.
+class TriangleSet::BVH {
+public:
+    explicit BVH(const std::vector<Triangle>& triangles);
+
+    // Closest hit nearer than distance, the same hit as testing every triangle of the set the hierarchy was built for
+    bool findRayIntersection(const std::vector<Triangle>& triangles, const glm::vec3& origin, const glm::vec3& direction,
+                             float& distance, glm::vec3& surfaceNormal) const;
+
+private:
+    static const uint32_t MAX_LEAF_TRIANGLES = 4;
+    static const int NUM_BINS = 16;
+    static const int MAX_DEPTH = 60;
+    // past MAX_DEPTH only nodes with too many triangles for a leaf are split, in halves
+    static const int STACK_SIZE = MAX_DEPTH + 16;
+    static const float TRAVERSAL_COST; // relative to a triangle test
+
+    class Node {
+    public:
+        glm::vec3 minimum;
+        uint32_t start; // first triangle of a leaf, second child of an interior node
+        glm::vec3 maximum;
+        uint16_t count; // triangles of a leaf, 0 for interior nodes
+        uint16_t axis; // split axis of an interior node, the nearest child is visited first
+    };
+
+    class Bounds {
+    public:
+        glm::vec3 minimum { std::numeric_limits<float>::max() };
+        glm::vec3 maximum { -std::numeric_limits<float>::max() };
+
+        void grow(const glm::vec3& point) { minimum = glm::min(minimum, point); maximum = glm::max(maximum, point); }
+        void grow(const Bounds& other) { minimum = glm::min(minimum, other.minimum); maximum = glm::max(maximum, other.maximum); }
+        float area() const {
+            glm::vec3 size = glm::max(maximum - minimum, glm::vec3(0.0f));
+            return size.x * size.y + size.y * size.z + size.z * size.x;
+        }
+    };
+
+    void build(uint32_t begin, uint32_t end, int depth);
+    // index of the first triangle of the right half, begin or end if no split is worth it
+    uint32_t split(uint32_t begin, uint32_t end, const Bounds& bounds, const Bounds& centroidBounds, uint16_t& axis);
+
+    static bool findRayBoxIntersection(const Node& node, const glm::vec3& origin, const glm::vec3& inverseDirection,
+                                       float maxDistance);
+
+    std::vector<Node> _nodes;
+    std::vector<uint32_t> _indices; // of the triangles, in leaf order
+
+    // only used while building
+    std::vector<Bounds> _triangleBounds;
+    std::vector<glm::vec3> _centroids;
+};
+
+const float TriangleSet::BVH::TRAVERSAL_COST = 1.0f;
+
+TriangleSet::BVH::BVH(const std::vector<Triangle>& triangles) {
+    static_assert(sizeof(Node) == 32, "BVH nodes are expected to be 32 bytes");
+    if (triangles.empty()) {
+        return;
+    }
+
+    uint32_t numTriangles = (uint32_t)triangles.size();
+    _indices.resize(numTriangles);
+    _triangleBounds.resize(numTriangles);
+    _centroids.resize(numTriangles);
+    for (uint32_t i = 0; i < numTriangles; i++) {
+        const Triangle& triangle = triangles[i];
+        _indices[i] = i;
+        _triangleBounds[i].grow(triangle.v0);
+        _triangleBounds[i].grow(triangle.v1);
+        _triangleBounds[i].grow(triangle.v2);
+        _centroids[i] = (triangle.v0 + triangle.v1 + triangle.v2) / 3.0f;
+    }
+
+    _nodes.reserve(2 * numTriangles / MAX_LEAF_TRIANGLES + 1);
+    build(0, numTriangles, 0);
+
+    _triangleBounds = std::vector<Bounds>();
+    _centroids = std::vector<glm::vec3>();
+}
+
+void TriangleSet::BVH::build(uint32_t begin, uint32_t end, int depth) {
+    Bounds bounds;
+    Bounds centroidBounds;
+    for (uint32_t i = begin; i < end; i++) {
+        bounds.grow(_triangleBounds[_indices[i]]);
+        centroidBounds.grow(_centroids[_indices[i]]);
+    }
+
+    uint32_t nodeIndex = (uint32_t)_nodes.size();
+    _nodes.emplace_back();
+    _nodes[nodeIndex].minimum = bounds.minimum;
+    _nodes[nodeIndex].maximum = bounds.maximum;
+    _nodes[nodeIndex].start = begin;
+    _nodes[nodeIndex].count = (uint16_t)(end - begin);
+    _nodes[nodeIndex].axis = 0;
+
+    const uint32_t MAX_COUNT = std::numeric_limits<uint16_t>::max();
+    if (end - begin <= MAX_LEAF_TRIANGLES || depth >= MAX_DEPTH) {
+        if (end - begin <= MAX_COUNT) {
+            return;
+        }
+    }
+
+    uint16_t axis = 0;
+    uint32_t middle = depth < MAX_DEPTH ? split(begin, end, bounds, centroidBounds, axis) : begin;
+    if (middle == begin || middle == end) {
+        // not worth splitting, or all the centroids are at the same place
+        if (end - begin <= MAX_COUNT) {
+            return;
+        }
+        middle = begin + (end - begin) / 2;
+    }
+
+    build(begin, middle, depth + 1);
+    uint32_t second = (uint32_t)_nodes.size();
+    build(middle, end, depth + 1);
+
+    _nodes[nodeIndex].start = second;
+    _nodes[nodeIndex].count = 0;
+    _nodes[nodeIndex].axis = axis;
+}
+
+uint32_t TriangleSet::BVH::split(uint32_t begin, uint32_t end, const Bounds& bounds, const Bounds& centroidBounds,
+                                 uint16_t& bestAxis) {
+    uint32_t count = end - begin;
+    float bestCost = (float)count * bounds.area(); // the cost of a leaf
+    int bestBin = -1;
+
+    for (int axis = 0; axis < 3; axis++) {
+        float extent = centroidBounds.maximum[axis] - centroidBounds.minimum[axis];
+        if (extent <= 0.0f) {
+            continue;
+        }
+        float scale = (float)NUM_BINS / extent;
+
+        Bounds binBounds[NUM_BINS];
+        uint32_t binCounts[NUM_BINS] = { 0 };
+        for (uint32_t i = begin; i < end; i++) {
+            uint32_t index = _indices[i];
+            int bin = std::min((int)((_centroids[index][axis] - centroidBounds.minimum[axis]) * scale), NUM_BINS - 1);
+            binBounds[bin].grow(_triangleBounds[index]);
+            binCounts[bin]++;
+        }
+
+        // cost of splitting after each bin, sweeping from the right then from the left
+        float rightCosts[NUM_BINS];
+        Bounds right;
+        uint32_t rightCount = 0;
+        for (int bin = NUM_BINS - 1; bin > 0; bin--) {
+            right.grow(binBounds[bin]);
+            rightCount += binCounts[bin];
+            rightCosts[bin - 1] = (float)rightCount * right.area();
+        }
+        Bounds left;
+        uint32_t leftCount = 0;
+        for (int bin = 0; bin < NUM_BINS - 1; bin++) {
+            left.grow(binBounds[bin]);
+            leftCount += binCounts[bin];
+            if (leftCount == 0 || leftCount == count) {
+                continue;
+            }
+            float cost = TRAVERSAL_COST * bounds.area() + (float)leftCount * left.area() + rightCosts[bin];
+            if (cost < bestCost) {
+                bestCost = cost;
+                bestBin = bin;
+                bestAxis = (uint16_t)axis;
+            }
+        }
+    }
+
+    if (bestBin < 0) {
+        // a large node still gets split, at the median of its longest axis, so leaves stay small
+        if (count <= MAX_LEAF_TRIANGLES * 4) {
+            return begin;
+        }
+        glm::vec3 extents = centroidBounds.maximum - centroidBounds.minimum;
+        bestAxis = (uint16_t)(extents.x > extents.y ? (extents.x > extents.z ? 0 : 2) : (extents.y > extents.z ? 1 : 2));
+        if (extents[bestAxis] <= 0.0f) {
+            return begin;
+        }
+        uint32_t middle = begin + count / 2;
+        int axis = bestAxis;
+        std::nth_element(_indices.begin() + begin, _indices.begin() + middle, _indices.begin() + end,
+            [&](uint32_t a, uint32_t b) { return _centroids[a][axis] < _centroids[b][axis]; });
+        return middle;
+    }
+
+    int axis = bestAxis;
+    float minimum = centroidBounds.minimum[axis];
+    float scale = (float)NUM_BINS / (centroidBounds.maximum[axis] - minimum);
+    auto middle = std::partition(_indices.begin() + begin, _indices.begin() + end, [&](uint32_t index) {
+        return std::min((int)((_centroids[index][axis] - minimum) * scale), NUM_BINS - 1) <= bestBin;
+    });
+    return (uint32_t)(middle - _indices.begin());
+}
+
+bool TriangleSet::BVH::findRayBoxIntersection(const Node& node, const glm::vec3& origin,
+                                              const glm::vec3& inverseDirection, float maxDistance) {
+#if GLM_ARCH & GLM_ARCH_SSE2_BIT
+    // the fourth lane of the bounds holds the node links, it is replaced by the [0, maxDistance] ray range
+    const __m128 XYZ_MASK = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+    __m128 rayOrigin = _mm_set_ps(0.0f, origin.z, origin.y, origin.x);
+    __m128 rayInverseDirection = _mm_set_ps(0.0f, inverseDirection.z, inverseDirection.y, inverseDirection.x);
+    __m128 t0 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.minimum.x), rayOrigin), rayInverseDirection);
+    __m128 t1 = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(&node.maximum.x), rayOrigin), rayInverseDirection);
+    __m128 tNear = _mm_and_ps(XYZ_MASK, _mm_min_ps(t0, t1));
+    __m128 tFar = _mm_or_ps(_mm_and_ps(XYZ_MASK, _mm_max_ps(t0, t1)), _mm_andnot_ps(XYZ_MASK, _mm_set1_ps(maxDistance)));
+    tNear = _mm_max_ps(tNear, _mm_shuffle_ps(tNear, tNear, _MM_SHUFFLE(2, 3, 0, 1)));
+    tNear = _mm_max_ps(tNear, _mm_shuffle_ps(tNear, tNear, _MM_SHUFFLE(1, 0, 3, 2)));
+    tFar = _mm_min_ps(tFar, _mm_shuffle_ps(tFar, tFar, _MM_SHUFFLE(2, 3, 0, 1)));
+    tFar = _mm_min_ps(tFar, _mm_shuffle_ps(tFar, tFar, _MM_SHUFFLE(1, 0, 3, 2)));
+    return _mm_comile_ss(tNear, tFar) != 0;
+#else
+    glm::vec3 t0 = (node.minimum - origin) * inverseDirection;
+    glm::vec3 t1 = (node.maximum - origin) * inverseDirection;
+    glm::vec3 tNear = glm::min(t0, t1);
+    glm::vec3 tFar = glm::max(t0, t1);
+    float entry = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+    return entry <= exit;
+#endif
+}
+
+bool TriangleSet::BVH::findRayIntersection(const std::vector<Triangle>& triangles, const glm::vec3& origin,
+                                           const glm::vec3& direction, float& distance, glm::vec3& surfaceNormal) const {
+    if (_nodes.empty()) {
+        return false;
+    }
+
+    glm::vec3 inverseDirection = 1.0f / direction;
+    float bestDistance = distance;
+    const Triangle* bestTriangle = nullptr;
+
+    uint32_t stack[STACK_SIZE];
+    int stackSize = 0;
+    uint32_t nodeIndex = 0;
+    while (true) {
+        const Node& node = _nodes[nodeIndex];
+        if (findRayBoxIntersection(node, origin, inverseDirection, bestDistance)) {
+            if (node.count == 0) {
+                uint32_t nearChild = nodeIndex + 1;
+                uint32_t farChild = node.start;
+                if (direction[node.axis] < 0.0f) {
+                    std::swap(nearChild, farChild);
+                }
+                stack[stackSize++] = farChild;
+                nodeIndex = nearChild;
+                continue;
+            }
+            for (uint32_t i = node.start, end = node.start + node.count; i < end; i++) {
+                const Triangle& triangle = triangles[_indices[i]];
+                float triangleDistance;
+                if (findRayTriangleIntersection(origin, direction, triangle, triangleDistance) &&
+                        triangleDistance < bestDistance) {
+                    bestDistance = triangleDistance;
+                    bestTriangle = &triangle;
+                }
+            }
+        }
+        if (stackSize == 0) {
+            break;
+        }
+        nodeIndex = stack[--stackSize];
+    }
+
+    if (!bestTriangle) {
+        return false;
+    }
+    distance = bestDistance;
+    surfaceNormal = bestTriangle->getNormal();
+    return true;
+}
+
 void TriangleSet::insert(const Triangle& t) {
+    _bvh.reset();
     _triangles.push_back(t);
 
     _bounds += t.v0;
@@ -21,6 +301,7 @@ void TriangleSet::insert(const Triangle& t) {
 }
 
 void TriangleSet::clear() {
+    _bvh.reset();
     _triangles.clear();
     _bounds.clear();
 }
@@ -36,16 +317,9 @@ bool TriangleSet::findRayIntersection(const glm::vec3& origin, const glm::vec3&
 
     if (_bounds.findRayIntersection(origin, direction, boxDistance, face, surfaceNormal)) {
         if (precision) {
-            for (const auto& triangle : _triangles) {
-                float thisTriangleDistance;
-                if (findRayTriangleIntersection(origin, direction, triangle, thisTriangleDistance)) {
-                    if (thisTriangleDistance < bestDistance) {
-                        bestDistance = thisTriangleDistance;
-                        intersectedSomething = true;
-                        surfaceNormal = triangle.getNormal();
-                        distance = bestDistance;
-                    }
-                }
+            if (getBVH()->findRayIntersection(_triangles, origin, direction, bestDistance, surfaceNormal)) {
+                intersectedSomething = true;
+                distance = bestDistance;
             }
         } else {
             intersectedSomething = true;
@@ -56,6 +330,24 @@ bool TriangleSet::findRayIntersection(const glm::vec3& origin, const glm::vec3&
     return intersectedSomething;
 }
 
+void TriangleSet::findRayIntersections(const std::vector<Ray>& rays, std::vector<RayHit>& hits) const {
+    hits.assign(rays.size(), RayHit());
+    auto bvh = getBVH();
+    for (size_t i = 0; i < rays.size(); i++) {
+        hits[i].hit = bvh->findRayIntersection(_triangles, rays[i].origin, rays[i].direction,
+                                               hits[i].distance, hits[i].surfaceNormal);
+    }
+}
+
+std::shared_ptr<const TriangleSet::BVH> TriangleSet::getBVH() const {
+    auto bvh = std::atomic_load(&_bvh);
+    if (!bvh) {
+        // concurrent first picks may each build one, they are identical
+        bvh = std::make_shared<BVH>(_triangles);
+        std::atomic_store(&_bvh, bvh);
+    }
+    return bvh;
+}
 
 bool TriangleSet::convexHullContains(const glm::vec3& point) const {
     if (!_bounds.contains(point)) {
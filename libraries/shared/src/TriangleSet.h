@@ -9,6 +9,8 @@
 //  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
 //
 
+#include <limits>
+#include <memory>
 #include <vector>
 
 #include "AABox.h"
@@ -16,6 +18,19 @@
 
 class TriangleSet {
 public:
+    class Ray {
+    public:
+        glm::vec3 origin;
+        glm::vec3 direction;
+    };
+
+    class RayHit {
+    public:
+        bool hit { false };
+        float distance { std::numeric_limits<float>::max() };
+        glm::vec3 surfaceNormal;
+    };
+
     void reserve(size_t size) { _triangles.reserve(size); } // reserve space in the datastructure for size number of triangles
     size_t size() const { return _triangles.size(); } 
 
@@ -26,9 +41,13 @@ public:
 
     // Determine if the given ray (origin/direction) in model space intersects with any triangles in the set. If an 
     // intersection occurs, the distance and surface normal will be provided.
+    // Precise intersections go through a bounding volume hierarchy of the triangles, built on the first one.
     bool findRayIntersection(const glm::vec3& origin, const glm::vec3& direction, 
         float& distance, BoxFace& face, glm::vec3& surfaceNormal, bool precision) const;
 
+    // Precise intersections of many rays with the set, one hit per ray
+    void findRayIntersections(const std::vector<Ray>& rays, std::vector<RayHit>& hits) const;
+
     // Determine if a point is "inside" all the triangles of a convex hull. It is the responsibility of the caller to
     // determine that the triangle set is indeed a convex hull. If the triangles added to this set are not in fact a 
     // convex hull, the result of this method is meaningless and undetermined.
@@ -36,6 +55,13 @@ public:
     const AABox& getBounds() const { return _bounds; }
 
 private:
+    class BVH;
+    std::shared_ptr<const BVH> getBVH() const;
+
     std::vector<Triangle> _triangles;
     AABox _bounds;
+
+    // Built lazily by const picks, possibly on several threads, so only accessed with the atomic shared_ptr functions
+    // there; copies of the set share it, inserting triangles drops it.
+    mutable std::shared_ptr<const BVH> _bvh;
 };
@@ -10,6 +10,7 @@
 #include "AnimTests.h"
 #include <AnimNodeLoader.h>
 #include <AnimClip.h>
+#include <AnimCompressedClip.h>
 #include <AnimBlendLinear.h>
 #include <AnimationLogging.h>
 #include <AnimVariant.h>
@@ -422,6 +423,123 @@ void AnimTests::testAnimPose() {
     }
 }
 
+void AnimTests::testCompressedClip() {
+    const float PI = (float)M_PI;
+    const int FRAME_COUNT = 120;
+    const int JOINT_COUNT = 3;
+
+    // joint 0 is constant, joint 1 moves linearly, joint 2 swings back and forth.
+    std::vector<AnimPoseVec> frames(FRAME_COUNT);
+    for (int frame = 0; frame < FRAME_COUNT; frame++) {
+        float t = (float)frame / (float)(FRAME_COUNT - 1);
+        frames[frame].push_back(AnimPose(glm::vec3(1.0f), glm::angleAxis(PI / 4.0f, glm::vec3(0.0f, 1.0f, 0.0f)), glm::vec3(0.0f, 1.0f, 0.0f)));
+        frames[frame].push_back(AnimPose(glm::vec3(1.0f), glm::quat(), glm::vec3(t, 0.0f, -2.0f * t)));
+        frames[frame].push_back(AnimPose(glm::vec3(1.0f), glm::angleAxis(PI * sinf(2.0f * PI * t), glm::vec3(1.0f, 0.0f, 0.0f)), glm::vec3()));
+    }
+
+    AnimCompressedClip clip(frames);
+    QCOMPARE(clip.getFrameCount(), FRAME_COUNT);
+    QCOMPARE(clip.getJointCount(), JOINT_COUNT);
+    QVERIFY(clip.getByteSize() < FRAME_COUNT * JOINT_COUNT * sizeof(AnimPose) / 4);
+
+    AnimPoseVec poses(JOINT_COUNT);
+    for (int frame = 0; frame < FRAME_COUNT; frame++) {
+        clip.sampleFrame(frame, &poses[0]);
+        for (int joint = 0; joint < JOINT_COUNT; joint++) {
+            const AnimPose& expected = frames[frame][joint];
+            QCOMPARE_WITH_ABS_ERROR(poses[joint].trans(), expected.trans(), EPSILON);
+            QCOMPARE_WITH_ABS_ERROR(poses[joint].scale(), expected.scale(), EPSILON);
+            QVERIFY(1.0f - fabsf(glm::dot(poses[joint].rot(), expected.rot())) < 0.0001f);
+        }
+    }
+}
+
+// joints swinging at different speeds and a translation that wobbles, so most tracks keep several keys
+static std::vector<AnimPoseVec> makeSwingingFrames(int frameCount, int jointCount) {
+    const float PI = (float)M_PI;
+    std::vector<AnimPoseVec> frames(frameCount);
+    for (int frame = 0; frame < frameCount; frame++) {
+        float t = (float)frame / (float)(frameCount - 1);
+        for (int joint = 0; joint < jointCount; joint++) {
+            float phase = (float)joint / (float)jointCount;
+            glm::quat rot = glm::angleAxis(0.5f * PI * sinf(2.0f * PI * (t + phase) * (1 + joint % 3)),
+                                           glm::normalize(glm::vec3(1.0f, phase, 0.5f)));
+            glm::vec3 trans(0.1f * sinf(4.0f * PI * t), 0.2f * phase, 0.0f);
+            frames[frame].push_back(AnimPose(glm::vec3(1.0f), rot, trans));
+        }
+    }
+    return frames;
+}
+
+void AnimTests::testCompressedClipFractionalFrames() {
+    const int FRAME_COUNT = 90;
+    const int JOINT_COUNT = 8;
+    AnimCompressedClip clip(makeSwingingFrames(FRAME_COUNT, JOINT_COUNT));
+
+    // sampling in between frames matches blending the two frames, playing forward and after jumps of the cursor
+    AnimCompressedClip::Cursor cursor;
+    AnimPoseVec poses(JOINT_COUNT);
+    AnimPoseVec prevPoses(JOINT_COUNT);
+    AnimPoseVec nextPoses(JOINT_COUNT);
+    std::vector<float> times;
+    for (float frame = 0.0f; frame < FRAME_COUNT - 1; frame += 0.37f) {
+        times.push_back(frame);
+    }
+    times.push_back(3.5f);
+    times.push_back(FRAME_COUNT - 1.5f);
+    times.push_back(0.25f);
+    for (float frame : times) {
+        clip.sampleFrame(frame, &poses[0], cursor);
+
+        int prevIndex = (int)glm::floor(frame);
+        clip.sampleFrame(prevIndex, &prevPoses[0]);
+        clip.sampleFrame(prevIndex + 1, &nextPoses[0]);
+        ::blend(JOINT_COUNT, &prevPoses[0], &nextPoses[0], glm::fract(frame), &prevPoses[0]);
+
+        for (int joint = 0; joint < JOINT_COUNT; joint++) {
+            QCOMPARE_WITH_ABS_ERROR(poses[joint].trans(), prevPoses[joint].trans(), EPSILON);
+            QCOMPARE_WITH_ABS_ERROR(poses[joint].scale(), prevPoses[joint].scale(), EPSILON);
+            QVERIFY(1.0f - fabsf(glm::dot(poses[joint].rot(), prevPoses[joint].rot())) < 0.0001f);
+        }
+    }
+
+    // out of range frames clamp to the ends
+    AnimPoseVec lastPoses(JOINT_COUNT);
+    clip.sampleFrame(FRAME_COUNT - 1, &lastPoses[0]);
+    clip.sampleFrame((float)FRAME_COUNT + 10.0f, &poses[0], cursor);
+    for (int joint = 0; joint < JOINT_COUNT; joint++) {
+        QCOMPARE_WITH_ABS_ERROR(poses[joint].trans(), lastPoses[joint].trans(), EPSILON);
+    }
+}
+
+static const int BENCHMARK_FRAME_COUNT = 300;
+static const int BENCHMARK_JOINT_COUNT = 60;
+static const float BENCHMARK_FRAME_STEP = 0.45f; // a 30 fps clip played at a 66 Hz update rate
+
+// how AnimClip played before the clips were compressed: blending two full precision frames
+void AnimTests::benchmarkUncompressedClip() {
+    auto frames = makeSwingingFrames(BENCHMARK_FRAME_COUNT, BENCHMARK_JOINT_COUNT);
+    AnimPoseVec poses(BENCHMARK_JOINT_COUNT);
+    float frame = 0.0f;
+    QBENCHMARK {
+        int prevIndex = (int)glm::floor(frame);
+        int nextIndex = std::min(prevIndex + 1, BENCHMARK_FRAME_COUNT - 1);
+        ::blend(BENCHMARK_JOINT_COUNT, &frames[prevIndex][0], &frames[nextIndex][0], glm::fract(frame), &poses[0]);
+        frame = fmodf(frame + BENCHMARK_FRAME_STEP, (float)(BENCHMARK_FRAME_COUNT - 1));
+    }
+}
+
+void AnimTests::benchmarkCompressedClip() {
+    AnimCompressedClip clip(makeSwingingFrames(BENCHMARK_FRAME_COUNT, BENCHMARK_JOINT_COUNT));
+    AnimCompressedClip::Cursor cursor;
+    AnimPoseVec poses(BENCHMARK_JOINT_COUNT);
+    float frame = 0.0f;
+    QBENCHMARK {
+        clip.sampleFrame(frame, &poses[0], cursor);
+        frame = fmodf(frame + BENCHMARK_FRAME_STEP, (float)(BENCHMARK_FRAME_COUNT - 1));
+    }
+}
+
 void AnimTests::testExpressionTokenizer() {
     QString str = "(10 +  x) >= 20.1 && (y != !z)";
     AnimExpression e("x");
@@ -27,6 +27,10 @@ private slots:
     void testVariant();
     void testAccumulateTime();
     void testAnimPose();
+    void testCompressedClip();
+    void testCompressedClipFractionalFrames();
+    void benchmarkUncompressedClip();
+    void benchmarkCompressedClip();
     void testExpressionTokenizer();
     void testExpressionParser();
     void testExpressionEvaluator();
@@ -0,0 +1,262 @@
+//
+//  AvatarDataTests.cpp
+//  tests/avatars/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "AvatarDataTests.h"
+
+#include <AvatarData.h>
+#include <AvatarHashMap.h>
+#include <AvatarPacketDecoder.h>
+#include <DependencyManager.h>
+#include <GLMHelpers.h>
+#include <HeadData.h>
+#include <NLPacket.h>
+#include <NodeList.h>
+#include <UUID.h>
+
+#include <../QTestExtensions.h>
+#include <../GLMTestUtils.h>
+
+QTEST_MAIN(AvatarDataTests)
+
+// the compressed quaternions and fixed point translations are good to about this much
+const float ROTATION_EPSILON = 0.001f;
+const float TRANSLATION_EPSILON = 0.001f;
+const int NUM_JOINTS = 10;
+
+// An avatar that encodes like the ones of agents, and gives access to the head and faux joint data
+class TestAvatar : public AvatarData {
+public:
+    QByteArray encode(AvatarDataDetail dataDetail) {
+        _globalPosition = getPosition();
+        return toByteArrayStateful(dataDetail);
+    }
+
+    void setBlendshapes(const QVector<float>& coefficients) {
+        setForceFaceTrackerConnected(true);
+        lazyInitHeadData();
+        _headData->setBlendshapeCoefficients(coefficients);
+    }
+
+    void setControllerMatrices(const glm::mat4& leftHand, const glm::mat4& rightHand) {
+        _controllerLeftHandMatrixCache.set(leftHand);
+        _controllerRightHandMatrixCache.set(rightHand);
+    }
+};
+
+// A hash map without a decoder thread, the test applies what it decodes itself
+class TestAvatarHashMap : public AvatarHashMap {
+public:
+    void apply(const AvatarPacketDecoder::DecodedPackets& decodedPackets) { applyDecodedPackets(decodedPackets); }
+};
+
+static glm::quat jointRotation(int index, float angle) {
+    return glm::angleAxis(angle * (index + 1), glm::normalize(glm::vec3(0.0f, 1.0f, 1.0f)));
+}
+
+static glm::vec3 jointTranslation(int index) {
+    return glm::vec3(0.01f * index, 0.1f, -0.02f * index);
+}
+
+static void setupSender(TestAvatar& sender) {
+    sender.setSessionUUID(QUuid::createUuid());
+    sender.setPosition(glm::vec3(1.0f, 2.0f, 3.0f));
+    sender.setOrientation(glm::angleAxis(0.5f, glm::normalize(glm::vec3(1.0f, 2.0f, 3.0f))));
+    for (int i = 0; i < NUM_JOINTS; i++) {
+        sender.setJointData(i, jointRotation(i, 0.1f), jointTranslation(i));
+    }
+    sender.setControllerMatrices(
+        createMatFromQuatAndPos(glm::angleAxis(0.3f, Vectors::UNIT_X), glm::vec3(-0.2f, 1.0f, 0.3f)),
+        createMatFromQuatAndPos(glm::angleAxis(-0.3f, Vectors::UNIT_Y), glm::vec3(0.2f, 1.1f, 0.3f)));
+    sender.setBlendshapes({ 0.1f, 0.5f, 0.9f, 0.0f, 1.0f });
+}
+
+static AvatarDataUpdate decodeAndApply(const QByteArray& bytes, AvatarData& receiver) {
+    AvatarDataUpdate update;
+    update.sessionUUID = receiver.getSessionUUID();
+    AvatarData::decodeDataFromBuffer(bytes, update);
+    receiver.applyDataUpdate(update);
+    return update;
+}
+
+static QSharedPointer<ReceivedMessage> makeMessage(PacketType type, const QByteArray& payload) {
+    auto packet = NLPacket::create(type);
+    packet->write(payload);
+    packet->seek(0);
+    return QSharedPointer<ReceivedMessage>::create(*packet);
+}
+
+void AvatarDataTests::initTestCase() {
+    DependencyManager::set<NodeList>(NodeType::Unassigned);
+}
+
+void AvatarDataTests::cleanupTestCase() {
+    DependencyManager::destroy<NodeList>();
+}
+
+void AvatarDataTests::testRoundTrip() {
+    TestAvatar sender;
+    setupSender(sender);
+    QByteArray bytes = sender.encode(AvatarData::SendAllData);
+
+    AvatarData receiver;
+    receiver.setSessionUUID(sender.getSessionUUID());
+    AvatarDataUpdate update = decodeAndApply(bytes, receiver);
+    QVERIFY(update.isComplete);
+    QCOMPARE(update.numBytesRead, bytes.size());
+
+    QCOMPARE(receiver.getPosition(), sender.getPosition());
+    QCOMPARE_QUATS(receiver.getOrientation(), sender.getOrientation(), ROTATION_EPSILON);
+
+    QCOMPARE(receiver.getJointRotations().size(), NUM_JOINTS);
+    for (int i = 0; i < NUM_JOINTS; i++) {
+        QCOMPARE_QUATS(receiver.getJointRotation(i), sender.getJointRotation(i), ROTATION_EPSILON);
+        QCOMPARE_WITH_ABS_ERROR(receiver.getJointTranslation(i), sender.getJointTranslation(i), TRANSLATION_EPSILON);
+    }
+
+    QCOMPARE_QUATS(glmExtractRotation(receiver.getControllerLeftHandMatrix()),
+                   glmExtractRotation(sender.getControllerLeftHandMatrix()), ROTATION_EPSILON);
+    QCOMPARE_WITH_ABS_ERROR(extractTranslation(receiver.getControllerLeftHandMatrix()),
+                            extractTranslation(sender.getControllerLeftHandMatrix()), TRANSLATION_EPSILON);
+    QCOMPARE_QUATS(glmExtractRotation(receiver.getControllerRightHandMatrix()),
+                   glmExtractRotation(sender.getControllerRightHandMatrix()), ROTATION_EPSILON);
+    QCOMPARE_WITH_ABS_ERROR(extractTranslation(receiver.getControllerRightHandMatrix()),
+                            extractTranslation(sender.getControllerRightHandMatrix()), TRANSLATION_EPSILON);
+
+    QVERIFY(receiver.getHeadData());
+    QCOMPARE(receiver.getHeadData()->getBlendshapeCoefficients(), sender.getHeadData()->getBlendshapeCoefficients());
+
+    // parseDataFromBuffer is the same two steps
+    AvatarData parsed;
+    QCOMPARE(parsed.parseDataFromBuffer(bytes), bytes.size());
+    QCOMPARE(parsed.getPosition(), sender.getPosition());
+}
+
+void AvatarDataTests::testUnsentJointsKeepValues() {
+    TestAvatar sender;
+    setupSender(sender);
+
+    AvatarData receiver;
+    receiver.setSessionUUID(sender.getSessionUUID());
+    decodeAndApply(sender.encode(AvatarData::SendAllData), receiver);
+    sender.doneEncoding(false);
+
+    // only the first joint moves enough to be sent again
+    const int MOVED_JOINT = 0;
+    const glm::quat movedRotation = jointRotation(MOVED_JOINT, 1.0f);
+    const glm::vec3 movedTranslation(0.5f, -0.5f, 0.25f);
+    sender.setJointData(MOVED_JOINT, movedRotation, movedTranslation);
+
+    AvatarDataUpdate update = decodeAndApply(sender.encode(AvatarData::CullSmallData), receiver);
+    QVERIFY(update.isComplete);
+    QVERIFY(update.hasFlags & AvatarDataPacket::PACKET_HAS_JOINT_DATA);
+    QCOMPARE(update.jointData.size(), NUM_JOINTS);
+    QVERIFY(update.jointData[MOVED_JOINT].rotationSet);
+    QVERIFY(update.jointData[MOVED_JOINT].translationSet);
+
+    QCOMPARE_QUATS(receiver.getJointRotation(MOVED_JOINT), movedRotation, ROTATION_EPSILON);
+    QCOMPARE_WITH_ABS_ERROR(receiver.getJointTranslation(MOVED_JOINT), movedTranslation, TRANSLATION_EPSILON);
+    for (int i = MOVED_JOINT + 1; i < NUM_JOINTS; i++) {
+        QVERIFY(!update.jointData[i].rotationSet);
+        QVERIFY(!update.jointData[i].translationSet);
+        QCOMPARE_QUATS(receiver.getJointRotation(i), jointRotation(i, 0.1f), ROTATION_EPSILON);
+        QCOMPARE_WITH_ABS_ERROR(receiver.getJointTranslation(i), jointTranslation(i), TRANSLATION_EPSILON);
+    }
+}
+
+void AvatarDataTests::testTruncatedPacket() {
+    TestAvatar sender;
+    setupSender(sender);
+    QByteArray bytes = sender.encode(AvatarData::SendAllData);
+
+    // cut inside the faux joints, the sections before the joint data are still applied
+    QByteArray truncated = bytes.left(bytes.size() - 4);
+    AvatarData receiver;
+    receiver.setSessionUUID(sender.getSessionUUID());
+    AvatarDataUpdate update = decodeAndApply(truncated, receiver);
+    QVERIFY(!update.isComplete);
+    QCOMPARE(update.numBytesRead, truncated.size());
+    QVERIFY(update.hasFlags & AvatarDataPacket::PACKET_HAS_AVATAR_GLOBAL_POSITION);
+    QVERIFY(update.hasFlags & AvatarDataPacket::PACKET_HAS_FACE_TRACKER_INFO);
+    QVERIFY(!(update.hasFlags & AvatarDataPacket::PACKET_HAS_JOINT_DATA));
+    QCOMPARE(receiver.getPosition(), sender.getPosition());
+    QCOMPARE_QUATS(receiver.getOrientation(), sender.getOrientation(), ROTATION_EPSILON);
+    QCOMPARE(receiver.getJointRotations().size(), 0);
+
+    // not even the flags
+    AvatarData empty;
+    update = decodeAndApply(bytes.left(1), empty);
+    QVERIFY(!update.isComplete);
+    QCOMPARE(update.hasFlags, (AvatarDataPacket::HasFlags)0);
+    QCOMPARE(empty.getPosition(), glm::vec3());
+
+    // the decoder skips the rest of a truncated message instead of reading past it
+    AvatarPacketDecoder decoder;
+    decoder.processAvatarDataPacket(makeMessage(PacketType::BulkAvatarData,
+                                                sender.getSessionUUID().toRfc4122() + truncated), SharedNodePointer());
+    AvatarPacketDecoder::DecodedPackets decodedPackets;
+    decoder.takeDecodedPackets(decodedPackets);
+    QCOMPARE((int)decodedPackets.size(), 1);
+    QCOMPARE(decodedPackets[0].update.sessionUUID, sender.getSessionUUID());
+    QVERIFY(!decodedPackets[0].update.isComplete);
+}
+
+void AvatarDataTests::testKillBeforeIdentity() {
+    TestAvatar sender;
+    setupSender(sender);
+    sender.setSkeletonModelURL(QUrl("http://example.com/avatar.fbx"));
+    sender.setDisplayName("returning avatar");
+    const QUuid sessionUUID = sender.getSessionUUID();
+
+    AvatarPacketDecoder decoder;
+    QSignalSpy decodedSpy(&decoder, &AvatarPacketDecoder::packetsDecoded);
+
+    // data, then the kill of the avatar, then the identity of its next session under the same ID
+    QByteArray killPayload = sessionUUID.toRfc4122();
+    killPayload.append((char)KillAvatarReason::AvatarDisconnected);
+    decoder.processAvatarDataPacket(makeMessage(PacketType::BulkAvatarData,
+                                                sessionUUID.toRfc4122() + sender.encode(AvatarData::SendAllData)),
+                                    SharedNodePointer());
+    decoder.processKillAvatar(makeMessage(PacketType::KillAvatar, killPayload), SharedNodePointer());
+    decoder.processAvatarIdentityPacket(makeMessage(PacketType::AvatarIdentity, sender.identityByteArray()),
+                                        SharedNodePointer());
+
+    // one signal for the whole batch, the later packets are picked up by the same take
+    QCOMPARE(decodedSpy.count(), 1);
+
+    AvatarPacketDecoder::DecodedPackets decodedPackets;
+    decoder.takeDecodedPackets(decodedPackets);
+    QCOMPARE((int)decodedPackets.size(), 3);
+    QVERIFY(!decodedPackets[0].isKill && !decodedPackets[0].isIdentity);
+    QCOMPARE(decodedPackets[0].update.sessionUUID, sessionUUID);
+    QVERIFY(decodedPackets[1].isKill);
+    QCOMPARE(decodedPackets[1].update.sessionUUID, sessionUUID);
+    QCOMPARE(decodedPackets[1].killReason, KillAvatarReason::AvatarDisconnected);
+    QVERIFY(decodedPackets[2].isIdentity);
+    QCOMPARE(decodedPackets[2].identity.uuid, sessionUUID);
+
+    TestAvatarHashMap hashMap;
+    QSignalSpy addedSpy(&hashMap, &AvatarHashMap::avatarAddedEvent);
+    QSignalSpy removedSpy(&hashMap, &AvatarHashMap::avatarRemovedEvent);
+    hashMap.apply(decodedPackets);
+
+    QCOMPARE(addedSpy.count(), 2);
+    QCOMPARE(removedSpy.count(), 1);
+
+    // the identity brought the avatar back, the data from before the kill went with the old one
+    AvatarSharedPointer avatar = hashMap.getAvatarBySessionID(sessionUUID);
+    QVERIFY(avatar);
+    QCOMPARE(avatar->getDisplayName(), QString("returning avatar"));
+    QCOMPARE(avatar->getPosition(), glm::vec3());
+
+    // and a take with nothing new decoded is empty, the caller hands back cleared storage like the hash map does
+    decodedPackets.clear();
+    decoder.takeDecodedPackets(decodedPackets);
+    QVERIFY(decodedPackets.empty());
+}
@@ -0,0 +1,163 @@
+//
+//  VoxelChunkGridTests.cpp
+//  tests/entities-renderer/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "VoxelChunkGridTests.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <memory>
+
+#include <VoxelChunkGrid.h>
+
+QTEST_MAIN(VoxelChunkGridTests)
+
+using SurfaceStyle = PolyVoxEntityItem::PolyVoxSurfaceStyle;
+using Vertices = std::vector<PolyVox::PositionMaterialNormal>;
+using Triangle = std::array<long, 18>;
+
+// not a multiple of the chunk size, so the last chunks are partial
+static const glm::ivec3 VOLUME_SIZE { 37, 20, 18 };
+
+static bool isEdgedSurfaceStyle(SurfaceStyle surfaceStyle) {
+    return surfaceStyle == PolyVoxEntityItem::SURFACE_EDGED_CUBIC ||
+        surfaceStyle == PolyVoxEntityItem::SURFACE_EDGED_MARCHING_CUBES;
+}
+
+// allocated like RenderablePolyVoxEntityItem::setVoxelVolumeSize does, filled with a sphere and some noise
+static std::unique_ptr<PolyVox::SimpleVolume<uint8_t>> createVolume(SurfaceStyle surfaceStyle) {
+    glm::ivec3 upper = isEdgedSurfaceStyle(surfaceStyle) ? VOLUME_SIZE + glm::ivec3(1) : VOLUME_SIZE;
+    std::unique_ptr<PolyVox::SimpleVolume<uint8_t>> volume(new PolyVox::SimpleVolume<uint8_t>(
+        PolyVox::Region(PolyVox::Vector3DInt32(0, 0, 0), PolyVox::Vector3DInt32(upper.x, upper.y, upper.z))));
+    volume->setBorderValue(255);
+
+    uint32_t seed = 12345;
+    glm::vec3 center = glm::vec3(VOLUME_SIZE) * 0.5f;
+    for (int z = 0; z <= upper.z; z++) {
+        for (int y = 0; y <= upper.y; y++) {
+            for (int x = 0; x <= upper.x; x++) {
+                seed = seed * 1664525 + 1013904223;
+                bool inSphere = glm::distance(glm::vec3(x, y, z), center) < 8.0f;
+                bool noise = (seed >> 24) < 32;
+                volume->setVoxelAt(x, y, z, (inSphere != noise) ? 255 : 0);
+            }
+        }
+    }
+    return volume;
+}
+
+// position and normal of each corner, rounded, starting from the smallest corner to keep the winding
+static void appendTriangles(const Vertices& vertices, const std::vector<uint32_t>& indices,
+                            std::vector<Triangle>& triangles) {
+    const float SCALE = 1000.0f;
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        std::array<std::array<long, 6>, 3> corners;
+        for (int c = 0; c < 3; c++) {
+            const auto& vertex = vertices[indices[i + c]];
+            auto position = vertex.getPosition();
+            auto normal = vertex.getNormal();
+            corners[c] = { { std::lround(position.getX() * SCALE), std::lround(position.getY() * SCALE),
+                             std::lround(position.getZ() * SCALE), std::lround(normal.getX() * SCALE),
+                             std::lround(normal.getY() * SCALE), std::lround(normal.getZ() * SCALE) } };
+        }
+        std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end()), corners.end());
+        Triangle triangle;
+        for (int c = 0; c < 3; c++) {
+            std::copy(corners[c].begin(), corners[c].end(), triangle.begin() + c * 6);
+        }
+        triangles.push_back(triangle);
+    }
+}
+
+static std::vector<Triangle> extractWholeVolume(PolyVox::SimpleVolume<uint8_t>* volume, SurfaceStyle surfaceStyle) {
+    // the enclosing region starts at 0, its mesh is already in volume coordinates
+    PolyVox::SurfaceMesh<PolyVox::PositionMaterialNormal> mesh;
+    extractVoxelSurface(volume, volume->getEnclosingRegion(), surfaceStyle, mesh);
+    std::vector<Triangle> triangles;
+    appendTriangles(mesh.getRawVertexData(), mesh.getIndices(), triangles);
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+// extracts the dirty chunks as the mesh job does, returns how many there were
+static int extractDirtyChunks(PolyVox::SimpleVolume<uint8_t>* volume, SurfaceStyle surfaceStyle, VoxelChunkGrid& grid) {
+    auto dirtyChunks = grid.takeDirtyChunks();
+    for (int index : dirtyChunks) {
+        PolyVox::SurfaceMesh<PolyVox::PositionMaterialNormal> mesh;
+        extractVoxelSurface(volume, grid.getChunkRegion(index), surfaceStyle, mesh);
+        grid.setChunkMesh(index, mesh);
+    }
+    return (int)dirtyChunks.size();
+}
+
+static std::vector<Triangle> getChunkTriangles(VoxelChunkGrid& grid) {
+    std::vector<Triangle> triangles;
+    for (int i = 0; i < grid.getNumChunks(); i++) {
+        appendTriangles(grid.getChunk(i).vertices, grid.getChunk(i).indices, triangles);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+static void addSurfaceStyleRows() {
+    QTest::addColumn<int>("surfaceStyle");
+    QTest::newRow("marching cubes") << (int)PolyVoxEntityItem::SURFACE_MARCHING_CUBES;
+    QTest::newRow("cubic") << (int)PolyVoxEntityItem::SURFACE_CUBIC;
+    QTest::newRow("edged cubic") << (int)PolyVoxEntityItem::SURFACE_EDGED_CUBIC;
+    QTest::newRow("edged marching cubes") << (int)PolyVoxEntityItem::SURFACE_EDGED_MARCHING_CUBES;
+}
+
+void VoxelChunkGridTests::chunksMatchWholeVolume_data() {
+    addSurfaceStyleRows();
+}
+
+void VoxelChunkGridTests::chunksMatchWholeVolume() {
+    QFETCH(int, surfaceStyle);
+    SurfaceStyle style = (SurfaceStyle)surfaceStyle;
+    auto volume = createVolume(style);
+
+    VoxelChunkGrid grid(volume->getEnclosingRegion(), style);
+    QVERIFY(grid.getNumChunks() > 1);
+    QCOMPARE(extractDirtyChunks(volume.get(), style, grid), grid.getNumChunks());
+
+    auto expected = extractWholeVolume(volume.get(), style);
+    QVERIFY(!expected.empty());
+    // neither missing nor duplicated triangles along the seams
+    QVERIFY(getChunkTriangles(grid) == expected);
+}
+
+void VoxelChunkGridTests::editedChunksMatchWholeVolume_data() {
+    addSurfaceStyleRows();
+}
+
+void VoxelChunkGridTests::editedChunksMatchWholeVolume() {
+    QFETCH(int, surfaceStyle);
+    SurfaceStyle style = (SurfaceStyle)surfaceStyle;
+    auto volume = createVolume(style);
+
+    VoxelChunkGrid grid(volume->getEnclosingRegion(), style);
+    extractDirtyChunks(volume.get(), style, grid);
+
+    // on both sides of the seams between the first chunks, and inside of one.  x stays below the last chunks.
+    const int SEAM = VoxelChunkGrid::CHUNK_SIZE;
+    const std::vector<glm::ivec3> edits {
+        { SEAM - 2, 5, 5 }, { SEAM - 1, 6, 5 }, { SEAM, 7, 5 }, { SEAM + 1, 8, 5 },
+        { 4, SEAM, 9 }, { 4, 9, SEAM - 1 }, { SEAM, SEAM, SEAM }, { 8, 8, 8 }
+    };
+    for (const auto& voxel : edits) {
+        uint8_t value = volume->getVoxelAt(voxel.x, voxel.y, voxel.z);
+        volume->setVoxelAt(voxel.x, voxel.y, voxel.z, value ? 0 : 255);
+        grid.markDirty(voxel.x, voxel.y, voxel.z);
+    }
+
+    // only the chunks the edits reach are extracted again
+    QVERIFY(extractDirtyChunks(volume.get(), style, grid) < grid.getNumChunks());
+    QVERIFY(getChunkTriangles(grid) == extractWholeVolume(volume.get(), style));
+}
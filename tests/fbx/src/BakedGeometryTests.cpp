@@ -0,0 +1,277 @@
+//
+//  BakedGeometryTests.cpp
+//  tests/fbx/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "BakedGeometryTests.h"
+
+#include <memory>
+
+#include <BakedGeometry.h>
+#include <GLMHelpers.h>
+
+QTEST_MAIN(BakedGeometryTests)
+
+static FBXTexture makeTexture(const QString& name) {
+    FBXTexture texture;
+    texture.name = name;
+    texture.filename = name.toUtf8() + ".png";
+    texture.content = QByteArray("embedded ") + name.toUtf8();
+    texture.transform.setTranslation(glm::vec3(0.5f, 0.25f, 0.0f));
+    texture.transform.setScale(glm::vec3(2.0f));
+    texture.maxNumPixels = 1024 * 1024;
+    texture.texcoordSet = 1;
+    texture.texcoordSetName = "uv1";
+    texture.isBumpmap = true;
+    return texture;
+}
+
+// a skinned quad with a blendshape, two joints, an animation and a textured material
+static FBXGeometry makeGeometry() {
+    FBXGeometry geometry;
+    geometry.originalURL = "http://localhost/model.fbx";
+    geometry.author = "author";
+    geometry.applicationName = "application";
+
+    for (int i = 0; i < 2; i++) {
+        FBXJoint joint;
+        joint.name = QString("joint%1").arg(i);
+        joint.parentIndex = i - 1;
+        joint.isSkeletonJoint = true;
+        joint.translation = glm::vec3(0.0f, (float)i, 0.0f);
+        joint.rotation = glm::angleAxis(0.5f * i, glm::vec3(0.0f, 0.0f, 1.0f));
+        joint.transform = glm::translate(glm::mat4(), joint.translation);
+        joint.freeLineage << i;
+        joint.shapeInfo.points << glm::vec3(0.1f * i);
+        geometry.joints << joint;
+        geometry.jointIndices.insert(joint.name, i + 1);
+    }
+    geometry.hasSkeletonJoints = true;
+
+    FBXMesh mesh;
+    FBXMeshPart part;
+    part.quadIndices << 0 << 1 << 2 << 3;
+    part.quadTrianglesIndices << 0 << 1 << 2 << 0 << 2 << 3;
+    part.materialID = "material";
+    mesh.parts << part;
+    mesh.vertices << glm::vec3(0.0f) << glm::vec3(1.0f, 0.0f, 0.0f) << glm::vec3(1.0f, 1.0f, 0.0f) << glm::vec3(0.0f, 1.0f, 0.0f);
+    mesh.normals.fill(glm::vec3(0.0f, 0.0f, 1.0f), mesh.vertices.size());
+    mesh.tangents.fill(glm::vec3(1.0f, 0.0f, 0.0f), mesh.vertices.size());
+    mesh.texCoords << glm::vec2(0.0f) << glm::vec2(1.0f, 0.0f) << glm::vec2(1.0f) << glm::vec2(0.0f, 1.0f);
+    for (int i = 0; i < mesh.vertices.size(); i++) {
+        mesh.clusterIndices << (uint16_t)(i % 2) << 0 << 0 << 0;
+        mesh.clusterWeights << 255 << 0 << 0 << 0;
+    }
+    for (int i = 0; i < 2; i++) {
+        FBXCluster cluster;
+        cluster.jointIndex = i;
+        cluster.inverseBindMatrix = glm::translate(glm::mat4(), glm::vec3(0.0f, -(float)i, 0.0f));
+        mesh.clusters << cluster;
+    }
+    mesh.meshExtents.addPoint(glm::vec3(0.0f));
+    mesh.meshExtents.addPoint(glm::vec3(1.0f, 1.0f, 0.0f));
+    mesh.modelTransform = glm::scale(glm::mat4(), glm::vec3(2.0f));
+    FBXBlendshape blendshape;
+    blendshape.indices << 2;
+    blendshape.vertices << glm::vec3(0.0f, 0.0f, 0.5f);
+    blendshape.normals << glm::vec3(0.0f, 0.0f, 1.0f);
+    mesh.blendshapes << blendshape;
+    mesh.meshIndex = 0;
+    geometry.meshes << mesh;
+
+    FBXMaterial& material = geometry.materials["material"];
+    material.materialID = "material";
+    material.name = "material name";
+    material.diffuseColor = glm::vec3(0.8f, 0.2f, 0.1f);
+    material.shininess = 40.0f;
+    material.albedoTexture = makeTexture("albedo");
+    material.normalTexture = makeTexture("normal");
+    material.lightmapTexture = makeTexture("lightmap");
+    material.lightmapParams = glm::vec2(0.5f, 2.0f);
+    material.useAlbedoMap = true;
+    material._material = std::make_shared<model::Material>();
+    material._material->setAlbedo(material.diffuseColor);
+    material._material->setRoughness(model::Material::shininessToRoughness(material.shininess));
+    material._material->setMetallic(0.3f);
+    material._material->setOpacity(0.5f);
+
+    geometry.offset = glm::translate(glm::mat4(), glm::vec3(0.0f, 0.0f, -1.0f));
+    geometry.headJointIndex = 1;
+    geometry.rootJointIndex = 0;
+    geometry.humanIKJointIndices << 0 << 1 << -1;
+    geometry.palmDirection = glm::vec3(0.0f, -1.0f, 0.0f);
+    geometry.bindExtents = mesh.meshExtents;
+    geometry.meshExtents = mesh.meshExtents;
+
+    for (int i = 0; i < 3; i++) {
+        FBXAnimationFrame frame;
+        frame.rotations << glm::quat() << glm::angleAxis(0.1f * i, glm::vec3(1.0f, 0.0f, 0.0f));
+        frame.translations << glm::vec3(0.0f) << glm::vec3(0.0f, 1.0f, 0.01f * i);
+        geometry.animationFrames << frame;
+    }
+    geometry.meshIndicesToModelNames.insert(0, "quad");
+    geometry.blendshapeChannelNames << "EyeBlink_L";
+    return geometry;
+}
+
+static std::unique_ptr<FBXGeometry> roundTrip(const FBXGeometry& geometry) {
+    QByteArray baked = writeBakedGeometry(geometry);
+    return std::unique_ptr<FBXGeometry>(readBakedGeometry(baked.constData(), baked.size()));
+}
+
+static void compareTextures(const FBXTexture& read, const FBXTexture& written) {
+    QCOMPARE(read.name, written.name);
+    QCOMPARE(read.filename, written.filename);
+    QCOMPARE(read.content, written.content);
+    QVERIFY(read.transform.getTranslation() == written.transform.getTranslation());
+    QVERIFY(read.transform.getRotation() == written.transform.getRotation());
+    QVERIFY(read.transform.getScale() == written.transform.getScale());
+    QCOMPARE(read.maxNumPixels, written.maxNumPixels);
+    QCOMPARE(read.texcoordSet, written.texcoordSet);
+    QCOMPARE(read.texcoordSetName, written.texcoordSetName);
+    QCOMPARE(read.isBumpmap, written.isBumpmap);
+}
+
+static void compareModelMaterials(const model::Material& read, const model::Material& written) {
+    QVERIFY(read.getKey()._flags == written.getKey()._flags);
+    QVERIFY(read.getEmissive(false) == written.getEmissive(false));
+    QVERIFY(read.getAlbedo(false) == written.getAlbedo(false));
+    QVERIFY(read.getFresnel(false) == written.getFresnel(false));
+    QCOMPARE(read.getRoughness(), written.getRoughness());
+    QCOMPARE(read.getMetallic(), written.getMetallic());
+    QCOMPARE(read.getScattering(), written.getScattering());
+    QCOMPARE(read.getOpacity(), written.getOpacity());
+}
+
+void BakedGeometryTests::testRoundTrip() {
+    FBXGeometry written = makeGeometry();
+    auto read = roundTrip(written);
+    QVERIFY(read);
+
+    QCOMPARE(read->originalURL, written.originalURL);
+    QCOMPARE(read->author, written.author);
+    QCOMPARE(read->applicationName, written.applicationName);
+
+    QCOMPARE(read->joints.size(), written.joints.size());
+    for (int i = 0; i < written.joints.size(); i++) {
+        const FBXJoint& readJoint = read->joints[i];
+        const FBXJoint& writtenJoint = written.joints[i];
+        QCOMPARE(readJoint.name, writtenJoint.name);
+        QCOMPARE(readJoint.parentIndex, writtenJoint.parentIndex);
+        QCOMPARE(readJoint.isSkeletonJoint, writtenJoint.isSkeletonJoint);
+        QVERIFY(readJoint.translation == writtenJoint.translation);
+        QVERIFY(readJoint.rotation == writtenJoint.rotation);
+        QVERIFY(readJoint.transform == writtenJoint.transform);
+        QCOMPARE(readJoint.freeLineage, writtenJoint.freeLineage);
+        QVERIFY(readJoint.shapeInfo.points == writtenJoint.shapeInfo.points);
+    }
+    QCOMPARE(read->jointIndices, written.jointIndices);
+    QCOMPARE(read->hasSkeletonJoints, written.hasSkeletonJoints);
+
+    QCOMPARE(read->meshes.size(), written.meshes.size());
+    const FBXMesh& readMesh = read->meshes[0];
+    const FBXMesh& writtenMesh = written.meshes[0];
+    QCOMPARE(readMesh.parts.size(), writtenMesh.parts.size());
+    QCOMPARE(readMesh.parts[0].quadIndices, writtenMesh.parts[0].quadIndices);
+    QCOMPARE(readMesh.parts[0].quadTrianglesIndices, writtenMesh.parts[0].quadTrianglesIndices);
+    QCOMPARE(readMesh.parts[0].triangleIndices, writtenMesh.parts[0].triangleIndices);
+    QCOMPARE(readMesh.parts[0].materialID, writtenMesh.parts[0].materialID);
+    QVERIFY(readMesh.vertices == writtenMesh.vertices);
+    QVERIFY(readMesh.normals == writtenMesh.normals);
+    QVERIFY(readMesh.tangents == writtenMesh.tangents);
+    QVERIFY(readMesh.texCoords == writtenMesh.texCoords);
+    QCOMPARE(readMesh.clusterIndices, writtenMesh.clusterIndices);
+    QCOMPARE(readMesh.clusterWeights, writtenMesh.clusterWeights);
+    QCOMPARE(readMesh.clusters.size(), writtenMesh.clusters.size());
+    for (int i = 0; i < writtenMesh.clusters.size(); i++) {
+        QCOMPARE(readMesh.clusters[i].jointIndex, writtenMesh.clusters[i].jointIndex);
+        QVERIFY(readMesh.clusters[i].inverseBindMatrix == writtenMesh.clusters[i].inverseBindMatrix);
+    }
+    QVERIFY(readMesh.meshExtents.minimum == writtenMesh.meshExtents.minimum);
+    QVERIFY(readMesh.meshExtents.maximum == writtenMesh.meshExtents.maximum);
+    QVERIFY(readMesh.modelTransform == writtenMesh.modelTransform);
+    QCOMPARE(readMesh.blendshapes.size(), writtenMesh.blendshapes.size());
+    QCOMPARE(readMesh.blendshapes[0].indices, writtenMesh.blendshapes[0].indices);
+    QVERIFY(readMesh.blendshapes[0].vertices == writtenMesh.blendshapes[0].vertices);
+    QVERIFY(readMesh.blendshapes[0].normals == writtenMesh.blendshapes[0].normals);
+    QCOMPARE(readMesh.meshIndex, writtenMesh.meshIndex);
+    // rebuilt rather than stored
+    QVERIFY(readMesh._mesh);
+
+    QCOMPARE(read->materials.keys(), written.materials.keys());
+
+    QVERIFY(read->offset == written.offset);
+    QCOMPARE(read->headJointIndex, written.headJointIndex);
+    QCOMPARE(read->rootJointIndex, written.rootJointIndex);
+    QCOMPARE(read->humanIKJointIndices, written.humanIKJointIndices);
+    QVERIFY(read->palmDirection == written.palmDirection);
+    QVERIFY(read->bindExtents.minimum == written.bindExtents.minimum);
+    QVERIFY(read->bindExtents.maximum == written.bindExtents.maximum);
+
+    QCOMPARE(read->animationFrames.size(), written.animationFrames.size());
+    for (int i = 0; i < written.animationFrames.size(); i++) {
+        QVERIFY(read->animationFrames[i].rotations == written.animationFrames[i].rotations);
+        QVERIFY(read->animationFrames[i].translations == written.animationFrames[i].translations);
+    }
+    QCOMPARE(read->meshIndicesToModelNames, written.meshIndicesToModelNames);
+    QCOMPARE(read->blendshapeChannelNames, written.blendshapeChannelNames);
+}
+
+void BakedGeometryTests::testMaterialRoundTrip() {
+    FBXGeometry written = makeGeometry();
+    // a mapping's scattering of 0 set after the metallic value also clears the metallic flag of the key
+    FBXMaterial& scattered = written.materials["scattered"];
+    scattered.materialID = "scattered";
+    scattered._material = std::make_shared<model::Material>();
+    scattered._material->setEmissive(glm::vec3(0.1f));
+    scattered._material->setAlbedo(glm::vec3(0.5f));
+    scattered._material->setRoughness(0.5f);
+    scattered._material->setMetallic(0.5f);
+    scattered._material->setScattering(0.0f);
+    scattered._material->setOpacity(1.0f);
+    scattered._material->setUnlit(true);
+    // and one without a model material
+    written.materials["bare"].materialID = "bare";
+
+    auto read = roundTrip(written);
+    QVERIFY(read);
+    QCOMPARE(read->materials.size(), written.materials.size());
+    for (auto it = written.materials.cbegin(); it != written.materials.cend(); ++it) {
+        const FBXMaterial& writtenMaterial = it.value();
+        const FBXMaterial& readMaterial = read->materials[it.key()];
+        QCOMPARE(readMaterial.materialID, writtenMaterial.materialID);
+        QCOMPARE(readMaterial.name, writtenMaterial.name);
+        QVERIFY(readMaterial.diffuseColor == writtenMaterial.diffuseColor);
+        QCOMPARE(readMaterial.shininess, writtenMaterial.shininess);
+        QCOMPARE(readMaterial.useAlbedoMap, writtenMaterial.useAlbedoMap);
+        QVERIFY(readMaterial.lightmapParams == writtenMaterial.lightmapParams);
+        compareTextures(readMaterial.albedoTexture, writtenMaterial.albedoTexture);
+        compareTextures(readMaterial.normalTexture, writtenMaterial.normalTexture);
+        compareTextures(readMaterial.lightmapTexture, writtenMaterial.lightmapTexture);
+        compareTextures(readMaterial.emissiveTexture, writtenMaterial.emissiveTexture);
+
+        QCOMPARE((bool)readMaterial._material, (bool)writtenMaterial._material);
+        if (writtenMaterial._material) {
+            compareModelMaterials(*readMaterial._material, *writtenMaterial._material);
+            QCOMPARE(readMaterial._material->isUnlit(), writtenMaterial._material->isUnlit());
+        }
+    }
+}
+
+void BakedGeometryTests::testDamagedDataThrows() {
+    QByteArray baked = writeBakedGeometry(makeGeometry());
+
+    QByteArray truncated = baked.left(baked.size() / 2);
+    QVERIFY_EXCEPTION_THROWN(readBakedGeometry(truncated.constData(), truncated.size()), QString);
+
+    // the version follows the magic number
+    QByteArray otherVersion = baked;
+    quint32 version = BAKED_GEOMETRY_VERSION + 1;
+    memcpy(otherVersion.data() + sizeof(quint32), &version, sizeof(version));
+    QVERIFY_EXCEPTION_THROWN(readBakedGeometry(otherVersion.constData(), otherVersion.size()), QString);
+}
@@ -0,0 +1,25 @@
+//
+//  BakedGeometryTests.h
+//  tests/fbx/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BakedGeometryTests_h
+#define hifi_BakedGeometryTests_h
+
+#include <QtTest/QtTest>
+
+class BakedGeometryTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testRoundTrip();
+    void testMaterialRoundTrip();
+    void testDamagedDataThrows();
+};
+
+#endif // hifi_BakedGeometryTests_h
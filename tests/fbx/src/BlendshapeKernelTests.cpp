@@ -0,0 +1,169 @@
+//
+//  BlendshapeKernelTests.cpp
+//  tests/fbx/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "BlendshapeKernelTests.h"
+
+#include <limits>
+
+#include <BlendshapeKernel.h>
+#include <FBXReader.h>
+
+#include <../GLMTestUtils.h>
+#include <../QTestExtensions.h>
+
+QTEST_MAIN(BlendshapeKernelTests)
+
+const int NUM_BLENDSHAPES = 6;
+const int NUM_VERTICES = 64;
+
+static float randomFloat(float min, float max) {
+    return min + (max - min) * ((float)qrand() / (float)RAND_MAX);
+}
+
+static glm::vec3 randomVec3(float min, float max) {
+    return glm::vec3(randomFloat(min, max), randomFloat(min, max), randomFloat(min, max));
+}
+
+// two meshes with blendshapes around one without, with each blendshape moving a random subset of vertices
+static QVector<FBXMesh> makeMeshes() {
+    qsrand(1);
+    QVector<FBXMesh> meshes(3);
+    for (int m = 0; m < meshes.size(); m++) {
+        FBXMesh& mesh = meshes[m];
+        for (int i = 0; i < NUM_VERTICES; i++) {
+            mesh.vertices << randomVec3(-1.0f, 1.0f);
+            mesh.normals << glm::normalize(randomVec3(0.1f, 1.0f));
+        }
+        if (m == 1) {
+            continue;
+        }
+        // the last mesh has fewer blendshapes than there are coefficients
+        int numBlendshapes = (m == 0) ? NUM_BLENDSHAPES : NUM_BLENDSHAPES / 2;
+        for (int b = 0; b < numBlendshapes; b++) {
+            FBXBlendshape blendshape;
+            for (int i = b % 3; i < NUM_VERTICES; i += 1 + qrand() % 3) {
+                blendshape.indices << i;
+                blendshape.vertices << randomVec3(-1.0f, 1.0f);
+                blendshape.normals << randomVec3(-1.0f, 1.0f);
+            }
+            mesh.blendshapes << blendshape;
+        }
+    }
+    return meshes;
+}
+
+static QVector<float> makeCoefficients() {
+    QVector<float> coefficients;
+    for (int i = 0; i < NUM_BLENDSHAPES; i++) {
+        coefficients << randomFloat(0.0f, 1.0f);
+    }
+    coefficients[1] = 0.0f;
+    coefficients[3] = 0.00005f;
+    return coefficients;
+}
+
+// blends the way Blender::run did before it used a BlendshapeKernel
+static void scalarBlend(const QVector<FBXMesh>& meshes, const QVector<float>& blendshapeCoefficients,
+                        QVector<glm::vec3>& vertices, QVector<glm::vec3>& normals) {
+    int offset = 0;
+    foreach (const FBXMesh& mesh, meshes) {
+        if (mesh.blendshapes.isEmpty()) {
+            continue;
+        }
+        vertices += mesh.vertices;
+        normals += mesh.normals;
+        glm::vec3* meshVertices = vertices.data() + offset;
+        glm::vec3* meshNormals = normals.data() + offset;
+        offset += mesh.vertices.size();
+        const float NORMAL_COEFFICIENT_SCALE = 0.01f;
+        for (int i = 0, n = qMin(blendshapeCoefficients.size(), mesh.blendshapes.size()); i < n; i++) {
+            float vertexCoefficient = blendshapeCoefficients.at(i);
+            const float EPSILON = 0.0001f;
+            if (vertexCoefficient < EPSILON) {
+                continue;
+            }
+            float normalCoefficient = vertexCoefficient * NORMAL_COEFFICIENT_SCALE;
+            const FBXBlendshape& blendshape = mesh.blendshapes.at(i);
+            for (int j = 0; j < blendshape.indices.size(); j++) {
+                int index = blendshape.indices.at(j);
+                meshVertices[index] += blendshape.vertices.at(j) * vertexCoefficient;
+                meshNormals[index] += blendshape.normals.at(j) * normalCoefficient;
+            }
+        }
+    }
+}
+
+void BlendshapeKernelTests::testQuantize() {
+    QVector<float> coefficients { -0.5f, 0.0f, 0.00005f, 0.25f, 1.0f, 1000.0f };
+    BlendshapeKernel::Coefficients quantized = BlendshapeKernel::quantize(coefficients);
+    QCOMPARE(quantized.size(), coefficients.size());
+    QCOMPARE(quantized[0], (quint16)0);
+    QCOMPARE(quantized[1], (quint16)0);
+    QCOMPARE(quantized[2], (quint16)0);
+    QCOMPARE(quantized[3], (quint16)(BlendshapeKernel::COEFFICIENT_STEPS / 4));
+    QCOMPARE(quantized[4], (quint16)BlendshapeKernel::COEFFICIENT_STEPS);
+    QCOMPARE(quantized[5], std::numeric_limits<quint16>::max());
+}
+
+void BlendshapeKernelTests::testMatchesScalarBlend() {
+    QVector<FBXMesh> meshes = makeMeshes();
+    QVector<float> coefficients = makeCoefficients();
+
+    QVector<glm::vec3> expectedVertices, expectedNormals;
+    scalarBlend(meshes, coefficients, expectedVertices, expectedNormals);
+
+    BlendshapeKernel kernel(meshes);
+    QVector<glm::vec3> vertices, normals;
+    kernel.blend(BlendshapeKernel::quantize(coefficients), vertices, normals);
+    QCOMPARE(vertices.size(), 2 * NUM_VERTICES);
+    QCOMPARE(vertices.size(), expectedVertices.size());
+    QCOMPARE(normals.size(), expectedNormals.size());
+
+    // each coefficient is off by at most half a step, on deltas of at most sqrt(3) per blendshape
+    const float QUANTIZATION_ERROR = 0.5f / (float)BlendshapeKernel::COEFFICIENT_STEPS;
+    const float EPSILON = NUM_BLENDSHAPES * glm::sqrt(3.0f) * QUANTIZATION_ERROR + 0.0001f;
+    for (int i = 0; i < vertices.size(); i++) {
+        QCOMPARE_WITH_ABS_ERROR(vertices[i], expectedVertices[i], EPSILON);
+        QCOMPARE_WITH_ABS_ERROR(normals[i], expectedNormals[i], EPSILON);
+    }
+
+    // coefficients on a quantization step blend like the scalar path up to float rounding
+    for (float& coefficient : coefficients) {
+        coefficient = glm::round(coefficient * 8.0f) / 8.0f;
+    }
+    expectedVertices.clear();
+    expectedNormals.clear();
+    scalarBlend(meshes, coefficients, expectedVertices, expectedNormals);
+    kernel.blend(BlendshapeKernel::quantize(coefficients), vertices, normals);
+    const float ROUNDING_EPSILON = 0.0001f;
+    for (int i = 0; i < vertices.size(); i++) {
+        QCOMPARE_WITH_ABS_ERROR(vertices[i], expectedVertices[i], ROUNDING_EPSILON);
+        QCOMPARE_WITH_ABS_ERROR(normals[i], expectedNormals[i], ROUNDING_EPSILON);
+    }
+}
+
+void BlendshapeKernelTests::testAccumulatePathsMatch() {
+    BlendshapeKernel kernel(makeMeshes());
+    BlendshapeKernel::Coefficients coefficients = BlendshapeKernel::quantize(makeCoefficients());
+
+    // accumulate uses SSE2 when glm was built with it, accumulateScalar is the fallback used without
+    QVector<glm::vec3> vertices, normals;
+    kernel.blend(coefficients, vertices, normals, &BlendshapeKernel::accumulate);
+    QVector<glm::vec3> scalarVertices, scalarNormals;
+    kernel.blend(coefficients, scalarVertices, scalarNormals, &BlendshapeKernel::accumulateScalar);
+
+    QCOMPARE(vertices.size(), scalarVertices.size());
+    QCOMPARE(normals.size(), scalarNormals.size());
+    const float EPSILON = 0.00001f;
+    for (int i = 0; i < vertices.size(); i++) {
+        QCOMPARE_WITH_ABS_ERROR(vertices[i], scalarVertices[i], EPSILON);
+        QCOMPARE_WITH_ABS_ERROR(normals[i], scalarNormals[i], EPSILON);
+    }
+}
@@ -0,0 +1,25 @@
+//
+//  BlendshapeKernelTests.h
+//  tests/fbx/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_BlendshapeKernelTests_h
+#define hifi_BlendshapeKernelTests_h
+
+#include <QtTest/QtTest>
+
+class BlendshapeKernelTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testQuantize();
+    void testMatchesScalarBlend();
+    void testAccumulatePathsMatch();
+};
+
+#endif // hifi_BlendshapeKernelTests_h
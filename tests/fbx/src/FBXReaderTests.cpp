@@ -0,0 +1,224 @@
+//
+//  FBXReaderTests.cpp
+//  tests/fbx/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "FBXReaderTests.h"
+
+#include <algorithm>
+
+#include <QtCore/QBuffer>
+#include <QtCore/QDirIterator>
+
+#include <FBXReader.h>
+
+#include "QDataStreamFBXParser.h"
+
+QTEST_MAIN(FBXReaderTests)
+
+static QString getRootPath() {
+    QFileInfo file(__FILE__);
+    return QDir::cleanPath(file.absolutePath() + "/../../..");
+}
+
+static bool isBinaryFBX(const QString& path) {
+    QFile file(path);
+    const QByteArray BINARY_PROLOG = "Kaydara FBX Binary  ";
+    return file.open(QIODevice::ReadOnly) && file.peek(BINARY_PROLOG.size()) == BINARY_PROLOG;
+}
+
+#ifdef Q_OS_LINUX
+// a field of /proc/self/status, in bytes
+static qint64 readStatusBytes(const QByteArray& field) {
+    QFile status("/proc/self/status");
+    if (!status.open(QIODevice::ReadOnly)) {
+        return -1;
+    }
+    for (const auto& line : status.readAll().split('\n')) {
+        if (line.startsWith(field + ":")) {
+            return line.mid(field.size() + 1).simplified().split(' ').first().toLongLong() * 1024; // in kB
+        }
+    }
+    return -1;
+}
+
+static bool resetPeakResidentSize() {
+    QFile clearRefs("/proc/self/clear_refs");
+    return clearRefs.open(QIODevice::WriteOnly) && clearRefs.write("5") == 1;
+}
+#endif
+
+template <typename T> static void compareArrays(const QVariant& left, const QVariant& right) {
+    QCOMPARE(left.value<QVector<T>>(), right.value<QVector<T>>());
+}
+
+static void compareNodes(const FBXNode& left, const FBXNode& right) {
+    QCOMPARE(left.name, right.name);
+    QCOMPARE(left.properties.size(), right.properties.size());
+    for (int i = 0; i < left.properties.size(); ++i) {
+        const auto& leftProperty = left.properties.at(i);
+        const auto& rightProperty = right.properties.at(i);
+        const int type = leftProperty.userType();
+        QCOMPARE(type, rightProperty.userType());
+        if (type == qMetaTypeId<QVector<float>>()) {
+            compareArrays<float>(leftProperty, rightProperty);
+        } else if (type == qMetaTypeId<QVector<double>>()) {
+            compareArrays<double>(leftProperty, rightProperty);
+        } else if (type == qMetaTypeId<QVector<qint64>>()) {
+            compareArrays<qint64>(leftProperty, rightProperty);
+        } else if (type == qMetaTypeId<QVector<qint32>>()) {
+            compareArrays<qint32>(leftProperty, rightProperty);
+        } else if (type == qMetaTypeId<QVector<bool>>()) {
+            compareArrays<bool>(leftProperty, rightProperty);
+        } else {
+            // scalars and strings
+            QCOMPARE(leftProperty, rightProperty);
+        }
+        if (QTest::currentTestFailed()) {
+            qWarning() << "Property" << i << "of" << left.name << "differs";
+            return;
+        }
+    }
+    QCOMPARE(left.children.size(), right.children.size());
+    for (int i = 0; i < left.children.size() && !QTest::currentTestFailed(); ++i) {
+        compareNodes(left.children.at(i), right.children.at(i));
+    }
+}
+
+void FBXReaderTests::initTestCase() {
+    QDirIterator it(getRootPath() + "/unpublishedScripts", { "*.fbx" }, QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        auto path = it.next();
+        if (isBinaryFBX(path)) {
+            _models << path;
+        }
+    }
+    if (_models.isEmpty()) {
+        QSKIP("No binary FBX model found in the source tree");
+    }
+}
+
+void FBXReaderTests::testDevicesParseTheSameTree() {
+    for (const auto& path : _models) {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        // memory mapped
+        FBXNode fromFile = FBXReader::parseFBX(&file);
+        QVERIFY(file.atEnd());
+
+        QVERIFY(file.seek(0));
+        QByteArray contents = file.readAll();
+        QBuffer buffer(&contents);
+        buffer.open(QIODevice::ReadOnly);
+        // in place in the buffer
+        FBXNode fromBuffer = FBXReader::parseFBX(&buffer);
+        QVERIFY(buffer.atEnd());
+
+        QVERIFY(!fromFile.children.isEmpty());
+        compareNodes(fromFile, fromBuffer);
+    }
+}
+
+void FBXReaderTests::testMatchesQDataStreamParser() {
+    for (const auto& path : _models) {
+        QFile file(path);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+        FBXNode parsed = FBXReader::parseFBX(&file);
+
+        QVERIFY(file.seek(0));
+        FBXNode reference = QDataStreamFBXParser::parseBinaryFBX(&file);
+
+        QVERIFY(!reference.children.isEmpty());
+        compareNodes(parsed, reference);
+        if (QTest::currentTestFailed()) {
+            qWarning() << "Parsing" << path << "differs from the QDataStream parser";
+            return;
+        }
+    }
+}
+
+void FBXReaderTests::testTruncatedDocumentThrows() {
+    QFile file(_models.first());
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QByteArray contents = file.readAll();
+    contents.truncate(contents.size() / 2);
+
+    bool threw = false;
+    try {
+        FBXReader::parseBinaryFBX(contents.constData(), contents.size());
+    } catch (const QString&) {
+        threw = true;
+    }
+    QVERIFY(threw);
+}
+
+void FBXReaderTests::addParserRows() {
+    QTest::addColumn<QString>("path");
+    QTest::addColumn<bool>("inPlace");
+    for (const auto& path : _models) {
+        QString name = QFileInfo(path).fileName();
+        QTest::newRow(qPrintable(name + " in place")) << path << true;
+        QTest::newRow(qPrintable(name + " QDataStream")) << path << false;
+    }
+}
+
+void FBXReaderTests::benchmarkParse_data() {
+    addParserRows();
+}
+
+void FBXReaderTests::benchmarkParse() {
+    QFETCH(QString, path);
+    QFETCH(bool, inPlace);
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QByteArray contents = file.readAll();
+
+    if (inPlace) {
+        QBENCHMARK {
+            FBXNode top = FBXReader::parseBinaryFBX(contents.constData(), contents.size());
+            Q_UNUSED(top);
+        }
+    } else {
+        QBuffer buffer(&contents);
+        buffer.open(QIODevice::ReadOnly);
+        QBENCHMARK {
+            buffer.seek(0);
+            FBXNode top = QDataStreamFBXParser::parseBinaryFBX(&buffer);
+            Q_UNUSED(top);
+        }
+    }
+}
+
+void FBXReaderTests::benchmarkPeakMemory_data() {
+    addParserRows();
+}
+
+// how much the resident size peaks above where it started while parsing a file, the parsed tree included
+void FBXReaderTests::benchmarkPeakMemory() {
+#ifdef Q_OS_LINUX
+    QFETCH(QString, path);
+    QFETCH(bool, inPlace);
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+
+    if (!resetPeakResidentSize()) {
+        QSKIP("The peak resident size can't be reset");
+    }
+    qint64 residentBefore = readStatusBytes("VmRSS");
+    qint64 peakResident;
+    {
+        FBXNode top = inPlace ? FBXReader::parseFBX(&file) : QDataStreamFBXParser::parseBinaryFBX(&file);
+        peakResident = readStatusBytes("VmHWM");
+        QVERIFY(!top.children.isEmpty());
+    }
+    QVERIFY(residentBefore >= 0 && peakResident >= 0);
+    QTest::setBenchmarkResult((qreal)std::max(peakResident - residentBefore, (qint64)0), QTest::BytesAllocated);
+#else
+    QSKIP("The peak resident size is only measured on Linux");
+#endif
+}
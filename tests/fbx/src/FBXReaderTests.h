@@ -0,0 +1,36 @@
+//
+//  FBXReaderTests.h
+//  tests/fbx/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_FBXReaderTests_h
+#define hifi_FBXReaderTests_h
+
+#include <QtTest/QtTest>
+
+class FBXReaderTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void testDevicesParseTheSameTree();
+    void testMatchesQDataStreamParser();
+    void testTruncatedDocumentThrows();
+    void benchmarkParse_data();
+    void benchmarkParse();
+    void benchmarkPeakMemory_data();
+    void benchmarkPeakMemory();
+
+private:
+    // rows of the files to parse, each with the in place and the QDataStream parser
+    void addParserRows();
+
+    QStringList _models;
+};
+
+#endif // hifi_FBXReaderTests_h
@@ -0,0 +1,203 @@
+//
+//  FrameIOTests.cpp
+//  tests/gpu/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "FrameIOTests.h"
+
+#include <string.h>
+
+#include <GLMHelpers.h>
+#include <gpu/Frame.h>
+#include <gpu/FrameIO.h>
+
+QTEST_MAIN(FrameIOTests)
+
+using namespace gpu;
+
+static BufferPointer makeBuffer(const QByteArray& contents) {
+    return std::make_shared<Buffer>(contents.size(), reinterpret_cast<const Byte*>(contents.constData()));
+}
+
+// two batches drawing with a shared buffer, pipeline and framebuffer, one of them with a named call
+static FramePointer makeFrame() {
+    auto frame = std::make_shared<Frame>();
+    frame->frameIndex = 42;
+    frame->pose = glm::translate(glm::mat4(), glm::vec3(1.0f, 2.0f, 3.0f));
+    frame->framebuffer.reset(Framebuffer::create("destination", Element::COLOR_RGBA_32, 64, 32));
+    frame->overlay.reset(Texture::create2D(Element::COLOR_RGBA_32, 16, 16));
+
+    auto vertices = makeBuffer("vertex data");
+    auto uniforms = makeBuffer("uniform data");
+    auto format = std::make_shared<Stream::Format>();
+    format->setAttribute(Stream::POSITION, 0, Element(VEC3, FLOAT, XYZ));
+    auto program = Shader::createProgram(Shader::createVertex(std::string("void main() { gl_Position = vec4(0.0); }")),
+                                         Shader::createPixel(std::string("void main() { }")));
+    auto state = std::make_shared<State>();
+    state->setCullMode(State::CULL_BACK);
+    auto pipeline = Pipeline::create(program, state);
+    TexturePointer texture(Texture::create2D(Element::COLOR_SRGBA_32, 8, 4));
+
+    frame->batches.resize(2);
+    for (size_t i = 0; i < frame->batches.size(); i++) {
+        Batch& batch = frame->batches[i];
+        batch.enableStereo(i == 0);
+        batch.setFramebuffer(frame->framebuffer);
+        batch.setPipeline(pipeline);
+        batch.setInputFormat(format);
+        batch.setInputBuffer(0, vertices, 0, 12);
+        batch.setUniformBuffer(0, uniforms, 0, uniforms->getSize());
+        batch.setResourceTexture(0, texture);
+        Transform view;
+        view.setTranslation(glm::vec3(0.0f, (float)i, 0.0f));
+        view.setRotation(glm::angleAxis(0.5f, glm::vec3(0.0f, 1.0f, 0.0f)));
+        batch.setViewTransform(view);
+        Transform model;
+        model.setScale(2.0f);
+        batch.setModelTransform(model);
+        batch.draw(Primitive::TRIANGLES, 3 * (uint32)(i + 1));
+    }
+
+    Batch& batch = frame->batches[1];
+    // two draws of a named call, with the second of its buffers filled
+    batch.getNamedBuffer("instances", 1)->setData(4, reinterpret_cast<const Byte*>("inst"));
+    batch.setupNamedCalls("instances", [](Batch&, Batch::NamedBatchData&) {});
+    batch.setupNamedCalls("instances", [](Batch&, Batch::NamedBatchData&) {});
+    return frame;
+}
+
+static void compareBuffers(const BufferPointer& read, const BufferPointer& written) {
+    QCOMPARE((bool)read, (bool)written);
+    if (written) {
+        QCOMPARE(read->getSize(), written->getSize());
+        QVERIFY(memcmp(read->getData(), written->getData(), written->getSize()) == 0);
+    }
+}
+
+static void compareTextures(const TexturePointer& read, const TexturePointer& written) {
+    QCOMPARE((bool)read, (bool)written);
+    if (written) {
+        QCOMPARE(read->getType(), written->getType());
+        QVERIFY(read->getTexelFormat() == written->getTexelFormat());
+        QCOMPARE(read->getWidth(), written->getWidth());
+        QCOMPARE(read->getHeight(), written->getHeight());
+        QCOMPARE(read->getNumMips(), written->getNumMips());
+    }
+}
+
+template <typename T> static void compareArrays(const std::vector<T>& read, const std::vector<T>& written) {
+    QCOMPARE(read.size(), written.size());
+    QVERIFY(written.empty() || memcmp(read.data(), written.data(), written.size() * sizeof(T)) == 0);
+}
+
+void FrameIOTests::testRoundTrip() {
+    FramePointer written = makeFrame();
+    QByteArray data = writeFrame(*written);
+    FramePointer read = readFrame(data);
+    QVERIFY(read);
+
+    QCOMPARE(read->frameIndex, written->frameIndex);
+    QVERIFY(read->pose == written->pose);
+    QCOMPARE(read->framebuffer->getName(), written->framebuffer->getName());
+    compareTextures(read->framebuffer->getRenderBuffer(0), written->framebuffer->getRenderBuffer(0));
+    compareTextures(read->overlay, written->overlay);
+
+    QCOMPARE(read->batches.size(), written->batches.size());
+    for (size_t i = 0; i < written->batches.size(); i++) {
+        const Batch& readBatch = read->batches[i];
+        const Batch& writtenBatch = written->batches[i];
+        QCOMPARE(readBatch.isStereoEnabled(), writtenBatch.isStereoEnabled());
+
+        compareArrays(readBatch._commands, writtenBatch._commands);
+        compareArrays(readBatch._commandOffsets, writtenBatch._commandOffsets);
+        compareArrays(readBatch._params, writtenBatch._params);
+        compareArrays(readBatch._data, writtenBatch._data);
+        compareArrays(readBatch._drawCallInfos, writtenBatch._drawCallInfos);
+        compareArrays(readBatch._objects, writtenBatch._objects);
+
+        QCOMPARE(readBatch._buffers.size(), writtenBatch._buffers.size());
+        for (size_t j = 0; j < writtenBatch._buffers.size(); j++) {
+            compareBuffers(readBatch._buffers._items[j]._data, writtenBatch._buffers._items[j]._data);
+        }
+        QCOMPARE(readBatch._textures.size(), writtenBatch._textures.size());
+        for (size_t j = 0; j < writtenBatch._textures.size(); j++) {
+            compareTextures(readBatch._textures._items[j]._data, writtenBatch._textures._items[j]._data);
+        }
+        QCOMPARE(readBatch._streamFormats.size(), writtenBatch._streamFormats.size());
+        for (size_t j = 0; j < writtenBatch._streamFormats.size(); j++) {
+            const auto& readFormat = readBatch._streamFormats._items[j]._data;
+            const auto& writtenFormat = writtenBatch._streamFormats._items[j]._data;
+            QCOMPARE(readFormat->getNumAttributes(), writtenFormat->getNumAttributes());
+            QCOMPARE(readFormat->getElementTotalSize(), writtenFormat->getElementTotalSize());
+        }
+        QCOMPARE(readBatch._transforms.size(), writtenBatch._transforms.size());
+        for (size_t j = 0; j < writtenBatch._transforms.size(); j++) {
+            const Transform& readTransform = readBatch._transforms._items[j]._data;
+            const Transform& writtenTransform = writtenBatch._transforms._items[j]._data;
+            QVERIFY(readTransform.getTranslation() == writtenTransform.getTranslation());
+            QVERIFY(readTransform.getRotation() == writtenTransform.getRotation());
+            QVERIFY(readTransform.getScale() == writtenTransform.getScale());
+        }
+        QCOMPARE(readBatch._pipelines.size(), writtenBatch._pipelines.size());
+        for (size_t j = 0; j < writtenBatch._pipelines.size(); j++) {
+            const PipelinePointer& readPipeline = readBatch._pipelines._items[j]._data;
+            const PipelinePointer& writtenPipeline = writtenBatch._pipelines._items[j]._data;
+            const auto& readShaders = readPipeline->getProgram()->getShaders();
+            const auto& writtenShaders = writtenPipeline->getProgram()->getShaders();
+            QCOMPARE(readShaders.size(), writtenShaders.size());
+            for (size_t k = 0; k < writtenShaders.size(); k++) {
+                QCOMPARE(readShaders[k]->getType(), writtenShaders[k]->getType());
+                QCOMPARE(readShaders[k]->getSource().getCode(), writtenShaders[k]->getSource().getCode());
+            }
+            QVERIFY(memcmp(&readPipeline->getState()->getValues(), &writtenPipeline->getState()->getValues(),
+                           sizeof(State::Data)) == 0);
+        }
+        QCOMPARE(readBatch._framebuffers.size(), writtenBatch._framebuffers.size());
+        for (size_t j = 0; j < writtenBatch._framebuffers.size(); j++) {
+            QCOMPARE(readBatch._framebuffers._items[j]._data->getName(),
+                     writtenBatch._framebuffers._items[j]._data->getName());
+        }
+        QCOMPARE(readBatch._lambdas.size(), writtenBatch._lambdas.size());
+
+        QCOMPARE(readBatch._namedData.size(), writtenBatch._namedData.size());
+        for (const auto& entry : writtenBatch._namedData) {
+            auto it = readBatch._namedData.find(entry.first);
+            QVERIFY(it != readBatch._namedData.end());
+            QCOMPARE(it->second.buffers.size(), entry.second.buffers.size());
+            for (size_t j = 0; j < entry.second.buffers.size(); j++) {
+                compareBuffers(it->second.buffers[j], entry.second.buffers[j]);
+            }
+            compareArrays(it->second.drawCallInfos, entry.second.drawCallInfos);
+        }
+    }
+
+    // objects shared between the batches are read back once and shared again
+    QVERIFY(read->batches[0]._buffers._items[0]._data == read->batches[1]._buffers._items[0]._data);
+    QVERIFY(read->batches[0]._pipelines._items[0]._data == read->batches[1]._pipelines._items[0]._data);
+    QVERIFY(read->batches[0]._framebuffers._items[0]._data == read->framebuffer);
+
+    // a frame read back writes the same capture
+    QCOMPARE(writeFrame(*read), data);
+}
+
+void FrameIOTests::testDamagedDataFails() {
+    QByteArray data = writeFrame(*makeFrame());
+
+    QVERIFY(!readFrame(QByteArray()));
+    for (int size : { 4, 8, data.size() / 2, data.size() - 1 }) {
+        QVERIFY(!readFrame(data.left(size)));
+    }
+
+    QByteArray wrongMagic = data;
+    wrongMagic[0] = wrongMagic[0] ^ 0xff;
+    QVERIFY(!readFrame(wrongMagic));
+
+    QByteArray wrongVersion = data;
+    wrongVersion[4] = wrongVersion[4] ^ 0xff;
+    QVERIFY(!readFrame(wrongVersion));
+}
@@ -0,0 +1,24 @@
+//
+//  FrameIOTests.h
+//  tests/gpu/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_FrameIOTests_h
+#define hifi_FrameIOTests_h
+
+#include <QtTest/QtTest>
+
+class FrameIOTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testRoundTrip();
+    void testDamagedDataFails();
+};
+
+#endif // hifi_FrameIOTests_h
@@ -43,6 +43,7 @@
 #include <gl/Config.h>
 #include <model/TextureMap.h>
 #include <ktx/KTX.h>
+#include <ktx/BlockCompression.h>
 
 
 QSharedPointer<FileLogger> logger;
@@ -77,6 +78,15 @@ QString getRootPath() {
     return result;
 }
 
+// Q_ASSERT compiles out of release builds, where the test has to fail just the same
+#define CHECK(condition) \
+    do { \
+        if (!(condition)) { \
+            qCritical() << "Check failed:" << #condition << "at line" << __LINE__; \
+            return 1; \
+        } \
+    } while (0)
+
 const QString TEST_IMAGE = getRootPath() + "/scripts/developer/tests/cube_texture.png";
 const QString TEST_IMAGE_KTX = getRootPath() + "/scripts/developer/tests/cube_texture.ktx";
 
@@ -87,7 +97,7 @@ int main(int argc, char** argv) {
     QCoreApplication::setOrganizationDomain("highfidelity.com");
     logger.reset(new FileLogger());
 
-    Q_ASSERT(sizeof(ktx::Header) == 12 + (sizeof(uint32_t) * 13));
+    static_assert(sizeof(ktx::Header) == 12 + (sizeof(uint32_t) * 13), "unexpected KTX header size");
 
     DependencyManager::set<tracing::Tracer>();
     qInstallMessageHandler(messageHandler);
@@ -116,34 +126,89 @@ int main(int argc, char** argv) {
         {
             const auto& memStorage = ktxMemory->getStorage();
             const auto& fileStorage = ktxFile->getStorage();
-            Q_ASSERT(memStorage->size() == fileStorage->size());
-            Q_ASSERT(memStorage->data() != fileStorage->data());
-            Q_ASSERT(0 == memcmp(memStorage->data(), fileStorage->data(), memStorage->size()));
-            Q_ASSERT(ktxFile->_images.size() == ktxMemory->_images.size());
+            CHECK(memStorage->size() == fileStorage->size());
+            CHECK(memStorage->data() != fileStorage->data());
+            CHECK(0 == memcmp(memStorage->data(), fileStorage->data(), memStorage->size()));
+            CHECK(ktxFile->_images.size() == ktxMemory->_images.size());
             auto imageCount = ktxFile->_images.size();
             auto startMemory = ktxMemory->_storage->data();
             auto startFile = ktxFile->_storage->data();
             for (size_t i = 0; i < imageCount; ++i) {
                 auto memImages = ktxMemory->_images[i];
                 auto fileImages = ktxFile->_images[i];
-                Q_ASSERT(memImages._padding == fileImages._padding);
-                Q_ASSERT(memImages._numFaces == fileImages._numFaces);
-                Q_ASSERT(memImages._imageSize == fileImages._imageSize);
-                Q_ASSERT(memImages._faceSize == fileImages._faceSize);
-                Q_ASSERT(memImages._faceBytes.size() == memImages._numFaces);
-                Q_ASSERT(fileImages._faceBytes.size() == fileImages._numFaces);
+                CHECK(memImages._padding == fileImages._padding);
+                CHECK(memImages._numFaces == fileImages._numFaces);
+                CHECK(memImages._imageSize == fileImages._imageSize);
+                CHECK(memImages._faceSize == fileImages._faceSize);
+                CHECK(memImages._faceBytes.size() == memImages._numFaces);
+                CHECK(fileImages._faceBytes.size() == fileImages._numFaces);
                 auto faceCount = fileImages._numFaces;
                 for (uint32_t face = 0; face < faceCount; ++face) {
                     auto memFace = memImages._faceBytes[face];
                     auto memOffset = memFace - startMemory;
                     auto fileFace = fileImages._faceBytes[face];
                     auto fileOffset = fileFace - startFile;
-                    Q_ASSERT(memOffset % 4 == 0);
-                    Q_ASSERT(memOffset == fileOffset);
+                    CHECK(memOffset % 4 == 0);
+                    CHECK(memOffset == fileOffset);
                 }
             }
         }
     }
+    // Round trip the texture through the CPU block compressor and check the decoded texels against the source
+    {
+        const auto& srcHeader = ktxMemory->getHeader();
+        const auto& srcImage = ktxMemory->_images[0];
+        auto width = srcHeader.evalPixelWidth(0);
+        auto height = srcHeader.evalPixelHeight(0);
+        bool srcIsBGRA = (srcHeader.getGLFormat() == ktx::GLFormat::BGRA);
+
+        struct Expectation {
+            ktx::BlockFormat format;
+            uint32_t numChannels;
+            double maxRMSE;
+        };
+        const std::vector<Expectation> expectations {
+            { ktx::BlockFormat::BC1, 3, 12.0 },
+            { ktx::BlockFormat::BC3, 4, 12.0 },
+            { ktx::BlockFormat::BC4, 1, 4.0 },
+            { ktx::BlockFormat::BC5, 2, 4.0 },
+            { ktx::BlockFormat::BC7, 4, 8.0 },
+        };
+
+        for (const auto& expectation : expectations) {
+            QElapsedTimer timer;
+            timer.start();
+            const ktx::KeyValues keyValues { ktx::KeyValue("hifi.compressed", "test") };
+            auto compressed = ktx::compressKTX(*ktxMemory, expectation.format, false, keyValues);
+            auto elapsed = timer.elapsed();
+            CHECK(compressed);
+            // Only the given key values are written, none of the source ones describing the uncompressed texels
+            CHECK(compressed->_keyValues.size() == 1);
+            CHECK(compressed->_keyValues.front()._key == "hifi.compressed");
+            CHECK(compressed->_images.size() == ktxMemory->_images.size());
+            CHECK(compressed->_images[0]._faceSize == ktx::block::evalCompressedSize(expectation.format, width, height));
+
+            std::vector<uint8_t> decoded(width * height * 4);
+            bool decodedOk = ktx::block::decompressImage(expectation.format, width, height, compressed->_images[0]._faceBytes[0], decoded.data());
+            CHECK(decodedOk);
+
+            double squaredError = 0.0;
+            for (size_t texel = 0; texel < width * height; ++texel) {
+                const uint8_t* srcTexel = srcImage._faceBytes[0] + texel * 4;
+                const uint8_t* decodedTexel = decoded.data() + texel * 4;
+                for (uint32_t channel = 0; channel < expectation.numChannels; ++channel) {
+                    uint32_t srcChannel = (srcIsBGRA && channel < 3) ? (2 - channel) : channel;
+                    double delta = (double)srcTexel[srcChannel] - (double)decodedTexel[channel];
+                    squaredError += delta * delta;
+                }
+            }
+            double rmse = sqrt(squaredError / (double)(width * height * expectation.numChannels));
+            qDebug() << "Block format" << (int)expectation.format << "compressed in" << elapsed << "ms"
+                << ktxMemory->getStorage()->size() << "->" << compressed->getStorage()->size() << "bytes, RMSE" << rmse;
+            CHECK(rmse < expectation.maxRMSE);
+        }
+    }
+
     testTexture->setKtxBacking(TEST_IMAGE_KTX.toStdString());
     return 0;
 }
@@ -0,0 +1,209 @@
+//
+//  ResourceRequestQueueTests.cpp
+//  tests/networking/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ResourceRequestQueueTests.h"
+
+#include <ResourceCache.h>
+#include <ResourceRequestQueue.h>
+
+QTEST_MAIN(ResourceRequestQueueTests)
+
+class CategorizedResource : public Resource {
+public:
+    CategorizedResource(const QUrl& url, ResourceRequestCategory category) : Resource(url), _category(category) {}
+
+    ResourceRequestCategory getRequestCategory() const override { return _category; }
+
+private:
+    ResourceRequestCategory _category;
+};
+
+// a resource that is queued as soon as it starts loading, as no request slot is ever free
+static QSharedPointer<Resource> createQueuedResource(const QString& path,
+                                                     ResourceRequestCategory category = ResourceRequestCategory::Other) {
+    QSharedPointer<Resource> resource(new CategorizedResource(QUrl("http://localhost/" + path), category));
+    resource->setSelf(resource);
+    resource->ensureLoading();
+    return resource;
+}
+
+static QList<QSharedPointer<Resource>> createResources(int count) {
+    QList<QSharedPointer<Resource>> resources;
+    for (int i = 0; i < count; ++i) {
+        resources << QSharedPointer<Resource>::create(QUrl(QString("http://localhost/%1").arg(i)));
+    }
+    return resources;
+}
+
+static QList<int> popAll(ResourceRequestQueue& queue) {
+    QList<int> order;
+    while (!queue.isEmpty()) {
+        order << queue.top().key;
+        queue.pop();
+    }
+    return order;
+}
+
+void ResourceRequestQueueTests::initTestCase() {
+    DependencyManager::set<ResourceCacheSharedItems>();
+    ResourceCache::setRequestLimit(0);
+}
+
+void ResourceRequestQueueTests::cleanupTestCase() {
+    DependencyManager::destroy<ResourceCacheSharedItems>();
+}
+
+void ResourceRequestQueueTests::popsByPriority() {
+    auto resources = createResources(64);
+    ResourceRequestQueue queue;
+    for (int i = 0; i < resources.size(); ++i) {
+        // scatter the priorities
+        QVERIFY(queue.push(resources[i], (float)((i * 37) % resources.size())));
+    }
+    QVERIFY(!queue.push(resources[0], 1000.0f));
+    QCOMPARE((int)queue.size(), resources.size());
+
+    float previous = FLT_MAX;
+    while (!queue.isEmpty()) {
+        QVERIFY(queue.top().priority <= previous);
+        previous = queue.top().priority;
+        queue.pop();
+    }
+}
+
+void ResourceRequestQueueTests::tiesGoToTheLatestRequest() {
+    auto resources = createResources(3);
+    ResourceRequestQueue queue;
+    for (const auto& resource : resources) {
+        queue.push(resource, -FLT_MAX);
+    }
+    auto order = popAll(queue);
+    QCOMPARE(order.size(), 3);
+    QCOMPARE(order[0], resources[2]->getRequestID());
+    QCOMPARE(order[1], resources[1]->getRequestID());
+    QCOMPARE(order[2], resources[0]->getRequestID());
+}
+
+void ResourceRequestQueueTests::updateReordersRequests() {
+    auto resources = createResources(4);
+    ResourceRequestQueue queue;
+    for (int i = 0; i < resources.size(); ++i) {
+        queue.push(resources[i], (float)i);
+    }
+    QVERIFY(queue.update(resources[0]->getRequestID(), 10.0f));
+    QVERIFY(queue.update(resources[3]->getRequestID(), -1.0f));
+    QVERIFY(!queue.update(-1, 0.0f));
+
+    auto order = popAll(queue);
+    QCOMPARE(order[0], resources[0]->getRequestID());
+    QCOMPARE(order[1], resources[2]->getRequestID());
+    QCOMPARE(order[2], resources[1]->getRequestID());
+    QCOMPARE(order[3], resources[3]->getRequestID());
+}
+
+void ResourceRequestQueueTests::removeKeepsHeapOrder() {
+    auto resources = createResources(32);
+    ResourceRequestQueue queue;
+    for (int i = 0; i < resources.size(); ++i) {
+        queue.push(resources[i], (float)((i * 13) % resources.size()));
+    }
+    for (int i = 0; i < resources.size(); i += 3) {
+        QVERIFY(queue.remove(resources[i]->getRequestID()));
+        QVERIFY(!queue.contains(resources[i]->getRequestID()));
+    }
+    QVERIFY(!queue.remove(resources[0]->getRequestID()));
+
+    float previous = FLT_MAX;
+    int count = 0;
+    while (!queue.isEmpty()) {
+        QVERIFY(queue.top().priority <= previous);
+        previous = queue.top().priority;
+        queue.pop();
+        ++count;
+    }
+    QCOMPARE(count, resources.size() - (resources.size() + 2) / 3);
+}
+
+void ResourceRequestQueueTests::orphanedRequestStaysQueued() {
+    auto sharedItems = DependencyManager::get<ResourceCacheSharedItems>();
+    auto orphaned = createQueuedResource("orphaned");
+    auto owned = createQueuedResource("owned");
+    {
+        QObject owner;
+        orphaned->setLoadPriority(&owner, 1.0f);
+    }
+    QObject owner;
+    owned->setLoadPriority(&owner, 0.5f);
+    QCOMPARE(sharedItems->getPendingRequestsCount(), (uint32_t)2);
+
+    // the request whose owner is gone loses its priority but isn't dropped
+    QCOMPARE(sharedItems->getHighestPendingRequest(), owned);
+    QCOMPARE(sharedItems->getHighestPendingRequest(), orphaned);
+    QCOMPARE(sharedItems->getPendingRequestsCount(), (uint32_t)0);
+}
+
+void ResourceRequestQueueTests::budgetHoldsBackCategory() {
+    auto sharedItems = DependencyManager::get<ResourceCacheSharedItems>();
+    sharedItems->setRequestBudget(ResourceRequestCategory::Texture, 1);
+
+    auto loading = createQueuedResource("loading.ktx", ResourceRequestCategory::Texture);
+    QCOMPARE(sharedItems->getHighestPendingRequest(), loading);
+    sharedItems->appendActiveRequest(loading);
+    QVERIFY(!sharedItems->isWithinRequestBudget(ResourceRequestCategory::Texture));
+
+    QObject owner;
+    auto texture = createQueuedResource("texture.ktx", ResourceRequestCategory::Texture);
+    texture->setLoadPriority(&owner, 1.0f);
+    auto model = createQueuedResource("model.fbx", ResourceRequestCategory::Model);
+    model->setLoadPriority(&owner, 0.0f);
+
+    // the texture has the higher priority, but its category is out of budget
+    QCOMPARE(sharedItems->getHighestPendingRequest(), model);
+    QVERIFY(sharedItems->getHighestPendingRequest().isNull());
+
+    sharedItems->removeRequest(loading);
+    QVERIFY(sharedItems->isWithinRequestBudget(ResourceRequestCategory::Texture));
+    QCOMPARE(sharedItems->getHighestPendingRequest(), texture);
+
+    sharedItems->setRequestBudget(ResourceRequestCategory::Texture, UNLIMITED_REQUEST_BUDGET);
+}
+
+void ResourceRequestQueueTests::shareFollowsRequestLimit() {
+    const float SHARE = 0.75f;
+    ResourceCache::setRequestShare(ResourceRequestCategory::Texture, SHARE);
+    QCOMPARE(ResourceCache::getRequestBudget(ResourceRequestCategory::Texture), 1);
+
+    ResourceCache::setRequestLimit(20);
+    QCOMPARE(ResourceCache::getRequestBudget(ResourceRequestCategory::Texture), 15);
+    ResourceCache::setRequestLimit(8);
+    QCOMPARE(ResourceCache::getRequestBudget(ResourceRequestCategory::Texture), 6);
+
+    // a fixed budget replaces the share
+    ResourceCache::setRequestBudget(ResourceRequestCategory::Texture, UNLIMITED_REQUEST_BUDGET);
+    ResourceCache::setRequestLimit(20);
+    QCOMPARE(ResourceCache::getRequestBudget(ResourceRequestCategory::Texture), UNLIMITED_REQUEST_BUDGET);
+
+    ResourceCache::setRequestLimit(0);
+}
+
+void ResourceRequestQueueTests::destroyedRequestIsRemoved() {
+    auto sharedItems = DependencyManager::get<ResourceCacheSharedItems>();
+    auto destroyed = createQueuedResource("destroyed");
+    int destroyedID = destroyed->getRequestID();
+    QCOMPARE(sharedItems->getPendingRequestsCount(), (uint32_t)1);
+    destroyed.reset();
+    QCOMPARE(sharedItems->getPendingRequestsCount(), (uint32_t)0);
+
+    // a new resource, likely at the address of the one destroyed, is queued all the same
+    auto created = createQueuedResource("created");
+    QVERIFY(created->getRequestID() != destroyedID);
+    QCOMPARE(sharedItems->getPendingRequestsCount(), (uint32_t)1);
+    QCOMPARE(sharedItems->getHighestPendingRequest(), created);
+}
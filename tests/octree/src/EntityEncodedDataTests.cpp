@@ -0,0 +1,166 @@
+//
+//  EntityEncodedDataTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityEncodedDataTests.h"
+
+#include <functional>
+
+#include <DependencyManager.h>
+#include <EntityItemProperties.h>
+#include <EntityTreeElement.h>
+#include <NodeList.h>
+#include <OctreePacketData.h>
+#include <ShapeEntityItem.h>
+#include <SharedUtil.h>
+
+QTEST_MAIN(EntityEncodedDataTests)
+
+// A box that counts how many times its properties were actually encoded, as opposed to copied from the cache
+class CountingBoxEntity : public ShapeEntityItem {
+public:
+    CountingBoxEntity() : ShapeEntityItem(EntityItemID(QUuid::createUuid())) {
+        setShape(entity::Shape::Cube);
+        setLastEdited(usecTimestampNow());
+    }
+
+    void appendSubclassData(OctreePacketData* packetData, EncodeBitstreamParams& params,
+                            EntityTreeElementExtraEncodeDataPointer extraEncodeData,
+                            EntityPropertyFlags& requestedProperties,
+                            EntityPropertyFlags& propertyFlags,
+                            EntityPropertyFlags& propertiesDidntFit,
+                            int& propertyCount,
+                            OctreeElement::AppendState& appendState) const override {
+        ++encodeCount;
+        ShapeEntityItem::appendSubclassData(packetData, params, extraEncodeData, requestedProperties, propertyFlags,
+                                            propertiesDidntFit, propertyCount, appendState);
+    }
+
+    mutable int encodeCount { 0 };
+};
+
+// What one viewer gets: each call has its own packet and params, like two nodes of the entity server
+static QByteArray encodeForViewer(const CountingBoxEntity& entity,
+                                  EntityTreeElementExtraEncodeDataPointer extraEncodeData = nullptr) {
+    OctreePacketData packetData;
+    EncodeBitstreamParams params;
+    OctreeElement::AppendState appendState = entity.appendEntityData(&packetData, params, extraEncodeData);
+    if (appendState != OctreeElement::COMPLETED) {
+        return QByteArray();
+    }
+    return QByteArray((const char*)packetData.getUncompressedData(), packetData.getUncompressedSize());
+}
+
+void EntityEncodedDataTests::initTestCase() {
+    DependencyManager::set<NodeList>(NodeType::Unassigned);
+}
+
+void EntityEncodedDataTests::cleanupTestCase() {
+    DependencyManager::destroy<NodeList>();
+}
+
+void EntityEncodedDataTests::testViewersShareBytes() {
+    CountingBoxEntity entity;
+    entity.setName("shared");
+
+    QByteArray first = encodeForViewer(entity);
+    QVERIFY(!first.isEmpty());
+    QCOMPARE(entity.encodeCount, 1);
+
+    QByteArray second = encodeForViewer(entity);
+    QCOMPARE(entity.encodeCount, 1);
+    QCOMPARE(second, first);
+}
+
+void EntityEncodedDataTests::testEditInvalidates() {
+    struct Edit {
+        const char* name;
+        std::function<void(EntityItemProperties&)> apply;
+    };
+    const std::vector<Edit> edits {
+        { "name", [](EntityItemProperties& properties) { properties.setName("edited"); } },
+        { "userData", [](EntityItemProperties& properties) { properties.setUserData("{\"edited\":true}"); } },
+        { "color", [](EntityItemProperties& properties) { properties.setColor(xColor { 1, 2, 3 }); } },
+        { "locked", [](EntityItemProperties& properties) { properties.setLocked(true); } },
+        { "visible", [](EntityItemProperties& properties) { properties.setVisible(false); } },
+        { "position", [](EntityItemProperties& properties) { properties.setPosition(glm::vec3(1.0f, 2.0f, 3.0f)); } },
+        { "dimensions", [](EntityItemProperties& properties) { properties.setDimensions(glm::vec3(2.0f)); } }
+    };
+
+    for (const auto& edit : edits) {
+        CountingBoxEntity entity;
+        QByteArray before = encodeForViewer(entity);
+        QVERIFY(!before.isEmpty());
+
+        EntityItemProperties properties;
+        edit.apply(properties);
+        QVERIFY2(entity.setProperties(properties), edit.name);
+
+        QByteArray after = encodeForViewer(entity);
+        QVERIFY2(entity.encodeCount == 2, edit.name);
+        QVERIFY2(after != before, edit.name);
+
+        // the new bytes are shared again
+        QCOMPARE(encodeForViewer(entity), after);
+        QVERIFY2(entity.encodeCount == 2, edit.name);
+    }
+
+    // an edit that keeps the timestamps the cached bytes were keyed on still invalidates them
+    CountingBoxEntity entity;
+    const quint64 lastEdited = entity.getLastEdited();
+    QByteArray before = encodeForViewer(entity);
+    entity.setName("same time");
+    entity.setLastEdited(lastEdited);
+    QByteArray after = encodeForViewer(entity);
+    QCOMPARE(entity.encodeCount, 2);
+    QVERIFY(after != before);
+}
+
+void EntityEncodedDataTests::testRequestedPropertiesDontShare() {
+    CountingBoxEntity entity;
+    entity.setName("partial");
+
+    QByteArray full = encodeForViewer(entity);
+    QCOMPARE(entity.encodeCount, 1);
+
+    // a viewer that still needs the properties that didn't fit in its last packet
+    EntityPropertyFlags remaining;
+    remaining += PROP_NAME;
+    remaining += PROP_COLOR;
+    auto extraEncodeData = std::make_shared<EntityTreeElementExtraEncodeData>();
+    extraEncodeData->entities.insert(entity.getEntityItemID(), remaining);
+
+    QByteArray partial = encodeForViewer(entity, extraEncodeData);
+    QVERIFY(!partial.isEmpty());
+    QCOMPARE(entity.encodeCount, 2);
+    QVERIFY(partial != full);
+    QVERIFY(partial.size() < full.size());
+
+    // both encodings stay cached side by side
+    QCOMPARE(encodeForViewer(entity), full);
+    QCOMPARE(encodeForViewer(entity, extraEncodeData), partial);
+    QCOMPARE(entity.encodeCount, 2);
+}
+
+void EntityEncodedDataTests::testAvatarSelfParentDoesntShare() {
+    CountingBoxEntity entity;
+    entity.setParentID(AVATAR_SELF_ID);
+
+    // the parent ID is replaced by each node's session UUID, so every viewer gets its own encoding
+    encodeForViewer(entity);
+    encodeForViewer(entity);
+    QCOMPARE(entity.encodeCount, 2);
+
+    // and nothing cached while it was parented to the avatar is served once it isn't anymore
+    entity.setParentID(QUuid());
+    QByteArray first = encodeForViewer(entity);
+    QCOMPARE(entity.encodeCount, 3);
+    QCOMPARE(encodeForViewer(entity), first);
+    QCOMPARE(entity.encodeCount, 3);
+}
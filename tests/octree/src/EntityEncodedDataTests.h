@@ -0,0 +1,28 @@
+//
+//  EntityEncodedDataTests.h
+//  tests/octree/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityEncodedDataTests_h
+#define hifi_EntityEncodedDataTests_h
+
+#include <QtTest/QtTest>
+
+class EntityEncodedDataTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testViewersShareBytes();
+    void testEditInvalidates();
+    void testRequestedPropertiesDontShare();
+    void testAvatarSelfParentDoesntShare();
+};
+
+#endif // hifi_EntityEncodedDataTests_h
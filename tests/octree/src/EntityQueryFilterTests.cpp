@@ -0,0 +1,233 @@
+//
+//  EntityQueryFilterTests.cpp
+//  tests/octree/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityQueryFilterTests.h"
+
+#include <vector>
+
+#include <QtCore/QJsonDocument>
+
+#include <DependencyManager.h>
+#include <EntityItemProperties.h>
+#include <EntityNodeData.h>
+#include <EntityQueryFilter.h>
+#include <EntityTree.h>
+#include <EntityTreeElement.h>
+#include <NodeList.h>
+#include <ShapeEntityItem.h>
+
+QTEST_MAIN(EntityQueryFilterTests)
+
+// How EntityItem::matchesJSONFilters() read the filters before they were compiled, kept as the reference
+static bool referenceMatches(const EntityItem& entity, const QJsonObject& jsonFilters) {
+    foreach(const auto& property, jsonFilters.keys()) {
+        if (property == EntityJSONQueryProperties::SERVER_SCRIPTS_PROPERTY &&
+            jsonFilters[property] == EntityQueryFilterSymbol::NonDefault) {
+            return entity.getServerScripts() != ENTITY_ITEM_DEFAULT_SERVER_SCRIPTS;
+        }
+    }
+    return true;
+}
+
+static std::vector<QJsonObject> filtersToTest() {
+    std::vector<QJsonObject> filters;
+    const char* jsonFilters[] = {
+        "{}",
+        "{ \"serverScripts\": \"+\" }",
+        "{ \"serverScripts\": \"-\" }",
+        "{ \"serverScripts\": 1 }",
+        "{ \"serverScripts\": null }",
+        "{ \"script\": \"+\" }",
+        "{ \"flags\": { \"includeAncestors\": true } }",
+        "{ \"flags\": { \"includeDescendants\": true }, \"serverScripts\": \"+\" }",
+        "{ \"name\": \"+\", \"serverScripts\": \"+\" }"
+    };
+    for (auto json : jsonFilters) {
+        filters.push_back(QJsonDocument::fromJson(json).object());
+    }
+    return filters;
+}
+
+static EntityItemPointer makeBox(const QString& serverScripts) {
+    EntityItemProperties properties;
+    properties.setServerScripts(serverScripts);
+    return ShapeEntityItem::boxFactory(EntityItemID(QUuid::createUuid()), properties);
+}
+
+static EntityItemPointer addBox(EntityTreePointer tree, const glm::vec3& position, const QString& serverScripts) {
+    EntityItemProperties properties;
+    properties.setType(EntityTypes::Box);
+    properties.setPosition(position);
+    properties.setDimensions(glm::vec3(1.0f));
+    properties.setServerScripts(serverScripts);
+    return tree->addEntity(EntityItemID(QUuid::createUuid()), properties);
+}
+
+// Walks the whole tree and checks that no subtree holding a matching entity would be skipped.
+// Returns whether any entity in the subtree matches.
+static bool checkNoMatchIsPruned(EntityTreeElementPointer element, const EntityQueryFilter& filter, int& prunedSubtrees) {
+    bool anyMatch = false;
+    element->forEachEntity([&](EntityItemPointer entity) {
+        anyMatch = anyMatch || filter.matches(*entity);
+    });
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        EntityTreeElementPointer child = element->getChildAtIndex(i);
+        if (child) {
+            anyMatch = checkNoMatchIsPruned(child, filter, prunedSubtrees) || anyMatch;
+        }
+    }
+
+    bool canMatch = filter.canMatchTraits(element->getSubtreeQueryFilterTraits());
+    if (anyMatch) {
+        QTest::qVerify(canMatch, "canMatchTraits", "a subtree with a matching entity was pruned", __FILE__, __LINE__);
+    } else if (!canMatch) {
+        prunedSubtrees++;
+    }
+    return anyMatch;
+}
+
+static EntityTreeElementPointer findRootChild(EntityTreePointer tree, const glm::vec3& position) {
+    EntityTreeElementPointer root = tree->getRoot();
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        EntityTreeElementPointer child = root->getChildAtIndex(i);
+        if (child && child->getAACube().contains(position)) {
+            return child;
+        }
+    }
+    return EntityTreeElementPointer();
+}
+
+void EntityQueryFilterTests::initTestCase() {
+    DependencyManager::set<NodeList>(NodeType::Unassigned);
+}
+
+void EntityQueryFilterTests::cleanupTestCase() {
+    DependencyManager::destroy<NodeList>();
+}
+
+void EntityQueryFilterTests::testMatchesJSONFilters() {
+    std::vector<EntityItemPointer> entities {
+        makeBox(ENTITY_ITEM_DEFAULT_SERVER_SCRIPTS),
+        makeBox("http://example.com/server.js")
+    };
+
+    for (const auto& jsonFilters : filtersToTest()) {
+        EntityQueryFilter filter(jsonFilters);
+        QCOMPARE(filter.hasFilters(), !jsonFilters.isEmpty());
+
+        QByteArray description = QJsonDocument(jsonFilters).toJson(QJsonDocument::Compact);
+        for (const auto& entity : entities) {
+            bool expected = referenceMatches(*entity, jsonFilters);
+            QVERIFY2(filter.matches(*entity) == expected, description.constData());
+            QVERIFY2(entity->matchesJSONFilters(jsonFilters) == expected, description.constData());
+        }
+    }
+}
+
+void EntityQueryFilterTests::testCanMatchTraits() {
+    EntityItemPointer withoutScripts = makeBox(ENTITY_ITEM_DEFAULT_SERVER_SCRIPTS);
+    EntityItemPointer withScripts = makeBox("http://example.com/server.js");
+    QCOMPARE(withoutScripts->getQueryFilterTraits(), (uint32_t)0);
+    QCOMPARE(withScripts->getQueryFilterTraits(), (uint32_t)EntityQueryFilter::SERVER_SCRIPTS_TRAIT);
+
+    // the traits of a matching entity never prune it
+    for (const auto& jsonFilters : filtersToTest()) {
+        EntityQueryFilter filter(jsonFilters);
+        QByteArray description = QJsonDocument(jsonFilters).toJson(QJsonDocument::Compact);
+        for (const auto& entity : { withoutScripts, withScripts }) {
+            if (filter.matches(*entity)) {
+                QVERIFY2(filter.canMatchTraits(entity->getQueryFilterTraits()), description.constData());
+            }
+        }
+    }
+
+    // only the serverScripts filter can prune, and only what has never had server scripts
+    EntityQueryFilter serverScriptsFilter(QJsonDocument::fromJson("{ \"serverScripts\": \"+\" }").object());
+    QVERIFY(!serverScriptsFilter.canMatchTraits(0));
+    QVERIFY(serverScriptsFilter.canMatchTraits(EntityQueryFilter::SERVER_SCRIPTS_TRAIT));
+    EntityQueryFilter unsupportedFilter(QJsonDocument::fromJson("{ \"script\": \"+\" }").object());
+    QVERIFY(unsupportedFilter.canMatchTraits(0));
+    QVERIFY(EntityQueryFilter().canMatchTraits(0));
+
+    // traits are sticky, an entity that lost its server scripts is still sent once more
+    withScripts->setServerScripts(ENTITY_ITEM_DEFAULT_SERVER_SCRIPTS);
+    QVERIFY(!serverScriptsFilter.matches(*withScripts));
+    QVERIFY(serverScriptsFilter.canMatchTraits(withScripts->getQueryFilterTraits()));
+}
+
+void EntityQueryFilterTests::testSubtreePruning() {
+    auto tree = std::make_shared<EntityTree>();
+    tree->setIsServer(true);
+    tree->createRootElement();
+
+    // scripted entities in two octants, plain ones everywhere
+    const float OFFSET = 1000.0f;
+    for (float x : { -OFFSET, OFFSET }) {
+        for (float y : { -OFFSET, OFFSET }) {
+            for (float z : { -OFFSET, OFFSET }) {
+                QVERIFY(addBox(tree, glm::vec3(x, y, z), ENTITY_ITEM_DEFAULT_SERVER_SCRIPTS));
+                QVERIFY(addBox(tree, glm::vec3(x, y, z) * 0.5f, ENTITY_ITEM_DEFAULT_SERVER_SCRIPTS));
+            }
+        }
+    }
+    QVERIFY(addBox(tree, glm::vec3(OFFSET), "http://example.com/server.js"));
+    QVERIFY(addBox(tree, glm::vec3(-OFFSET, OFFSET, -OFFSET) * 0.25f, "http://example.com/server.js"));
+
+    for (const auto& jsonFilters : filtersToTest()) {
+        EntityQueryFilter filter(jsonFilters);
+        int prunedSubtrees = 0;
+        QVERIFY(checkNoMatchIsPruned(tree->getRoot(), filter, prunedSubtrees));
+        if (QTest::currentTestFailed()) {
+            return;
+        }
+        if (jsonFilters.value(EntityJSONQueryProperties::SERVER_SCRIPTS_PROPERTY) == EntityQueryFilterSymbol::NonDefault) {
+            // the six octants without scripted entities are skipped
+            QVERIFY(prunedSubtrees >= 6);
+        } else {
+            QCOMPARE(prunedSubtrees, 0);
+        }
+    }
+}
+
+void EntityQueryFilterTests::testTraitsGeneration() {
+    auto tree = std::make_shared<EntityTree>();
+    tree->setIsServer(true);
+    tree->createRootElement();
+
+    const glm::vec3 FIRST_POSITION(1000.0f);
+    const glm::vec3 SECOND_POSITION(-1000.0f);
+    EntityItemPointer first = addBox(tree, FIRST_POSITION, ENTITY_ITEM_DEFAULT_SERVER_SCRIPTS);
+    EntityItemPointer second = addBox(tree, SECOND_POSITION, ENTITY_ITEM_DEFAULT_SERVER_SCRIPTS);
+    QVERIFY(first && second);
+
+    EntityTreeElementPointer root = tree->getRoot();
+    EntityTreeElementPointer firstOctant = findRootChild(tree, FIRST_POSITION);
+    EntityTreeElementPointer secondOctant = findRootChild(tree, SECOND_POSITION);
+    QVERIFY(firstOctant && secondOctant && firstOctant != secondOctant);
+
+    // cache the empty traits everywhere
+    QCOMPARE(root->getSubtreeQueryFilterTraits(), (uint32_t)0);
+    QCOMPARE(first->getElement()->getSubtreeQueryFilterTraits(), (uint32_t)0);
+
+    // an entity gaining a trait is seen by its element and every ancestor, not by the other octants
+    first->setServerScripts("http://example.com/server.js");
+    QCOMPARE(first->getElement()->getSubtreeQueryFilterTraits(), (uint32_t)EntityQueryFilter::SERVER_SCRIPTS_TRAIT);
+    QCOMPARE(firstOctant->getSubtreeQueryFilterTraits(), (uint32_t)EntityQueryFilter::SERVER_SCRIPTS_TRAIT);
+    QCOMPARE(root->getSubtreeQueryFilterTraits(), (uint32_t)EntityQueryFilter::SERVER_SCRIPTS_TRAIT);
+    QCOMPARE(secondOctant->getSubtreeQueryFilterTraits(), (uint32_t)0);
+
+    // a traited entity added to a cached subtree is seen too
+    QVERIFY(addBox(tree, SECOND_POSITION * 0.5f, "http://example.com/server.js"));
+    QCOMPARE(secondOctant->getSubtreeQueryFilterTraits(), (uint32_t)EntityQueryFilter::SERVER_SCRIPTS_TRAIT);
+
+    // setting the trait again doesn't need a recompute, the cached values stay correct
+    first->setServerScripts("http://example.com/other.js");
+    QCOMPARE(root->getSubtreeQueryFilterTraits(), (uint32_t)EntityQueryFilter::SERVER_SCRIPTS_TRAIT);
+}
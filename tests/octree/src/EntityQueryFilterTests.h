@@ -0,0 +1,28 @@
+//
+//  EntityQueryFilterTests.h
+//  tests/octree/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityQueryFilterTests_h
+#define hifi_EntityQueryFilterTests_h
+
+#include <QtTest/QtTest>
+
+class EntityQueryFilterTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void testMatchesJSONFilters();
+    void testCanMatchTraits();
+    void testSubtreePruning();
+    void testTraitsGeneration();
+};
+
+#endif // hifi_EntityQueryFilterTests_h
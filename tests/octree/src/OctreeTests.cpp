@@ -13,13 +13,16 @@
 //
 
 #include <QDebug>
+#include <QElapsedTimer>
 
 #include <ByteCountCoding.h>
 #include <EntityItem.h>
 #include <EntityTree.h>
 #include <EntityTreeElement.h>
+#include <NumericalConstants.h>
 #include <Octree.h>
 #include <OctreeConstants.h>
+#include <OctreeElementPool.h>
 #include <PropertyFlags.h>
 #include <SharedUtil.h>
 
@@ -827,3 +830,95 @@ void OctreeTests::elementAddChildTests() {
         }
     }
 }
+
+// children are stored packed, every subset of them must be found at its index, in and out of order
+void OctreeTests::elementChildSubsetTests() {
+    EntityTreePointer tree = std::make_shared<EntityTree>();
+    const int MAX_CHILD_INDEX = 8;
+    const int NUM_SUBSETS = 1 << MAX_CHILD_INDEX;
+    for (int subset = 0; subset < NUM_SUBSETS; subset++) {
+        auto e = tree->createNewElement();
+        OctreeElementPointer children[MAX_CHILD_INDEX];
+
+        // add the children from the last index to the first, so each one shifts the others
+        for (int i = MAX_CHILD_INDEX - 1; i >= 0; i--) {
+            if (subset & (1 << i)) {
+                children[i] = e->addChildAtIndex(i);
+            }
+        }
+        for (int i = 0; i < MAX_CHILD_INDEX; i++) {
+            QCOMPARE(e->getChildAtIndex(i), children[i]);
+        }
+        QCOMPARE(e->getChildCount(), numberOfOnes((unsigned char)subset));
+
+        // remove every other child, then the rest
+        for (int pass = 0; pass < 2; pass++) {
+            for (int i = pass; i < MAX_CHILD_INDEX; i += 2) {
+                if (children[i]) {
+                    QCOMPARE(e->removeChildAtIndex(i), children[i]);
+                    children[i].reset();
+                }
+            }
+            for (int i = 0; i < MAX_CHILD_INDEX; i++) {
+                QCOMPARE(e->getChildAtIndex(i), children[i]);
+            }
+        }
+        QVERIFY(e->isLeaf());
+    }
+}
+
+static void addChildrenToDepth(OctreeElementPointer element, int depth) {
+    if (depth == 0) {
+        return;
+    }
+    for (int i = 0; i < NUMBER_OF_CHILDREN; i++) {
+        addChildrenToDepth(element->addChildAtIndex(i), depth - 1);
+    }
+}
+
+static bool countElementOperation(OctreeElementPointer element, void* extraData) {
+    (*static_cast<int*>(extraData))++;
+    return true;
+}
+
+static QString processMemoryDescription() {
+    MemoryInfo info;
+    if (!getMemoryInfo(info)) {
+        return "unknown";
+    }
+    return QString("%1 MB").arg((double)info.processUsedMemoryBytes / MB_TO_BYTES(1), 0, 'f', 1);
+}
+
+// a pruned tree gives its chunks back, and the traversal time of a full tree is reported alongside the memory
+void OctreeTests::elementPoolReleaseTests() {
+    auto& pool = OctreeElementPool<sizeof(EntityTreeElement)>::getInstance();
+    const size_t chunksBefore = pool.getChunkCount();
+    qDebug() << "process memory before building:" << processMemoryDescription() << "pool chunks:" << chunksBefore;
+
+    const int DEPTH = 5;
+    const int EXPECTED_ELEMENTS = (1 << (3 * (DEPTH + 1))) / 7; // 1 + 8 + ... + 8^DEPTH
+    EntityTreePointer tree = std::make_shared<EntityTree>();
+    tree->createRootElement();
+    addChildrenToDepth(tree->getRoot(), DEPTH);
+    const size_t chunksBuilt = pool.getChunkCount();
+    QVERIFY(chunksBuilt > chunksBefore + 1);
+    qDebug() << "process memory after building" << EXPECTED_ELEMENTS << "elements:" << processMemoryDescription()
+        << "pool chunks:" << chunksBuilt << "reserved bytes:" << pool.getReservedBytes();
+
+    const int TRAVERSALS = 10;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < TRAVERSALS; i++) {
+        int elementCount = 0;
+        tree->recurseTreeWithOperation(countElementOperation, &elementCount);
+        QCOMPARE(elementCount, EXPECTED_ELEMENTS);
+    }
+    qDebug() << "traversal:" << (double)timer.nsecsElapsed() / (TRAVERSALS * NSECS_PER_MSEC) << "ms";
+
+    // the elements hold their tree, erase them to break the cycle
+    tree->eraseAllOctreeElements(false);
+    tree.reset();
+    const size_t chunksAfter = pool.getChunkCount();
+    qDebug() << "process memory after erasing:" << processMemoryDescription() << "pool chunks:" << chunksAfter;
+    QVERIFY(chunksAfter <= chunksBefore + 1);
+}
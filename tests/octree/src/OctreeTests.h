@@ -26,6 +26,8 @@ private slots:
     void modelItemTests();
 
     void elementAddChildTests();
+    void elementChildSubsetTests();
+    void elementPoolReleaseTests();
 
     // TODO: Break these into separate test functions
 };
@@ -10,6 +10,8 @@
 //
 
 #include <iostream>
+#include <ShapeDiskCache.h>
+#include <ShapeFactory.h>
 #include <ShapeManager.h>
 #include <StreamUtils.h>
 #include <Extents.h>
@@ -243,3 +245,147 @@ void ShapeManagerTests::addCompoundShape() {
     QCOMPARE(shapeManager.getNumShapes(), 0);
     QCOMPARE(shapeManager.getNumReferences(info), 0);
 }
+
+// a bumpy grid of (size + 1)^2 points and 2 * size^2 triangles
+static ShapeInfo makeStaticMeshInfo(int size) {
+    ShapeInfo::PointList points;
+    Extents extents;
+    for (int i = 0; i <= size; ++i) {
+        for (int j = 0; j <= size; ++j) {
+            glm::vec3 point((float)i, 0.1f * sinf((float)(i * j)), (float)j);
+            points.push_back(point);
+            extents.addPoint(point);
+        }
+    }
+    ShapeInfo info;
+    info.setPointCollection(ShapeInfo::PointCollection() << points);
+    info.setParams(SHAPE_TYPE_STATIC_MESH, 0.5f * (extents.maximum - extents.minimum));
+    ShapeInfo::TriangleIndices& indices = info.getTriangleIndices();
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            int corner = i * (size + 1) + j;
+            indices << corner << corner + 1 << corner + size + 1;
+            indices << corner + 1 << corner + size + 2 << corner + size + 1;
+        }
+    }
+    return info;
+}
+
+static ShapeInfo makeCompoundInfo(int numHulls) {
+    ShapeInfo::PointCollection pointCollection;
+    Extents extents;
+    for (int i = 0; i < numHulls; ++i) {
+        ShapeInfo::PointList pointList;
+        for (int j = 0; j < 8; ++j) {
+            glm::vec3 point = glm::vec3((float)(j & 1), (float)((j >> 1) & 1), (float)((j >> 2) & 1)) + (float)i;
+            pointList.push_back(point);
+            extents.addPoint(point);
+        }
+        pointCollection.push_back(pointList);
+    }
+    ShapeInfo info;
+    info.setParams(SHAPE_TYPE_COMPOUND, 0.5f * (extents.maximum - extents.minimum));
+    info.setPointCollection(pointCollection);
+    return info;
+}
+
+static void compareAabbs(const btCollisionShape* shape, const btCollisionShape* otherShape) {
+    btTransform identity;
+    identity.setIdentity();
+    btVector3 minimum, maximum, otherMinimum, otherMaximum;
+    shape->getAabb(identity, minimum, maximum);
+    otherShape->getAabb(identity, otherMinimum, otherMaximum);
+    QCOMPARE(otherMinimum, minimum);
+    QCOMPARE(otherMaximum, maximum);
+}
+
+void ShapeManagerTests::requestBoxShape() {
+    ShapeInfo info;
+    info.setBox(glm::vec3(1.0f));
+
+    // cheap shapes are built right away
+    ShapeManager shapeManager;
+    const btCollisionShape* shape = shapeManager.requestShape(info);
+    QVERIFY(shape != nullptr);
+    QCOMPARE(shapeManager.getNumReferences(info), 1);
+}
+
+void ShapeManagerTests::requestStaticMeshShape() {
+    ShapeInfo info = makeStaticMeshInfo(50);
+
+    ShapeManager shapeManager;
+    const btCollisionShape* shape = shapeManager.requestShape(info);
+    QElapsedTimer timer;
+    timer.start();
+    const qint64 BUILD_TIMEOUT = 10000; // msec
+    while (!shape && timer.elapsed() < BUILD_TIMEOUT) {
+        QThread::msleep(1);
+        shape = shapeManager.requestShape(info);
+    }
+    QVERIFY(shape != nullptr);
+    QCOMPARE(shape->getShapeType(), (int)TRIANGLE_MESH_SHAPE_PROXYTYPE);
+
+    // only the request that got the shape holds a reference
+    QCOMPARE(shapeManager.getNumShapes(), 1);
+    QCOMPARE(shapeManager.getNumReferences(info), 1);
+    QCOMPARE(shapeManager.getShape(info), shape);
+    QCOMPARE(shapeManager.getNumReferences(info), 2);
+}
+
+void ShapeManagerTests::cacheStaticMeshShape() {
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    ShapeDiskCache cache(directory.path());
+
+    ShapeInfo info = makeStaticMeshInfo(50);
+    QVERIFY(cache.loadShape(info) == nullptr);
+
+    const btCollisionShape* shape = ShapeFactory::createShapeFromInfo(info);
+    QVERIFY(cache.saveShape(info, shape));
+
+    const btCollisionShape* loadedShape = cache.loadShape(info);
+    QVERIFY(loadedShape != nullptr);
+    QCOMPARE(loadedShape->getShapeType(), (int)TRIANGLE_MESH_SHAPE_PROXYTYPE);
+    compareAabbs(shape, loadedShape);
+    auto bvh = const_cast<btBvhTriangleMeshShape*>(static_cast<const btBvhTriangleMeshShape*>(shape))->getOptimizedBvh();
+    auto loadedBvh = const_cast<btBvhTriangleMeshShape*>(static_cast<const btBvhTriangleMeshShape*>(loadedShape))->getOptimizedBvh();
+    QVERIFY(loadedBvh != nullptr);
+    QCOMPARE(loadedBvh->getQuantizedNodeArray().size(), bvh->getQuantizedNodeArray().size());
+
+    // nor does another mesh with the same hash
+    ShapeInfo otherInfo = info;
+    otherInfo.getTriangleIndices()[0] = otherInfo.getTriangleIndices()[1];
+    QCOMPARE(otherInfo.getHash().getHash(), info.getHash().getHash());
+    QVERIFY(cache.loadShape(otherInfo) == nullptr);
+
+    ShapeFactory::deleteShape(shape);
+    ShapeFactory::deleteShape(loadedShape);
+}
+
+void ShapeManagerTests::cacheCompoundShape() {
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    ShapeDiskCache cache(directory.path());
+
+    const int NUM_HULLS = 4;
+    ShapeInfo info = makeCompoundInfo(NUM_HULLS);
+    const btCollisionShape* shape = ShapeFactory::createShapeFromInfo(info);
+    QVERIFY(cache.saveShape(info, shape));
+
+    const btCollisionShape* loadedShape = cache.loadShape(info);
+    QVERIFY(loadedShape != nullptr);
+    QCOMPARE(loadedShape->getShapeType(), (int)COMPOUND_SHAPE_PROXYTYPE);
+    const btCompoundShape* compound = static_cast<const btCompoundShape*>(shape);
+    const btCompoundShape* loadedCompound = static_cast<const btCompoundShape*>(loadedShape);
+    QCOMPARE(loadedCompound->getNumChildShapes(), NUM_HULLS);
+    for (int i = 0; i < NUM_HULLS; ++i) {
+        const btConvexHullShape* hull = static_cast<const btConvexHullShape*>(compound->getChildShape(i));
+        const btConvexHullShape* loadedHull = static_cast<const btConvexHullShape*>(loadedCompound->getChildShape(i));
+        QCOMPARE(loadedHull->getNumPoints(), hull->getNumPoints());
+        QCOMPARE(loadedHull->getMargin(), hull->getMargin());
+    }
+    compareAabbs(shape, loadedShape);
+
+    ShapeFactory::deleteShape(shape);
+    ShapeFactory::deleteShape(loadedShape);
+}
@@ -25,6 +25,10 @@ private slots:
     void addCylinderShape();
     void addCapsuleShape();
     void addCompoundShape();
+    void requestBoxShape();
+    void requestStaticMeshShape();
+    void cacheStaticMeshShape();
+    void cacheCompoundShape();
 };
 
 #endif // hifi_ShapeManagerTests_h
@@ -79,6 +79,47 @@ void testFilePersist() {
     QVERIFY(readClip->duration() == 5.0f);
 }
 
+void testIndexedFilePersist() {
+    QTemporaryFile file;
+    QString fileName;
+    if (file.open()) {
+        fileName = file.fileName();
+        file.close();
+    }
+
+    // enough frames for several blocks, with same sized payloads stored as deltas
+    auto writeClip = Clip::newClip();
+    const int FRAME_COUNT = 200;
+    for (int i = 0; i < FRAME_COUNT; ++i) {
+        QByteArray data(64, (char)(i / 10));
+        data[0] = (char)i;
+        writeClip->addFrame(std::make_shared<Frame>(TEST_FRAME_TYPE, (float)i, i % 7 ? data : QByteArray(3, 'x')));
+    }
+    QVERIFY(Clip::toIndexedFile(fileName, writeClip));
+
+    auto readClip = Clip::fromFile(fileName);
+    QVERIFY(readClip != Clip::Pointer());
+    QVERIFY(readClip->frameCount() == (size_t)FRAME_COUNT);
+    QVERIFY(readClip->duration() == writeClip->duration());
+
+    readClip->seek(0);
+    writeClip->seek(0);
+    for (auto readFrame = readClip->nextFrame(), writeFrame = writeClip->nextFrame(); readFrame && writeFrame;
+        readFrame = readClip->nextFrame(), writeFrame = writeClip->nextFrame()) {
+        QVERIFY(readFrame->type == writeFrame->type);
+        QVERIFY(readFrame->timeOffset == writeFrame->timeOffset);
+        QVERIFY(readFrame->data == writeFrame->data);
+    }
+
+    // random access lands on the same frames as the source
+    for (Frame::Time position : { 150u, 3u, 64u, 199u }) {
+        readClip->seekFrameTime(position);
+        writeClip->seekFrameTime(position);
+        QVERIFY(readClip->positionFrameTime() == writeClip->positionFrameTime());
+        QVERIFY(readClip->peekFrame()->data == writeClip->peekFrame()->data);
+    }
+}
+
 void testClipOrdering() {
     auto writeClip = Clip::newClip();
     // simulate our of order addition of frames
@@ -110,5 +151,6 @@ int main(int, const char**) {
 #endif
     testFrameTypeRegistration();
     testFilePersist();
+    testIndexedFilePersist();
     testClipOrdering();
 }
\ No newline at end of file
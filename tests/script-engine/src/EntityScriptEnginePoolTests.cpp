@@ -0,0 +1,154 @@
+//
+//  EntityScriptEnginePoolTests.cpp
+//  tests/script-engine/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityScriptEnginePoolTests.h"
+
+#include <algorithm>
+#include <set>
+
+#include <DependencyManager.h>
+#include <EntityScriptEnginePool.h>
+#include <ScriptEngines.h>
+
+QTEST_MAIN(EntityScriptEnginePoolTests)
+
+using EnginePointer = EntityScriptEnginePool::EnginePointer;
+
+// engines that are never run, so their frames are only the ones the tests emit
+static std::vector<EnginePointer> createEngines(int count) {
+    std::vector<EnginePointer> engines;
+    for (int i = 0; i < count; i++) {
+        engines.push_back(EnginePointer(new ScriptEngine(ScriptEngine::ENTITY_SERVER_SCRIPT, NO_SCRIPT,
+                                                         QString("about:Entities %1").arg(i + 1))));
+    }
+    return engines;
+}
+
+static int indexOf(const std::vector<EnginePointer>& engines, const EnginePointer& engine) {
+    auto it = std::find(engines.begin(), engines.end(), engine);
+    return it != engines.end() ? (int)(it - engines.begin()) : -1;
+}
+
+void EntityScriptEnginePoolTests::initTestCase() {
+    DependencyManager::set<ScriptEngines>(ScriptEngine::ENTITY_SERVER_SCRIPT);
+}
+
+void EntityScriptEnginePoolTests::cleanupTestCase() {
+    DependencyManager::destroy<ScriptEngines>();
+}
+
+void EntityScriptEnginePoolTests::assignKeepsEngine() {
+    EntityScriptEnginePool pool;
+    QVERIFY(pool.isEmpty());
+    QVERIFY(pool.assign(QUuid::createUuid(), QString()).isNull());
+
+    auto engines = createEngines(4);
+    pool.setEngines(engines);
+    QVERIFY(!pool.isEmpty());
+
+    EntityItemID entityID = QUuid::createUuid();
+    QVERIFY(pool.find(entityID).isNull());
+    auto engine = pool.assign(entityID, QString());
+    QVERIFY(indexOf(engines, engine) >= 0);
+    QCOMPARE(pool.find(entityID), engine);
+
+    // an assignment outlives a change of script group, reloading the script is what moves it
+    QCOMPARE(pool.assign(entityID, "group"), engine);
+    QCOMPARE(pool.getAssignedEntities(), QList<QUuid>({ entityID }));
+}
+
+void EntityScriptEnginePoolTests::scriptGroupSharesEngine() {
+    EntityScriptEnginePool pool;
+    auto engines = createEngines(4);
+    pool.setEngines(engines);
+
+    const int NUM_ENTITIES = 32;
+    auto engine = pool.assign(QUuid::createUuid(), "group");
+    std::set<int> ungroupedEngines;
+    for (int i = 0; i < NUM_ENTITIES; i++) {
+        QCOMPARE(pool.assign(QUuid::createUuid(), "group"), engine);
+        ungroupedEngines.insert(indexOf(engines, pool.assign(QUuid::createUuid(), QString())));
+    }
+    // entities without a group are spread by their ID
+    QVERIFY(ungroupedEngines.size() > 1);
+    QCOMPARE(pool.getAssignedEntities().size(), 2 * NUM_ENTITIES + 1);
+}
+
+void EntityScriptEnginePoolTests::releaseForgetsEngine() {
+    EntityScriptEnginePool pool;
+    pool.setEngines(createEngines(2));
+
+    EntityItemID entityID = QUuid::createUuid();
+    pool.assign(entityID, QString());
+    pool.release(entityID);
+    QVERIFY(pool.find(entityID).isNull());
+    QVERIFY(pool.getAssignedEntities().isEmpty());
+}
+
+void EntityScriptEnginePoolTests::setEnginesForgetsAssignments() {
+    EntityScriptEnginePool pool;
+    pool.setEngines(createEngines(2));
+
+    EntityItemID entityID = QUuid::createUuid();
+    pool.assign(entityID, QString());
+
+    auto engines = createEngines(3);
+    pool.setEngines(engines);
+    QVERIFY(pool.find(entityID).isNull());
+    QVERIFY(pool.getAssignedEntities().isEmpty());
+    QCOMPARE(pool.getEngines(), engines);
+}
+
+void EntityScriptEnginePoolTests::statsCountAssignments() {
+    EntityScriptEnginePool pool;
+    auto engines = createEngines(3);
+    pool.setEngines(engines);
+
+    std::vector<int> assigned(engines.size(), 0);
+    for (int i = 0; i < 20; i++) {
+        assigned[indexOf(engines, pool.assign(QUuid::createUuid(), QString()))]++;
+    }
+
+    auto stats = pool.takeStats();
+    QCOMPARE(stats.size(), engines.size());
+    for (size_t i = 0; i < engines.size(); i++) {
+        QCOMPARE(stats[i].assignedEntities, assigned[i]);
+        QCOMPARE(stats[i].runningScripts, 0);
+        QCOMPARE(stats[i].timers, 0);
+    }
+}
+
+void EntityScriptEnginePoolTests::statsAverageBusyTime() {
+    EntityScriptEnginePool pool;
+    auto engines = createEngines(2);
+    pool.setEngines(engines);
+
+    emit engines[0]->frameFinished(2000);
+    emit engines[0]->frameFinished(4000);
+    // a frame's update gets the time since the last one, sleep included, it doesn't count
+    emit engines[0]->update(1.0f);
+
+    auto stats = pool.takeStats();
+    QCOMPARE(stats[0].averageFrameMsecs, 3.0f);
+    QCOMPARE(stats[1].averageFrameMsecs, 0.0f);
+
+    // taking the stats starts the next period
+    emit engines[1]->frameFinished(500);
+    stats = pool.takeStats();
+    QCOMPARE(stats[0].averageFrameMsecs, 0.0f);
+    QCOMPARE(stats[1].averageFrameMsecs, 0.5f);
+
+    // the frames of engines that were replaced aren't counted anymore
+    pool.setEngines(createEngines(1));
+    emit engines[0]->frameFinished(1000);
+    stats = pool.takeStats();
+    QCOMPARE(stats.size(), (size_t)1);
+    QCOMPARE(stats[0].averageFrameMsecs, 0.0f);
+}
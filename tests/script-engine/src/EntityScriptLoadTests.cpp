@@ -0,0 +1,119 @@
+//
+//  EntityScriptLoadTests.cpp
+//  tests/script-engine/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "EntityScriptLoadTests.h"
+
+#include <DependencyManager.h>
+#include <EntityScriptProgramCache.h>
+#include <ScriptEngine.h>
+#include <ScriptEngines.h>
+
+QTEST_MAIN(EntityScriptLoadTests)
+
+// Feeds the entity scripts straight to the engine, as the script cache does once it has their contents
+class TestScriptEngine : public ScriptEngine {
+public:
+    TestScriptEngine() : ScriptEngine(ScriptEngine::ENTITY_SERVER_SCRIPT, NO_SCRIPT, "about:EntityScriptLoadTests") {}
+
+    void loadContents(const EntityItemID& entityID, const QString& contents) {
+        entityScriptContentAvailable(entityID, contents, contents, false, true, "OK");
+    }
+};
+
+// The usual entity script pattern: the instance is kept in a variable of the function enclosing the constructor
+static const QString CLOSURE_SCRIPT {
+    "(function() {\n"
+    "    var _this;\n"
+    "    function Entity() {\n"
+    "        _this = this;\n"
+    "    }\n"
+    "    Entity.prototype = {\n"
+    "        preload: function(entityID) {\n"
+    "            _this.entityID = entityID;\n"
+    "        },\n"
+    "        getEntityID: function() {\n"
+    "            return _this.entityID;\n"
+    "        },\n"
+    "        getOwnEntityID: function() {\n"
+    "            return this.entityID;\n"
+    "        }\n"
+    "    };\n"
+    "    return Entity;\n"
+    "})"
+};
+
+static QScriptValue callScriptMethod(ScriptEngine& engine, const EntityItemID& entityID, const QString& methodName) {
+    EntityScriptDetails details;
+    if (!engine.getEntityScriptDetails(entityID, details)) {
+        return QScriptValue();
+    }
+    return details.scriptObject.property(methodName).call(details.scriptObject);
+}
+
+static int countInstances(const QString& fileName) {
+    return EntityScriptProgramCache::instance().getStats()[fileName].toObject()["instances"].toInt();
+}
+
+void EntityScriptLoadTests::initTestCase() {
+    DependencyManager::set<ScriptEngines>(ScriptEngine::ENTITY_SERVER_SCRIPT);
+}
+
+void EntityScriptLoadTests::cleanupTestCase() {
+    DependencyManager::destroy<ScriptEngines>();
+}
+
+void EntityScriptLoadTests::closureIsPerEntity() {
+    TestScriptEngine engine;
+    EntityItemID first = QUuid::createUuid();
+    EntityItemID second = QUuid::createUuid();
+    engine.loadContents(first, CLOSURE_SCRIPT);
+    engine.loadContents(second, CLOSURE_SCRIPT);
+    QVERIFY(engine.isEntityScriptRunning(first));
+    QVERIFY(engine.isEntityScriptRunning(second));
+
+    // each entity sees its own instance through _this, loading the second one didn't take over the first one's
+    QString firstID = callScriptMethod(engine, first, "getOwnEntityID").toString();
+    QString secondID = callScriptMethod(engine, second, "getOwnEntityID").toString();
+    QVERIFY(!firstID.isEmpty());
+    QVERIFY(firstID != secondID);
+    QCOMPARE(callScriptMethod(engine, first, "getEntityID").toString(), firstID);
+    QCOMPARE(callScriptMethod(engine, second, "getEntityID").toString(), secondID);
+
+    engine.unloadEntityScript(first, true);
+    engine.unloadEntityScript(second, true);
+}
+
+void EntityScriptLoadTests::instancesAreCounted() {
+    const QString EMBEDDED_FILE_NAME { "about:EmbeddedEntityScript" };
+    TestScriptEngine engine;
+    EntityItemID first = QUuid::createUuid();
+    EntityItemID second = QUuid::createUuid();
+    engine.loadContents(first, CLOSURE_SCRIPT);
+    engine.loadContents(second, CLOSURE_SCRIPT);
+    QCOMPARE(countInstances(EMBEDDED_FILE_NAME), 2);
+
+    engine.unloadEntityScript(first, true);
+    QCOMPARE(countInstances(EMBEDDED_FILE_NAME), 1);
+    // the script is forgotten with its last instance
+    engine.unloadEntityScript(second, true);
+    QVERIFY(!EntityScriptProgramCache::instance().getStats().contains(EMBEDDED_FILE_NAME));
+}
+
+void EntityScriptLoadTests::badScriptFailsEveryEntity() {
+    const QString BAD_SCRIPT { "(function() { return 1; }" };
+    TestScriptEngine engine;
+    for (int i = 0; i < 2; i++) {
+        EntityItemID entityID = QUuid::createUuid();
+        engine.loadContents(entityID, BAD_SCRIPT);
+        EntityScriptDetails details;
+        QVERIFY(engine.getEntityScriptDetails(entityID, details));
+        QCOMPARE((int)details.status, (int)EntityScriptStatus::ERROR_RUNNING_SCRIPT);
+    }
+}
@@ -0,0 +1,27 @@
+//
+//  EntityScriptLoadTests.h
+//  tests/script-engine/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_EntityScriptLoadTests_h
+#define hifi_EntityScriptLoadTests_h
+
+#include <QtTest/QtTest>
+
+class EntityScriptLoadTests : public QObject {
+    Q_OBJECT
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+
+    void closureIsPerEntity();
+    void instancesAreCounted();
+    void badScriptFailsEveryEntity();
+};
+
+#endif // hifi_EntityScriptLoadTests_h
@@ -0,0 +1,103 @@
+//
+//  MetricsRegistryTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "MetricsRegistryTests.h"
+
+#include <limits>
+#include <thread>
+#include <vector>
+
+#include <MetricsRegistry.h>
+
+QTEST_MAIN(MetricsRegistryTests)
+
+using Histogram = MetricsRegistry::Histogram;
+
+void MetricsRegistryTests::testHistogramBuckets() {
+    // every value falls in a bucket whose upper bound is within 1/16th above it
+    for (uint64_t value = 0; value < 100000; value++) {
+        int bucket = Histogram::getBucket(value);
+        QVERIFY(bucket >= 0 && bucket < Histogram::NUM_BUCKETS);
+        uint64_t upperBound = Histogram::getBucketUpperBound(bucket);
+        QVERIFY(upperBound >= value);
+        QVERIFY(upperBound - value <= value / Histogram::SUB_BUCKETS);
+        if (bucket > 0) {
+            QVERIFY(Histogram::getBucketUpperBound(bucket - 1) < value);
+        }
+    }
+    QCOMPARE(Histogram::getBucket(std::numeric_limits<uint64_t>::max()), Histogram::NUM_BUCKETS - 1);
+}
+
+void MetricsRegistryTests::testHistogramPercentiles() {
+    Histogram histogram;
+    QCOMPARE(histogram.getSnapshot().getPercentile(0.5), (uint64_t)0);
+
+    for (uint64_t value = 1; value <= 1000; value++) {
+        histogram.record(value);
+    }
+    auto snapshot = histogram.getSnapshot();
+    QCOMPARE(snapshot.count, (uint64_t)1000);
+    QCOMPARE(snapshot.sum, (uint64_t)500500);
+
+    uint64_t median = snapshot.getPercentile(0.5);
+    QVERIFY(median >= 500 && median <= 500 + 500 / Histogram::SUB_BUCKETS);
+    uint64_t p99 = snapshot.getPercentile(0.99);
+    QVERIFY(p99 >= 990 && p99 <= 990 + 990 / Histogram::SUB_BUCKETS);
+}
+
+void MetricsRegistryTests::testCounterThreads() {
+    MetricsRegistry registry;
+    auto& counter = registry.getCounter("test_total", "test counter");
+    QCOMPARE(&registry.getCounter("test_total", "ignored"), &counter);
+
+    const int NUM_THREADS = 4;
+    const int INCREMENTS_PER_THREAD = 100000;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < NUM_THREADS; i++) {
+        threads.emplace_back([&] {
+            for (int j = 0; j < INCREMENTS_PER_THREAD; j++) {
+                counter.add();
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    QCOMPARE(counter.get(), (uint64_t)(NUM_THREADS * INCREMENTS_PER_THREAD));
+}
+
+void MetricsRegistryTests::testPrometheusText() {
+    MetricsRegistry registry;
+    registry.getGauge("mixer.load %", "load").set(0.5);
+    registry.getHistogram("frame_usecs", "frame times").record(100);
+
+    QString text = registry.toPrometheusText();
+    QVERIFY(text.contains("# TYPE mixer_load_percent gauge\nmixer_load_percent 0.5\n"));
+    QVERIFY(text.contains("# HELP frame_usecs frame times\n# TYPE frame_usecs summary\n"));
+    QVERIFY(text.contains("frame_usecs{quantile=\"0.5\"} 103\n"));
+    QVERIFY(text.contains("frame_usecs_sum 100\nframe_usecs_count 1\n"));
+}
+
+void MetricsRegistryTests::testPublishStats() {
+    MetricsRegistry registry;
+    QJsonObject stats {
+        { "avg_frame_time", 3.0 },
+        { "is_throttling", true },
+        { "timing", QJsonObject { { "mix", 2.0 } } },
+        { QUuid::createUuid().toString(), QJsonObject { { "per_node", 1.0 } } }
+    };
+    registry.publishStats("audio-mixer", stats);
+
+    QString text = registry.toPrometheusText();
+    QVERIFY(text.contains("audio_mixer_avg_frame_time 3\n"));
+    QVERIFY(text.contains("audio_mixer_is_throttling 1\n"));
+    QVERIFY(text.contains("audio_mixer_timing_mix 2\n"));
+    QVERIFY(!text.contains("per_node"));
+}
@@ -0,0 +1,27 @@
+//
+//  MetricsRegistryTests.h
+//  tests/shared/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_MetricsRegistryTests_h
+#define hifi_MetricsRegistryTests_h
+
+#include <QtTest/QtTest>
+
+class MetricsRegistryTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testHistogramBuckets();
+    void testHistogramPercentiles();
+    void testCounterThreads();
+    void testPrometheusText();
+    void testPublishStats();
+};
+
+#endif // hifi_MetricsRegistryTests_h
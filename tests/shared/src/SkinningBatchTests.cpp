@@ -0,0 +1,129 @@
+//
+//  SkinningBatchTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "SkinningBatchTests.h"
+
+#include <vector>
+
+#include <glm/gtc/quaternion.hpp>
+#include <glm/gtx/transform.hpp>
+
+#include <SkinningBatch.h>
+
+QTEST_MAIN(SkinningBatchTests)
+
+// roughly an avatar: a skeleton driving a few skinned meshes
+static const int JOINTS_PER_RIG = 100;
+static const int CLUSTERS_PER_RIG = 120;
+
+class SyntheticRig {
+public:
+    explicit SyntheticRig(int seed) {
+        for (int i = 0; i < JOINTS_PER_RIG; i++) {
+            float angle = (float)(seed * JOINTS_PER_RIG + i) * 0.01f;
+            glm::quat rotation = glm::angleAxis(angle, glm::normalize(glm::vec3(1.0f, (float)i, (float)seed)));
+            jointTransforms.push_back(glm::translate(glm::vec3((float)i, angle, -angle)) * glm::mat4_cast(rotation));
+        }
+        for (int i = 0; i < CLUSTERS_PER_RIG; i++) {
+            clusterJoints.push_back((i * 7) % JOINTS_PER_RIG);
+            inverseBindMatrices.push_back(glm::inverse(jointTransforms[clusterJoints.back()]) *
+                glm::scale(glm::vec3(1.0f + (float)i * 0.001f)));
+        }
+        clusterMatrices.resize(CLUSTERS_PER_RIG);
+    }
+
+    void addTo(SkinningBatch& batch) {
+        for (int i = 0; i < CLUSTERS_PER_RIG; i++) {
+            batch.add(jointTransforms[clusterJoints[i]], inverseBindMatrices[i], &clusterMatrices[i]);
+        }
+    }
+
+    std::vector<glm::mat4> jointTransforms;
+    std::vector<int> clusterJoints;
+    std::vector<glm::mat4> inverseBindMatrices;
+    std::vector<glm::mat4> clusterMatrices;
+};
+
+static std::vector<SyntheticRig> makeCrowd(int size) {
+    std::vector<SyntheticRig> crowd;
+    for (int i = 0; i < size; i++) {
+        crowd.emplace_back(i);
+    }
+    return crowd;
+}
+
+void SkinningBatchTests::testCompute() {
+    // enough clusters to be split in chunks
+    auto crowd = makeCrowd(50);
+    SkinningBatch batch;
+    for (auto& rig : crowd) {
+        rig.addTo(batch);
+    }
+    QVERIFY(batch.size() > 2 * SkinningBatch::MATRICES_PER_CHUNK);
+    batch.compute();
+
+    const float EPSILON = 1.0e-4f;
+    for (auto& rig : crowd) {
+        for (int i = 0; i < CLUSTERS_PER_RIG; i++) {
+            glm::mat4 expected = rig.jointTransforms[rig.clusterJoints[i]] * rig.inverseBindMatrices[i];
+            for (int column = 0; column < 4; column++) {
+                glm::vec4 difference = glm::abs(rig.clusterMatrices[i][column] - expected[column]);
+                QVERIFY(glm::all(glm::lessThan(difference, glm::vec4(EPSILON))));
+            }
+        }
+    }
+}
+
+void SkinningBatchTests::testEmpty() {
+    SkinningBatch batch;
+    batch.compute();
+    QCOMPARE(batch.size(), (size_t)0);
+}
+
+static void addCrowdSizes() {
+    QTest::addColumn<int>("crowdSize");
+    for (int size : { 1, 10, 100, 300 }) {
+        QTest::newRow(qPrintable(QString("%1 rigs").arg(size))) << size;
+    }
+}
+
+void SkinningBatchTests::benchmarkPerModel_data() {
+    addCrowdSizes();
+}
+
+// what every model computing its own matrices costs
+void SkinningBatchTests::benchmarkPerModel() {
+    QFETCH(int, crowdSize);
+    auto crowd = makeCrowd(crowdSize);
+    QBENCHMARK {
+        for (auto& rig : crowd) {
+            SkinningBatch batch;
+            rig.addTo(batch);
+            batch.computeSerially();
+        }
+    }
+}
+
+void SkinningBatchTests::benchmarkBatched_data() {
+    addCrowdSizes();
+}
+
+void SkinningBatchTests::benchmarkBatched() {
+    QFETCH(int, crowdSize);
+    auto crowd = makeCrowd(crowdSize);
+    SkinningBatch batch;
+    QBENCHMARK {
+        batch.clear();
+        for (auto& rig : crowd) {
+            rig.addTo(batch);
+        }
+        batch.compute();
+    }
+}
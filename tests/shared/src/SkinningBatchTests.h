@@ -0,0 +1,28 @@
+//
+//  SkinningBatchTests.h
+//  tests/shared/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_SkinningBatchTests_h
+#define hifi_SkinningBatchTests_h
+
+#include <QtTest/QtTest>
+
+class SkinningBatchTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testCompute();
+    void testEmpty();
+    void benchmarkPerModel_data();
+    void benchmarkPerModel();
+    void benchmarkBatched_data();
+    void benchmarkBatched();
+};
+
+#endif // hifi_SkinningBatchTests_h
@@ -0,0 +1,206 @@
+//
+//  SpatiallyNestableTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "SpatiallyNestableTests.h"
+
+#include <vector>
+
+#include <DependencyManager.h>
+#include <SpatialParentFinder.h>
+#include <SpatiallyNestable.h>
+
+#include <../QTestExtensions.h>
+#include <../GLMTestUtils.h>
+
+QTEST_MAIN(SpatiallyNestableTests)
+
+const float EPSILON = 0.0001f;
+
+// A nestable with joints, which move without telling the children hanging off them, like the ones of avatars
+class TestNestable : public SpatiallyNestable {
+public:
+    TestNestable() : SpatiallyNestable(NestableType::Entity, QUuid::createUuid()) {}
+
+    void setJoint(int index, const glm::quat& rotation, const glm::vec3& translation) {
+        if (index >= (int)_jointRotations.size()) {
+            _jointRotations.resize(index + 1);
+            _jointTranslations.resize(index + 1);
+        }
+        _jointRotations[index] = rotation;
+        _jointTranslations[index] = translation;
+    }
+
+    glm::quat getAbsoluteJointRotationInObjectFrame(int index) const override {
+        return index < (int)_jointRotations.size() ? _jointRotations[index] : glm::quat();
+    }
+    glm::vec3 getAbsoluteJointTranslationInObjectFrame(int index) const override {
+        return index < (int)_jointTranslations.size() ? _jointTranslations[index] : glm::vec3();
+    }
+
+private:
+    std::vector<glm::quat> _jointRotations;
+    std::vector<glm::vec3> _jointTranslations;
+};
+
+using TestNestablePointer = std::shared_ptr<TestNestable>;
+
+class TestParentFinder : public SpatialParentFinder {
+public:
+    void add(const SpatiallyNestablePointer& nestable) { _nestables[nestable->getID()] = nestable; }
+
+    SpatiallyNestableWeakPointer find(QUuid parentID, bool& success,
+                                      SpatialParentTree* entityTree = nullptr) const override {
+        auto it = _nestables.find(parentID);
+        success = it != _nestables.end();
+        return success ? it.value() : SpatiallyNestableWeakPointer();
+    }
+
+private:
+    QHash<QUuid, SpatiallyNestableWeakPointer> _nestables;
+};
+
+static TestNestablePointer createNestable(const glm::vec3& position, const glm::quat& orientation,
+                                          const TestNestablePointer& parent = TestNestablePointer()) {
+    auto nestable = std::make_shared<TestNestable>();
+    DependencyManager::get<TestParentFinder>()->add(nestable);
+    if (parent) {
+        nestable->setParentID(parent->getID());
+    }
+    nestable->setLocalPosition(position);
+    nestable->setLocalOrientation(orientation);
+    return nestable;
+}
+
+// the world transform, evaluated from the local transforms up the chain without any cache
+static Transform computeUncachedTransform(const SpatiallyNestable& nestable) {
+    Transform result = nestable.getLocalTransform();
+    QUuid parentID = nestable.getParentID();
+    if (parentID.isNull()) {
+        return result;
+    }
+    bool success;
+    auto parent = DependencyManager::get<TestParentFinder>()->find(parentID, success).lock();
+    Transform parentTransform = computeUncachedTransform(*parent);
+    parentTransform.setScale(1.0f);
+    if (nestable.getParentJointIndex() != INVALID_JOINT_INDEX) {
+        Transform jointTransform = parent->getAbsoluteJointTransformInObjectFrame(nestable.getParentJointIndex());
+        Transform::mult(parentTransform, Transform(parentTransform), jointTransform);
+        parentTransform.setScale(1.0f);
+    }
+    Transform::mult(result, parentTransform, Transform(result));
+    return result;
+}
+
+static void verifyTransform(const SpatiallyNestable& nestable) {
+    bool success = false;
+    Transform transform = nestable.getTransform(success);
+    QVERIFY(success);
+    QCOMPARE_WITH_ABS_ERROR(transform.getMatrix(), computeUncachedTransform(nestable).getMatrix(), EPSILON);
+}
+
+void SpatiallyNestableTests::initTestCase() {
+    DependencyManager::registerInheritance<SpatialParentFinder, TestParentFinder>();
+    DependencyManager::set<TestParentFinder>();
+}
+
+void SpatiallyNestableTests::cleanupTestCase() {
+    DependencyManager::destroy<TestParentFinder>();
+}
+
+void SpatiallyNestableTests::testParentMove() {
+    auto root = createNestable(glm::vec3(1.0f, 2.0f, 3.0f), glm::angleAxis(0.5f, glm::vec3(0.0f, 1.0f, 0.0f)));
+    auto child = createNestable(glm::vec3(0.0f, 1.0f, 0.0f), glm::angleAxis(0.3f, glm::vec3(1.0f, 0.0f, 0.0f)), root);
+    auto grandchild = createNestable(glm::vec3(2.0f, 0.0f, 0.0f), glm::quat(), child);
+    // the first evaluation fills the caches of the whole chain
+    verifyTransform(*grandchild);
+    verifyTransform(*grandchild);
+
+    root->setPosition(glm::vec3(-4.0f, 0.5f, 7.0f));
+    verifyTransform(*child);
+    verifyTransform(*grandchild);
+
+    root->setOrientation(glm::angleAxis(1.2f, glm::normalize(glm::vec3(1.0f, 1.0f, 0.0f))));
+    verifyTransform(*grandchild);
+
+    Transform rootTransform;
+    rootTransform.setTranslation(glm::vec3(3.0f, -1.0f, 0.0f));
+    rootTransform.setRotation(glm::angleAxis(-0.7f, glm::vec3(0.0f, 0.0f, 1.0f)));
+    root->setTransform(rootTransform);
+    verifyTransform(*grandchild);
+}
+
+void SpatiallyNestableTests::testReparent() {
+    auto first = createNestable(glm::vec3(1.0f, 0.0f, 0.0f), glm::angleAxis(0.5f, glm::vec3(0.0f, 1.0f, 0.0f)));
+    auto second = createNestable(glm::vec3(0.0f, 5.0f, 0.0f), glm::angleAxis(1.5f, glm::vec3(0.0f, 0.0f, 1.0f)));
+    auto child = createNestable(glm::vec3(0.0f, 0.0f, 2.0f), glm::quat(), first);
+    auto grandchild = createNestable(glm::vec3(1.0f, 1.0f, 0.0f), glm::quat(), child);
+    verifyTransform(*grandchild);
+
+    child->setParentID(second->getID());
+    verifyTransform(*child);
+    verifyTransform(*grandchild);
+
+    // the old parent moving no longer moves them
+    first->setPosition(glm::vec3(9.0f, 9.0f, 9.0f));
+    verifyTransform(*grandchild);
+
+    child->setParentID(QUuid());
+    verifyTransform(*grandchild);
+}
+
+void SpatiallyNestableTests::testJointParent() {
+    auto root = createNestable(glm::vec3(1.0f, 2.0f, 3.0f), glm::angleAxis(0.5f, glm::vec3(0.0f, 1.0f, 0.0f)));
+    auto avatar = createNestable(glm::vec3(0.0f, 0.0f, 1.0f), glm::quat(), root);
+    avatar->setJoint(0, glm::angleAxis(0.4f, glm::vec3(1.0f, 0.0f, 0.0f)), glm::vec3(0.0f, 1.0f, 0.0f));
+    avatar->setJoint(1, glm::angleAxis(-0.8f, glm::vec3(0.0f, 0.0f, 1.0f)), glm::vec3(0.5f, 1.5f, 0.0f));
+
+    auto held = createNestable(glm::vec3(0.0f, 0.0f, 0.3f), glm::quat(), avatar);
+    held->setParentJointIndex(0);
+    auto attachment = createNestable(glm::vec3(0.1f, 0.0f, 0.0f), glm::quat(), held);
+    verifyTransform(*attachment);
+
+    // the joint moves without notifying anyone
+    avatar->setJoint(0, glm::angleAxis(1.1f, glm::vec3(0.0f, 1.0f, 0.0f)), glm::vec3(0.2f, 0.8f, 0.0f));
+    verifyTransform(*held);
+    verifyTransform(*attachment);
+
+    held->setParentJointIndex(1);
+    verifyTransform(*attachment);
+
+    // and the parent of the joint moving still moves them
+    root->setPosition(glm::vec3(-2.0f, 0.0f, 4.0f));
+    verifyTransform(*attachment);
+
+    held->setParentJointIndex(INVALID_JOINT_INDEX);
+    verifyTransform(*attachment);
+}
+
+void SpatiallyNestableTests::testLocalEdit() {
+    auto root = createNestable(glm::vec3(1.0f, 2.0f, 3.0f), glm::angleAxis(0.5f, glm::vec3(0.0f, 1.0f, 0.0f)));
+    auto child = createNestable(glm::vec3(0.0f, 1.0f, 0.0f), glm::quat(), root);
+    auto grandchild = createNestable(glm::vec3(2.0f, 0.0f, 0.0f), glm::quat(), child);
+    verifyTransform(*grandchild);
+
+    child->setLocalPosition(glm::vec3(3.0f, 0.0f, -1.0f));
+    verifyTransform(*grandchild);
+
+    child->setLocalOrientation(glm::angleAxis(0.9f, glm::vec3(0.0f, 0.0f, 1.0f)));
+    verifyTransform(*grandchild);
+
+    Transform localTransform;
+    localTransform.setTranslation(glm::vec3(0.0f, -2.0f, 0.5f));
+    localTransform.setRotation(glm::angleAxis(-0.3f, glm::vec3(1.0f, 0.0f, 0.0f)));
+    child->setLocalTransform(localTransform);
+    verifyTransform(*child);
+    verifyTransform(*grandchild);
+
+    grandchild->setLocalPosition(glm::vec3(0.0f, 0.0f, 4.0f));
+    verifyTransform(*grandchild);
+}
@@ -0,0 +1,165 @@
+//
+//  TimerWheelTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "TimerWheelTests.h"
+
+#include <vector>
+
+#include <TimerWheel.h>
+
+QTEST_MAIN(TimerWheelTests)
+
+using TimerID = TimerWheel::TimerID;
+
+// an odd start so the slots wrap at different times than the delays
+static const quint64 START = 1234567;
+
+void TimerWheelTests::testOrdering() {
+    TimerWheel wheel(START);
+    TimerID late = wheel.add(START, 300);
+    TimerID early = wheel.add(START, 5);
+    TimerID middle = wheel.add(START, 40);
+    TimerID immediate = wheel.add(START, 0);
+
+    std::vector<TimerID> fired;
+    auto record = [&](TimerID timer, quint64) { fired.push_back(timer); };
+
+    wheel.advance(START + 4, record);
+    QCOMPARE(fired, std::vector<TimerID>({ immediate }));
+
+    wheel.advance(START + 1000, record);
+    QCOMPARE(fired, std::vector<TimerID>({ immediate, early, middle, late }));
+    QCOMPARE(wheel.size(), (size_t)0);
+}
+
+void TimerWheelTests::testCancel() {
+    TimerWheel wheel(START);
+    TimerID kept = wheel.add(START, 10);
+    TimerID cancelled = wheel.add(START, 10);
+    TimerID far = wheel.add(START, 100000);
+
+    QVERIFY(wheel.cancel(cancelled));
+    QVERIFY(!wheel.cancel(cancelled));
+    QVERIFY(wheel.cancel(far));
+    QCOMPARE(wheel.size(), (size_t)1);
+
+    std::vector<TimerID> fired;
+    wheel.advance(START + 200000, [&](TimerID timer, quint64) { fired.push_back(timer); });
+    QCOMPARE(fired, std::vector<TimerID>({ kept }));
+    QVERIFY(!wheel.cancel(kept));
+}
+
+void TimerWheelTests::testInterval() {
+    TimerWheel wheel(START);
+    TimerID timer = wheel.add(START, 10, 10);
+
+    int count = 0;
+    auto counter = [&](TimerID, quint64) { count++; };
+    for (quint64 now = START; now <= START + 100; now++) {
+        wheel.advance(now, counter);
+    }
+    QCOMPARE(count, 10);
+    QVERIFY(wheel.contains(timer));
+
+    // falling behind skips the missed periods rather than firing them all at once
+    quint64 lateness = 0;
+    wheel.advance(START + 1005, [&](TimerID, quint64 late) { count++; lateness = late; });
+    QCOMPARE(count, 11);
+    QCOMPARE(lateness, (quint64)895);
+    wheel.advance(START + 1014, counter);
+    QCOMPARE(count, 11);
+    wheel.advance(START + 1015, counter);
+    QCOMPARE(count, 12);
+}
+
+void TimerWheelTests::testLongDelays() {
+    TimerWheel wheel(START);
+    // on both sides of the level boundaries, so they cascade down one or more levels
+    std::vector<quint64> delays { 255, 256, 65535, 65536, 70000, 16777215, 16777216, 20000000 };
+    std::vector<TimerID> timers;
+    for (auto delay : delays) {
+        timers.push_back(wheel.add(START, delay));
+    }
+
+    // advanced in uneven steps, like a busy script loop, the due time is when it fired minus how late it was
+    std::vector<quint64> dueTimes(delays.size(), 0);
+    quint64 now = START;
+    while (wheel.size() > 0) {
+        now += 997;
+        wheel.advance(now, [&](TimerID timer, quint64 late) {
+            dueTimes[timer - timers[0]] = now - late;
+        });
+    }
+
+    for (size_t i = 0; i < delays.size(); i++) {
+        QCOMPARE(dueTimes[i], START + delays[i]);
+    }
+}
+
+void TimerWheelTests::testSlotBoundaries() {
+    // a start on a level 2 boundary, so the timers come due on the tick their level cascades
+    const quint64 start = START & ~(quint64)(TimerWheel::SLOTS * TimerWheel::SLOTS - 1);
+    TimerWheel wheel(start);
+    std::vector<quint64> delays { 256, 512, 65536, 131072, 16777216 };
+    std::vector<TimerID> timers;
+    for (auto delay : delays) {
+        timers.push_back(wheel.add(start, delay));
+    }
+
+    // one tick at a time around each due time, so a timer firing a tick late shows
+    std::vector<quint64> firedAt(delays.size(), 0);
+    std::vector<quint64> lateness(delays.size(), 0);
+    quint64 now = start;
+    auto record = [&](TimerID timer, quint64 late) {
+        firedAt[timer - timers[0]] = now;
+        lateness[timer - timers[0]] = late;
+    };
+    for (auto delay : delays) {
+        now = start + delay - 2;
+        wheel.advance(now, record);
+        for (int i = 0; i < 4; i++, now++) {
+            wheel.advance(now, record);
+        }
+    }
+
+    QCOMPARE(wheel.size(), (size_t)0);
+    for (size_t i = 0; i < delays.size(); i++) {
+        QCOMPARE(firedAt[i], start + delays[i]);
+        QCOMPARE(lateness[i], (quint64)0);
+    }
+}
+
+void TimerWheelTests::testChangesWhileFiring() {
+    TimerWheel wheel(START);
+    TimerID first = wheel.add(START, 10);
+    TimerID second = wheel.add(START, 10);
+    TimerID repeating = wheel.add(START, 10, 10);
+    TimerID added = 0;
+
+    std::vector<TimerID> fired;
+    wheel.advance(START + 10, [&](TimerID timer, quint64) {
+        fired.push_back(timer);
+        if (timer == first) {
+            // a single shot timer is already gone, a sibling due at the same time doesn't fire anymore
+            QVERIFY(!wheel.contains(first));
+            QVERIFY(wheel.cancel(second));
+            added = wheel.add(START + 10, 0);
+        } else if (timer == repeating) {
+            QVERIFY(wheel.cancel(repeating));
+        }
+    });
+    QCOMPARE(fired, std::vector<TimerID>({ first, repeating }));
+    QVERIFY(wheel.contains(added));
+    QVERIFY(!wheel.contains(repeating));
+
+    wheel.advance(START + 11, [&](TimerID timer, quint64) { fired.push_back(timer); });
+    QCOMPARE(fired, std::vector<TimerID>({ first, repeating, added }));
+    QCOMPARE(wheel.size(), (size_t)0);
+}
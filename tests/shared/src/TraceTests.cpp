@@ -8,7 +8,13 @@
 
 #include "TraceTests.h"
 
+#include <thread>
+
 #include <QtTest/QtTest>
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonDocument>
+#include <QtCore/QJsonObject>
+#include <QtCore/QTemporaryDir>
 #include <QtGui/QDesktopServices>
 
 #include <Profile.h>
@@ -21,6 +27,19 @@ Q_LOGGING_CATEGORY(trace_test, "trace.test")
 
 const QString OUTPUT_FILE = "traces/testTrace.json.gz";
 
+static QJsonArray serializeToJson(tracing::Tracer& tracer) {
+    QTemporaryDir directory;
+    QString path = directory.path() + "/trace" + tracing::Tracer::BINARY_EXTENSION;
+    tracer.serialize(path);
+
+    QFile file(path);
+    QByteArray json;
+    if (!file.open(QIODevice::ReadOnly) || !tracing::convertToJson(file.readAll(), json)) {
+        return QJsonArray();
+    }
+    return QJsonDocument::fromJson(json).array();
+}
+
 void TraceTests::testTraceSerialization() {
     auto tracer = DependencyManager::set<tracing::Tracer>();
     tracer->startTracing();
@@ -45,3 +64,84 @@ void TraceTests::testTraceSerialization() {
     qDebug() << "Done";
 }
 
+void TraceTests::testBinaryTraceConversion() {
+    auto tracer = DependencyManager::set<tracing::Tracer>();
+    tracer->startTracing();
+    tracer->traceDuration(trace_test(), "Duration", tracing::DurationBegin, 42);
+    tracing::traceEvent(trace_test(), "Counter", tracing::Counter, "", { { "value", 3 } });
+    tracing::traceEvent(trace_test(), "Async", tracing::AsyncNestableStart, "request-1", { { "url", "atp:/a.fbx" } });
+    std::thread([] {
+        tracing::traceEvent(trace_test(), "OtherThread", tracing::Instant);
+    }).join();
+    tracing::traceEvent(trace_test(), "Duration", tracing::DurationEnd);
+    tracer->stopTracing();
+
+    QTemporaryDir directory;
+    QString path = directory.path() + "/trace" + tracing::Tracer::BINARY_EXTENSION;
+    tracer->serialize(path);
+
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QByteArray json;
+    QVERIFY(tracing::convertToJson(file.readAll(), json));
+
+    QJsonArray events = QJsonDocument::fromJson(json).array();
+    QCOMPARE(events.size(), 5);
+    QMap<QString, QJsonObject> byName;
+    for (const auto& event : events) {
+        QJsonObject object = event.toObject();
+        QCOMPARE(object["cat"].toString(), QString("trace.test"));
+        byName.insertMulti(object["name"].toString(), object);
+    }
+    QCOMPARE(byName.values("Duration").size(), 2);
+    QCOMPARE(byName["Counter"]["args"].toObject()["value"].toInt(), 3);
+    QCOMPARE(byName["Async"]["id"].toString(), QString("request-1"));
+    QCOMPARE(byName["Async"]["args"].toObject()["url"].toString(), QString("atp:/a.fbx"));
+    QVERIFY(byName["OtherThread"]["tid"] != byName["Counter"]["tid"]);
+    QCOMPARE(tracer->getDroppedEventCount(), (quint64)0);
+}
+
+void TraceTests::testPayloadsOfSuccessiveThreads() {
+    auto tracer = DependencyManager::set<tracing::Tracer>();
+    tracer->startTracing();
+    // threads run one after the other are often given the ID of the previous one
+    const int NUM_THREADS = 8;
+    for (int i = 0; i < NUM_THREADS; i++) {
+        std::thread([i] {
+            tracing::traceEvent(trace_test(), QString("Thread%1").arg(i), tracing::Instant, "", { { "index", i } });
+        }).join();
+    }
+    tracer->stopTracing();
+
+    QJsonArray events = serializeToJson(*tracer);
+    QCOMPARE(events.size(), NUM_THREADS);
+    for (const auto& event : events) {
+        QJsonObject object = event.toObject();
+        int index = object["args"].toObject()["index"].toInt();
+        QCOMPARE(object["name"].toString(), QString("Thread%1").arg(index));
+    }
+}
+
+void TraceTests::testSerializeTakesEvents() {
+    auto tracer = DependencyManager::set<tracing::Tracer>();
+    tracer->startTracing();
+    tracing::traceEvent(trace_test(), "First", tracing::Instant, "", { { "capture", 1 } });
+    tracer->stopTracing();
+    QJsonArray events = serializeToJson(*tracer);
+    QCOMPARE(events.size(), 1);
+    QCOMPARE(events[0].toObject()["name"].toString(), QString("First"));
+
+    // nothing was recorded since
+    QCOMPARE(serializeToJson(*tracer).size(), 0);
+
+    // a new capture interns its strings again, ids cached by this thread for the previous one aren't reused
+    tracer->startTracing();
+    tracing::traceEvent(trace_test(), "Second", tracing::Instant, "", { { "capture", 2 } });
+    tracer->stopTracing();
+    events = serializeToJson(*tracer);
+    QCOMPARE(events.size(), 1);
+    QJsonObject second = events[0].toObject();
+    QCOMPARE(second["name"].toString(), QString("Second"));
+    QCOMPARE(second["cat"].toString(), QString("trace.test"));
+    QCOMPARE(second["args"].toObject()["capture"].toInt(), 2);
+}
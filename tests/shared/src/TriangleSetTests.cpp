@@ -0,0 +1,223 @@
+//
+//  TriangleSetTests.cpp
+//  tests/shared/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "TriangleSetTests.h"
+
+#include <vector>
+
+#include <GLMHelpers.h>
+#include <TriangleSet.h>
+
+QTEST_MAIN(TriangleSetTests)
+
+static const float RADIUS = 1.0f;
+
+// a bumpy sphere, tessellated in rings and segments, about 2 * rings * segments triangles
+static TriangleSet makeSphere(int rings, int segments) {
+    auto vertex = [&](int ring, int segment) {
+        float latitude = PI * (float)ring / (float)rings;
+        float longitude = TWO_PI * (float)segment / (float)segments;
+        float radius = RADIUS * (1.0f + 0.05f * sinf(7.0f * latitude) * cosf(5.0f * longitude));
+        return radius * glm::vec3(sinf(latitude) * cosf(longitude), cosf(latitude), sinf(latitude) * sinf(longitude));
+    };
+
+    TriangleSet triangleSet;
+    triangleSet.reserve(2 * rings * segments);
+    for (int ring = 0; ring < rings; ring++) {
+        for (int segment = 0; segment < segments; segment++) {
+            glm::vec3 v0 = vertex(ring, segment);
+            glm::vec3 v1 = vertex(ring + 1, segment);
+            glm::vec3 v2 = vertex(ring + 1, segment + 1);
+            glm::vec3 v3 = vertex(ring, segment + 1);
+            // wound to face outwards
+            triangleSet.insert({ v0, v2, v1 });
+            triangleSet.insert({ v0, v3, v2 });
+        }
+    }
+    return triangleSet;
+}
+
+// rays from around the sphere aimed near its center, some of them missing it
+static std::vector<TriangleSet::Ray> makeRays(int count) {
+    std::vector<TriangleSet::Ray> rays;
+    for (int i = 0; i < count; i++) {
+        float angle = (float)i * 2.39996f; // golden angle, spreads the origins
+        float height = 1.0f - 2.0f * ((float)i + 0.5f) / (float)count;
+        float ringRadius = sqrtf(1.0f - height * height);
+        glm::vec3 origin = 3.0f * RADIUS * glm::vec3(ringRadius * cosf(angle), height, ringRadius * sinf(angle));
+        glm::vec3 target = 1.2f * RADIUS * glm::vec3(sinf(3.0f * angle), cosf(5.0f * angle), sinf(angle) * cosf(angle));
+        rays.push_back({ origin, glm::normalize(target - origin) });
+    }
+    return rays;
+}
+
+// the linear search that the hierarchy replaces
+static bool findBruteForceIntersection(const TriangleSet& triangleSet, const TriangleSet::Ray& ray, float& distance) {
+    bool hit = false;
+    distance = std::numeric_limits<float>::max();
+    for (size_t i = 0; i < triangleSet.size(); i++) {
+        float triangleDistance;
+        if (findRayTriangleIntersection(ray.origin, ray.direction, triangleSet.getTriangle(i), triangleDistance) &&
+                triangleDistance < distance) {
+            distance = triangleDistance;
+            hit = true;
+        }
+    }
+    return hit;
+}
+
+void TriangleSetTests::testMatchesBruteForce() {
+    TriangleSet triangleSet = makeSphere(40, 80);
+    int numHits = 0;
+    for (const auto& ray : makeRays(2000)) {
+        float expectedDistance;
+        bool expectedHit = findBruteForceIntersection(triangleSet, ray, expectedDistance);
+
+        float distance = 0.0f;
+        BoxFace face;
+        glm::vec3 normal;
+        bool hit = triangleSet.findRayIntersection(ray.origin, ray.direction, distance, face, normal, true);
+        QCOMPARE(hit, expectedHit);
+        if (hit) {
+            QCOMPARE(distance, expectedDistance);
+            // the sphere is hit from the outside
+            QVERIFY(glm::dot(normal, ray.direction) < 0.0f);
+            numHits++;
+        }
+    }
+    // the rays are expected to both hit and miss
+    QVERIFY(numHits > 0 && numHits < 2000);
+}
+
+void TriangleSetTests::testBatchedRays() {
+    TriangleSet triangleSet = makeSphere(20, 40);
+    auto rays = makeRays(500);
+    std::vector<TriangleSet::RayHit> hits;
+    triangleSet.findRayIntersections(rays, hits);
+    QCOMPARE(hits.size(), rays.size());
+    for (size_t i = 0; i < rays.size(); i++) {
+        float distance = 0.0f;
+        BoxFace face;
+        glm::vec3 normal;
+        bool hit = triangleSet.findRayIntersection(rays[i].origin, rays[i].direction, distance, face, normal, true);
+        QCOMPARE(hits[i].hit, hit);
+        if (hit) {
+            QCOMPARE(hits[i].distance, distance);
+            QCOMPARE(hits[i].surfaceNormal, normal);
+        }
+    }
+}
+
+void TriangleSetTests::testInsertAfterPick() {
+    TriangleSet triangleSet = makeSphere(8, 16);
+    TriangleSet::Ray ray { glm::vec3(0.0f, 0.0f, 3.0f * RADIUS), glm::vec3(0.0f, 0.0f, -1.0f) };
+    float distance = 0.0f;
+    BoxFace face;
+    glm::vec3 normal;
+    QVERIFY(triangleSet.findRayIntersection(ray.origin, ray.direction, distance, face, normal, true));
+    float sphereDistance = distance;
+
+    // a triangle in front of the sphere must be found by the next pick
+    float wallZ = 2.0f * RADIUS;
+    triangleSet.insert({ glm::vec3(-1.0f, -1.0f, wallZ), glm::vec3(1.0f, -1.0f, wallZ), glm::vec3(0.0f, 1.0f, wallZ) });
+    QVERIFY(triangleSet.findRayIntersection(ray.origin, ray.direction, distance, face, normal, true));
+    QVERIFY(distance < sphereDistance);
+    QCOMPARE(distance, RADIUS);
+}
+
+void TriangleSetTests::testCopyAfterPick() {
+    TriangleSet triangleSet = makeSphere(20, 40);
+    auto rays = makeRays(200);
+    std::vector<TriangleSet::RayHit> hits;
+    triangleSet.findRayIntersections(rays, hits);
+
+    // the copy shares the hierarchy, which indexes the triangles of whichever set picks with it
+    TriangleSet copy = triangleSet;
+    triangleSet.clear();
+    std::vector<TriangleSet::RayHit> copyHits;
+    copy.findRayIntersections(rays, copyHits);
+    for (size_t i = 0; i < rays.size(); i++) {
+        QCOMPARE(copyHits[i].hit, hits[i].hit);
+        if (hits[i].hit) {
+            QCOMPARE(copyHits[i].distance, hits[i].distance);
+            QCOMPARE(copyHits[i].surfaceNormal, hits[i].surfaceNormal);
+        }
+    }
+}
+
+void TriangleSetTests::testEmpty() {
+    TriangleSet triangleSet;
+    std::vector<TriangleSet::RayHit> hits;
+    triangleSet.findRayIntersections(makeRays(4), hits);
+    QCOMPARE(hits.size(), (size_t)4);
+    for (const auto& hit : hits) {
+        QVERIFY(!hit.hit);
+    }
+}
+
+static const int BENCHMARK_RAYS = 100;
+
+static void addMeshSizes() {
+    QTest::addColumn<int>("rings");
+    for (int rings : { 16, 50, 160 }) {
+        QTest::newRow(qPrintable(QString("%1 triangles").arg(4 * rings * rings))) << rings;
+    }
+}
+
+void TriangleSetTests::benchmarkBruteForce_data() {
+    addMeshSizes();
+}
+
+void TriangleSetTests::benchmarkBruteForce() {
+    QFETCH(int, rings);
+    TriangleSet triangleSet = makeSphere(rings, 2 * rings);
+    auto rays = makeRays(BENCHMARK_RAYS);
+    QBENCHMARK {
+        for (const auto& ray : rays) {
+            float distance;
+            findBruteForceIntersection(triangleSet, ray, distance);
+        }
+    }
+}
+
+void TriangleSetTests::benchmarkBVH_data() {
+    addMeshSizes();
+}
+
+void TriangleSetTests::benchmarkBVH() {
+    QFETCH(int, rings);
+    TriangleSet triangleSet = makeSphere(rings, 2 * rings);
+    auto rays = makeRays(BENCHMARK_RAYS);
+    float distance;
+    BoxFace face;
+    glm::vec3 normal;
+    // the first precise pick builds the hierarchy
+    triangleSet.findRayIntersection(rays[0].origin, rays[0].direction, distance, face, normal, true);
+    QBENCHMARK {
+        for (const auto& ray : rays) {
+            triangleSet.findRayIntersection(ray.origin, ray.direction, distance, face, normal, true);
+        }
+    }
+}
+
+void TriangleSetTests::benchmarkBatched_data() {
+    addMeshSizes();
+}
+
+void TriangleSetTests::benchmarkBatched() {
+    QFETCH(int, rings);
+    TriangleSet triangleSet = makeSphere(rings, 2 * rings);
+    auto rays = makeRays(BENCHMARK_RAYS);
+    std::vector<TriangleSet::RayHit> hits;
+    triangleSet.findRayIntersections(rays, hits);
+    QBENCHMARK {
+        triangleSet.findRayIntersections(rays, hits);
+    }
+}
@@ -0,0 +1,33 @@
+//
+//  TriangleSetTests.h
+//  tests/shared/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_TriangleSetTests_h
+#define hifi_TriangleSetTests_h
+
+#include <QtTest/QtTest>
+
+class TriangleSetTests : public QObject {
+    Q_OBJECT
+
+private slots:
+    void testMatchesBruteForce();
+    void testBatchedRays();
+    void testInsertAfterPick();
+    void testCopyAfterPick();
+    void testEmpty();
+    void benchmarkBruteForce_data();
+    void benchmarkBruteForce();
+    void benchmarkBVH_data();
+    void benchmarkBVH();
+    void benchmarkBatched_data();
+    void benchmarkBatched();
+};
+
+#endif // hifi_TriangleSetTests_h
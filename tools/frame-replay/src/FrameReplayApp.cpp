@@ -0,0 +1,121 @@
+//
+//  FrameReplayApp.cpp
+//  tools/frame-replay/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "FrameReplayApp.h"
+
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+#include <QCommandLineParser>
+#include <QDebug>
+#include <QFile>
+#include <QFileInfo>
+
+#include <SharedUtil.h>
+#include <gpu/Context.h>
+#include <gpu/Frame.h>
+#include <gpu/FrameIO.h>
+#include <gpu/null/NullBackend.h>
+
+static const int DEFAULT_ITERATIONS = 100;
+
+static QString formatTimings(std::vector<quint64>& timings) {
+    std::sort(timings.begin(), timings.end());
+    quint64 total = std::accumulate(timings.begin(), timings.end(), (quint64)0);
+    return QString("min %1 us, median %2 us, mean %3 us")
+        .arg(timings.front()).arg(timings[timings.size() / 2]).arg(total / timings.size());
+}
+
+FrameReplayApp::FrameReplayApp(int argc, char* argv[]) : QCoreApplication(argc, argv) {
+
+    // parse command-line
+    QCommandLineParser parser;
+    parser.setApplicationDescription("High Fidelity GPU Frame Replay");
+    const QCommandLineOption helpOption = parser.addHelpOption();
+
+    const QCommandLineOption iterationsOption("n", "number of times each frame is replayed", "iterations",
+                                              QString::number(DEFAULT_ITERATIONS));
+    parser.addOption(iterationsOption);
+    parser.addPositionalArgument("frames", "frames captured by the interface", "frame.hfframe...");
+
+    if (!parser.parse(QCoreApplication::arguments())) {
+        qCritical() << parser.errorText() << endl;
+        parser.showHelp();
+        _returnCode = 1;
+        return;
+    }
+
+    if (parser.isSet(helpOption) || parser.positionalArguments().isEmpty()) {
+        parser.showHelp();
+        return;
+    }
+
+    int iterations = std::max(parser.value(iterationsOption).toInt(), 1);
+
+    gpu::Context::init<gpu::null::Backend>();
+    auto context = std::make_shared<gpu::Context>();
+    // the first frame sets up the context's frame timer
+    context->beginFrame();
+    context->consumeFrameUpdates(context->endFrame());
+
+    for (const QString& path : parser.positionalArguments()) {
+        QFile file(path);
+        if (!file.open(QIODevice::ReadOnly)) {
+            qCritical() << "Failed to open file " << path;
+            _returnCode = 2;
+            continue;
+        }
+        QByteArray data = file.readAll();
+
+        std::vector<quint64> buildTimings;
+        std::vector<quint64> executeTimings;
+        size_t numBatches = 0;
+        size_t numCommands = 0;
+        gpu::ContextStats stats;
+        bool failed = false;
+        for (int i = 0; i < iterations; i++) {
+            // rebuilding the batches and their objects stands for recording them
+            quint64 start = usecTimestampNow();
+            gpu::FramePointer frame = gpu::readFrame(data);
+            quint64 built = usecTimestampNow();
+            if (!frame) {
+                qCritical() << "Failed to read frame " << path;
+                failed = true;
+                break;
+            }
+            context->executeFrame(frame);
+            quint64 executed = usecTimestampNow();
+
+            buildTimings.push_back(built - start);
+            executeTimings.push_back(executed - built);
+            if (i == 0) {
+                numBatches = frame->batches.size();
+                for (const auto& batch : frame->batches) {
+                    numCommands += batch.getCommands().size();
+                }
+                context->getFrameStats(stats);
+            }
+        }
+        if (failed) {
+            _returnCode = 3;
+            continue;
+        }
+
+        qInfo().noquote() << QFileInfo(path).fileName() << ":" << numBatches << "batches," << numCommands << "commands,"
+            << stats._DSNumDrawcalls << "draws," << stats._DSNumTriangles << "triangles,"
+            << stats._PSNumSetPipelines << "pipeline changes";
+        qInfo().noquote() << "  build:  " << formatTimings(buildTimings);
+        qInfo().noquote() << "  execute:" << formatTimings(executeTimings);
+    }
+}
+
+FrameReplayApp::~FrameReplayApp() {
+}
@@ -0,0 +1,31 @@
+//
+//  FrameReplayApp.h
+//  tools/frame-replay/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#ifndef hifi_FrameReplayApp_h
+#define hifi_FrameReplayApp_h
+
+#include <QCoreApplication>
+
+// Replays frames captured from the interface (Developer > Render > Capture Frame) through the null gpu backend,
+// timing the rebuild of their batches and the translation of their commands, so render CPU changes can be
+// measured on machines without a GPU.
+class FrameReplayApp : public QCoreApplication {
+    Q_OBJECT
+public:
+    FrameReplayApp(int argc, char* argv[]);
+    ~FrameReplayApp();
+
+    int getReturnCode() const { return _returnCode; }
+
+private:
+    int _returnCode { 0 };
+};
+
+#endif //hifi_FrameReplayApp_h
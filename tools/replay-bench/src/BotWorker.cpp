@@ -0,0 +1,236 @@
+//
+//  BotWorker.cpp
+//  tools/replay-bench/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "BotWorker.h"
+
+#include <algorithm>
+
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
+#include <udt/Packet.h>
+
+void BotProbeHeader::write(udt::Packet& packet) const {
+    packet.writePrimitive(botIndex);
+    packet.writePrimitive(sequence);
+    packet.writePrimitive(sentUsecs);
+    packet.writePrimitive(kind);
+}
+
+bool BotProbeHeader::read(udt::Packet& packet) {
+    if (packet.getPayloadSize() < SIZE) {
+        return false;
+    }
+    packet.readPrimitive(&botIndex);
+    packet.readPrimitive(&sequence);
+    packet.readPrimitive(&sentUsecs);
+    packet.readPrimitive(&kind);
+    return true;
+}
+
+BotWorker::BotWorker(int firstBotIndex, const std::vector<SharedClip::Pointer>& clips, int avatarHz,
+                     const HifiSockAddr& target, QObject* parent) :
+    QObject(parent),
+    _firstBotIndex(firstBotIndex),
+    _avatarIntervalUsecs(USECS_PER_SECOND / std::max(avatarHz, 1)),
+    _target(target)
+{
+    _bots.resize(clips.size());
+    for (size_t i = 0; i < clips.size(); i++) {
+        _bots[i].index = (quint32)(firstBotIndex + i);
+        _bots[i].clip = clips[i];
+    }
+}
+
+void BotWorker::start() {
+    if (!_target.isNull()) {
+        // created here so it lives on this worker's thread
+        _socket.reset(new udt::Socket());
+        _socket->bind(QHostAddress::AnyIPv4);
+        _socket->setPacketHandler([this](std::unique_ptr<udt::Packet> packet) {
+            handleEcho(std::move(packet));
+        });
+    }
+
+    // spread the bots over their clips so they don't all send their first frames on the same tick
+    quint64 now = usecTimestampNow();
+    for (auto& bot : _bots) {
+        quint64 offsetUsecs = (quint64)randIntInRange(0, bot.clip->getDurationMs()) * USECS_PER_MSEC;
+        bot.startUsecs = now - offsetUsecs;
+        bot.nextAvatarUsecs = now + (quint64)randIntInRange(0, (int)_avatarIntervalUsecs);
+        quint32 clipTimeMs = (quint32)(offsetUsecs / USECS_PER_MSEC);
+        const auto& audioFrames = bot.clip->getAudioFrames();
+        while (bot.audioCursor < audioFrames.size() && audioFrames[bot.audioCursor].timeMs < clipTimeMs) {
+            bot.audioCursor++;
+        }
+    }
+
+    _timer = new QTimer(this);
+    _timer->setTimerType(Qt::PreciseTimer);
+    connect(_timer, &QTimer::timeout, this, &BotWorker::tick);
+    _timer->start(TICK_INTERVAL_MSECS);
+}
+
+void BotWorker::stopSending() {
+    if (_timer) {
+        _timer->stop();
+    }
+}
+
+void BotWorker::stop() {
+    stopSending();
+    if (_socket) {
+        // late echoes count as lost
+        _socket.reset();
+    }
+}
+
+void BotWorker::tick() {
+    quint64 now = usecTimestampNow();
+    for (auto& bot : _bots) {
+        update(bot, now);
+    }
+}
+
+void BotWorker::update(Bot& bot, quint64 now) {
+    quint64 elapsedMs = (now - bot.startUsecs) / USECS_PER_MSEC;
+    quint32 durationMs = bot.clip->getDurationMs();
+    quint32 loop = (quint32)(elapsedMs / durationMs);
+    quint32 clipTimeMs = (quint32)(elapsedMs % durationMs);
+
+    const auto& audioFrames = bot.clip->getAudioFrames();
+    if (loop != bot.loop) {
+        // flush the end of the previous pass before wrapping, like a looping recording does
+        while (bot.audioCursor < audioFrames.size()) {
+            send(bot, BotProbeHeader::Audio, audioFrames[bot.audioCursor++].payload, now);
+        }
+        bot.audioCursor = 0;
+        bot.loop = loop;
+        bot.stats.loops++;
+    }
+
+    // audio goes out as the playhead reaches it, lateness is how far behind the playhead it was sent
+    while (bot.audioCursor < audioFrames.size() && audioFrames[bot.audioCursor].timeMs <= clipTimeMs) {
+        const auto& frame = audioFrames[bot.audioCursor++];
+        bot.stats.audioLateness.add((quint64)(clipTimeMs - frame.timeMs) * USECS_PER_MSEC);
+        send(bot, BotProbeHeader::Audio, frame.payload, now);
+    }
+
+    // avatar data is sampled at a fixed rate, missed slots are skipped rather than caught up, as the Agent does
+    if (now >= bot.nextAvatarUsecs) {
+        bot.stats.avatarLateness.add(now - bot.nextAvatarUsecs);
+        if (auto frame = bot.clip->findAvatarFrame(clipTimeMs)) {
+            send(bot, BotProbeHeader::Avatar, frame->payload, now);
+        }
+        bot.nextAvatarUsecs += _avatarIntervalUsecs;
+        while (bot.nextAvatarUsecs <= now) {
+            bot.nextAvatarUsecs += _avatarIntervalUsecs;
+            bot.stats.avatarPacketsSkipped++;
+        }
+    }
+}
+
+void BotWorker::send(Bot& bot, BotProbeHeader::Kind kind, const QByteArray& payload, quint64 now) {
+    BotProbeHeader header;
+    header.botIndex = bot.index;
+    header.sequence = bot.sequence++;
+    header.sentUsecs = now;
+    header.kind = kind;
+
+    auto packet = udt::Packet::create();
+    header.write(*packet);
+    qint64 available = packet->getPayloadCapacity() - BotProbeHeader::SIZE;
+    if (payload.size() > available) {
+        // a real sender would cull joints to fit, keep the load at one MTU per packet
+        bot.stats.packetsTruncated++;
+    }
+    packet->write(payload.constData(), std::min((qint64)payload.size(), available));
+
+    quint64 wireSize = (quint64)packet->getWireSize();
+    bot.stats.bytesSent += wireSize;
+    _bytesSent += wireSize;
+    if (kind == BotProbeHeader::Avatar) {
+        bot.stats.avatarPacketsSent++;
+    } else {
+        bot.stats.audioPacketsSent++;
+    }
+
+    if (_socket) {
+        _socket->writePacket(std::move(packet), _target);
+    }
+}
+
+void BotWorker::handleEcho(std::unique_ptr<udt::Packet> packet) {
+    BotProbeHeader header;
+    if (!header.read(*packet)) {
+        return;
+    }
+    int slot = (int)header.botIndex - _firstBotIndex;
+    if (slot < 0 || slot >= (int)_bots.size()) {
+        return;
+    }
+    auto& stats = _bots[slot].stats;
+    stats.roundTrip.add(usecTimestampNow() - header.sentUsecs);
+    stats.echoesReceived++;
+}
+
+static double toKbps(quint64 bytes, float seconds) {
+    return seconds > 0.0f ? (double)bytes * BITS_IN_BYTE / seconds / BYTES_PER_KILOBYTE : 0.0;
+}
+
+QJsonArray BotWorker::getBotReports(float seconds, Totals& totals) const {
+    QJsonArray reports;
+    for (const auto& bot : _bots) {
+        const auto& stats = bot.stats;
+        quint64 sent = stats.avatarPacketsSent + stats.audioPacketsSent;
+        QJsonObject report {
+            { "index", (double)bot.index },
+            { "clip", bot.clip->getName() },
+            { "loops", (double)stats.loops },
+            { "avatarPacketsSent", (double)stats.avatarPacketsSent },
+            { "avatarPacketsSkipped", (double)stats.avatarPacketsSkipped },
+            { "audioPacketsSent", (double)stats.audioPacketsSent },
+            { "packetsTruncated", (double)stats.packetsTruncated },
+            { "kbps", toKbps(stats.bytesSent, seconds) },
+            { "avatarLatenessUsecs", stats.avatarLateness.toJson() },
+            { "audioLatenessUsecs", stats.audioLateness.toJson() }
+        };
+        if (!_target.isNull()) {
+            report["echoesReceived"] = (double)stats.echoesReceived;
+            report["loss"] = sent > 0 ? 1.0 - (double)stats.echoesReceived / sent : 0.0;
+            report["roundTripUsecs"] = stats.roundTrip.toJson();
+        }
+        reports.append(report);
+
+        totals.avatarLateness.merge(stats.avatarLateness);
+        totals.audioLateness.merge(stats.audioLateness);
+        totals.roundTrip.merge(stats.roundTrip);
+        totals.packetsSent += sent;
+        totals.echoesReceived += stats.echoesReceived;
+        totals.bytesSent += stats.bytesSent;
+    }
+    totals.hasTarget = totals.hasTarget || !_target.isNull();
+    return reports;
+}
+
+QJsonObject BotWorker::Totals::toJson(float seconds) const {
+    QJsonObject totals {
+        { "packetsSent", (double)packetsSent },
+        { "bytesSent", (double)bytesSent },
+        { "kbps", toKbps(bytesSent, seconds) },
+        { "avatarLatenessUsecs", avatarLateness.toJson() },
+        { "audioLatenessUsecs", audioLateness.toJson() }
+    };
+    if (hasTarget) {
+        totals["echoesReceived"] = (double)echoesReceived;
+        totals["loss"] = packetsSent > 0 ? 1.0 - (double)echoesReceived / packetsSent : 0.0;
+        totals["roundTripUsecs"] = roundTrip.toJson();
+    }
+    return totals;
+}
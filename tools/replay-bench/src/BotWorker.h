@@ -0,0 +1,128 @@
+//
+//  BotWorker.h
+//  tools/replay-bench/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#pragma once
+
+#ifndef hifi_BotWorker_h
+#define hifi_BotWorker_h
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonObject>
+#include <QtCore/QObject>
+#include <QtCore/QTimer>
+
+#include <HifiSockAddr.h>
+#include <udt/Socket.h>
+
+#include "LatencyHistogram.h"
+#include "SharedClip.h"
+
+// Every packet a bot sends starts with this, the echo server sends it back untouched.
+class BotProbeHeader {
+public:
+    enum Kind : quint8 { Avatar, Audio };
+
+    quint32 botIndex { 0 };
+    quint32 sequence { 0 };
+    quint64 sentUsecs { 0 };
+    quint8 kind { Avatar };
+
+    static const int SIZE = sizeof(quint32) + sizeof(quint32) + sizeof(quint64) + sizeof(quint8);
+
+    void write(udt::Packet& packet) const;
+    bool read(udt::Packet& packet);
+};
+
+// Plays a slice of the bots on one thread: each bot replays its clip at the Agent's rates and sends
+// what it would send, either nowhere (dry run) or to a target over the worker's socket, shared by its bots.
+class BotWorker : public QObject {
+    Q_OBJECT
+public:
+    static const int TICK_INTERVAL_MSECS = 5;
+
+    BotWorker(int firstBotIndex, const std::vector<SharedClip::Pointer>& clips, int avatarHz,
+              const HifiSockAddr& target, QObject* parent = nullptr);
+
+    int getBotCount() const { return (int)_bots.size(); }
+    quint64 getBytesSent() const { return _bytesSent.load(); }
+
+    // sums over all the bots, merged from every worker
+    class Totals {
+    public:
+        LatencyHistogram avatarLateness;
+        LatencyHistogram audioLateness;
+        LatencyHistogram roundTrip;
+        quint64 packetsSent { 0 };
+        quint64 echoesReceived { 0 };
+        quint64 bytesSent { 0 };
+        bool hasTarget { false }; // false for a dry run, which has no echoes to count
+
+        QJsonObject toJson(float seconds) const;
+    };
+
+    // one entry per bot, only valid once the worker is stopped and its thread is finished
+    QJsonArray getBotReports(float seconds, Totals& totals) const;
+
+public slots:
+    void start();
+    // stops the bots but keeps listening for echoes
+    void stopSending();
+    void stop();
+
+private slots:
+    void tick();
+
+private:
+    class Stats {
+    public:
+        LatencyHistogram avatarLateness;
+        LatencyHistogram audioLateness;
+        LatencyHistogram roundTrip;
+        quint64 avatarPacketsSent { 0 };
+        quint64 avatarPacketsSkipped { 0 };
+        quint64 audioPacketsSent { 0 };
+        quint64 packetsTruncated { 0 };
+        quint64 echoesReceived { 0 };
+        quint64 bytesSent { 0 };
+        quint32 loops { 0 };
+    };
+
+    class Bot {
+    public:
+        quint32 index { 0 };
+        SharedClip::Pointer clip;
+        quint64 startUsecs { 0 };
+        quint64 nextAvatarUsecs { 0 };
+        size_t audioCursor { 0 };
+        quint32 loop { 0 };
+        quint32 sequence { 0 };
+        Stats stats;
+    };
+
+    void update(Bot& bot, quint64 now);
+    void send(Bot& bot, BotProbeHeader::Kind kind, const QByteArray& payload, quint64 now);
+    void handleEcho(std::unique_ptr<udt::Packet> packet);
+
+    std::vector<Bot> _bots;
+    int _firstBotIndex { 0 };
+    quint64 _avatarIntervalUsecs { 0 };
+
+    HifiSockAddr _target;
+    std::unique_ptr<udt::Socket> _socket;
+    QTimer* _timer { nullptr };
+
+    std::atomic<quint64> _bytesSent { 0 };
+};
+
+#endif // hifi_BotWorker_h
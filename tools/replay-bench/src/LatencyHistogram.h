@@ -0,0 +1,81 @@
+//
+//  LatencyHistogram.h
+//  tools/replay-bench/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#pragma once
+
+#ifndef hifi_LatencyHistogram_h
+#define hifi_LatencyHistogram_h
+
+#include <array>
+
+#include <QtCore/QJsonArray>
+#include <QtCore/QJsonObject>
+
+// Power of two buckets of microseconds: bucket 0 counts zeros, bucket i counts values in [2^(i-1), 2^i).
+// Small enough to keep one per bot and stream.
+class LatencyHistogram {
+public:
+    static const int NUM_BUCKETS = 40;
+
+    void add(quint64 usecs) {
+        int bucket = 0;
+        while (usecs > 0 && bucket < NUM_BUCKETS - 1) {
+            usecs >>= 1;
+            bucket++;
+        }
+        _buckets[bucket]++;
+        _count++;
+    }
+
+    void merge(const LatencyHistogram& other) {
+        for (int i = 0; i < NUM_BUCKETS; i++) {
+            _buckets[i] += other._buckets[i];
+        }
+        _count += other._count;
+    }
+
+    quint64 getCount() const { return _count; }
+
+    // upper bound of the bucket holding the given fraction of the samples
+    quint64 getPercentile(float fraction) const {
+        quint64 target = (quint64)(fraction * _count);
+        quint64 seen = 0;
+        for (int i = 0; i < NUM_BUCKETS; i++) {
+            seen += _buckets[i];
+            if (seen > target) {
+                return i == 0 ? 0 : (1ULL << i) - 1;
+            }
+        }
+        return 0;
+    }
+
+    QJsonObject toJson() const {
+        QJsonArray buckets;
+        int last = NUM_BUCKETS - 1;
+        while (last > 0 && _buckets[last] == 0) {
+            last--;
+        }
+        for (int i = 0; i <= last; i++) {
+            buckets.append((double)_buckets[i]);
+        }
+        return QJsonObject {
+            { "count", (double)_count },
+            { "p50", (double)getPercentile(0.5f) },
+            { "p99", (double)getPercentile(0.99f) },
+            { "log2Buckets", buckets }
+        };
+    }
+
+private:
+    std::array<quint64, NUM_BUCKETS> _buckets {};
+    quint64 _count { 0 };
+};
+
+#endif // hifi_LatencyHistogram_h
@@ -0,0 +1,268 @@
+//
+//  ReplayBench.cpp
+//  tools/replay-bench/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "ReplayBench.h"
+
+#include <algorithm>
+#include <cstdio>
+
+#include <QtCore/QFile>
+#include <QtCore/QJsonDocument>
+
+#include <LogHandler.h>
+#include <NumericalConstants.h>
+#include <SharedUtil.h>
+#include <udt/Packet.h>
+
+// same rate as the Agent sends a scripted avatar at
+const int AVATAR_DATA_HZ = 45;
+
+const QCommandLineOption CLIP_OPTION {
+    "clip", "recording to replay, repeat to spread bots over several clips", "path"
+};
+const QCommandLineOption BOTS_OPTION { "bots", "number of bots (defaults to 100)", "count", "100" };
+const QCommandLineOption THREADS_OPTION {
+    "threads", "number of worker threads (defaults to the number of cores)", "count"
+};
+const QCommandLineOption DURATION_OPTION { "duration", "seconds to run (defaults to 60)", "seconds", "60" };
+const QCommandLineOption AVATAR_HZ_OPTION {
+    "avatar-hz", "avatar data send rate (defaults to the Agent's)", "hz", QString::number(AVATAR_DATA_HZ)
+};
+const QCommandLineOption TARGET_OPTION {
+    "target", "echo server to send to, as host:port (defaults to a dry run that sends nothing)", "host:port"
+};
+const QCommandLineOption LISTEN_OPTION { "listen", "run as an echo server on the given port", "port" };
+const QCommandLineOption REPORT_OPTION { "report", "file to write the JSON report to (defaults to stdout)", "path" };
+
+const int PROGRESS_INTERVAL_MSECS = 5 * MSECS_PER_SECOND;
+// time given to the last echoes before the workers stop
+const int ECHO_DRAIN_MSECS = 500;
+
+ReplayBench::ReplayBench(int& argc, char** argv) :
+    QCoreApplication(argc, argv)
+{
+    qInstallMessageHandler(LogHandler::verboseMessageHandler);
+
+    if (!parseArguments()) {
+        QMetaObject::invokeMethod(this, "quit", Qt::QueuedConnection);
+        return;
+    }
+
+    if (_argumentParser.isSet(LISTEN_OPTION)) {
+        startEchoServer((quint16)_argumentParser.value(LISTEN_OPTION).toUInt());
+    } else {
+        startBots();
+    }
+}
+
+ReplayBench::~ReplayBench() {
+    stopWorkers();
+    for (size_t i = 0; i < _threads.size(); i++) {
+        delete _workers[i];
+        delete _threads[i];
+    }
+}
+
+bool ReplayBench::parseArguments() {
+    _argumentParser.setApplicationDescription("High Fidelity Replay Bench");
+    _argumentParser.addOptions({
+        CLIP_OPTION, BOTS_OPTION, THREADS_OPTION, DURATION_OPTION, AVATAR_HZ_OPTION,
+        TARGET_OPTION, LISTEN_OPTION, REPORT_OPTION
+    });
+    const QCommandLineOption helpOption = _argumentParser.addHelpOption();
+
+    if (!_argumentParser.parse(arguments())) {
+        qCritical() << _argumentParser.errorText();
+        _argumentParser.showHelp();
+        return false;
+    }
+
+    if (_argumentParser.isSet(helpOption)) {
+        _argumentParser.showHelp();
+        return false;
+    }
+
+    if (_argumentParser.isSet(LISTEN_OPTION)) {
+        return true;
+    }
+
+    for (const auto& path : _argumentParser.values(CLIP_OPTION)) {
+        auto clip = SharedClip::load(path);
+        if (!clip) {
+            return false;
+        }
+        _clips.push_back(clip);
+    }
+    if (_clips.empty()) {
+        qCritical() << "At least one --clip is required.";
+        return false;
+    }
+
+    _botCount = _argumentParser.value(BOTS_OPTION).toInt();
+    _durationSeconds = _argumentParser.value(DURATION_OPTION).toInt();
+    _avatarHz = _argumentParser.value(AVATAR_HZ_OPTION).toInt();
+    if (_botCount <= 0 || _durationSeconds <= 0 || _avatarHz <= 0) {
+        qCritical() << "--bots, --duration and --avatar-hz must be positive.";
+        return false;
+    }
+
+    if (_argumentParser.isSet(TARGET_OPTION)) {
+        QString hostnamePortString = _argumentParser.value(TARGET_OPTION);
+        int separator = hostnamePortString.lastIndexOf(':');
+        quint16 port = (quint16)hostnamePortString.mid(separator + 1).toUInt();
+        if (separator <= 0 || port == 0) {
+            qCritical() << "Could not parse a host and port combination from" << hostnamePortString;
+            return false;
+        }
+        // blocks on the lookup, fine for a command line tool
+        _target = HifiSockAddr(hostnamePortString.left(separator), port, true);
+        if (_target.getAddress().isNull()) {
+            qCritical() << "Could not resolve" << hostnamePortString;
+            return false;
+        }
+    }
+
+    _reportPath = _argumentParser.value(REPORT_OPTION);
+    return true;
+}
+
+void ReplayBench::startBots() {
+    int threadCount = _argumentParser.isSet(THREADS_OPTION) ?
+        _argumentParser.value(THREADS_OPTION).toInt() : QThread::idealThreadCount();
+    threadCount = std::max(1, std::min(threadCount, _botCount));
+
+    qDebug() << "Starting" << _botCount << "bots on" << threadCount << "threads for" << _durationSeconds << "seconds,"
+        << (_target.isNull() ? QString("dry run") : QString("sending to %1").arg(_target.toString()));
+
+    int firstBot = 0;
+    for (int i = 0; i < threadCount; i++) {
+        int lastBot = (int)((qint64)_botCount * (i + 1) / threadCount);
+        std::vector<SharedClip::Pointer> clips;
+        for (int bot = firstBot; bot < lastBot; bot++) {
+            clips.push_back(_clips[bot % _clips.size()]);
+        }
+
+        auto thread = new QThread();
+        thread->setObjectName(QString("BotWorker %1").arg(i));
+        auto worker = new BotWorker(firstBot, clips, _avatarHz, _target);
+        worker->moveToThread(thread);
+        connect(thread, &QThread::started, worker, &BotWorker::start);
+        _threads.push_back(thread);
+        _workers.push_back(worker);
+        firstBot = lastBot;
+    }
+
+    _startUsecs = _lastProgressUsecs = usecTimestampNow();
+    for (auto thread : _threads) {
+        thread->start();
+    }
+
+    connect(&_progressTimer, &QTimer::timeout, this, &ReplayBench::printProgress);
+    _progressTimer.start(PROGRESS_INTERVAL_MSECS);
+    QTimer::singleShot(_durationSeconds * MSECS_PER_SECOND, this, &ReplayBench::finish);
+}
+
+void ReplayBench::startEchoServer(quint16 port) {
+    _echoSocket.reset(new udt::Socket());
+    _echoSocket->bind(QHostAddress::AnyIPv4, port);
+    _echoSocket->setPacketHandler([this](std::unique_ptr<udt::Packet> packet) {
+        // only the probe header goes back, the echo shouldn't double the load on the sender's link
+        BotProbeHeader header;
+        if (!header.read(*packet)) {
+            return;
+        }
+        auto reply = udt::Packet::create(BotProbeHeader::SIZE);
+        header.write(*reply);
+        _echoSocket->writePacket(std::move(reply), packet->getSenderSockAddr());
+        _echoedPackets++;
+    });
+    qDebug() << "Echo server is listening on" << _echoSocket->localPort();
+
+    _lastProgressUsecs = usecTimestampNow();
+    connect(&_progressTimer, &QTimer::timeout, this, &ReplayBench::printProgress);
+    _progressTimer.start(PROGRESS_INTERVAL_MSECS);
+}
+
+void ReplayBench::printProgress() {
+    quint64 now = usecTimestampNow();
+    float seconds = (float)(now - _lastProgressUsecs) / USECS_PER_SECOND;
+    _lastProgressUsecs = now;
+
+    if (_echoSocket) {
+        qDebug() << "Echoed" << _echoedPackets << "packets";
+        return;
+    }
+
+    quint64 bytes = 0;
+    for (auto worker : _workers) {
+        bytes += worker->getBytesSent();
+    }
+    float kbps = seconds > 0.0f ? (float)(bytes - _lastProgressBytes) * BITS_IN_BYTE / seconds / BYTES_PER_KILOBYTE : 0.0f;
+    _lastProgressBytes = bytes;
+    qDebug() << (now - _startUsecs) / USECS_PER_SECOND << "s -" << bytes << "bytes sent," << kbps << "kbps";
+}
+
+void ReplayBench::finish() {
+    _progressTimer.stop();
+    // stop sending first, then give the echoes in flight a chance to land
+    for (auto worker : _workers) {
+        QMetaObject::invokeMethod(worker, "stopSending", Qt::BlockingQueuedConnection);
+    }
+    _stopUsecs = usecTimestampNow();
+    QTimer::singleShot(_target.isNull() ? 0 : ECHO_DRAIN_MSECS, this, [this] {
+        stopWorkers();
+        writeReport();
+        quit();
+    });
+}
+
+void ReplayBench::stopWorkers() {
+    for (size_t i = 0; i < _threads.size(); i++) {
+        if (_threads[i]->isRunning()) {
+            QMetaObject::invokeMethod(_workers[i], "stop", Qt::BlockingQueuedConnection);
+            _threads[i]->quit();
+            _threads[i]->wait();
+        }
+    }
+}
+
+void ReplayBench::writeReport() {
+    float seconds = (float)(_stopUsecs - _startUsecs) / USECS_PER_SECOND;
+
+    QJsonArray bots;
+    BotWorker::Totals totals;
+    for (auto worker : _workers) {
+        for (const auto& report : worker->getBotReports(seconds, totals)) {
+            bots.append(report);
+        }
+    }
+
+    QJsonObject report {
+        { "bots", bots },
+        { "totals", totals.toJson(seconds) },
+        { "botCount", _botCount },
+        { "threadCount", (int)_threads.size() },
+        { "seconds", seconds },
+        { "avatarHz", _avatarHz },
+        { "target", _target.isNull() ? QString() : _target.toString() }
+    };
+    QByteArray json = QJsonDocument(report).toJson();
+
+    if (_reportPath.isEmpty()) {
+        fprintf(stdout, "%s", json.constData());
+        return;
+    }
+    QFile file(_reportPath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate) || file.write(json) != json.size()) {
+        qCritical() << "Could not write the report to" << _reportPath;
+        return;
+    }
+    qDebug() << "Report written to" << _reportPath;
+}
@@ -0,0 +1,72 @@
+//
+//  ReplayBench.h
+//  tools/replay-bench/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#pragma once
+
+#ifndef hifi_ReplayBench_h
+#define hifi_ReplayBench_h
+
+#include <memory>
+#include <vector>
+
+#include <QtCore/QCommandLineParser>
+#include <QtCore/QCoreApplication>
+#include <QtCore/QThread>
+#include <QtCore/QTimer>
+
+#include <HifiSockAddr.h>
+#include <udt/Socket.h>
+
+#include "BotWorker.h"
+#include "SharedClip.h"
+
+// Transport benchmark: replays recordings as many bots in one process and reports how well the sending side and
+// the udt socket kept up.  With --listen it is instead the echo server the bots measure round trips against.
+// The bots are not domain nodes, mixers would drop their packets, so this measures no mixer.
+class ReplayBench : public QCoreApplication {
+    Q_OBJECT
+public:
+    ReplayBench(int& argc, char** argv);
+    ~ReplayBench();
+
+private slots:
+    void printProgress();
+    void finish();
+
+private:
+    bool parseArguments();
+    void startBots();
+    void startEchoServer(quint16 port);
+    void stopWorkers();
+    void writeReport();
+
+    QCommandLineParser _argumentParser;
+
+    std::vector<SharedClip::Pointer> _clips;
+    std::vector<QThread*> _threads;
+    std::vector<BotWorker*> _workers;
+
+    int _botCount { 0 };
+    int _avatarHz { 0 };
+    int _durationSeconds { 0 };
+    HifiSockAddr _target;
+    QString _reportPath;
+
+    quint64 _startUsecs { 0 };
+    quint64 _stopUsecs { 0 };
+    quint64 _lastProgressBytes { 0 };
+    quint64 _lastProgressUsecs { 0 };
+    QTimer _progressTimer;
+
+    std::unique_ptr<udt::Socket> _echoSocket;
+    quint64 _echoedPackets { 0 };
+};
+
+#endif // hifi_ReplayBench_h
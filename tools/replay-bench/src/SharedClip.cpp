@@ -0,0 +1,75 @@
+//
+//  SharedClip.cpp
+//  tools/replay-bench/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#include "SharedClip.h"
+
+#include <algorithm>
+
+#include <QtCore/QDebug>
+
+#include <AudioConstants.h>
+#include <AvatarData.h>
+#include <recording/Clip.h>
+#include <recording/Frame.h>
+
+SharedClip::Pointer SharedClip::load(const QString& filePath) {
+    using namespace recording;
+
+    auto clip = Clip::fromFile(filePath);
+    if (!clip) {
+        qWarning() << "Unable to read recording" << filePath;
+        return nullptr;
+    }
+
+    static const FrameType AVATAR_FRAME_TYPE = Frame::registerFrameType(AvatarData::FRAME_NAME);
+    static const FrameType AUDIO_FRAME_TYPE = Frame::registerFrameType(AudioConstants::getAudioFrameName());
+
+    auto result = std::make_shared<SharedClip>();
+    result->_name = clip->getName().isEmpty() ? filePath : clip->getName();
+    result->_durationMs = Frame::frameTimeToMilliseconds(Frame::secondsToFrameTime(clip->duration()));
+
+    // apply every avatar frame to a scratch avatar, like the Agent's frame handler does, and keep what it would send
+    AvatarData avatar;
+    clip->seek(0.0f);
+    for (auto frame = clip->nextFrame(); frame; frame = clip->nextFrame()) {
+        SharedClip::Frame decoded;
+        decoded.timeMs = Frame::frameTimeToMilliseconds(frame->timeOffset);
+        if (frame->type == AVATAR_FRAME_TYPE) {
+            AvatarData::fromFrame(frame->data, avatar);
+            decoded.payload = avatar.toByteArrayStateful(AvatarData::SendAllData);
+            result->_avatarFrames.push_back(decoded);
+        } else if (frame->type == AUDIO_FRAME_TYPE) {
+            decoded.payload = frame->data;
+            result->_audioFrames.push_back(decoded);
+        }
+    }
+
+    if (result->_durationMs == 0 || (result->_avatarFrames.empty() && result->_audioFrames.empty())) {
+        qWarning() << "Recording" << filePath << "has nothing to play";
+        return nullptr;
+    }
+
+    auto byTime = [](const SharedClip::Frame& a, const SharedClip::Frame& b) { return a.timeMs < b.timeMs; };
+    std::stable_sort(result->_avatarFrames.begin(), result->_avatarFrames.end(), byTime);
+    std::stable_sort(result->_audioFrames.begin(), result->_audioFrames.end(), byTime);
+
+    qDebug() << "Loaded" << result->_name << "-" << result->_durationMs << "ms,"
+        << result->_avatarFrames.size() << "avatar frames," << result->_audioFrames.size() << "audio frames";
+    return result;
+}
+
+const SharedClip::Frame* SharedClip::findAvatarFrame(quint32 timeMs) const {
+    auto next = std::upper_bound(_avatarFrames.begin(), _avatarFrames.end(), timeMs,
+                                 [](quint32 time, const SharedClip::Frame& frame) { return time < frame.timeMs; });
+    if (next == _avatarFrames.begin()) {
+        return nullptr;
+    }
+    return &(*(next - 1));
+}
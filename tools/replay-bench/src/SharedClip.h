@@ -0,0 +1,53 @@
+//
+//  SharedClip.h
+//  tools/replay-bench/src
+//
+//  Copyright 2017 High Fidelity, Inc.
+//
+//  Distributed under the Apache License, Version 2.0.
+//  See the accompanying file LICENSE or http://www.apache.org/licenses/LICENSE-2.0.html
+//
+
+#pragma once
+
+#ifndef hifi_SharedClip_h
+#define hifi_SharedClip_h
+
+#include <memory>
+#include <vector>
+
+#include <QtCore/QByteArray>
+#include <QtCore/QString>
+
+// A recording decoded once into the payloads an Agent playing it would send, shared read-only by every bot.
+class SharedClip {
+public:
+    using Pointer = std::shared_ptr<const SharedClip>;
+
+    class Frame {
+    public:
+        quint32 timeMs { 0 }; // from the start of the clip
+        QByteArray payload;
+    };
+
+    // nullptr if the file can't be read or holds neither avatar nor audio frames
+    static Pointer load(const QString& filePath);
+
+    const QString& getName() const { return _name; }
+    quint32 getDurationMs() const { return _durationMs; }
+
+    // sorted by time
+    const std::vector<Frame>& getAvatarFrames() const { return _avatarFrames; }
+    const std::vector<Frame>& getAudioFrames() const { return _audioFrames; }
+
+    // the last avatar frame at or before the given time, nullptr if there is none
+    const Frame* findAvatarFrame(quint32 timeMs) const;
+
+private:
+    QString _name;
+    quint32 _durationMs { 0 };
+    std::vector<Frame> _avatarFrames;
+    std::vector<Frame> _audioFrames;
+};
+
+#endif // hifi_SharedClip_h